@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+""" pygame.examples.maskbench
+
+Time the Mask overlap functions with each overlap backend this machine
+supports, on square masks from 32x32 up to 2048x2048.
+
+GENERIC is the plain C version; SSE2 and AVX2 test several rows at once.
+The masks are striped so that overlap() never finds a hit and has to scan
+the whole area, like the other three functions.
+
+   python -m pygame.examples.maskbench [repeats]
+"""
+
+import sys
+import time
+
+import pygame
+
+SIZES = (32, 64, 128, 256, 512, 1024, 2048)
+BACKENDS = ('GENERIC', 'SSE2', 'AVX2')
+
+
+def striped_mask(size, first_row):
+    """A mask with every other row set, starting at first_row."""
+    mask = pygame.mask.Mask((size, size))
+    row = pygame.mask.Mask((size, 1), fill=True)
+    for y in range(first_row, size, 2):
+        mask.draw(row, (0, y))
+    return mask
+
+
+def time_calls(func, repeats):
+    start = time.time()
+    for _ in range(repeats):
+        func()
+    return (time.time() - start) / repeats
+
+
+def main(repeats=20):
+    original = pygame.mask._get_overlap_backend()
+    backends = []
+    for backend in BACKENDS:
+        try:
+            pygame.mask._set_overlap_backend(backend)
+        except ValueError:
+            continue
+        backends.append(backend)
+
+    print("microseconds per call, offset (3, 2)\n")
+    print("%-10s %-8s %10s %10s %10s %10s" % (
+        "size", "backend", "overlap", "area", "mask", "speedup"))
+    try:
+        for size in SIZES:
+            mask1 = striped_mask(size, 0)
+            mask2 = striped_mask(size, 1)
+            offset = (3, 2)
+            count = max(1, repeats * (2048 // size) ** 2 // 64)
+            generic_total = None
+            for backend in backends:
+                pygame.mask._set_overlap_backend(backend)
+                times = [
+                    time_calls(lambda: mask1.overlap(mask2, offset), count),
+                    time_calls(lambda: mask1.overlap_area(mask2, offset),
+                               count),
+                    time_calls(lambda: mask1.overlap_mask(mask2, offset),
+                               count),
+                ]
+                total = sum(times)
+                if generic_total is None:
+                    generic_total = total
+                print("%-10s %-8s %10.1f %10.1f %10.1f %9.2fx" % (
+                    "%dx%d" % (size, size), backend,
+                    times[0] * 1e6, times[1] * 1e6, times[2] * 1e6,
+                    generic_total / total))
+    finally:
+        pygame.mask._set_overlap_backend(original)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1:
+        main(int(sys.argv[1]))
+    else:
+        main()
@@ -12,6 +12,7 @@ LGPL (c) A. Schiffler
 #include <string.h>
 
 #include "SDL_gfxPrimitives.h"
+#include "../polygon_fill.h"
 //#include "SDL_rotozoom.h"
 #include "SDL_gfxPrimitives_font.h"
 
@@ -5081,16 +5082,37 @@ int aapolygonRGBA(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy, int n
 /* ---- Filled Polygon */
 
 /*!
-\brief Internal helper qsort callback functions used in filled polygon drawing.
+\brief Internal state passed to the span callbacks of filled and textured polygons.
+*/
+typedef struct {
+	SDL_Surface *dst;
+	Uint32 color;
+	SDL_Surface *texture;
+	int texture_dx;
+	int texture_dy;
+	int result;
+} _gfxPolygonSpan;
 
-\param a The surface to draw on.
-\param b Vertex array containing X coordinates of the points of the polygon.
+/*!
+\brief Internal span callback used in filled polygon drawing.
 
-\returns Returns 0 if a==b, a negative number if a<b or a positive number if a>b.
+\param data The _gfxPolygonSpan state.
+\param y The scanline.
+\param xs Sorted 16.16 fixed point intersections of the polygon with the scanline.
+\param count Number of intersections.
 */
-int _gfxPrimitivesCompareInt(const void *a, const void *b)
+static void _filledPolygonSpan(void *data, int y, const int *xs, int count)
 {
-	return (*(const int *) a) - (*(const int *) b);
+	_gfxPolygonSpan *span = (_gfxPolygonSpan *) data;
+	int i, xa, xb;
+
+	for (i = 0; (i + 1 < count); i += 2) {
+		xa = xs[i] + 1;
+		xa = (xa >> 16) + ((xa & 32768) >> 15);
+		xb = xs[i+1] - 1;
+		xb = (xb >> 16) + ((xb & 32768) >> 15);
+		span->result |= hlineColor(span->dst, xa, xb, y, span->color);
+	}
 }
 
 /*!
@@ -5124,14 +5146,8 @@ Note: The last two parameters are optional; but are required for multithreaded o
 */
 int filledPolygonColorMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy, int n, Uint32 color, int **polyInts, int *polyAllocated)
 {
-	int result;
 	int i;
-	int y, xa, xb;
-	int miny, maxy;
-	int x1, y1;
-	int x2, y2;
-	int ind1, ind2;
-	int ints;
+	_gfxPolygonSpan span;
 	int *gfxPrimitivesPolyInts = NULL;
 	int *gfxPrimitivesPolyIntsNew = NULL;
 	int gfxPrimitivesPolyAllocated = 0;
@@ -5177,11 +5193,11 @@ int filledPolygonColorMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy
 	* Allocate temp array, only grow array 
 	*/
 	if (!gfxPrimitivesPolyAllocated) {
-		gfxPrimitivesPolyInts = (int *) malloc(sizeof(int) * n);
-		gfxPrimitivesPolyAllocated = n;
+		gfxPrimitivesPolyInts = (int *) malloc(sizeof(int) * 2 * n);
+		gfxPrimitivesPolyAllocated = 2 * n;
 	} else {
-		if (gfxPrimitivesPolyAllocated < n) {
-			gfxPrimitivesPolyIntsNew = (int *) realloc(gfxPrimitivesPolyInts, sizeof(int) * n);
+		if (gfxPrimitivesPolyAllocated < 2 * n) {
+			gfxPrimitivesPolyIntsNew = (int *) realloc(gfxPrimitivesPolyInts, sizeof(int) * 2 * n);
 			if (!gfxPrimitivesPolyIntsNew) {
 				if (!gfxPrimitivesPolyInts) {
 					free(gfxPrimitivesPolyInts);
@@ -5190,7 +5206,7 @@ int filledPolygonColorMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy
 				gfxPrimitivesPolyAllocated = 0;
 			} else {
 				gfxPrimitivesPolyInts = gfxPrimitivesPolyIntsNew;
-				gfxPrimitivesPolyAllocated = n;
+				gfxPrimitivesPolyAllocated = 2 * n;
 			}
 		}
 	}
@@ -5221,62 +5237,22 @@ int filledPolygonColorMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy
 	}
 
 	/*
-	* Determine Y maxima 
+	* Draw, scanning y with the shared active edge table filler 
 	*/
-	miny = vy[0];
-	maxy = vy[0];
-	for (i = 1; (i < n); i++) {
-		if (vy[i] < miny) {
-			miny = vy[i];
-		} else if (vy[i] > maxy) {
-			maxy = vy[i];
-		}
+	for (i = 0; (i < n); i++) {
+		gfxPrimitivesPolyInts[i] = vx[i];
+		gfxPrimitivesPolyInts[n + i] = vy[i];
 	}
-
-	/*
-	* Draw, scanning y 
-	*/
-	result = 0;
-	for (y = miny; (y <= maxy); y++) {
-		ints = 0;
-		for (i = 0; (i < n); i++) {
-			if (!i) {
-				ind1 = n - 1;
-				ind2 = 0;
-			} else {
-				ind1 = i - 1;
-				ind2 = i;
-			}
-			y1 = vy[ind1];
-			y2 = vy[ind2];
-			if (y1 < y2) {
-				x1 = vx[ind1];
-				x2 = vx[ind2];
-			} else if (y1 > y2) {
-				y2 = vy[ind1];
-				y1 = vy[ind2];
-				x2 = vx[ind1];
-				x1 = vx[ind2];
-			} else {
-				continue;
-			}
-			if ( ((y >= y1) && (y < y2)) || ((y == maxy) && (y > y1) && (y <= y2)) ) {
-				gfxPrimitivesPolyInts[ints++] = ((65536 * (y - y1)) / (y2 - y1)) * (x2 - x1) + (65536 * x1);
-			} 	    
-		}
-
-		qsort(gfxPrimitivesPolyInts, ints, sizeof(int), _gfxPrimitivesCompareInt);
-
-		for (i = 0; (i < ints); i += 2) {
-			xa = gfxPrimitivesPolyInts[i] + 1;
-			xa = (xa >> 16) + ((xa & 32768) >> 15);
-			xb = gfxPrimitivesPolyInts[i+1] - 1;
-			xb = (xb >> 16) + ((xb & 32768) >> 15);
-			result |= hlineColor(dst, xa, xb, y, color);
-		}
+	span.dst = dst;
+	span.color = color;
+	span.result = 0;
+	if (pg_fill_polygon(gfxPrimitivesPolyInts, gfxPrimitivesPolyInts + n, n,
+		dst->clip_rect.y, dst->clip_rect.y + dst->clip_rect.h - 1,
+		PG_POLY_FIXED16, _filledPolygonSpan, &span)) {
+		return (-1);
 	}
 
-	return (result);
+	return (span.result);
 }
 
 /*!
@@ -5476,6 +5452,28 @@ int _HLineTextured(SDL_Surface * dst, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surfac
 	return result;
 }
 
+/*!
+\brief Internal span callback used in textured polygon drawing.
+
+\param data The _gfxPolygonSpan state.
+\param y The scanline.
+\param xs Sorted 16.16 fixed point intersections of the polygon with the scanline.
+\param count Number of intersections.
+*/
+static void _texturedPolygonSpan(void *data, int y, const int *xs, int count)
+{
+	_gfxPolygonSpan *span = (_gfxPolygonSpan *) data;
+	int i, xa, xb;
+
+	for (i = 0; (i + 1 < count); i += 2) {
+		xa = xs[i] + 1;
+		xa = (xa >> 16) + ((xa & 32768) >> 15);
+		xb = xs[i+1] - 1;
+		xb = (xb >> 16) + ((xb & 32768) >> 15);
+		span->result |= _HLineTextured(span->dst, xa, xb, y, span->texture, span->texture_dx, span->texture_dy);
+	}
+}
+
 /*!
 \brief Draws a polygon filled with the given texture (Multi-Threading Capable). 
 
@@ -5502,14 +5500,9 @@ to the left and want the texture to apear the same you need to increase the text
 int texturedPolygonMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy, int n, 
 					  SDL_Surface * texture, int texture_dx, int texture_dy, int **polyInts, int *polyAllocated)
 {
-	int result;
 	int i;
-	int y, xa, xb;
 	int minx,maxx,miny, maxy;
-	int x1, y1;
-	int x2, y2;
-	int ind1, ind2;
-	int ints;
+	_gfxPolygonSpan span;
 	int *gfxPrimitivesPolyInts = NULL;
 	int gfxPrimitivesPolyAllocated = 0;
 
@@ -5544,12 +5537,12 @@ int texturedPolygonMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy, i
 	* Allocate temp array, only grow array 
 	*/
 	if (!gfxPrimitivesPolyAllocated) {
-		gfxPrimitivesPolyInts = (int *) malloc(sizeof(int) * n);
-		gfxPrimitivesPolyAllocated = n;
+		gfxPrimitivesPolyInts = (int *) malloc(sizeof(int) * 2 * n);
+		gfxPrimitivesPolyAllocated = 2 * n;
 	} else {
-		if (gfxPrimitivesPolyAllocated < n) {
-			gfxPrimitivesPolyInts = (int *) realloc(gfxPrimitivesPolyInts, sizeof(int) * n);
-			gfxPrimitivesPolyAllocated = n;
+		if (gfxPrimitivesPolyAllocated < 2 * n) {
+			gfxPrimitivesPolyInts = (int *) realloc(gfxPrimitivesPolyInts, sizeof(int) * 2 * n);
+			gfxPrimitivesPolyAllocated = 2 * n;
 		}
 	}
 
@@ -5605,49 +5598,24 @@ int texturedPolygonMT(SDL_Surface * dst, const Sint16 * vx, const Sint16 * vy, i
 	}
 
 	/*
-	* Draw, scanning y 
+	* Draw, scanning y with the shared active edge table filler 
 	*/
-	result = 0;
-	for (y = miny; (y <= maxy); y++) {
-		ints = 0;
-		for (i = 0; (i < n); i++) {
-			if (!i) {
-				ind1 = n - 1;
-				ind2 = 0;
-			} else {
-				ind1 = i - 1;
-				ind2 = i;
-			}
-			y1 = vy[ind1];
-			y2 = vy[ind2];
-			if (y1 < y2) {
-				x1 = vx[ind1];
-				x2 = vx[ind2];
-			} else if (y1 > y2) {
-				y2 = vy[ind1];
-				y1 = vy[ind2];
-				x2 = vx[ind1];
-				x1 = vx[ind2];
-			} else {
-				continue;
-			}
-			if ( ((y >= y1) && (y < y2)) || ((y == maxy) && (y > y1) && (y <= y2)) ) {
-				gfxPrimitivesPolyInts[ints++] = ((65536 * (y - y1)) / (y2 - y1)) * (x2 - x1) + (65536 * x1);
-			} 
-		}
-
-		qsort(gfxPrimitivesPolyInts, ints, sizeof(int), _gfxPrimitivesCompareInt);
-
-		for (i = 0; (i < ints); i += 2) {
-			xa = gfxPrimitivesPolyInts[i] + 1;
-			xa = (xa >> 16) + ((xa & 32768) >> 15);
-			xb = gfxPrimitivesPolyInts[i+1] - 1;
-			xb = (xb >> 16) + ((xb & 32768) >> 15);
-			result |= _HLineTextured(dst, xa, xb, y, texture, texture_dx, texture_dy);
-		}
+	for (i = 0; (i < n); i++) {
+		gfxPrimitivesPolyInts[i] = vx[i];
+		gfxPrimitivesPolyInts[n + i] = vy[i];
+	}
+	span.dst = dst;
+	span.texture = texture;
+	span.texture_dx = texture_dx;
+	span.texture_dy = texture_dy;
+	span.result = 0;
+	if (pg_fill_polygon(gfxPrimitivesPolyInts, gfxPrimitivesPolyInts + n, n,
+		dst->clip_rect.y, dst->clip_rect.y + dst->clip_rect.h - 1,
+		PG_POLY_FIXED16, _texturedPolygonSpan, &span)) {
+		return (-1);
 	}
 
-	return (result);
+	return (span.result);
 }
 
 /*!
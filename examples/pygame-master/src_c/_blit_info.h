@@ -0,0 +1,50 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _BLIT_INFO_H
+#define _BLIT_INFO_H
+
+#include "_surface.h"
+
+/* The structure passed to the low level blit functions */
+typedef struct
+{
+    int              width;
+    int              height;
+    Uint8           *s_pixels;
+    int              s_pxskip;
+    int              s_skip;
+    Uint8           *d_pixels;
+    int              d_pxskip;
+    int              d_skip;
+    SDL_PixelFormat *src;
+    SDL_PixelFormat *dst;
+#if IS_SDLv1
+    Uint32           src_flags;
+    Uint32           dst_flags;
+#else /* IS_SDLv2 */
+    Uint8            src_blanket_alpha;
+    int              src_has_colorkey;
+    Uint32           src_colorkey;
+    SDL_BlendMode    src_blend;
+    SDL_BlendMode    dst_blend;
+#endif /* IS_SDLv2 */
+} SDL_BlitInfo;
+
+#endif /* _BLIT_INFO_H */
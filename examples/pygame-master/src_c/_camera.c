@@ -113,6 +113,7 @@ surf_colorspace(PyObject *self, PyObject *arg)
     }
     else {
         newsurf = pgSurface_AsSurface(surfobj2);
+        pgSurface_Changed(surfobj2);
     }
 
     /* check to see if the size is the same. */
@@ -357,6 +358,9 @@ camera_get_image(pgCameraObject *self, PyObject *arg)
         return RAISE(PyExc_ValueError,
                      "Destination surface not the correct width or height.");
     }
+    if (surfobj) {
+        pgSurface_Changed(surfobj);
+    }
 
     Py_BEGIN_ALLOW_THREADS;
     if (!v4l2_read_frame(self, surf))
@@ -397,6 +401,9 @@ camera_get_image(pgCameraObject *self, PyObject *arg)
         return RAISE(PyExc_ValueError,
                      "Destination surface not the correct width or height.");
     }
+    if (surfobj) {
+        pgSurface_Changed(surfobj);
+    }
     /*is dit nodig op osx... */
     Py_BEGIN_ALLOW_THREADS;
 
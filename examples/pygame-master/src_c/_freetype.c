@@ -59,6 +59,10 @@ _ft_autoquit(void);
 static PyObject *
 _ft_get_cache_size(PyObject *, PyObject *);
 static PyObject *
+_ft_get_cache_stats(PyObject *, PyObject *);
+static PyObject *
+_ft_set_cache_limit(PyObject *, PyObject *);
+static PyObject *
 _ft_get_default_resolution(PyObject *, PyObject *);
 static PyObject *
 _ft_set_default_resolution(PyObject *, PyObject *);
@@ -145,6 +149,10 @@ _ftfont_setfgcolor(pgFontObject *, PyObject *, void *);
 
 static PyObject *
 _ftfont_getresolution(pgFontObject *, void *);
+static PyObject *
+_ftfont_getlayoutcachesize(pgFontObject *, void *);
+static int
+_ftfont_setlayoutcachesize(pgFontObject *, PyObject *, void *);
 
 static PyObject *
 _ftfont_getfontmetric(pgFontObject *, void *);
@@ -531,6 +539,10 @@ static PyMethodDef _ft_methods[] = {
      DOC_PYGAMEFREETYPEGETVERSION},
     {"get_cache_size", _ft_get_cache_size, METH_NOARGS,
      DOC_PYGAMEFREETYPEGETCACHESIZE},
+    {"get_cache_stats", _ft_get_cache_stats, METH_NOARGS,
+     DOC_PYGAMEFREETYPEGETCACHESTATS},
+    {"set_cache_limit", _ft_set_cache_limit, METH_VARARGS,
+     DOC_PYGAMEFREETYPESETCACHELIMIT},
     {"get_default_resolution", _ft_get_default_resolution,
      METH_NOARGS, DOC_PYGAMEFREETYPEGETDEFAULTRESOLUTION},
     {"set_default_resolution", _ft_set_default_resolution,
@@ -616,6 +628,8 @@ static PyGetSetDef _ftfont_getsets[] = {
      (setter)_ftfont_setrender_flag, DOC_FONTUSEBITMAPSTRIKES,
      (void *)FT_RFLAG_USE_BITMAP_STRIKES},
     {"resolution", (getter)_ftfont_getresolution, 0, DOC_FONTRESOLUTION, 0},
+    {"layout_cache_size", (getter)_ftfont_getlayoutcachesize,
+     (setter)_ftfont_setlayoutcachesize, DOC_FONTLAYOUTCACHESIZE, 0},
     {"rotation", (getter)_ftfont_getrotation, (setter)_ftfont_setrotation,
      DOC_FONTROTATION, 0},
     {"fgcolor", (getter)_ftfont_getfgcolor, (setter)_ftfont_setfgcolor,
@@ -1248,6 +1262,43 @@ _ftfont_getresolution(pgFontObject *self, void *closure)
     return PyLong_FromUnsignedLong((unsigned long)self->resolution);
 }
 
+/** layout cache attribute */
+static PyObject *
+_ftfont_getlayoutcachesize(pgFontObject *self, void *closure)
+{
+    ASSERT_SELF_IS_ALIVE(self);
+    return PyInt_FromLong((long)self->_internals->layout_capacity);
+}
+
+static int
+_ftfont_setlayoutcachesize(pgFontObject *self, PyObject *value,
+                           void *closure)
+{
+    long size;
+
+    if (!pgFont_IS_ALIVE(self)) {
+        PyErr_SetString(PyExc_RuntimeError, MODULE_NAME "." FONT_TYPE_NAME
+                        " instance is not initialized");
+        return -1;
+    }
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError,
+                        "layout_cache_size cannot be deleted");
+        return -1;
+    }
+    size = PyInt_AsLong(value);
+    if (size == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (size < 0 || size > 1024) {
+        PyErr_Format(PyExc_ValueError,
+                     "layout cache size %ld is outside range [0, 1024]",
+                     size);
+        return -1;
+    }
+    return _PGFT_LayoutSetCacheSize(self, (int)size);
+}
+
 /** text rotation attribute */
 static PyObject *
 _ftfont_getrotation(pgFontObject *self, void *closure)
@@ -1944,6 +1995,7 @@ _ftfont_render_to(pgFontObject *self, PyObject *args, PyObject *kwds)
         PyErr_SetString(pgExc_SDLError, "display Surface quit");
         goto error;
     }
+    pgSurface_Changed(surface_obj);
     if (_PGFT_Render_ExistingSurface(self->freetype, self, &render, text,
                                      surface, xpos, ypos, &fg_color,
                                      bg_color_obj ? &bg_color : 0, &r))
@@ -2016,7 +2068,8 @@ _ft_autoinit(PyObject *self, PyObject *args)
         if (cache_size == 0) {
             cache_size = PGFT_DEFAULT_CACHE_SIZE;
         }
-        if (_PGFT_Init(&(FREETYPE_MOD_STATE(self)->freetype), cache_size)) {
+        if (_PGFT_Init(&(FREETYPE_MOD_STATE(self)->freetype), cache_size,
+                       FREETYPE_MOD_STATE(self)->cache_limit)) {
             return 0;
         }
         FREETYPE_MOD_STATE(self)->cache_size = cache_size;
@@ -2105,6 +2158,52 @@ _ft_get_cache_size(PyObject *self, PyObject *args)
         (unsigned long)(FREETYPE_STATE->cache_size));
 }
 
+static PyObject *
+_ft_get_cache_stats(PyObject *self, PyObject *args)
+{
+    FreeTypeInstance *ft;
+    const GlyphCache *glyph_cache;
+    const FontCache *cache;
+    unsigned long faces = 0;
+    ASSERT_GRAB_FREETYPE(ft, 0);
+
+    glyph_cache = &ft->glyph_cache;
+    for (cache = glyph_cache->faces; cache; cache = cache->next) {
+        ++faces;
+    }
+    return Py_BuildValue("{sksksksnsnsksksksk}",
+                         "hits", glyph_cache->hits,
+                         "misses", glyph_cache->misses,
+                         "evictions", glyph_cache->evictions,
+                         "bytes", (Py_ssize_t)glyph_cache->bytes,
+                         "limit", (Py_ssize_t)glyph_cache->limit,
+                         "glyphs", glyph_cache->glyphs,
+                         "faces", faces,
+                         "layout_hits", glyph_cache->layout_hits,
+                         "layout_misses", glyph_cache->layout_misses);
+}
+
+static PyObject *
+_ft_set_cache_limit(PyObject *self, PyObject *args)
+{
+    Py_ssize_t limit;
+    _FreeTypeState *state = FREETYPE_MOD_STATE(self);
+
+    if (!PyArg_ParseTuple(args, "n", &limit)) {
+        return 0;
+    }
+    if (limit < 0) {
+        return RAISE(PyExc_ValueError, "cache limit must not be negative");
+    }
+
+    state->cache_limit = (size_t)limit;
+    if (state->freetype) {
+        _PGFT_GlyphCache_SetLimit(&state->freetype->glyph_cache,
+                                  (size_t)limit);
+    }
+    Py_RETURN_NONE;
+}
+
 static PyObject *
 _ft_get_default_resolution(PyObject *self, PyObject *args)
 {
@@ -2225,6 +2324,7 @@ MODINIT_DEFINE(_freetype)
 
     FREETYPE_MOD_STATE(module)->freetype = 0;
     FREETYPE_MOD_STATE(module)->cache_size = 0;
+    FREETYPE_MOD_STATE(module)->cache_limit = 0;
     FREETYPE_MOD_STATE(module)->resolution = PGFT_DEFAULT_RESOLUTION;
 
     Py_INCREF((PyObject *)&pgFont_Type);
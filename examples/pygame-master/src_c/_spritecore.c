@@ -0,0 +1,1486 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/*
+ *  Native helpers for pygame.sprite.
+ *
+ *  SpriteIndex is the broad phase behind spritecollide(), groupcollide()
+ *  and spritecollideany(). Each group keeps one, and adds and removes
+ *  sprites in it as they join and leave the group. The sprite bounds are
+ *  kept sorted on their left edge (sweep and prune), so colliding two
+ *  groups only compares boxes whose x ranges overlap instead of every
+ *  pair. Before a query the index is refreshed: removed sprites are
+ *  dropped, the boxes are brought up to date and the previous order is
+ *  re-sorted with an insertion sort. Sprites move a little from frame to
+ *  frame and new ones are few, so that only falls back to qsort when the
+ *  order has been scrambled.
+ *
+ *  A Rect does not tell anyone when it moves, so each box keeps the Rect
+ *  its bounds came from. For rect bounds, a sprite that still has that
+ *  Rect in its instance dict is compared against it in C, and only new
+ *  sprites, replaced rects and the other bounds modes call back into
+ *  Python. Nothing is sorted when no box changed.
+ *
+ *  draw_dirty() is the body of LayeredDirty.draw(). In dirty rect mode the
+ *  areas to redraw are merged into their exact union (see region.h), the
+ *  background and the sprites are drawn with a single Surface.blits()
+ *  call, and the union is returned as disjoint rects.
+ */
+#include "pygame.h"
+
+#include "pgcompat.h"
+
+#include "region.h"
+
+#include <limits.h>
+#include <math.h>
+
+/* How the bounds of a sprite are found. The box must hold every point the
+ * matching collided callback can report a hit for. */
+#define BOUNDS_RECT 0       /* sprite.rect; exact for collide_rect */
+#define BOUNDS_MASK 1       /* rect.topleft plus mask or image size */
+#define BOUNDS_CIRCLE 2     /* rect.center plus radius, times ratio */
+#define BOUNDS_RECT_RATIO 3 /* sprite.rect scaled by ratio */
+
+/* Insertion sort shifts allowed per box before giving up for qsort */
+#define SPRITEINDEX_MAX_SHIFTS 8
+
+typedef struct {
+    int x0, y0, x1, y1;     /* closed bounds compared by the sweep */
+    int rx, ry, rw, rh;     /* sprite.rect for the exact BOUNDS_RECT test */
+    PyObject *sprite;       /* owned */
+    PyObject *rect;         /* owned Rect rx to rh came from, or NULL */
+    double layer;           /* hits are listed by layer, then by seq, */
+    Py_ssize_t seq;         /* which is the order the sprites were added */
+} pgSpriteBox;
+
+typedef struct {
+    const pgSpriteBox *a, *b;
+} pgSpritePair;
+
+typedef struct {
+    PyObject_HEAD PyObject *members; /* sprite -> seq of its live box */
+    pgSpriteBox *boxes; /* sorted on x0 as of the last refresh */
+    Py_ssize_t count;   /* including boxes of removed sprites */
+    Py_ssize_t capacity;
+    Py_ssize_t seq;     /* seq of the next sprite added */
+    int removed;        /* boxes of removed sprites are left to drop */
+    int fresh;          /* boxes are sorted and match mode and ratio */
+    int busy;           /* refresh() is running */
+    int maxw; /* widest x1 - x0, bounds the search in query() */
+    int mode;
+    double ratio;
+} pgSpriteIndexObject;
+
+/* What draw_dirty() needs of one sprite of a LayeredDirty group */
+typedef struct {
+    PyObject *sprite;            /* borrowed from the sprite list */
+    PyObject *rect, *source;     /* owned; source may be None */
+    PyObject *image, *blendmode; /* owned, only for visible sprites */
+    int x, y, w, h;              /* screen area: rect.topleft, source size */
+    int offx, offy;              /* image position minus screen position */
+    int dirty, visible;
+    Py_ssize_t blit; /* index of the whole sprite blit, or -1 */
+} pgDirtySprite;
+
+static PyTypeObject pgSpriteIndex_Type;
+
+static PyObject *str_rect, *str_mask, *str_image, *str_radius, *str_get_size;
+static PyObject *str_dirty, *str_visible, *str_source_rect, *str_blendmode;
+static PyObject *str_blits;
+
+static int
+_bound_lo(double v)
+{
+    v = floor(v);
+    if (!(v >= INT_MIN)) {
+        return INT_MIN;
+    }
+    return v > INT_MAX ? INT_MAX : (int)v;
+}
+
+static int
+_bound_hi(double v)
+{
+    v = ceil(v);
+    if (!(v <= INT_MAX)) {
+        return INT_MAX;
+    }
+    return v < INT_MIN ? INT_MIN : (int)v;
+}
+
+/* Returns the attribute, or NULL with no error set if it is missing. */
+static PyObject *
+_optional_attr(PyObject *obj, PyObject *name)
+{
+    PyObject *value = PyObject_GetAttr(obj, name);
+
+    if (!value && PyErr_ExceptionMatches(PyExc_AttributeError)) {
+        PyErr_Clear();
+    }
+    return value;
+}
+
+static void
+_set_bounds(pgSpriteBox *box, double left, double top, double right,
+            double bottom)
+{
+    box->x0 = _bound_lo(left);
+    box->y0 = _bound_lo(top);
+    box->x1 = _bound_hi(right);
+    box->y1 = _bound_hi(bottom);
+}
+
+/* Bounds for BOUNDS_RECT and BOUNDS_RECT_RATIO, which only need rx to rh */
+static void
+_rect_bounds(pgSpriteBox *box, int mode, double ratio)
+{
+    double left = MIN(box->rx, (double)box->rx + box->rw);
+    double right = MAX(box->rx, (double)box->rx + box->rw);
+    double top = MIN(box->ry, (double)box->ry + box->rh);
+    double bottom = MAX(box->ry, (double)box->ry + box->rh);
+    double r;
+
+    if (mode == BOUNDS_RECT_RATIO) {
+        /* Rect.inflate() truncates, so allow a pixel either way */
+        r = fabs(box->rw * ratio - box->rw) / 2.0 + 1.0;
+        left -= r;
+        right += r;
+        r = fabs(box->rh * ratio - box->rh) / 2.0 + 1.0;
+        top -= r;
+        bottom += r;
+    }
+    _set_bounds(box, left, top, right, bottom);
+}
+
+/* Read the bounds of sprite into box. If held is not NULL, it is set to a
+ * new reference to the sprite's rect when that is a Rect, or NULL, and
+ * whatever it held before is released. */
+static int
+_sprite_box(PyObject *sprite, int mode, double ratio, pgSpriteBox *box,
+            PyObject **held)
+{
+    PyObject *obj, *size, *old;
+    GAME_Rect temp, *rect;
+    double cx, cy, r;
+    int w, h;
+
+    obj = PyObject_GetAttr(sprite, str_rect);
+    if (!obj) {
+        return -1;
+    }
+    rect = pgRect_FromObject(obj, &temp);
+    if (!rect) {
+        Py_DECREF(obj);
+        PyErr_SetString(PyExc_TypeError, "sprite rect must be a Rect");
+        return -1;
+    }
+    box->rx = rect->x;
+    box->ry = rect->y;
+    box->rw = rect->w;
+    box->rh = rect->h;
+    if (held) {
+        old = *held;
+        *held = NULL;
+        if (pgRect_Check(obj)) {
+            Py_INCREF(obj);
+            *held = obj;
+        }
+        Py_XDECREF(old);
+    }
+    Py_DECREF(obj);
+
+    switch (mode) {
+        case BOUNDS_RECT:
+        case BOUNDS_RECT_RATIO:
+            _rect_bounds(box, mode, ratio);
+            break;
+        case BOUNDS_MASK:
+            obj = _optional_attr(sprite, str_mask);
+            if (!obj && !PyErr_Occurred()) {
+                obj = PyObject_GetAttr(sprite, str_image);
+            }
+            if (!obj) {
+                return -1;
+            }
+            size = PyObject_CallMethodObjArgs(obj, str_get_size, NULL);
+            Py_DECREF(obj);
+            if (!size) {
+                return -1;
+            }
+            if (!pg_TwoIntsFromObj(size, &w, &h)) {
+                Py_DECREF(size);
+                PyErr_SetString(PyExc_TypeError,
+                                "get_size() must return two integers");
+                return -1;
+            }
+            Py_DECREF(size);
+            _set_bounds(box, box->rx, box->ry, (double)box->rx + MAX(w, 0),
+                        (double)box->ry + MAX(h, 0));
+            break;
+        case BOUNDS_CIRCLE:
+            obj = _optional_attr(sprite, str_radius);
+            if (obj) {
+                r = PyFloat_AsDouble(obj);
+                Py_DECREF(obj);
+                if (r == -1.0 && PyErr_Occurred()) {
+                    return -1;
+                }
+                r *= ratio;
+            }
+            else if (PyErr_Occurred()) {
+                return -1;
+            }
+            else {
+                /* store the radius on the sprite like collide_circle() */
+                r = ratio * 0.5 *
+                    sqrt((double)box->rw * box->rw +
+                         (double)box->rh * box->rh);
+                obj = PyFloat_FromDouble(r);
+                if (!obj || PyObject_SetAttr(sprite, str_radius, obj)) {
+                    Py_XDECREF(obj);
+                    return -1;
+                }
+                Py_DECREF(obj);
+            }
+            r = fabs(r);
+            cx = box->rx + (box->rw >> 1);
+            cy = box->ry + (box->rh >> 1);
+            _set_bounds(box, cx - r, cy - r, cx + r, cy + r);
+            break;
+    }
+    return 0;
+}
+
+/* Whether the rect of a box's sprite is still the Rect it was read from,
+ * found without running any Python code. That holds when the attribute
+ * comes straight from the instance dict: no custom getattr and no data
+ * descriptor on the class can stand in front of it. */
+static int
+_box_rect_held(pgSpriteBox *box)
+{
+    PyObject *sprite = box->sprite, **dictptr, *descr;
+    PyTypeObject *type = Py_TYPE(sprite);
+
+    if (!box->rect || type->tp_getattro != PyObject_GenericGetAttr) {
+        return 0;
+    }
+    descr = _PyType_Lookup(type, str_rect);
+    if (descr && Py_TYPE(descr)->tp_descr_set) {
+        return 0;
+    }
+    dictptr = _PyObject_GetDictPtr(sprite);
+    return dictptr && *dictptr &&
+           PyDict_GetItem(*dictptr, str_rect) == box->rect;
+}
+
+/* Same test as Rect.colliderect() */
+static int
+_rects_collide(pgSpriteBox *a, pgSpriteBox *b)
+{
+    return (a->rx < b->rx + b->rw && a->ry < b->ry + b->rh &&
+            a->rx + a->rw > b->rx && a->ry + a->rh > b->ry);
+}
+
+static int
+_compare_boxes(const void *a, const void *b)
+{
+    int x0a = ((const pgSpriteBox *)a)->x0;
+    int x0b = ((const pgSpriteBox *)b)->x0;
+
+    return (x0a > x0b) - (x0a < x0b);
+}
+
+static int
+_compare_order(const pgSpriteBox *a, const pgSpriteBox *b)
+{
+    if (a->layer != b->layer) {
+        return a->layer < b->layer ? -1 : 1;
+    }
+    return (a->seq > b->seq) - (a->seq < b->seq);
+}
+
+static int
+_compare_pairs(const void *a, const void *b)
+{
+    const pgSpritePair *pa = (const pgSpritePair *)a;
+    const pgSpritePair *pb = (const pgSpritePair *)b;
+
+    if (pa->a != pb->a) {
+        return _compare_order(pa->a, pb->a);
+    }
+    return pa->b == pb->b ? 0 : _compare_order(pa->b, pb->b);
+}
+
+static void
+_sort_boxes(pgSpriteBox *boxes, Py_ssize_t count, int coherent)
+{
+    Py_ssize_t i, j;
+    Py_ssize_t budget = count * SPRITEINDEX_MAX_SHIFTS;
+    pgSpriteBox box;
+
+    if (coherent) {
+        for (i = 1; i < count && budget >= 0; ++i) {
+            box = boxes[i];
+            for (j = i; j > 0 && boxes[j - 1].x0 > box.x0; --j) {
+                boxes[j] = boxes[j - 1];
+            }
+            boxes[j] = box;
+            budget -= i - j;
+        }
+        if (budget >= 0) {
+            return;
+        }
+    }
+    if (count) {
+        qsort(boxes, count, sizeof(pgSpriteBox), _compare_boxes);
+    }
+}
+
+static int
+_add_pair(pgSpritePair **pairs, Py_ssize_t *npairs, Py_ssize_t *size,
+          const pgSpriteBox *a, const pgSpriteBox *b)
+{
+    pgSpritePair *grown = *pairs;
+
+    if (*npairs == *size) {
+        PyMem_Resize(grown, pgSpritePair, *size ? *size * 2 : 64);
+        if (!grown) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        *pairs = grown;
+        *size = *size ? *size * 2 : 64;
+    }
+    (*pairs)[*npairs].a = a;
+    (*pairs)[*npairs].b = b;
+    ++*npairs;
+    return 0;
+}
+
+/* Whether two boxes overlap, given that b does not start left of a and
+ * starts no further right than a ends. */
+static int
+_boxes_hit(pgSpriteBox *a, pgSpriteBox *b, int exact)
+{
+    if (a->y0 > b->y1 || b->y0 > a->y1) {
+        return 0;
+    }
+    return exact ? _rects_collide(a, b) : 1;
+}
+
+/* Fails with RuntimeError while refresh() reads the sprites, which may run
+ * Python code that could otherwise change the boxes under it. */
+static int
+_spriteindex_check_busy(pgSpriteIndexObject *self)
+{
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "SpriteIndex changed during refresh()");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+_spriteindex_append(pgSpriteIndexObject *self, PyObject *sprite,
+                    double layer)
+{
+    pgSpriteBox *boxes = self->boxes, *box;
+    PyObject *seq;
+    int replaced;
+
+    if (!self->members) {
+        self->members = PyDict_New();
+        if (!self->members) {
+            return -1;
+        }
+    }
+    if (self->count == self->capacity) {
+        PyMem_Resize(boxes, pgSpriteBox,
+                     self->capacity ? self->capacity * 2 : 64);
+        if (!boxes) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        self->boxes = boxes;
+        self->capacity = self->capacity ? self->capacity * 2 : 64;
+    }
+
+    replaced = PyDict_GetItem(self->members, sprite) != NULL;
+    seq = PyInt_FromSsize_t(self->seq);
+    if (!seq) {
+        return -1;
+    }
+    if (PyDict_SetItem(self->members, sprite, seq)) {
+        Py_DECREF(seq);
+        return -1;
+    }
+    Py_DECREF(seq);
+
+    /* an earlier box of the sprite no longer matches its seq */
+    if (replaced) {
+        self->removed = 1;
+    }
+    box = self->boxes + self->count++;
+    Py_INCREF(sprite);
+    box->sprite = sprite;
+    box->rect = NULL;
+    box->layer = layer;
+    box->seq = self->seq++;
+    self->fresh = 0;
+    return 0;
+}
+
+static PyObject *
+spriteindex_add(pgSpriteIndexObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"sprite", "layer", NULL};
+    PyObject *sprite;
+    double layer = 0.0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|d:add", keywords,
+                                     &sprite, &layer)) {
+        return NULL;
+    }
+    if (_spriteindex_check_busy(self) ||
+        _spriteindex_append(self, sprite, layer)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+spriteindex_extend(pgSpriteIndexObject *self, PyObject *args,
+                   PyObject *kwds)
+{
+    char *keywords[] = {"sprites", "layers", NULL};
+    PyObject *sprites, *layers = Py_None, *seq, *lseq = NULL;
+    Py_ssize_t n, i;
+    double layer = 0.0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:extend", keywords,
+                                     &sprites, &layers)) {
+        return NULL;
+    }
+    if (_spriteindex_check_busy(self)) {
+        return NULL;
+    }
+    seq = PySequence_Fast(sprites, "sprites must be a sequence");
+    if (!seq) {
+        return NULL;
+    }
+    n = PySequence_Fast_GET_SIZE(seq);
+    if (layers != Py_None) {
+        lseq = PySequence_Fast(layers, "layers must be a sequence");
+        if (!lseq) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+        if (PySequence_Fast_GET_SIZE(lseq) != n) {
+            PyErr_SetString(PyExc_ValueError,
+                            "sprites and layers must be the same length");
+            goto error;
+        }
+    }
+    for (i = 0; i < n; ++i) {
+        if (lseq) {
+            layer = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(lseq, i));
+            if (layer == -1.0 && PyErr_Occurred()) {
+                goto error;
+            }
+        }
+        if (_spriteindex_append(self, PySequence_Fast_GET_ITEM(seq, i),
+                                layer)) {
+            goto error;
+        }
+    }
+    Py_DECREF(seq);
+    Py_XDECREF(lseq);
+    Py_RETURN_NONE;
+
+error:
+    Py_DECREF(seq);
+    Py_XDECREF(lseq);
+    return NULL;
+}
+
+static PyObject *
+spriteindex_remove(pgSpriteIndexObject *self, PyObject *sprite)
+{
+    if (_spriteindex_check_busy(self)) {
+        return NULL;
+    }
+    if (!self->members || PyDict_DelItem(self->members, sprite)) {
+        /* sprites the index does not hold are ignored */
+        if (PyErr_Occurred() && !PyErr_ExceptionMatches(PyExc_KeyError)) {
+            return NULL;
+        }
+        PyErr_Clear();
+        Py_RETURN_NONE;
+    }
+    self->removed = 1;
+    self->fresh = 0;
+    Py_RETURN_NONE;
+}
+
+/* Release count sprites and their rects, after the boxes no longer hold
+ * them. */
+static void
+_release_sprites(PyObject **objs, Py_ssize_t count)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < count; ++i) {
+        Py_XDECREF(objs[i]);
+    }
+}
+
+/* Drop the boxes from start on, releasing their sprites. */
+static int
+_spriteindex_truncate(pgSpriteIndexObject *self, Py_ssize_t start)
+{
+    Py_ssize_t n = self->count - start, i;
+    PyObject **dropped;
+
+    if (n <= 0) {
+        return 0;
+    }
+    /* Releasing a sprite may run its __del__, so take the sprites out of
+     * the boxes first. */
+    dropped = PyMem_New(PyObject *, 2 * n);
+    if (!dropped) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < n; ++i) {
+        dropped[2 * i] = self->boxes[start + i].sprite;
+        dropped[2 * i + 1] = self->boxes[start + i].rect;
+    }
+    self->count = start;
+    _release_sprites(dropped, 2 * n);
+    PyMem_Free(dropped);
+    return 0;
+}
+
+static PyObject *
+spriteindex_clear_all(pgSpriteIndexObject *self, PyObject *args)
+{
+    if (_spriteindex_check_busy(self)) {
+        return NULL;
+    }
+    if (self->members) {
+        PyDict_Clear(self->members);
+    }
+    self->removed = 0;
+    self->fresh = 0;
+    if (_spriteindex_truncate(self, 0)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/* Move the boxes of removed sprites to the end and drop them. */
+static int
+_spriteindex_compact(pgSpriteIndexObject *self)
+{
+    pgSpriteBox *boxes = self->boxes, box;
+    PyObject *seq;
+    Py_ssize_t i, kept = 0;
+
+    for (i = 0; i < self->count; ++i) {
+        seq = PyDict_GetItem(self->members, boxes[i].sprite);
+        if (seq && PyInt_AsSsize_t(seq) == boxes[i].seq) {
+            box = boxes[kept];
+            boxes[kept++] = boxes[i];
+            boxes[i] = box;
+        }
+    }
+    self->removed = 0;
+    return _spriteindex_truncate(self, kept);
+}
+
+static PyObject *
+spriteindex_refresh(pgSpriteIndexObject *self, PyObject *args,
+                    PyObject *kwds)
+{
+    char *keywords[] = {"mode", "ratio", NULL};
+    pgSpriteBox *box;
+    Py_ssize_t i, changed = 0;
+    int mode = BOUNDS_RECT;
+    double ratio = 1.0;
+    int maxw = 0, reuse;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|id:refresh", keywords,
+                                     &mode, &ratio)) {
+        return NULL;
+    }
+    if (mode < BOUNDS_RECT || mode > BOUNDS_RECT_RATIO) {
+        return RAISE(PyExc_ValueError, "invalid bounds mode");
+    }
+    if (_spriteindex_check_busy(self)) {
+        return NULL;
+    }
+
+    self->busy = 1;
+    self->fresh = 0;
+    if (self->removed && _spriteindex_compact(self)) {
+        self->busy = 0;
+        return NULL;
+    }
+
+    /* Rect bounds only depend on the rect, so a box whose sprite still has
+     * the Rect it was read from is checked against it in place; only the
+     * other boxes are read again through Python. */
+    reuse = (mode == BOUNDS_RECT || mode == BOUNDS_RECT_RATIO) &&
+            mode == self->mode && ratio == self->ratio;
+    for (i = 0; i < self->count; ++i) {
+        box = self->boxes + i;
+        if (reuse && _box_rect_held(box)) {
+            GAME_Rect *r = &pgRect_AsRect(box->rect);
+
+            if (r->x != box->rx || r->y != box->ry || r->w != box->rw ||
+                r->h != box->rh) {
+                box->rx = r->x;
+                box->ry = r->y;
+                box->rw = r->w;
+                box->rh = r->h;
+                _rect_bounds(box, mode, ratio);
+                ++changed;
+            }
+        }
+        else {
+            if (_sprite_box(box->sprite, mode, ratio, box, &box->rect)) {
+                /* some boxes may already have the new mode's bounds */
+                self->mode = -1;
+                self->busy = 0;
+                return NULL;
+            }
+            ++changed;
+        }
+        if (box->x1 - (double)box->x0 > maxw) {
+            maxw = (int)MIN(box->x1 - (double)box->x0, INT_MAX);
+        }
+    }
+    /* dropping removed boxes keeps the rest in order */
+    if (changed) {
+        _sort_boxes(self->boxes, self->count, 1);
+    }
+    self->busy = 0;
+
+    self->fresh = 1;
+    self->maxw = maxw;
+    self->mode = mode;
+    self->ratio = ratio;
+    Py_RETURN_NONE;
+}
+
+static int
+_spriteindex_check_fresh(pgSpriteIndexObject *self)
+{
+    if (!self->fresh) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "SpriteIndex changed since refresh()");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+spriteindex_collide(pgSpriteIndexObject *self, PyObject *arg)
+{
+    pgSpriteIndexObject *other = (pgSpriteIndexObject *)arg;
+    pgSpriteBox *a, *b, *box;
+    pgSpritePair *pairs = NULL;
+    Py_ssize_t na, nb, i, j, k, npairs = 0, size = 0;
+    PyObject *result, *hits, *item, *entry;
+    int exact;
+
+    if (!PyObject_TypeCheck(arg, &pgSpriteIndex_Type)) {
+        return RAISE(PyExc_TypeError, "argument must be a SpriteIndex");
+    }
+    if (_spriteindex_check_fresh(self) || _spriteindex_check_fresh(other)) {
+        return NULL;
+    }
+    a = self->boxes;
+    b = other->boxes;
+    na = self->count;
+    nb = other->count;
+    exact = self->mode == BOUNDS_RECT && other->mode == BOUNDS_RECT;
+
+    /* Each overlapping pair is found once, by whichever box starts first
+     * scanning the other list for boxes that start before it ends. */
+    i = j = 0;
+    while (i < na && j < nb) {
+        if (a[i].x0 < b[j].x0) {
+            box = a + i++;
+            for (k = j; k < nb && b[k].x0 <= box->x1; ++k) {
+                if (_boxes_hit(box, b + k, exact) &&
+                    _add_pair(&pairs, &npairs, &size, box, b + k)) {
+                    PyMem_Free(pairs);
+                    return NULL;
+                }
+            }
+        }
+        else {
+            box = b + j++;
+            for (k = i; k < na && a[k].x0 <= box->x1; ++k) {
+                if (_boxes_hit(box, a + k, exact) &&
+                    _add_pair(&pairs, &npairs, &size, a + k, box)) {
+                    PyMem_Free(pairs);
+                    return NULL;
+                }
+            }
+        }
+    }
+    if (npairs) {
+        qsort(pairs, npairs, sizeof(pgSpritePair), _compare_pairs);
+    }
+
+    result = PyList_New(0);
+    if (!result) {
+        PyMem_Free(pairs);
+        return NULL;
+    }
+    for (i = 0; i < npairs; i = j) {
+        for (j = i; j < npairs && pairs[j].a == pairs[i].a; ++j) {
+        }
+        hits = PyList_New(j - i);
+        if (!hits) {
+            goto error;
+        }
+        for (k = i; k < j; ++k) {
+            item = pairs[k].b->sprite;
+            Py_INCREF(item);
+            PyList_SET_ITEM(hits, k - i, item);
+        }
+        entry = Py_BuildValue("(ON)", pairs[i].a->sprite, hits);
+        if (!entry) {
+            goto error;
+        }
+        if (PyList_Append(result, entry)) {
+            Py_DECREF(entry);
+            goto error;
+        }
+        Py_DECREF(entry);
+    }
+    PyMem_Free(pairs);
+    return result;
+
+error:
+    PyMem_Free(pairs);
+    Py_DECREF(result);
+    return NULL;
+}
+
+static PyObject *
+spriteindex_query(pgSpriteIndexObject *self, PyObject *sprite)
+{
+    pgSpriteBox query, *box;
+    pgSpritePair *pairs = NULL;
+    Py_ssize_t lo, hi, mid, npairs = 0, size = 0, i;
+    PyObject *result, *item;
+    double start;
+    int exact = self->mode == BOUNDS_RECT;
+
+    if (_spriteindex_check_fresh(self)) {
+        return NULL;
+    }
+    if (!self->count) {
+        return PyList_New(0);
+    }
+    if (_sprite_box(sprite, self->mode, self->ratio, &query, NULL)) {
+        return NULL;
+    }
+
+    /* no box wider than maxw can reach query from further left */
+    start = (double)query.x0 - self->maxw;
+    lo = 0;
+    hi = self->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (self->boxes[mid].x0 < start) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    for (box = self->boxes + lo; box < self->boxes + self->count; ++box) {
+        if (box->x0 > query.x1) {
+            break;
+        }
+        if (box->x1 >= query.x0 && _boxes_hit(&query, box, exact) &&
+            _add_pair(&pairs, &npairs, &size, box, box)) {
+            PyMem_Free(pairs);
+            return NULL;
+        }
+    }
+    if (npairs) {
+        qsort(pairs, npairs, sizeof(pgSpritePair), _compare_pairs);
+    }
+
+    result = PyList_New(npairs);
+    if (result) {
+        for (i = 0; i < npairs; ++i) {
+            item = pairs[i].a->sprite;
+            Py_INCREF(item);
+            PyList_SET_ITEM(result, i, item);
+        }
+    }
+    PyMem_Free(pairs);
+    return result;
+}
+
+static Py_ssize_t
+spriteindex_length(pgSpriteIndexObject *self)
+{
+    return self->members ? PyDict_Size(self->members) : 0;
+}
+
+static int
+spriteindex_traverse(pgSpriteIndexObject *self, visitproc visit, void *arg)
+{
+    Py_ssize_t i;
+
+    Py_VISIT(self->members);
+    for (i = 0; i < self->count; ++i) {
+        Py_VISIT(self->boxes[i].sprite);
+        Py_VISIT(self->boxes[i].rect);
+    }
+    return 0;
+}
+
+static int
+spriteindex_clear(pgSpriteIndexObject *self)
+{
+    pgSpriteBox *boxes = self->boxes;
+    Py_ssize_t count = self->count, i;
+
+    self->boxes = NULL;
+    self->count = self->capacity = 0;
+    self->removed = 0;
+    self->fresh = 0;
+    Py_CLEAR(self->members);
+    for (i = 0; i < count; ++i) {
+        Py_DECREF(boxes[i].sprite);
+        Py_XDECREF(boxes[i].rect);
+    }
+    PyMem_Free(boxes);
+    return 0;
+}
+
+static void
+spriteindex_dealloc(pgSpriteIndexObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    spriteindex_clear(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMethodDef spriteindex_methods[] = {
+    {"add", (PyCFunction)spriteindex_add, METH_VARARGS | METH_KEYWORDS,
+     "add(sprite, layer=0) -> None\n"
+     "add a sprite, or move it to the end of its layer"},
+    {"extend", (PyCFunction)spriteindex_extend,
+     METH_VARARGS | METH_KEYWORDS,
+     "extend(sprites, layers=None) -> None\n"
+     "add a sequence of sprites, with a layer for each"},
+    {"remove", (PyCFunction)spriteindex_remove, METH_O,
+     "remove(sprite) -> None\n"
+     "remove a sprite, if the index holds it"},
+    {"clear", (PyCFunction)spriteindex_clear_all, METH_NOARGS,
+     "clear() -> None\n"
+     "remove every sprite"},
+    {"refresh", (PyCFunction)spriteindex_refresh,
+     METH_VARARGS | METH_KEYWORDS,
+     "refresh(mode=BOUNDS_RECT, ratio=1.0) -> None\n"
+     "read the sprite bounds again before a query"},
+    {"collide", (PyCFunction)spriteindex_collide, METH_O,
+     "collide(other) -> list\n"
+     "list (sprite, [other sprites]) for every overlapping pair of boxes"},
+    {"query", (PyCFunction)spriteindex_query, METH_O,
+     "query(sprite) -> list\n"
+     "list the indexed sprites whose boxes overlap the sprite's box"},
+    {NULL, NULL, 0, NULL}};
+
+static PySequenceMethods spriteindex_as_sequence = {
+    (lenfunc)spriteindex_length, /* sq_length */
+};
+
+static PyTypeObject pgSpriteIndex_Type = {
+    TYPE_HEAD(NULL, 0) "pygame._spritecore.SpriteIndex", /* tp_name */
+    sizeof(pgSpriteIndexObject),        /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)spriteindex_dealloc,    /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_compare */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    &spriteindex_as_sequence,           /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /* tp_flags */
+    "SpriteIndex() -> SpriteIndex\n"
+    "broad phase collision index for a sprite group", /* tp_doc */
+    (traverseproc)spriteindex_traverse, /* tp_traverse */
+    (inquiry)spriteindex_clear,         /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    spriteindex_methods,                /* tp_methods */
+    0,                                  /* tp_members */
+    0,                                  /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    0,                                  /* tp_init */
+    0,                                  /* tp_alloc */
+    PyType_GenericNew,                  /* tp_new */
+};
+
+static int
+_region_add(pg_region *region, Sint64 x0, Sint64 y0, Sint64 x1, Sint64 y1,
+            const pg_region_rect *clip)
+{
+    if (pg_region_add(region, x0, y0, x1, y1, clip)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
+static int
+_region_add_object(pg_region *region, PyObject *obj,
+                   const pg_region_rect *clip)
+{
+    GAME_Rect temp, *rect = pgRect_FromObject(obj, &temp);
+
+    if (!rect) {
+        PyErr_SetString(PyExc_TypeError, "dirty area must be a Rect");
+        return -1;
+    }
+    return _region_add(region, rect->x, rect->y, (Sint64)rect->x + rect->w,
+                       (Sint64)rect->y + rect->h, clip);
+}
+
+static int
+_region_union(pg_region *region)
+{
+    if (pg_region_union(region)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+_region_as_list(pg_region *region)
+{
+    PyObject *result = PyList_New(region->count), *rect;
+    pg_region_rect *r;
+    Py_ssize_t i;
+
+    if (!result) {
+        return NULL;
+    }
+    for (i = 0; i < region->count; ++i) {
+        r = region->rects + i;
+        rect = pgRect_New4(r->x0, r->y0, r->x1 - r->x0, r->y1 - r->y0);
+        if (!rect) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, i, rect);
+    }
+    return result;
+}
+
+static int
+_clip_from_object(PyObject *obj, pg_region_rect *clip)
+{
+    GAME_Rect temp, *rect = pgRect_FromObject(obj, &temp);
+
+    if (!rect) {
+        PyErr_SetString(PyExc_TypeError, "clip must be a Rect");
+        return -1;
+    }
+    clip->x0 = rect->x;
+    clip->y0 = rect->y;
+    clip->x1 = (int)MIN((Sint64)rect->x + MAX(rect->w, 0), INT_MAX);
+    clip->y1 = (int)MIN((Sint64)rect->y + MAX(rect->h, 0), INT_MAX);
+    return 0;
+}
+
+/* Reads what drawing needs of a sprite. Sprites that are neither dirty
+ * nor visible are left out after the first two attributes. */
+static int
+_dirty_sprite_load(PyObject *sprite, pgDirtySprite *spr)
+{
+    PyObject *obj;
+    GAME_Rect temp, *rect;
+    int whole;
+
+    spr->sprite = sprite;
+    spr->blit = -1;
+    obj = PyObject_GetAttr(sprite, str_dirty);
+    if (!obj) {
+        return -1;
+    }
+    if (!pg_IntFromObj(obj, &spr->dirty)) {
+        Py_DECREF(obj);
+        PyErr_SetString(PyExc_TypeError, "sprite dirty must be an integer");
+        return -1;
+    }
+    Py_DECREF(obj);
+    obj = PyObject_GetAttr(sprite, str_visible);
+    if (!obj) {
+        return -1;
+    }
+    spr->visible = PyObject_IsTrue(obj);
+    Py_DECREF(obj);
+    if (spr->visible < 0) {
+        return -1;
+    }
+    if (spr->dirty <= 0 && !spr->visible) {
+        return 0;
+    }
+
+    spr->rect = PyObject_GetAttr(sprite, str_rect);
+    if (!spr->rect) {
+        return -1;
+    }
+    rect = pgRect_FromObject(spr->rect, &temp);
+    if (!rect) {
+        PyErr_SetString(PyExc_TypeError, "sprite rect must be a Rect");
+        return -1;
+    }
+    spr->x = rect->x;
+    spr->y = rect->y;
+    spr->w = rect->w;
+    spr->h = rect->h;
+    spr->offx = -spr->x;
+    spr->offy = -spr->y;
+
+    spr->source = PyObject_GetAttr(sprite, str_source_rect);
+    if (!spr->source) {
+        return -1;
+    }
+    if (spr->source != Py_None) {
+        /* like the Python version, a dirty sprite only takes the source
+         * size when source_rect is true */
+        whole = spr->dirty > 0 ? PyObject_IsTrue(spr->source) : 1;
+        if (whole < 0) {
+            return -1;
+        }
+        rect = pgRect_FromObject(spr->source, &temp);
+        if (!rect) {
+            PyErr_SetString(PyExc_TypeError, "source_rect must be a Rect");
+            return -1;
+        }
+        if (whole) {
+            spr->w = rect->w;
+            spr->h = rect->h;
+        }
+        spr->offx = rect->x - spr->x;
+        spr->offy = rect->y - spr->y;
+    }
+
+    if (spr->visible) {
+        spr->image = PyObject_GetAttr(sprite, str_image);
+        if (!spr->image) {
+            return -1;
+        }
+        spr->blendmode = PyObject_GetAttr(sprite, str_blendmode);
+        if (!spr->blendmode) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int
+_append_blit(PyObject *blits, PyObject *item)
+{
+    int result;
+
+    if (!item) {
+        return -1;
+    }
+    result = PyList_Append(blits, item);
+    Py_DECREF(item);
+    return result;
+}
+
+static int
+_append_sprite_blit(PyObject *blits, pgDirtySprite *spr)
+{
+    spr->blit = PyList_GET_SIZE(blits);
+    return _append_blit(blits,
+                        Py_BuildValue("(OOOO)", spr->image, spr->rect,
+                                      spr->source, spr->blendmode));
+}
+
+/* Blits the parts of a sprite inside the region. The region is sorted on
+ * its bands, so the search starts at the first rect reaching below the
+ * top of the sprite. */
+static int
+_append_sprite_parts(PyObject *blits, pgDirtySprite *spr,
+                     pg_region *region)
+{
+    pg_region_rect *r;
+    Py_ssize_t lo = 0, hi = region->count, mid;
+    Sint64 x1 = (Sint64)spr->x + spr->w, y1 = (Sint64)spr->y + spr->h;
+    int cx0, cy0, cx1, cy1;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (region->rects[mid].y1 <= spr->y) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    for (r = region->rects + lo; r < region->rects + region->count; ++r) {
+        if (r->y0 >= y1) {
+            break;
+        }
+        if (r->x1 <= spr->x || r->x0 >= x1) {
+            continue;
+        }
+        cx0 = MAX(r->x0, spr->x);
+        cy0 = MAX(r->y0, spr->y);
+        cx1 = (int)MIN(r->x1, x1);
+        cy1 = (int)MIN(r->y1, y1);
+        if (_append_blit(blits, Py_BuildValue(
+                                    "(O(ii)(iiii)O)", spr->image, cx0, cy0,
+                                    cx0 + spr->offx, cy0 + spr->offy,
+                                    cx1 - cx0, cy1 - cy0, spr->blendmode))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static PyObject *
+_spritecore_draw_dirty(PyObject *self, PyObject *args)
+{
+    PyObject *surface, *sprites, *spritedict, *update, *clipobj, *bgd;
+    PyObject *init_rect, *seq, *upseq = NULL, *blits = NULL, *drawn = NULL;
+    PyObject *result = NULL, *old, *zero = NULL;
+    PyObject **items;
+    pgDirtySprite *sprs = NULL, *spr;
+    pg_region region = {NULL, 0, 0};
+    pg_region_rect clip;
+    Py_ssize_t n, i;
+    Sint64 area = 0;
+    int use_update, full;
+
+    if (!PyArg_ParseTuple(args, "OOO!OOOiO:draw_dirty", &surface, &sprites,
+                          &PyDict_Type, &spritedict, &update, &clipobj, &bgd,
+                          &use_update, &init_rect)) {
+        return NULL;
+    }
+    if (_clip_from_object(clipobj, &clip)) {
+        return NULL;
+    }
+    seq = PySequence_Fast(sprites, "sprites must be a sequence");
+    if (!seq) {
+        return NULL;
+    }
+    n = PySequence_Fast_GET_SIZE(seq);
+    items = PySequence_Fast_ITEMS(seq);
+    sprs = PyMem_New(pgDirtySprite, n ? n : 1);
+    if (!sprs) {
+        Py_DECREF(seq);
+        return PyErr_NoMemory();
+    }
+    memset(sprs, 0, sizeof(pgDirtySprite) * n);
+    for (i = 0; i < n; ++i) {
+        if (_dirty_sprite_load(items[i], sprs + i)) {
+            goto end;
+        }
+    }
+
+    /* The area to redraw: what was lost, and where each dirty sprite was
+     * and is now. When that is all of the clip area, everything is drawn
+     * without splitting the non-dirty sprites. */
+    full = !use_update;
+    if (use_update) {
+        upseq = PySequence_Fast(update, "update must be a sequence");
+        if (!upseq) {
+            goto end;
+        }
+        for (i = 0; i < PySequence_Fast_GET_SIZE(upseq); ++i) {
+            if (_region_add_object(&region,
+                                   PySequence_Fast_GET_ITEM(upseq, i),
+                                   &clip)) {
+                goto end;
+            }
+        }
+        for (spr = sprs; spr < sprs + n; ++spr) {
+            if (spr->dirty <= 0) {
+                continue;
+            }
+            if (_region_add(&region, spr->x, spr->y,
+                            (Sint64)spr->x + spr->w,
+                            (Sint64)spr->y + spr->h, &clip)) {
+                goto end;
+            }
+            old = PyDict_GetItem(spritedict, spr->sprite);
+            if (old && old != init_rect &&
+                _region_add_object(&region, old, &clip)) {
+                goto end;
+            }
+        }
+        if (_region_union(&region)) {
+            goto end;
+        }
+        area = pg_region_area(&region);
+        full = area > 0 && area == ((Sint64)clip.x1 - clip.x0) *
+                                       ((Sint64)clip.y1 - clip.y0);
+    }
+
+    blits = PyList_New(0);
+    if (!blits) {
+        goto end;
+    }
+    if (bgd != Py_None) {
+        if (full) {
+            if (_append_blit(blits, Py_BuildValue("(O(ii))", bgd, 0, 0))) {
+                goto end;
+            }
+        }
+        else {
+            for (i = 0; i < region.count; ++i) {
+                pg_region_rect *r = region.rects + i;
+                int w = r->x1 - r->x0, h = r->y1 - r->y0;
+
+                if (_append_blit(blits,
+                                 Py_BuildValue("(O(iiii)(iiii))", bgd, r->x0,
+                                               r->y0, w, h, r->x0, r->y0, w,
+                                               h))) {
+                    goto end;
+                }
+            }
+        }
+    }
+    for (spr = sprs; spr < sprs + n; ++spr) {
+        if (!spr->visible) {
+            continue;
+        }
+        if (full || spr->dirty > 0) {
+            if (_append_sprite_blit(blits, spr)) {
+                goto end;
+            }
+        }
+        else if (_append_sprite_parts(blits, spr, &region)) {
+            goto end;
+        }
+    }
+
+    if (PyList_GET_SIZE(blits)) {
+        drawn = PyObject_CallMethodObjArgs(surface, str_blits, blits, NULL);
+        if (!drawn) {
+            goto end;
+        }
+        if (!PyList_Check(drawn) ||
+            PyList_GET_SIZE(drawn) != PyList_GET_SIZE(blits)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "blits() must return a list of rects");
+            goto end;
+        }
+    }
+    for (spr = sprs; spr < sprs + n; ++spr) {
+        if (spr->blit >= 0 &&
+            PyDict_SetItem(spritedict, spr->sprite,
+                           PyList_GET_ITEM(drawn, spr->blit))) {
+            goto end;
+        }
+    }
+
+    if (use_update) {
+        zero = PyInt_FromLong(0);
+        if (!zero) {
+            goto end;
+        }
+        for (spr = sprs; spr < sprs + n; ++spr) {
+            if (spr->dirty == 1 &&
+                PyObject_SetAttr(spr->sprite, str_dirty, zero)) {
+                goto end;
+            }
+        }
+    }
+
+    if (full) {
+        result = Py_BuildValue("[N]", pgRect_New4(clip.x0, clip.y0,
+                                                  clip.x1 - clip.x0,
+                                                  clip.y1 - clip.y0));
+    }
+    else {
+        result = _region_as_list(&region);
+    }
+
+end:
+    for (i = 0; i < n; ++i) {
+        Py_XDECREF(sprs[i].rect);
+        Py_XDECREF(sprs[i].source);
+        Py_XDECREF(sprs[i].image);
+        Py_XDECREF(sprs[i].blendmode);
+    }
+    PyMem_Free(sprs);
+    pg_region_clear(&region);
+    Py_XDECREF(zero);
+    Py_XDECREF(drawn);
+    Py_XDECREF(blits);
+    Py_XDECREF(upseq);
+    Py_DECREF(seq);
+    return result;
+}
+
+static PyObject *
+_spritecore_union_rects(PyObject *self, PyObject *args)
+{
+    PyObject *rects, *clipobj, *seq, *result;
+    pg_region region = {NULL, 0, 0};
+    pg_region_rect clip;
+    Py_ssize_t i;
+
+    if (!PyArg_ParseTuple(args, "OO:union_rects", &rects, &clipobj)) {
+        return NULL;
+    }
+    if (_clip_from_object(clipobj, &clip)) {
+        return NULL;
+    }
+    seq = PySequence_Fast(rects, "rects must be a sequence");
+    if (!seq) {
+        return NULL;
+    }
+    for (i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        if (_region_add_object(&region, PySequence_Fast_GET_ITEM(seq, i),
+                               &clip)) {
+            pg_region_clear(&region);
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+    Py_DECREF(seq);
+    result = _region_union(&region) ? NULL : _region_as_list(&region);
+    pg_region_clear(&region);
+    return result;
+}
+
+static PyMethodDef _spritecore_methods[] = {
+    {"draw_dirty", _spritecore_draw_dirty, METH_VARARGS,
+     "draw_dirty(surface, sprites, spritedict, update, clip, bgd, "
+     "use_update, init_rect) -> list\n"
+     "draw a LayeredDirty group, returning the changed areas"},
+    {"union_rects", _spritecore_union_rects, METH_VARARGS,
+     "union_rects(rects, clip) -> list\n"
+     "the union of the rects inside clip, as disjoint rects"},
+    {NULL, NULL, 0, NULL}};
+
+MODINIT_DEFINE(_spritecore)
+{
+    PyObject *module;
+
+#if PY3
+    static struct PyModuleDef _module = {PyModuleDef_HEAD_INIT,
+                                         "_spritecore",
+                                         "native helpers for pygame.sprite",
+                                         -1,
+                                         _spritecore_methods,
+                                         NULL,
+                                         NULL,
+                                         NULL,
+                                         NULL};
+#endif
+
+    /* imported needed apis; Do this first so if there is an error
+       the module is not loaded.
+    */
+    import_pygame_base();
+    if (PyErr_Occurred()) {
+        MODINIT_ERROR;
+    }
+    import_pygame_rect();
+    if (PyErr_Occurred()) {
+        MODINIT_ERROR;
+    }
+
+    str_rect = Text_FromUTF8("rect");
+    str_mask = Text_FromUTF8("mask");
+    str_image = Text_FromUTF8("image");
+    str_radius = Text_FromUTF8("radius");
+    str_get_size = Text_FromUTF8("get_size");
+    str_dirty = Text_FromUTF8("dirty");
+    str_visible = Text_FromUTF8("_visible");
+    str_source_rect = Text_FromUTF8("source_rect");
+    str_blendmode = Text_FromUTF8("blendmode");
+    str_blits = Text_FromUTF8("blits");
+    if (!str_rect || !str_mask || !str_image || !str_radius ||
+        !str_get_size || !str_dirty || !str_visible || !str_source_rect ||
+        !str_blendmode || !str_blits) {
+        MODINIT_ERROR;
+    }
+
+    if (PyType_Ready(&pgSpriteIndex_Type) < 0) {
+        MODINIT_ERROR;
+    }
+
+#if PY3
+    module = PyModule_Create(&_module);
+#else
+    module = Py_InitModule3(MODPREFIX "_spritecore", _spritecore_methods,
+                            "native helpers for pygame.sprite");
+#endif
+    if (module == NULL) {
+        MODINIT_ERROR;
+    }
+    Py_INCREF(&pgSpriteIndex_Type);
+    if (PyModule_AddObject(module, "SpriteIndex",
+                           (PyObject *)&pgSpriteIndex_Type)) {
+        Py_DECREF(&pgSpriteIndex_Type);
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+    if (PyModule_AddIntConstant(module, "BOUNDS_RECT", BOUNDS_RECT) ||
+        PyModule_AddIntConstant(module, "BOUNDS_MASK", BOUNDS_MASK) ||
+        PyModule_AddIntConstant(module, "BOUNDS_CIRCLE", BOUNDS_CIRCLE) ||
+        PyModule_AddIntConstant(module, "BOUNDS_RECT_RATIO",
+                                BOUNDS_RECT_RATIO)) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+    MODINIT_RETURN(module);
+}
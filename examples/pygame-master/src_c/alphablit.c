@@ -24,31 +24,10 @@
 
 #define NO_PYGAME_C_API
 #include "_surface.h"
+#include "simd_blitters.h"
 
-/* The structure passed to the low level blit functions */
-typedef struct
-{
-    int              width;
-    int              height;
-    Uint8           *s_pixels;
-    int              s_pxskip;
-    int              s_skip;
-    Uint8           *d_pixels;
-    int              d_pxskip;
-    int              d_skip;
-    SDL_PixelFormat *src;
-    SDL_PixelFormat *dst;
-#if IS_SDLv1
-    Uint32           src_flags;
-    Uint32           dst_flags;
-#else /* IS_SDLv2 */
-    Uint8            src_blanket_alpha;
-    int              src_has_colorkey;
-    Uint32           src_colorkey;
-    SDL_BlendMode    src_blend;
-    SDL_BlendMode    dst_blend;
-#endif /* IS_SDLv2 */
-} SDL_BlitInfo;
+/* Which vectorized kernels SoftBlitPyGame uses, see pygame_InitBlitBackend */
+static int blit_backend = PG_BACKEND_GENERIC;
 
 static void alphablit_alpha (SDL_BlitInfo * info);
 static void alphablit_colorkey (SDL_BlitInfo * info);
@@ -74,6 +53,53 @@ SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect,
 extern int  SDL_RLESurface (SDL_Surface * surface);
 extern void SDL_UnRLESurface (SDL_Surface * surface, int recode);
 
+#if defined(PG_ENABLE_SSE2)
+/* A channel that is one whole byte of a 32 bit pixel */
+#define _BYTE_CHANNEL(m) \
+    ((m) == 0xFF || (m) == 0xFF00 || (m) == 0xFF0000 || (m) == 0xFF000000)
+
+/* Can the vectorized kernels do this blit? They need a forward 32 bit to
+   32 bit blit with byte sized channels, and R, G and B in the same place
+   in the source and the destination. If src_alpha is set the source alpha
+   channel is read too. */
+static int
+_simd_blit_ok (SDL_BlitInfo * info, int src_alpha)
+{
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+
+    if (blit_backend == PG_BACKEND_GENERIC)
+        return 0;
+    if (srcfmt->BytesPerPixel != 4 || dstfmt->BytesPerPixel != 4 ||
+        info->s_pxskip != 4 || info->d_pxskip != 4)
+        return 0;
+    if (srcfmt->Rmask != dstfmt->Rmask ||
+        srcfmt->Gmask != dstfmt->Gmask ||
+        srcfmt->Bmask != dstfmt->Bmask)
+        return 0;
+    if (!_BYTE_CHANNEL (dstfmt->Rmask) ||
+        !_BYTE_CHANNEL (dstfmt->Gmask) ||
+        !_BYTE_CHANNEL (dstfmt->Bmask))
+        return 0;
+    if (dstfmt->Amask && !_BYTE_CHANNEL (dstfmt->Amask))
+        return 0;
+    if (src_alpha && !_BYTE_CHANNEL (srcfmt->Amask))
+        return 0;
+    return 1;
+}
+
+/* Run the vectorized version of a blitter with the current backend */
+#if defined(PG_ENABLE_AVX2)
+#define _SIMD_BLIT(name, info)                  \
+    if (blit_backend == PG_BACKEND_AVX2)   \
+        name##_avx2_argb (info);                \
+    else                                        \
+        name##_sse2_argb (info)
+#else /* !PG_ENABLE_AVX2 */
+#define _SIMD_BLIT(name, info) name##_sse2_argb (info)
+#endif /* !PG_ENABLE_AVX2 */
+#endif /* PG_ENABLE_SSE2 */
+
 
 
 static int
@@ -336,6 +362,13 @@ blit_blend_rgba_add (SDL_BlitInfo * info)
 #endif /* IS_SDLv2 */
     {
         int incr = srcpxskip > 0 ? 1 : -1;
+#if defined(PG_ENABLE_SSE2)
+        if (incr > 0 && blit_backend != PG_BACKEND_GENERIC)
+        {
+            _SIMD_BLIT (blit_blend_rgba_add, info);
+            return;
+        }
+#endif /* PG_ENABLE_SSE2 */
         if (incr < 0)
         {
             src += 3;
@@ -490,6 +523,13 @@ blit_blend_rgba_sub (SDL_BlitInfo * info)
 #endif /* IS_SDLv2 */
     {
         int incr = srcpxskip > 0 ? 1 : -1;
+#if defined(PG_ENABLE_SSE2)
+        if (incr > 0 && blit_backend != PG_BACKEND_GENERIC)
+        {
+            _SIMD_BLIT (blit_blend_rgba_sub, info);
+            return;
+        }
+#endif /* PG_ENABLE_SSE2 */
         if (incr < 0)
         {
             src += 3;
@@ -639,6 +679,13 @@ blit_blend_rgba_mul (SDL_BlitInfo * info)
 #endif /* IS_SDLv2 */
     {
         int incr = srcpxskip > 0 ? 1 : -1;
+#if defined(PG_ENABLE_SSE2)
+        if (incr > 0 && blit_backend != PG_BACKEND_GENERIC)
+        {
+            _SIMD_BLIT (blit_blend_rgba_mul, info);
+            return;
+        }
+#endif /* PG_ENABLE_SSE2 */
         if (incr < 0)
         {
             src += 3;
@@ -787,6 +834,13 @@ blit_blend_rgba_min (SDL_BlitInfo * info)
 #endif /* IS_SDLv2 */
     {
         int incr = srcpxskip > 0 ? 1 : -1;
+#if defined(PG_ENABLE_SSE2)
+        if (incr > 0 && blit_backend != PG_BACKEND_GENERIC)
+        {
+            _SIMD_BLIT (blit_blend_rgba_min, info);
+            return;
+        }
+#endif /* PG_ENABLE_SSE2 */
         if (incr < 0)
         {
             src += 3;
@@ -935,6 +989,13 @@ blit_blend_rgba_max (SDL_BlitInfo * info)
 #endif /* IS_SDLv2 */
     {
         int incr = srcpxskip > 0 ? 1 : -1;
+#if defined(PG_ENABLE_SSE2)
+        if (incr > 0 && blit_backend != PG_BACKEND_GENERIC)
+        {
+            _SIMD_BLIT (blit_blend_rgba_max, info);
+            return;
+        }
+#endif /* PG_ENABLE_SSE2 */
         if (incr < 0)
         {
             src += 3;
@@ -1070,6 +1131,14 @@ blit_blend_premultiplied (SDL_BlitInfo * info)
     printf ("Premultiplied alpha blit with %d and %d\n", srcbpp, dstbpp);
     */
 
+#if defined(PG_ENABLE_SSE2)
+    if (_simd_blit_ok (info, srcppa))
+    {
+        _SIMD_BLIT (blit_blend_premultiplied, info);
+        return;
+    }
+#endif /* PG_ENABLE_SSE2 */
+
     if (srcbpp == 1)
     {
         if (dstbpp == 1)
@@ -2191,6 +2260,7 @@ blit_blend_max (SDL_BlitInfo * info)
 
 
 
+
 
 
 static void
@@ -2225,6 +2295,14 @@ alphablit_alpha (SDL_BlitInfo * info)
        printf ("Alpha blit with %d and %d\n", srcbpp, dstbpp);
        */
 
+#if defined(PG_ENABLE_SSE2)
+    if (_simd_blit_ok (info, 1))
+    {
+        _SIMD_BLIT (alphablit_alpha, info);
+        return;
+    }
+#endif /* PG_ENABLE_SSE2 */
+
     if (srcbpp == 1)
     {
         if (dstbpp == 1)
@@ -2405,6 +2483,14 @@ alphablit_colorkey (SDL_BlitInfo * info)
 #if IS_SDLv2
     assert (info->src_has_colorkey);
 #endif /* IS_SDLv2 */
+
+#if defined(PG_ENABLE_SSE2)
+    if (_simd_blit_ok (info, 0))
+    {
+        _SIMD_BLIT (alphablit_colorkey, info);
+        return;
+    }
+#endif /* PG_ENABLE_SSE2 */
     if (srcbpp == 1)
     {
         if (dstbpp == 1)
@@ -2636,6 +2722,14 @@ alphablit_solid (SDL_BlitInfo * info)
        printf ("Solid blit with %d and %d\n", srcbpp, dstbpp);
        */
 
+#if defined(PG_ENABLE_SSE2)
+    if (_simd_blit_ok (info, 0))
+    {
+        _SIMD_BLIT (alphablit_solid, info);
+        return;
+    }
+#endif /* PG_ENABLE_SSE2 */
+
     if (srcbpp == 1)
     {
         if (dstbpp == 1)
@@ -2929,6 +3023,50 @@ pygame_Blit (SDL_Surface * src, SDL_Rect * srcrect,
     return 0;
 }
 
+/* Switch to a backend the CPU can run, if this build has its kernels */
+static int
+_use_blit_backend (int backend)
+{
+    switch (backend)
+    {
+    case PG_BACKEND_GENERIC:
+        break;
+#if defined(PG_ENABLE_SSE2)
+    case PG_BACKEND_SSE2:
+        break;
+#endif /* PG_ENABLE_SSE2 */
+#if defined(PG_ENABLE_AVX2)
+    case PG_BACKEND_AVX2:
+        break;
+#endif /* PG_ENABLE_AVX2 */
+    default:
+        return -1;
+    }
+    blit_backend = backend;
+    return 0;
+}
+
+/* Pick the fastest blit kernels this machine supports */
+void
+pygame_InitBlitBackend (void)
+{
+    pg_backend_set_best (_use_blit_backend);
+}
+
+const char *
+pygame_GetBlitBackend (void)
+{
+    return pg_backend_name (blit_backend);
+}
+
+/* Returns 0 on success, -1 for an unknown backend and -2 for one this
+   build or machine cannot run. */
+int
+pygame_SetBlitBackend (const char *type)
+{
+    return pg_backend_set (type, _use_blit_backend);
+}
+
 int
 pygame_AlphaBlit (SDL_Surface * src, SDL_Rect * srcrect,
                   SDL_Surface * dst, SDL_Rect * dstrect, int the_args)
@@ -32,6 +32,28 @@
 #define MIN(a, b) ((a) <= (b) ? (a) : (b))
 #define MAX(a, b) ((a) >= (b) ? (a) : (b))
 
+/* BITMASK_W is an unsigned long, so it is 64 bits wide wherever longs are. */
+#if ULONG_MAX > 0xffffffffUL
+#define BITMASK_W_IS_64 1
+#else
+#define BITMASK_W_IS_64 0
+#endif
+
+/* Vector versions of the overlap kernels, picked at run time with
+   bitmask_set_backend(); see simd_backend.h. This file has no SDL, so the
+   caller checks the CPU. */
+#define PG_SIMD_GATING_ONLY
+#include "simd_backend.h"
+
+#if defined(PG_HAS_AVX2)
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BITMASK_POPCNT(w) __popcnt(w)
+#else
+#define BITMASK_POPCNT(w) __builtin_popcountl(w)
+#endif
+#endif /* PG_HAS_AVX2 */
+
 /* The code by Gillies is slightly (1-3%) faster than the more
    readable code below */
 #define GILLIES
@@ -171,7 +193,7 @@ bitmask_fill(bitmask_t *m)
 
     len = m->h * ((m->w - 1) / BITMASK_W_LEN);
 
-    shift = BITMASK_W_LEN - (m->w % BITMASK_W_LEN);
+    shift = BITMASK_W_MASK - ((m->w - 1) & BITMASK_W_MASK);
     full = ~(BITMASK_W)0;
     cmask = (~(BITMASK_W)0) >> shift;
     /* fill all the pixels that aren't in the rightmost BITMASK_Ws */
@@ -197,7 +219,7 @@ bitmask_invert(bitmask_t *m)
 
     len = m->h * ((m->w - 1) / BITMASK_W_LEN);
 
-    shift = BITMASK_W_LEN - (m->w % BITMASK_W_LEN);
+    shift = BITMASK_W_MASK - ((m->w - 1) & BITMASK_W_MASK);
     cmask = (~(BITMASK_W)0) >> shift;
     /* flip all the pixels that aren't in the rightmost BITMASK_Ws */
     for (pixels = m->bits; pixels < (m->bits + len); pixels++) {
@@ -229,14 +251,538 @@ bitmask_count(bitmask_t *m)
     return tot;
 }
 
+/* The overlap functions below walk the masks one stripe (a column of
+   words, one per row) at a time. Their inner loops come in two forms:
+
+   shifted a:  ((a[k] >> shift) | (a2[k] << (BITMASK_W_LEN - shift))) & b[k]
+               where a2 is the next stripe of a, or NULL if there is none.
+   shifted b:  a[k] & ((b[k] << lshift) | (b[k] >> rshift))
+               where a shift of BITMASK_W_LEN or more gives all zeros.
+
+   Each backend supplies the same four loops over these words, so the SSE2
+   and AVX2 versions can handle several rows of a stripe at once. A fifth
+   loop builds mask rows from 32 bit pixels for bitmask_set_row_within().
+*/
+typedef struct {
+    /* Nonzero if any shifted a word overlaps b. */
+    int (*any)(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+               int n, unsigned int shift);
+    /* Number of overlapping shifted a bits. */
+    unsigned int (*count)(const BITMASK_W *ap, const BITMASK_W *app,
+                          const BITMASK_W *bp, int n, unsigned int shift);
+    /* Index of the first row where a overlaps shifted b, or n. */
+    int (*find)(const BITMASK_W *ap, const BITMASK_W *bp, int n,
+                unsigned int lshift, unsigned int rshift);
+    /* c = a & shifted b, or c |= a & shifted b if accumulate is set. */
+    void (*intersect)(BITMASK_W *cp, const BITMASK_W *ap,
+                      const BITMASK_W *bp, int n, unsigned int lshift,
+                      unsigned int rshift, int accumulate);
+    /* Sets the words cp[0], cp[stride], ... of one row from w pixels, as
+       described for bitmask_set_row_within(); flip is all ones to invert. */
+    void (*within)(BITMASK_W *cp, int stride, const unsigned int *p,
+                   const unsigned int *q, int w, unsigned int color,
+                   unsigned int dist, unsigned int bytes, BITMASK_W flip);
+} bitmask_kernels;
+
+#define SHL(w, s) ((s) < BITMASK_W_LEN ? (w) << (s) : 0)
+#define SHR(w, s) ((s) < BITMASK_W_LEN ? (w) >> (s) : 0)
+
+static int
+any_generic(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+            int n, unsigned int shift)
+{
+    unsigned int rshift = BITMASK_W_LEN - shift;
+    int k;
+
+    if (app) {
+        for (k = 0; k < n; k++)
+            if (((ap[k] >> shift) | (app[k] << rshift)) & bp[k])
+                return 1;
+    }
+    else {
+        for (k = 0; k < n; k++)
+            if ((ap[k] >> shift) & bp[k])
+                return 1;
+    }
+    return 0;
+}
+
+static unsigned int
+count_generic(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+              int n, unsigned int shift)
+{
+    unsigned int rshift = BITMASK_W_LEN - shift;
+    unsigned int count = 0;
+    int k;
+
+    if (app) {
+        for (k = 0; k < n; k++)
+            count += bitcount(((ap[k] >> shift) | (app[k] << rshift)) & bp[k]);
+    }
+    else {
+        for (k = 0; k < n; k++)
+            count += bitcount((ap[k] >> shift) & bp[k]);
+    }
+    return count;
+}
+
+static int
+find_generic(const BITMASK_W *ap, const BITMASK_W *bp, int n,
+             unsigned int lshift, unsigned int rshift)
+{
+    int k;
+
+    for (k = 0; k < n; k++)
+        if (ap[k] & (SHL(bp[k], lshift) | SHR(bp[k], rshift)))
+            return k;
+    return n;
+}
+
+static void
+and_generic(BITMASK_W *cp, const BITMASK_W *ap, const BITMASK_W *bp, int n,
+            unsigned int lshift, unsigned int rshift, int accumulate)
+{
+    int k;
+
+    if (accumulate) {
+        for (k = 0; k < n; k++)
+            cp[k] |= ap[k] & (SHL(bp[k], lshift) | SHR(bp[k], rshift));
+    }
+    else {
+        for (k = 0; k < n; k++)
+            cp[k] = ap[k] & (SHL(bp[k], lshift) | SHR(bp[k], rshift));
+    }
+}
+
+/* 1 if every byte of p picked by bytes is less than the same byte of dist
+   away from c. */
+static INLINE BITMASK_W
+within_pixel(unsigned int p, unsigned int c, unsigned int dist,
+             unsigned int bytes)
+{
+    unsigned int s;
+    int d;
+
+    for (s = 0; s < 32; s += 8) {
+        if ((bytes >> s) & 0xff) {
+            d = (int)((p >> s) & 0xff) - (int)((c >> s) & 0xff);
+            if ((d < 0 ? -d : d) >= (int)((dist >> s) & 0xff))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static void
+within_generic(BITMASK_W *cp, int stride, const unsigned int *p,
+               const unsigned int *q, int w, unsigned int color,
+               unsigned int dist, unsigned int bytes, BITMASK_W flip)
+{
+    BITMASK_W word;
+    int x, i, n;
+
+    for (x = 0; x < w; x += BITMASK_W_LEN, cp += stride) {
+        n = MIN((int)BITMASK_W_LEN, w - x);
+        word = 0;
+        for (i = 0; i < n; i++)
+            word |= within_pixel(p[x + i], q ? q[x + i] : color, dist, bytes)
+                    << i;
+        word ^= flip;
+        if (n < (int)BITMASK_W_LEN)
+            word &= BITMASK_N(n) - 1;
+        *cp = word;
+    }
+}
+
+static const bitmask_kernels generic_kernels = {
+    any_generic, count_generic, find_generic, and_generic, within_generic};
+
+#ifdef PG_HAS_SSE2
+/* Vector shifts by a count in the low quadword of an xmm register give
+   zero for counts of the lane width or more, so the shifted b form needs no
+   special case here. */
+#if BITMASK_W_IS_64
+#define MM_SLL_W _mm_sll_epi64
+#define MM_SRL_W _mm_srl_epi64
+#define MM256_SLL_W _mm256_sll_epi64
+#define MM256_SRL_W _mm256_srl_epi64
+#else
+#define MM_SLL_W _mm_sll_epi32
+#define MM_SRL_W _mm_srl_epi32
+#define MM256_SLL_W _mm256_sll_epi32
+#define MM256_SRL_W _mm256_srl_epi32
+#endif
+
+#define SSE2_STEP ((int)(sizeof(__m128i) / sizeof(BITMASK_W)))
+#define LOAD_SSE2(p) _mm_loadu_si128((const __m128i *)(p))
+
+/* Bits set in each 64 bit half of v, as two 64 bit sums. */
+static INLINE __m128i
+popcount_sse2(__m128i v)
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2),
+                     _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+    v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+    return _mm_sad_epu8(v, _mm_setzero_si128());
+}
+
+static INLINE int
+is_zero_sse2(__m128i v)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) ==
+           0xFFFF;
+}
+
+static int
+any_sse2(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+         int n, unsigned int shift)
+{
+    __m128i s = _mm_cvtsi32_si128(shift);
+    __m128i r = _mm_cvtsi32_si128(BITMASK_W_LEN - shift);
+    __m128i v;
+    int k;
+
+    for (k = 0; k + SSE2_STEP <= n; k += SSE2_STEP) {
+        v = MM_SRL_W(LOAD_SSE2(ap + k), s);
+        if (app)
+            v = _mm_or_si128(v, MM_SLL_W(LOAD_SSE2(app + k), r));
+        if (!is_zero_sse2(_mm_and_si128(v, LOAD_SSE2(bp + k))))
+            return 1;
+    }
+    return any_generic(ap + k, app ? app + k : NULL, bp + k, n - k, shift);
+}
+
+static unsigned int
+count_sse2(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+           int n, unsigned int shift)
+{
+    __m128i s = _mm_cvtsi32_si128(shift);
+    __m128i r = _mm_cvtsi32_si128(BITMASK_W_LEN - shift);
+    __m128i v, sum = _mm_setzero_si128();
+    int k;
+
+    for (k = 0; k + SSE2_STEP <= n; k += SSE2_STEP) {
+        v = MM_SRL_W(LOAD_SSE2(ap + k), s);
+        if (app)
+            v = _mm_or_si128(v, MM_SLL_W(LOAD_SSE2(app + k), r));
+        v = _mm_and_si128(v, LOAD_SSE2(bp + k));
+        sum = _mm_add_epi64(sum, popcount_sse2(v));
+    }
+    sum = _mm_add_epi64(sum, _mm_srli_si128(sum, 8));
+    return (unsigned int)_mm_cvtsi128_si32(sum) +
+           count_generic(ap + k, app ? app + k : NULL, bp + k, n - k, shift);
+}
+
+static int
+find_sse2(const BITMASK_W *ap, const BITMASK_W *bp, int n,
+          unsigned int lshift, unsigned int rshift)
+{
+    __m128i l = _mm_cvtsi32_si128(lshift);
+    __m128i r = _mm_cvtsi32_si128(rshift);
+    __m128i b;
+    int k;
+
+    for (k = 0; k + SSE2_STEP <= n; k += SSE2_STEP) {
+        b = LOAD_SSE2(bp + k);
+        b = _mm_or_si128(MM_SLL_W(b, l), MM_SRL_W(b, r));
+        if (!is_zero_sse2(_mm_and_si128(LOAD_SSE2(ap + k), b)))
+            break;
+    }
+    return k + find_generic(ap + k, bp + k, n - k, lshift, rshift);
+}
+
+static void
+and_sse2(BITMASK_W *cp, const BITMASK_W *ap, const BITMASK_W *bp, int n,
+         unsigned int lshift, unsigned int rshift, int accumulate)
+{
+    __m128i l = _mm_cvtsi32_si128(lshift);
+    __m128i r = _mm_cvtsi32_si128(rshift);
+    __m128i b;
+    int k;
+
+    for (k = 0; k + SSE2_STEP <= n; k += SSE2_STEP) {
+        b = LOAD_SSE2(bp + k);
+        b = _mm_or_si128(MM_SLL_W(b, l), MM_SRL_W(b, r));
+        b = _mm_and_si128(LOAD_SSE2(ap + k), b);
+        if (accumulate)
+            b = _mm_or_si128(b, LOAD_SSE2(cp + k));
+        _mm_storeu_si128((__m128i *)(cp + k), b);
+    }
+    and_generic(cp + k, ap + k, bp + k, n - k, lshift, rshift, accumulate);
+}
+
+/* All ones in each 32 bit lane whose pixel in p is within dist of c. The
+   byte differences use saturating subtraction both ways. */
+static INLINE __m128i
+within_lanes_sse2(__m128i p, __m128i c, __m128i dist, __m128i bytes)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i d = _mm_or_si128(_mm_subs_epu8(p, c), _mm_subs_epu8(c, p));
+    __m128i out = _mm_cmpeq_epi8(_mm_subs_epu8(dist, d), zero);
+
+    return _mm_cmpeq_epi32(_mm_and_si128(out, bytes), zero);
+}
+
+/* Tests 16 pixels at a time; the lane masks are packed down to one byte
+   per pixel, which keeps them in order for _mm_movemask_epi8(). */
+static void
+within_sse2(BITMASK_W *cp, int stride, const unsigned int *p,
+            const unsigned int *q, int w, unsigned int color,
+            unsigned int dist, unsigned int bytes, BITMASK_W flip)
+{
+    const __m128i c = _mm_set1_epi32((int)color);
+    const __m128i d = _mm_set1_epi32((int)dist);
+    const __m128i b = _mm_set1_epi32((int)bytes);
+    __m128i v[4];
+    BITMASK_W word;
+    int x, i, j;
+
+    for (x = 0; x + (int)BITMASK_W_LEN <= w; x += BITMASK_W_LEN) {
+        word = 0;
+        for (i = 0; i < (int)BITMASK_W_LEN; i += 16) {
+            for (j = 0; j < 4; j++)
+                v[j] = within_lanes_sse2(
+                    LOAD_SSE2(p + x + i + 4 * j),
+                    q ? LOAD_SSE2(q + x + i + 4 * j) : c, d, b);
+            v[0] = _mm_packs_epi16(_mm_packs_epi32(v[0], v[1]),
+                                   _mm_packs_epi32(v[2], v[3]));
+            word |= (BITMASK_W)(unsigned int)_mm_movemask_epi8(v[0]) << i;
+        }
+        *cp = word ^ flip;
+        cp += stride;
+    }
+    within_generic(cp, stride, p + x, q ? q + x : NULL, w - x, color, dist,
+                   bytes, flip);
+}
+
+static const bitmask_kernels sse2_kernels = {any_sse2, count_sse2, find_sse2,
+                                             and_sse2, within_sse2};
+#endif /* PG_HAS_SSE2 */
+
+#ifdef PG_HAS_AVX2
+#define AVX2_STEP ((int)(sizeof(__m256i) / sizeof(BITMASK_W)))
+#define LOAD_AVX2(p) _mm256_loadu_si256((const __m256i *)(p))
+
+/* Every CPU with AVX2 also has POPCNT, so the leftover rows use it. */
+PG_FUNCTION_TARGET_AVX2_POPCNT static unsigned int
+count_popcnt(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+             int n, unsigned int shift)
+{
+    unsigned int rshift = BITMASK_W_LEN - shift;
+    unsigned int count = 0;
+    int k;
+
+    if (app) {
+        for (k = 0; k < n; k++)
+            count += BITMASK_POPCNT(((ap[k] >> shift) | (app[k] << rshift)) &
+                                    bp[k]);
+    }
+    else {
+        for (k = 0; k < n; k++)
+            count += BITMASK_POPCNT((ap[k] >> shift) & bp[k]);
+    }
+    return count;
+}
+
+/* Bits set in each 64 bit quarter of v, using a nibble lookup table. */
+PG_FUNCTION_TARGET_AVX2_POPCNT static INLINE __m256i
+popcount_avx2(__m256i v)
+{
+    const __m256i table =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i m4 = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, m4));
+    __m256i hi = _mm256_shuffle_epi8(
+        table, _mm256_and_si256(_mm256_srli_epi16(v, 4), m4));
+
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+PG_FUNCTION_TARGET_AVX2_POPCNT static int
+any_avx2(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+         int n, unsigned int shift)
+{
+    __m128i s = _mm_cvtsi32_si128(shift);
+    __m128i r = _mm_cvtsi32_si128(BITMASK_W_LEN - shift);
+    __m256i v;
+    int k;
+
+    for (k = 0; k + AVX2_STEP <= n; k += AVX2_STEP) {
+        v = MM256_SRL_W(LOAD_AVX2(ap + k), s);
+        if (app)
+            v = _mm256_or_si256(v, MM256_SLL_W(LOAD_AVX2(app + k), r));
+        if (!_mm256_testz_si256(v, LOAD_AVX2(bp + k)))
+            return 1;
+    }
+    return any_generic(ap + k, app ? app + k : NULL, bp + k, n - k, shift);
+}
+
+PG_FUNCTION_TARGET_AVX2_POPCNT static unsigned int
+count_avx2(const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+           int n, unsigned int shift)
+{
+    __m128i s = _mm_cvtsi32_si128(shift);
+    __m128i r = _mm_cvtsi32_si128(BITMASK_W_LEN - shift);
+    __m256i v, sum = _mm256_setzero_si256();
+    __m128i total;
+    int k;
+
+    for (k = 0; k + AVX2_STEP <= n; k += AVX2_STEP) {
+        v = MM256_SRL_W(LOAD_AVX2(ap + k), s);
+        if (app)
+            v = _mm256_or_si256(v, MM256_SLL_W(LOAD_AVX2(app + k), r));
+        v = _mm256_and_si256(v, LOAD_AVX2(bp + k));
+        sum = _mm256_add_epi64(sum, popcount_avx2(v));
+    }
+    total = _mm_add_epi64(_mm256_castsi256_si128(sum),
+                          _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi64(total, _mm_srli_si128(total, 8));
+    return (unsigned int)_mm_cvtsi128_si32(total) +
+           count_popcnt(ap + k, app ? app + k : NULL, bp + k, n - k, shift);
+}
+
+PG_FUNCTION_TARGET_AVX2_POPCNT static int
+find_avx2(const BITMASK_W *ap, const BITMASK_W *bp, int n,
+          unsigned int lshift, unsigned int rshift)
+{
+    __m128i l = _mm_cvtsi32_si128(lshift);
+    __m128i r = _mm_cvtsi32_si128(rshift);
+    __m256i b;
+    int k;
+
+    for (k = 0; k + AVX2_STEP <= n; k += AVX2_STEP) {
+        b = LOAD_AVX2(bp + k);
+        b = _mm256_or_si256(MM256_SLL_W(b, l), MM256_SRL_W(b, r));
+        if (!_mm256_testz_si256(LOAD_AVX2(ap + k), b))
+            break;
+    }
+    return k + find_generic(ap + k, bp + k, n - k, lshift, rshift);
+}
+
+PG_FUNCTION_TARGET_AVX2_POPCNT static void
+and_avx2(BITMASK_W *cp, const BITMASK_W *ap, const BITMASK_W *bp, int n,
+         unsigned int lshift, unsigned int rshift, int accumulate)
+{
+    __m128i l = _mm_cvtsi32_si128(lshift);
+    __m128i r = _mm_cvtsi32_si128(rshift);
+    __m256i b;
+    int k;
+
+    for (k = 0; k + AVX2_STEP <= n; k += AVX2_STEP) {
+        b = LOAD_AVX2(bp + k);
+        b = _mm256_or_si256(MM256_SLL_W(b, l), MM256_SRL_W(b, r));
+        b = _mm256_and_si256(LOAD_AVX2(ap + k), b);
+        if (accumulate)
+            b = _mm256_or_si256(b, LOAD_AVX2(cp + k));
+        _mm256_storeu_si256((__m256i *)(cp + k), b);
+    }
+    and_generic(cp + k, ap + k, bp + k, n - k, lshift, rshift, accumulate);
+}
+
+PG_FUNCTION_TARGET_AVX2_POPCNT static INLINE __m256i
+within_lanes_avx2(__m256i p, __m256i c, __m256i dist, __m256i bytes)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i d =
+        _mm256_or_si256(_mm256_subs_epu8(p, c), _mm256_subs_epu8(c, p));
+    __m256i out = _mm256_cmpeq_epi8(_mm256_subs_epu8(dist, d), zero);
+
+    return _mm256_cmpeq_epi32(_mm256_and_si256(out, bytes), zero);
+}
+
+/* Tests 32 pixels at a time. The packs work within 128 bit halves, so a
+   dword permute puts the pixel bytes back in order before the movemask. */
+PG_FUNCTION_TARGET_AVX2_POPCNT static void
+within_avx2(BITMASK_W *cp, int stride, const unsigned int *p,
+            const unsigned int *q, int w, unsigned int color,
+            unsigned int dist, unsigned int bytes, BITMASK_W flip)
+{
+    const __m256i c = _mm256_set1_epi32((int)color);
+    const __m256i d = _mm256_set1_epi32((int)dist);
+    const __m256i b = _mm256_set1_epi32((int)bytes);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    __m256i v[4];
+    BITMASK_W word;
+    int x, i, j;
+
+    for (x = 0; x + (int)BITMASK_W_LEN <= w; x += BITMASK_W_LEN) {
+        word = 0;
+        for (i = 0; i < (int)BITMASK_W_LEN; i += 32) {
+            for (j = 0; j < 4; j++)
+                v[j] = within_lanes_avx2(
+                    LOAD_AVX2(p + x + i + 8 * j),
+                    q ? LOAD_AVX2(q + x + i + 8 * j) : c, d, b);
+            v[0] = _mm256_packs_epi16(_mm256_packs_epi32(v[0], v[1]),
+                                      _mm256_packs_epi32(v[2], v[3]));
+            v[0] = _mm256_permutevar8x32_epi32(v[0], order);
+            word |= (BITMASK_W)(unsigned int)_mm256_movemask_epi8(v[0]) << i;
+        }
+        *cp = word ^ flip;
+        cp += stride;
+    }
+    within_generic(cp, stride, p + x, q ? q + x : NULL, w - x, color, dist,
+                   bytes, flip);
+}
+
+static const bitmask_kernels avx2_kernels = {any_avx2, count_avx2, find_avx2,
+                                             and_avx2, within_avx2};
+#endif /* PG_HAS_AVX2 */
+
+static const bitmask_kernels *kernels = &generic_kernels;
+static int kernels_backend = BITMASK_BACKEND_GENERIC;
+
+int
+bitmask_set_backend(int backend)
+{
+    switch (backend) {
+        case BITMASK_BACKEND_GENERIC:
+            kernels = &generic_kernels;
+            break;
+#ifdef PG_HAS_SSE2
+        case BITMASK_BACKEND_SSE2:
+            kernels = &sse2_kernels;
+            break;
+#endif /* PG_HAS_SSE2 */
+#ifdef PG_HAS_AVX2
+        case BITMASK_BACKEND_AVX2:
+            kernels = &avx2_kernels;
+            break;
+#endif /* PG_HAS_AVX2 */
+        default:
+            return -1;
+    }
+    kernels_backend = backend;
+    return 0;
+}
+
+int
+bitmask_get_backend(void)
+{
+    return kernels_backend;
+}
+
+void
+bitmask_set_row_within(bitmask_t *m, int y, const unsigned int *pixels,
+                       const unsigned int *others, unsigned int color,
+                       unsigned int dist, unsigned int bytes, int invert)
+{
+    kernels->within(m->bits + y, m->h, pixels, others, m->w, color, dist,
+                    bytes, invert ? ~(BITMASK_W)0 : 0);
+}
+
 int
 bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
                 int yoffset)
 {
-    const BITMASK_W *a_entry, *a_end;
-    const BITMASK_W *b_entry;
-    const BITMASK_W *ap, *app, *bp;
-    unsigned int shift, rshift, i, astripes, bstripes;
+    const BITMASK_W *a_entry, *b_entry;
+    unsigned int shift, i, astripes, bstripes;
+    int rows;
 
     /* Return if no overlap or one mask has a width/height of 0. */
     if ((xoffset >= a->w) || (yoffset >= a->h) || (yoffset <= -b->h) ||
@@ -249,47 +795,37 @@ bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
         if (yoffset >= 0) {
             a_entry = a->bits +
                       a->h * ((unsigned int)xoffset / BITMASK_W_LEN) + yoffset;
-            a_end = a_entry + MIN(b->h, a->h - yoffset);
+            rows = MIN(b->h, a->h - yoffset);
             b_entry = b->bits;
         }
         else {
             a_entry = a->bits + a->h * ((unsigned int)xoffset / BITMASK_W_LEN);
-            a_end = a_entry + MIN(b->h + yoffset, a->h);
+            rows = MIN(b->h + yoffset, a->h);
             b_entry = b->bits - yoffset;
         }
         shift = xoffset & BITMASK_W_MASK;
         if (shift) {
-            rshift = BITMASK_W_LEN - shift;
             astripes = ((unsigned int)(a->w - 1)) / BITMASK_W_LEN -
                        (unsigned int)xoffset / BITMASK_W_LEN;
             bstripes = ((unsigned int)(b->w - 1)) / BITMASK_W_LEN + 1;
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, app = ap + a->h, bp = b_entry;
-                         ap < a_end;)
-                        if ((*ap++ >> shift) & *bp ||
-                            (*app++ << rshift) & *bp++)
-                            return 1;
+                    if (kernels->any(a_entry, a_entry + a->h, b_entry, rows,
+                                     shift))
+                        return 1;
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    if ((*ap++ >> shift) & *bp++)
-                        return 1;
-                return 0;
+                return kernels->any(a_entry, NULL, b_entry, rows, shift);
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, app = ap + a->h, bp = b_entry;
-                         ap < a_end;)
-                        if ((*ap++ >> shift) & *bp ||
-                            (*app++ << rshift) & *bp++)
-                            return 1;
+                    if (kernels->any(a_entry, a_entry + a->h, b_entry, rows,
+                                     shift))
+                        return 1;
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
                 return 0;
@@ -300,11 +836,9 @@ bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    if (*ap++ & *bp++)
-                        return 1;
+                if (kernels->any(a_entry, NULL, b_entry, rows, 0))
+                    return 1;
                 a_entry += a->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
             return 0;
@@ -332,14 +866,33 @@ firstsetbit(BITMASK_W w)
     return i;
 }
 
+/* Looks for the first row where stripe a overlaps stripe b shifted by
+ * lshift/rshift, and if found stores its position in x and y. xbase is the
+ * x coordinate of the first bit of the a stripe. */
+static INLINE int
+overlap_pos_stripe(const BITMASK_W *a_entry, const BITMASK_W *b_entry,
+                   int rows, unsigned int lshift, unsigned int rshift,
+                   unsigned int xbase, int yoffset, int *x, int *y)
+{
+    int k = kernels->find(a_entry, b_entry, rows, lshift, rshift);
+
+    if (k == rows)
+        return 0;
+    *y = k + yoffset;
+    *x = xbase + firstsetbit(a_entry[k] & (SHL(b_entry[k], lshift) |
+                                           SHR(b_entry[k], rshift)));
+    return 1;
+}
+
 /* x and y are given in the coordinates of mask a, and are untouched if there
  * is no overlap */
 int
 bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
                     int yoffset, int *x, int *y)
 {
-    const BITMASK_W *a_entry, *a_end, *b_entry, *ap, *bp;
+    const BITMASK_W *a_entry, *b_entry;
     unsigned int shift, rshift, i, astripes, bstripes, xbase;
+    int rows;
 
     /* Return if no overlap or one mask has a width/height of 0. */
     if ((xoffset >= a->w) || (yoffset >= a->h) || (yoffset <= -b->h) ||
@@ -351,12 +904,12 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
         xbase = xoffset / BITMASK_W_LEN; /* first stripe from mask a */
         if (yoffset >= 0) {
             a_entry = a->bits + a->h * xbase + yoffset;
-            a_end = a_entry + MIN(b->h, a->h - yoffset);
+            rows = MIN(b->h, a->h - yoffset);
             b_entry = b->bits;
         }
         else {
             a_entry = a->bits + a->h * xbase;
-            a_end = a_entry + MIN(b->h + yoffset, a->h);
+            rows = MIN(b->h + yoffset, a->h);
             b_entry = b->bits - yoffset;
             yoffset = 0; /* relied on below */
         }
@@ -368,52 +921,38 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp << shift)) {
-                            *y = ap - a_entry + yoffset;
-                            *x = (xbase + i) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp << shift));
-                            return 1;
-                        }
+                    if (overlap_pos_stripe(a_entry, b_entry, rows, shift,
+                                           BITMASK_W_LEN,
+                                           (xbase + i) * BITMASK_W_LEN,
+                                           yoffset, x, y))
+                        return 1;
                     a_entry += a->h;
-                    a_end += a->h;
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp >> rshift)) {
-                            *y = ap - a_entry + yoffset;
-                            *x = (xbase + i + 1) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp >> rshift));
-                            return 1;
-                        }
+                    if (overlap_pos_stripe(a_entry, b_entry, rows,
+                                           BITMASK_W_LEN, rshift,
+                                           (xbase + i + 1) * BITMASK_W_LEN,
+                                           yoffset, x, y))
+                        return 1;
                     b_entry += b->h;
                 }
-                for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                    if (*ap & (*bp << shift)) {
-                        *y = ap - a_entry + yoffset;
-                        *x = (xbase + astripes) * BITMASK_W_LEN +
-                             firstsetbit(*ap & (*bp << shift));
-                        return 1;
-                    }
-                return 0;
+                return overlap_pos_stripe(a_entry, b_entry, rows, shift,
+                                          BITMASK_W_LEN,
+                                          (xbase + astripes) * BITMASK_W_LEN,
+                                          yoffset, x, y);
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp << shift)) {
-                            *y = ap - a_entry + yoffset;
-                            *x = (xbase + i) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp << shift));
-                            return 1;
-                        }
+                    if (overlap_pos_stripe(a_entry, b_entry, rows, shift,
+                                           BITMASK_W_LEN,
+                                           (xbase + i) * BITMASK_W_LEN,
+                                           yoffset, x, y))
+                        return 1;
                     a_entry += a->h;
-                    a_end += a->h;
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp >> rshift)) {
-                            *y = ap - a_entry + yoffset;
-                            *x = (xbase + i + 1) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp >> rshift));
-                            return 1;
-                        }
+                    if (overlap_pos_stripe(a_entry, b_entry, rows,
+                                           BITMASK_W_LEN, rshift,
+                                           (xbase + i + 1) * BITMASK_W_LEN,
+                                           yoffset, x, y))
+                        return 1;
                     b_entry += b->h;
                 }
                 return 0;
@@ -425,16 +964,12 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++) {
-                    if (*ap & *bp) {
-                        *y = ap - a_entry + yoffset;
-                        *x = (xbase + i) * BITMASK_W_LEN +
-                             firstsetbit(*ap & *bp);
-                        return 1;
-                    }
-                }
+                if (overlap_pos_stripe(a_entry, b_entry, rows, 0,
+                                       BITMASK_W_LEN,
+                                       (xbase + i) * BITMASK_W_LEN, yoffset,
+                                       x, y))
+                    return 1;
                 a_entry += a->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
             return 0;
@@ -455,9 +990,10 @@ int
 bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
                      int yoffset)
 {
-    const BITMASK_W *a_entry, *a_end, *b_entry, *ap, *bp;
-    unsigned int shift, rshift, i, astripes, bstripes;
+    const BITMASK_W *a_entry, *b_entry;
+    unsigned int shift, i, astripes, bstripes;
     unsigned int count = 0;
+    int rows;
 
     /* Return if no overlap or one mask has a width/height of 0. */
     if ((xoffset >= a->w) || (yoffset >= a->h) || (yoffset <= -b->h) ||
@@ -469,41 +1005,35 @@ bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
     swapentry:
         if (yoffset >= 0) {
             a_entry = a->bits + a->h * (xoffset / BITMASK_W_LEN) + yoffset;
-            a_end = a_entry + MIN(b->h, a->h - yoffset);
+            rows = MIN(b->h, a->h - yoffset);
             b_entry = b->bits;
         }
         else {
             a_entry = a->bits + a->h * (xoffset / BITMASK_W_LEN);
-            a_end = a_entry + MIN(b->h + yoffset, a->h);
+            rows = MIN(b->h + yoffset, a->h);
             b_entry = b->bits - yoffset;
         }
         shift = xoffset & BITMASK_W_MASK;
         if (shift) {
-            rshift = BITMASK_W_LEN - shift;
             astripes = (a->w - 1) / BITMASK_W_LEN - xoffset / BITMASK_W_LEN;
             bstripes = (b->w - 1) / BITMASK_W_LEN + 1;
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        count += bitcount(
-                            ((*ap >> shift) | (*(ap + a->h) << rshift)) & *bp);
+                    count += kernels->count(a_entry, a_entry + a->h, b_entry,
+                                            rows, shift);
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    count += bitcount((*ap++ >> shift) & *bp++);
+                count += kernels->count(a_entry, NULL, b_entry, rows, shift);
                 return count;
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        count += bitcount(
-                            ((*ap >> shift) | (*(ap + a->h) << rshift)) & *bp);
+                    count += kernels->count(a_entry, a_entry + a->h, b_entry,
+                                            rows, shift);
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
                 return count;
@@ -514,11 +1044,8 @@ bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    count += bitcount(*ap++ & *bp++);
-
+                count += kernels->count(a_entry, NULL, b_entry, rows, 0);
                 a_entry += a->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
             return count;
@@ -539,10 +1066,9 @@ void
 bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
                      int xoffset, int yoffset)
 {
-    const BITMASK_W *a_entry, *a_end, *ap;
-    const BITMASK_W *b_entry, *b_end, *bp;
+    const BITMASK_W *a_entry, *b_entry;
     BITMASK_W *c_entry, *c_end, *cp;
-    int shift, rshift, i, astripes, bstripes;
+    int shift, rshift, i, astripes, bstripes, rows;
 
     /* Return if no overlap or one mask has a width/height of 0. */
     if ((xoffset >= a->w) || (yoffset >= a->h) || (yoffset <= -b->h) ||
@@ -554,13 +1080,13 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
         if (yoffset >= 0) {
             a_entry = a->bits + a->h * (xoffset / BITMASK_W_LEN) + yoffset;
             c_entry = c->bits + c->h * (xoffset / BITMASK_W_LEN) + yoffset;
-            a_end = a_entry + MIN(b->h, a->h - yoffset);
+            rows = MIN(b->h, a->h - yoffset);
             b_entry = b->bits;
         }
         else {
             a_entry = a->bits + a->h * (xoffset / BITMASK_W_LEN);
             c_entry = c->bits + c->h * (xoffset / BITMASK_W_LEN);
-            a_end = a_entry + MIN(b->h + yoffset, a->h);
+            rows = MIN(b->h + yoffset, a->h);
             b_entry = b->bits - yoffset;
         }
         shift = xoffset & BITMASK_W_MASK;
@@ -571,42 +1097,35 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp << shift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows, shift,
+                                       BITMASK_W_LEN, 1);
 
                     /* The c_entry (output mask) must advance with a_entry. */
                     a_entry += a->h;
-                    a_end += a->h;
                     c_entry += c->h;
 
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp >> rshift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows,
+                                       BITMASK_W_LEN, rshift, 1);
 
                     b_entry += b->h;
                 }
 
                 /* This is the '.. zig' to handle the remaining bits. */
-                for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                     ap++, bp++, cp++)
-                    *cp |= *ap & (*bp << shift);
+                kernels->intersect(c_entry, a_entry, b_entry, rows, shift,
+                                   BITMASK_W_LEN, 1);
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp << shift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows, shift,
+                                       BITMASK_W_LEN, 1);
 
                     /* The c_entry (output mask) must advance with a_entry. */
                     a_entry += a->h;
-                    a_end += a->h;
                     c_entry += c->h;
 
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp >> rshift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows,
+                                       BITMASK_W_LEN, rshift, 1);
 
                     b_entry += b->h;
                 }
@@ -617,13 +1136,10 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                     ap++, bp++, cp++) {
-                    *cp = *ap & *bp;
-                }
+                kernels->intersect(c_entry, a_entry, b_entry, rows, 0,
+                                   BITMASK_W_LEN, 0);
                 a_entry += a->h;
                 c_entry += c->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
         }
@@ -634,13 +1150,13 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
 
         if (yoffset >= 0) {
             b_entry = b->bits + b->h * (xoffset / BITMASK_W_LEN) + yoffset;
-            b_end = b_entry + MIN(a->h, b->h - yoffset);
+            rows = MIN(a->h, b->h - yoffset);
             a_entry = a->bits;
             c_entry = c->bits;
         }
         else {
             b_entry = b->bits + b->h * (xoffset / BITMASK_W_LEN);
-            b_end = b_entry + MIN(a->h + yoffset, b->h);
+            rows = MIN(a->h + yoffset, b->h);
             a_entry = a->bits - yoffset;
             c_entry = c->bits - yoffset;
         }
@@ -652,32 +1168,25 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp = *ap & (*bp >> shift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows,
+                                       BITMASK_W_LEN, shift, 0);
                     b_entry += b->h;
-                    b_end += b->h;
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp |= *ap & (*bp << rshift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows, rshift,
+                                       BITMASK_W_LEN, 1);
                     a_entry += a->h;
                     c_entry += c->h;
                 }
-                for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                     bp++, ap++, cp++)
-                    *cp = *ap & (*bp >> shift);
+                kernels->intersect(c_entry, a_entry, b_entry, rows,
+                                   BITMASK_W_LEN, shift, 0);
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp = *ap & (*bp >> shift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows,
+                                       BITMASK_W_LEN, shift, 0);
                     b_entry += b->h;
-                    b_end += b->h;
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp |= *ap & (*bp << rshift);
+                    kernels->intersect(c_entry, a_entry, b_entry, rows, rshift,
+                                       BITMASK_W_LEN, 1);
                     a_entry += a->h;
                     c_entry += c->h;
                 }
@@ -688,12 +1197,9 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
         {
             astripes = (MIN(a->w, b->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                     bp++, ap++, cp++) {
-                    *cp = *ap & *bp;
-                }
+                kernels->intersect(c_entry, a_entry, b_entry, rows, 0,
+                                   BITMASK_W_LEN, 0);
                 b_entry += b->h;
-                b_end += b->h;
                 a_entry += a->h;
                 c_entry += c->h;
             }
@@ -702,8 +1208,9 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
         yoffset *= -1;
     }
     /* Zero out bits outside the mask rectangle (to the right), if there
-     is a chance we were drawing there. */
-    if (xoffset + b->w > c->w) {
+     is a chance we were drawing there. A width that fills its last stripe
+     has no such bits. */
+    if (xoffset + b->w > c->w && (c->w & BITMASK_W_MASK)) {
         BITMASK_W edgemask;
         int n = c->w / BITMASK_W_LEN;
         shift = (n + 1) * BITMASK_W_LEN - c->w;
@@ -848,8 +1355,9 @@ bitmask_draw(bitmask_t *a, const bitmask_t *b, int xoffset, int yoffset)
         yoffset *= -1;
     }
     /* Zero out bits outside the mask rectangle (to the right), if there
-     is a chance we were drawing there. */
-    if (xoffset + b->w > a->w) {
+     is a chance we were drawing there. A width that fills its last stripe
+     has no such bits. */
+    if (xoffset + b->w > a->w && (a->w & BITMASK_W_MASK)) {
         BITMASK_W edgemask;
         int n = a->w / BITMASK_W_LEN;
         shift = (n + 1) * BITMASK_W_LEN - a->w;
@@ -1033,11 +1541,138 @@ bitmask_scale(const bitmask_t *m, int w, int h)
     return nm;
 }
 
+/* Convolution.
+
+   Every set bit of b draws a shifted copy of a into the output. A run of
+   L set bits in a row of b draws the same as a single copy of a dilated
+   L bits sideways, and k identical rows of b draw the same as that copy
+   dilated k rows down. So b is cut into runs, runs of equal rows are
+   merged, and each (L, k) dilation of a is drawn once per run. A dilation
+   by L takes about log2(L) shift-ORs of whole words, and runs are sorted
+   by size so that each dilation grows out of the previous one. For a solid
+   kernel this costs a few passes over a per row of b, where drawing each
+   bit cost a pass per bit of b. */
+
+/* One run of b, with the dilation it needs and where to draw it */
+typedef struct {
+    int L, k;   /* dilation width and height */
+    int dx, dy; /* position of the dilated copy of a in the output */
+} convolve_run;
+
+static int
+compare_convolve_runs(const void *p1, const void *p2)
+{
+    const convolve_run *r1 = (const convolve_run *)p1;
+    const convolve_run *r2 = (const convolve_run *)p2;
+
+    if (r1->k != r2->k)
+        return r1->k < r2->k ? -1 : 1;
+    if (r1->L != r2->L)
+        return r1->L < r2->L ? -1 : 1;
+    return 0;
+}
+
+/* m(x, y) |= m(x - s, y) for every bit, with s > 0. Going from the last
+   word to the first only ever reads words that are not yet changed. */
+static void
+bitmask_dilate_x(bitmask_t *m, int s)
+{
+    const int h = m->h;
+    const int nwords = (m->w - 1) / BITMASK_W_LEN + 1;
+    const int q = s / BITMASK_W_LEN, r = s & BITMASK_W_MASK;
+    const BITMASK_W endmask =
+        ~(BITMASK_W)0 >> ((BITMASK_W_LEN - m->w % BITMASK_W_LEN) %
+                          BITMASK_W_LEN);
+    BITMASK_W *dst, *src, *prev;
+    int k, y;
+
+    for (k = nwords - 1; k >= q; k--) {
+        dst = m->bits + k * h;
+        src = m->bits + (k - q) * h;
+        if (!r) {
+            for (y = 0; y < h; y++)
+                dst[y] |= src[y];
+        }
+        else if (k - q > 0) {
+            prev = src - h;
+            for (y = 0; y < h; y++)
+                dst[y] |= (src[y] << r) | (prev[y] >> (BITMASK_W_LEN - r));
+        }
+        else {
+            for (y = 0; y < h; y++)
+                dst[y] |= src[y] << r;
+        }
+    }
+    dst = m->bits + (nwords - 1) * h;
+    for (y = 0; y < h; y++)
+        dst[y] &= endmask;
+}
+
+/* m(x, y) |= m(x, y - s) for every bit, with s > 0 */
+static void
+bitmask_dilate_y(bitmask_t *m, int s)
+{
+    const int nwords = (m->w - 1) / BITMASK_W_LEN + 1;
+    BITMASK_W *col;
+    int k, y;
+
+    for (k = 0; k < nwords; k++) {
+        col = m->bits + k * m->h;
+        for (y = m->h - 1; y >= s; y--)
+            col[y] |= col[y - s];
+    }
+}
+
+/* Grow a dilation covering `have` bits (or rows) to one covering `want` */
+static void
+bitmask_dilate(bitmask_t *m, int have, int want, int vertical)
+{
+    int s;
+
+    while (have < want) {
+        s = have < want - have ? have : want - have;
+        if (vertical)
+            bitmask_dilate_y(m, s);
+        else
+            bitmask_dilate_x(m, s);
+        have += s;
+    }
+}
+
+/* Returns nonzero if rows y1 and y2 of m are the same */
+static int
+bitmask_rows_equal(const bitmask_t *m, int y1, int y2)
+{
+    const int nwords = (m->w - 1) / BITMASK_W_LEN + 1;
+    int k;
+
+    for (k = 0; k < nwords; k++)
+        if (m->bits[k * m->h + y1] != m->bits[k * m->h + y2])
+            return 0;
+    return 1;
+}
+
+/* Draws a into output once for every set bit of b, as the old convolve
+   did. Used when there is no memory for the dilations. */
+static void
+bitmask_convolve_bits(const bitmask_t *a, const bitmask_t *b,
+                      bitmask_t *output, int xoffset, int yoffset)
+{
+    int x, y;
+
+    for (y = 0; y < b->h; y++)
+        for (x = 0; x < b->w; x++)
+            if (bitmask_getbit(b, x, y))
+                bitmask_draw(output, a, xoffset - x, yoffset - y);
+}
+
 void
 bitmask_convolve(const bitmask_t *a, const bitmask_t *b, bitmask_t *output,
                  int xoffset, int yoffset)
 {
-    int x, y;
+    convolve_run *runs;
+    bitmask_t *dilated = NULL;
+    int nruns = 0, i, j, x, y, k, L, Lmax;
 
     if (!a->h || !a->w || !b->h || !b->w || !output->h || !output->w) {
         return;
@@ -1046,8 +1681,61 @@ bitmask_convolve(const bitmask_t *a, const bitmask_t *b, bitmask_t *output,
     xoffset += b->w - 1;
     yoffset += b->h - 1;
 
-    for (y = 0; y < b->h; y++)
-        for (x = 0; x < b->w; x++)
-            if (bitmask_getbit(b, x, y))
-                bitmask_draw(output, a, xoffset - x, yoffset - y);
+    /* a row of w bits has at most (w + 1) / 2 runs */
+    runs = (convolve_run *)malloc(sizeof(convolve_run) * b->h *
+                                  ((b->w + 1) / 2));
+    if (!runs) {
+        bitmask_convolve_bits(a, b, output, xoffset, yoffset);
+        return;
+    }
+
+    for (y = 0; y < b->h; y += k) {
+        for (k = 1; y + k < b->h && bitmask_rows_equal(b, y, y + k); k++)
+            ;
+        for (x = 0; x < b->w; x++) {
+            if (!bitmask_getbit(b, x, y))
+                continue;
+            for (L = 1; x + L < b->w && bitmask_getbit(b, x + L, y); L++)
+                ;
+            x += L;
+            runs[nruns].L = L;
+            runs[nruns].k = k;
+            runs[nruns].dx = xoffset - (x - 1);
+            runs[nruns].dy = yoffset - (y + k - 1);
+            nruns++;
+        }
+    }
+    if (nruns > 1)
+        qsort(runs, nruns, sizeof(convolve_run), compare_convolve_runs);
+
+    for (i = 0; i < nruns; i = j) {
+        k = runs[i].k;
+        Lmax = runs[i].L;
+        for (j = i + 1; j < nruns && runs[j].k == k; j++)
+            Lmax = runs[j].L;
+
+        if (k == 1 && Lmax == 1) {
+            /* single bits need no dilation */
+            for (; i < j; i++)
+                bitmask_draw(output, a, runs[i].dx, runs[i].dy);
+            continue;
+        }
+
+        dilated = bitmask_create(a->w + Lmax - 1, a->h + k - 1);
+        if (!dilated) {
+            free(runs);
+            bitmask_convolve_bits(a, b, output, xoffset, yoffset);
+            return;
+        }
+        bitmask_draw(dilated, a, 0, 0);
+        bitmask_dilate(dilated, 1, k, 1);
+        for (L = 1; i < j; i++) {
+            bitmask_dilate(dilated, L, runs[i].L, 0);
+            L = runs[i].L;
+            bitmask_draw(output, dilated, runs[i].dx, runs[i].dy);
+        }
+        bitmask_free(dilated);
+    }
+
+    free(runs);
 }
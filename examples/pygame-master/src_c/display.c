@@ -30,10 +30,18 @@
 
 #include "doc/display_doc.h"
 
+#include "region.h"
+
 #include <SDL_syswm.h>
 
 static PyTypeObject pgVidInfo_Type;
 
+/* update() with a rect list presents the whole screen once the merged
+ * rects cover this fraction of it, and counts the pixels that merging
+ * overlapping rects kept from being presented twice. */
+static double pg_update_threshold = 0.75;
+static Uint64 pg_saved_pixels = 0;
+
 
 #if IS_SDLv1
 
@@ -1576,7 +1584,10 @@ pg_update(PyObject *self, PyObject *arg)
         PyObject *seq;
         PyObject *r;
         Py_ssize_t loop, num;
-        int count;
+        pg_region region = {NULL, 0, 0};
+        pg_region_rect screen_rect;
+        Sint64 requested, presented;
+        int i, full;
         SDL_Rect *rects;
         if (PyTuple_Size(arg) != 1)
             return RAISE(
@@ -1588,14 +1599,11 @@ pg_update(PyObject *self, PyObject *arg)
                 PyExc_ValueError,
                 "update requires a rectstyle or sequence of recstyles");
 
+        screen_rect.x0 = screen_rect.y0 = 0;
+        screen_rect.x1 = wide;
+        screen_rect.y1 = high;
         num = PySequence_Length(seq);
-        rects = PyMem_New(SDL_Rect, num);
-        if (!rects)
-            return NULL;
-        count = 0;
         for (loop = 0; loop < num; ++loop) {
-            SDL_Rect *cur_rect = (rects + count);
-
             /*get rect from the sequence*/
             r = PySequence_GetItem(seq, loop);
             if (r == Py_None) {
@@ -1605,34 +1613,70 @@ pg_update(PyObject *self, PyObject *arg)
             gr = pgRect_FromObject(r, &temp);
             Py_XDECREF(r);
             if (!gr) {
-                PyMem_Free((char *)rects);
+                pg_region_clear(&region);
                 return RAISE(PyExc_ValueError,
                              "update_rects requires a single list of rects");
             }
 
-            if (gr->w < 1 && gr->h < 1)
-                continue;
-
-            /*bail out if rect not onscreen*/
-            if (!pg_screencroprect(gr, wide, high, cur_rect))
-                continue;
-
-            ++count;
+            /*offscreen parts are cropped, empty rects left out*/
+            if (pg_region_add(&region, gr->x, gr->y, (Sint64)gr->x + gr->w,
+                              (Sint64)gr->y + gr->h, &screen_rect)) {
+                pg_region_clear(&region);
+                return PyErr_NoMemory();
+            }
         }
 
-        if (count) {
+        /*present overlapping and touching rects once*/
+        requested = pg_region_area(&region);
+        if (pg_region_union(&region)) {
+            pg_region_clear(&region);
+            return PyErr_NoMemory();
+        }
+        presented = pg_region_area(&region);
+        full = presented > 0 &&
+               presented >= pg_update_threshold * ((double)wide * high);
+        if (full)
+            presented = (Sint64)wide * high;
+        if (requested > presented)
+            pg_saved_pixels += (Uint64)(requested - presented);
+
+        if (full) {
 #if IS_SDLv1
             Py_BEGIN_ALLOW_THREADS;
-            SDL_UpdateRects(screen, count, rects);
+            SDL_UpdateRect(screen, 0, 0, 0, 0);
             Py_END_ALLOW_THREADS;
 #else  /* IS_SDLv2 */
             Py_BEGIN_ALLOW_THREADS;
-            SDL_UpdateWindowSurfaceRects(win, rects, count);
+            SDL_UpdateWindowSurface(win);
             Py_END_ALLOW_THREADS;
 #endif /* IS_SDLv2 */
         }
+        else if (region.count) {
+            rects = PyMem_New(SDL_Rect, region.count);
+            if (!rects) {
+                pg_region_clear(&region);
+                return PyErr_NoMemory();
+            }
+            for (i = 0; i < region.count; ++i) {
+                pg_region_rect *cur = region.rects + i;
 
-        PyMem_Free((char *)rects);
+                rects[i].x = cur->x0;
+                rects[i].y = cur->y0;
+                rects[i].w = cur->x1 - cur->x0;
+                rects[i].h = cur->y1 - cur->y0;
+            }
+#if IS_SDLv1
+            Py_BEGIN_ALLOW_THREADS;
+            SDL_UpdateRects(screen, region.count, rects);
+            Py_END_ALLOW_THREADS;
+#else  /* IS_SDLv2 */
+            Py_BEGIN_ALLOW_THREADS;
+            SDL_UpdateWindowSurfaceRects(win, rects, region.count);
+            Py_END_ALLOW_THREADS;
+#endif /* IS_SDLv2 */
+            PyMem_Free((char *)rects);
+        }
+        pg_region_clear(&region);
     }
     Py_RETURN_NONE;
 }
@@ -2126,6 +2170,32 @@ pg_toggle_fullscreen(PyObject *self, PyObject *args)
 }
 #endif /* IS_SDLv1 */
 
+static PyObject *
+pg_set_update_threshold(PyObject *self, PyObject *arg)
+{
+    double fraction = PyFloat_AsDouble(arg);
+
+    if (fraction == -1.0 && PyErr_Occurred())
+        return NULL;
+    if (!(fraction >= 0.0 && fraction <= 1.0))
+        return RAISE(PyExc_ValueError,
+                     "threshold must be between 0.0 and 1.0");
+    pg_update_threshold = fraction;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+pg_get_update_threshold(PyObject *self, PyObject *args)
+{
+    return PyFloat_FromDouble(pg_update_threshold);
+}
+
+static PyObject *
+pg_get_saved_pixels(PyObject *self, PyObject *args)
+{
+    return PyLong_FromUnsignedLongLong(pg_saved_pixels);
+}
+
 static PyMethodDef _pg_display_methods[] = {
     {"__PYGAMEinit__", pg_display_autoinit, 1,
      "auto initialize function for display."},
@@ -2148,6 +2218,12 @@ static PyMethodDef _pg_display_methods[] = {
 
     {"flip", pg_flip, METH_NOARGS, DOC_PYGAMEDISPLAYFLIP},
     {"update", pg_update, METH_VARARGS, DOC_PYGAMEDISPLAYUPDATE},
+    {"set_update_threshold", pg_set_update_threshold, METH_O,
+     DOC_PYGAMEDISPLAYSETUPDATETHRESHOLD},
+    {"get_update_threshold", pg_get_update_threshold, METH_NOARGS,
+     DOC_PYGAMEDISPLAYGETUPDATETHRESHOLD},
+    {"get_saved_pixels", pg_get_saved_pixels, METH_NOARGS,
+     DOC_PYGAMEDISPLAYGETSAVEDPIXELS},
 
     {"set_palette", pg_set_palette, METH_VARARGS, DOC_PYGAMEDISPLAYSETPALETTE},
     {"set_gamma", pg_set_gamma, METH_VARARGS, DOC_PYGAMEDISPLAYSETGAMMA},
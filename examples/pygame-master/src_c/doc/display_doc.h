@@ -7,6 +7,9 @@
 #define DOC_PYGAMEDISPLAYGETSURFACE "get_surface() -> Surface\nGet a reference to the currently set display surface"
 #define DOC_PYGAMEDISPLAYFLIP "flip() -> None\nUpdate the full display Surface to the screen"
 #define DOC_PYGAMEDISPLAYUPDATE "update(rectangle=None) -> None\nupdate(rectangle_list) -> None\nUpdate portions of the screen for software displays"
+#define DOC_PYGAMEDISPLAYSETUPDATETHRESHOLD "set_update_threshold(fraction) -> None\nSet when update() with a rectangle list updates the whole screen"
+#define DOC_PYGAMEDISPLAYGETUPDATETHRESHOLD "get_update_threshold() -> fraction\nGet when update() with a rectangle list updates the whole screen"
+#define DOC_PYGAMEDISPLAYGETSAVEDPIXELS "get_saved_pixels() -> int\nGet the number of pixels update() did not need to send"
 #define DOC_PYGAMEDISPLAYGETDRIVER "get_driver() -> name\nGet the name of the pygame display backend"
 #define DOC_PYGAMEDISPLAYINFO "Info() -> VideoInfo\nCreate a video display information object"
 #define DOC_PYGAMEDISPLAYGETWMINFO "get_wm_info() -> dict\nGet information about the current windowing system"
@@ -63,6 +66,18 @@ pygame.display.update
  update(rectangle_list) -> None
 Update portions of the screen for software displays
 
+pygame.display.set_update_threshold
+ set_update_threshold(fraction) -> None
+Set when update() with a rectangle list updates the whole screen
+
+pygame.display.get_update_threshold
+ get_update_threshold() -> fraction
+Get when update() with a rectangle list updates the whole screen
+
+pygame.display.get_saved_pixels
+ get_saved_pixels() -> int
+Get the number of pixels update() did not need to send
+
 pygame.display.get_driver
  get_driver() -> name
 Get the name of the pygame display backend
@@ -2,6 +2,7 @@
 #define DOC_PYGAMEDRAW "pygame module for drawing shapes"
 #define DOC_PYGAMEDRAWRECT "rect(surface, color, rect) -> Rect\nrect(surface, color, rect, width=0) -> Rect\ndraw a rectangle"
 #define DOC_PYGAMEDRAWPOLYGON "polygon(surface, color, points) -> Rect\npolygon(surface, color, points, width=0) -> Rect\ndraw a polygon"
+#define DOC_PYGAMEDRAWAAPOLYGON "aapolygon(surface, color, points) -> Rect\ndraw a filled antialiased polygon"
 #define DOC_PYGAMEDRAWCIRCLE "circle(surface, color, center, radius) -> Rect\ncircle(surface, color, center, radius, width=0) -> Rect\ndraw a circle"
 #define DOC_PYGAMEDRAWELLIPSE "ellipse(surface, color, rect) -> Rect\nellipse(surface, color, rect, width=0) -> Rect\ndraw an ellipse"
 #define DOC_PYGAMEDRAWARC "arc(surface, color, rect, start_angle, stop_angle) -> Rect\narc(surface, color, rect, start_angle, stop_angle, width=1) -> Rect\ndraw an elliptical arc"
@@ -9,6 +10,7 @@
 #define DOC_PYGAMEDRAWLINES "lines(surface, color, closed, points) -> Rect\nlines(surface, color, closed, points, width=1) -> Rect\ndraw multiple contiguous straight line segments"
 #define DOC_PYGAMEDRAWAALINE "aaline(surface, color, start_pos, end_pos) -> Rect\naaline(surface, color, start_pos, end_pos, blend=1) -> Rect\ndraw a straight antialiased line"
 #define DOC_PYGAMEDRAWAALINES "aalines(surface, color, closed, points) -> Rect\naalines(surface, color, closed, points, blend=1) -> Rect\ndraw multiple contiguous straight antialiased line segments"
+#define DOC_PYGAMEDRAWBATCH "batch(surface, records, rects=False) -> Rect\nbatch(surface, records, rects=True) -> list\ndraw many primitives in one call"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -28,6 +30,10 @@ pygame.draw.polygon
  polygon(surface, color, points, width=0) -> Rect
 draw a polygon
 
+pygame.draw.aapolygon
+ aapolygon(surface, color, points) -> Rect
+draw a filled antialiased polygon
+
 pygame.draw.circle
  circle(surface, color, center, radius) -> Rect
  circle(surface, color, center, radius, width=0) -> Rect
@@ -63,4 +69,9 @@ pygame.draw.aalines
  aalines(surface, color, closed, points, blend=1) -> Rect
 draw multiple contiguous straight antialiased line segments
 
+pygame.draw.batch
+ batch(surface, records, rects=False) -> Rect
+ batch(surface, records, rects=True) -> list
+draw many primitives in one call
+
 */
\ No newline at end of file
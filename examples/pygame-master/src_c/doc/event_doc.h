@@ -2,6 +2,7 @@
 #define DOC_PYGAMEEVENT "pygame module for interacting with events and queues"
 #define DOC_PYGAMEEVENTPUMP "pump() -> None\ninternally process pygame event handlers"
 #define DOC_PYGAMEEVENTGET "get(eventtype=None) -> Eventlist\nget(eventtype=None, pump=True) -> Eventlist\nget events from the queue"
+#define DOC_PYGAMEEVENTGETINTO "get_into(buffer, pump=True) -> count\nget events from the queue into a buffer of records"
 #define DOC_PYGAMEEVENTPOLL "poll() -> EventType instance\nget a single event from the queue"
 #define DOC_PYGAMEEVENTWAIT "wait() -> EventType instance\nwait for a single event from the queue"
 #define DOC_PYGAMEEVENTPEEK "peek(eventtype=None) -> bool\npeek(eventtype=None, pump=True) -> bool\ntest if event types are waiting on the queue"
@@ -35,6 +36,10 @@ pygame.event.get
  get(eventtype=None, pump=True) -> Eventlist
 get events from the queue
 
+pygame.event.get_into
+ get_into(buffer, pump=True) -> count
+get events from the queue into a buffer of records
+
 pygame.event.poll
  poll() -> EventType instance
 get a single event from the queue
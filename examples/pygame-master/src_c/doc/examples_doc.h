@@ -25,6 +25,7 @@
 #define DOC_PYGAMEEXAMPLESCURSORSMAIN "cursors.main() -> None\ndisplay two different custom cursors"
 #define DOC_PYGAMEEXAMPLESPIXELARRAYMAIN "pixelarray.main() -> None\ndisplay various pixelarray generated effects"
 #define DOC_PYGAMEEXAMPLESSCALETESTMAIN "scaletest.main(imagefile, convert_alpha=False, run_speed_test=True) -> None\ninteractively scale an image using smoothscale"
+#define DOC_PYGAMEEXAMPLESMASKBENCHMAIN "maskbench.main(repeats=20) -> None\ntime the Mask overlap functions with each overlap backend"
 #define DOC_PYGAMEEXAMPLESMIDIMAIN "midi.main(mode='output', device_id=None) -> None\nrun a midi example"
 #define DOC_PYGAMEEXAMPLESSCROLLMAIN "scroll.main(image_file=None) -> None\nrun a Surface.scroll example that shows a magnified image"
 #define DOC_PYGAMEEXAMPLESCAMERAMAIN "camera.main() -> None\ndisplay video captured live from an attached camera"
@@ -138,6 +139,10 @@ pygame.examples.scaletest.main
  scaletest.main(imagefile, convert_alpha=False, run_speed_test=True) -> None
 interactively scale an image using smoothscale
 
+pygame.examples.maskbench.main
+ maskbench.main(repeats=20) -> None
+time the Mask overlap functions with each overlap backend
+
 pygame.examples.midi.main
  midi.main(mode='output', device_id=None) -> None
 run a midi example
@@ -7,6 +7,8 @@
 #define DOC_PYGAMEFREETYPEGETINIT "get_init() -> bool\nReturns True if the FreeType module is currently initialized."
 #define DOC_PYGAMEFREETYPEWASINIT "was_init() -> bool\nDEPRECATED: Use get_init() instead."
 #define DOC_PYGAMEFREETYPEGETCACHESIZE "get_cache_size() -> long\nReturn the glyph case size"
+#define DOC_PYGAMEFREETYPEGETCACHESTATS "get_cache_stats() -> dict\nReturn glyph cache statistics"
+#define DOC_PYGAMEFREETYPESETCACHELIMIT "set_cache_limit(limit)\nSet the glyph cache memory budget in bytes"
 #define DOC_PYGAMEFREETYPEGETDEFAULTRESOLUTION "get_default_resolution() -> long\nReturn the default pixel size in dots per inch"
 #define DOC_PYGAMEFREETYPESETDEFAULTRESOLUTION "set_default_resolution([resolution])\nSet the default pixel size in dots per inch for the module"
 #define DOC_PYGAMEFREETYPESYSFONT "SysFont(name, size, bold=False, italic=False) -> Font\ncreate a Font object from the system fonts"
@@ -49,6 +51,7 @@
 #define DOC_FONTPAD "pad -> bool\npadded boundary mode"
 #define DOC_FONTUCS4 "ucs4 -> bool\nEnable UCS-4 mode"
 #define DOC_FONTRESOLUTION "resolution -> int\nPixel resolution in dots per inch"
+#define DOC_FONTLAYOUTCACHESIZE "layout_cache_size -> int\nNumber of recent text layouts kept for reuse"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -86,6 +89,14 @@ pygame.freetype.get_cache_size
  get_cache_size() -> long
 Return the glyph case size
 
+pygame.freetype.get_cache_stats
+ get_cache_stats() -> dict
+Return glyph cache statistics
+
+pygame.freetype.set_cache_limit
+ set_cache_limit(limit)
+Set the glyph cache memory budget in bytes
+
 pygame.freetype.get_default_resolution
  get_default_resolution() -> long
 Return the default pixel size in dots per inch
@@ -256,4 +267,8 @@ pygame.freetype.Font.resolution
  resolution -> int
 Pixel resolution in dots per inch
 
+pygame.freetype.Font.layout_cache_size
+ layout_cache_size -> int
+Number of recent text layouts kept for reuse
+
 */
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define DOC_PYGAMEMASK "pygame module for image masks."
 #define DOC_PYGAMEMASKFROMSURFACE "from_surface(Surface) -> Mask\nfrom_surface(Surface, threshold=127) -> Mask\nCreates a Mask from the given surface"
 #define DOC_PYGAMEMASKFROMTHRESHOLD "from_threshold(Surface, color) -> Mask\nfrom_threshold(Surface, color, threshold=(0, 0, 0, 255), othersurface=None, palette_colors=1) -> Mask\nCreates a mask by thresholding Surfaces"
+#define DOC_PYGAMEMASKSETCACHESIZE "set_cache_size(size) -> None\nSets how many masks from_surface() keeps"
+#define DOC_PYGAMEMASKGETCACHESIZE "get_cache_size() -> int\nGets how many masks from_surface() keeps"
+#define DOC_PYGAMEMASKCLEARCACHE "clear_cache() -> None\nForgets the masks kept by from_surface()"
 #define DOC_PYGAMEMASKMASK "Mask(size=(width, height)) -> Mask\nMask(size=(width, height), fill=False) -> Mask\npygame object for representing 2D bitmasks"
 #define DOC_MASKCOPY "copy() -> Mask\nReturns a new copy of the mask"
 #define DOC_MASKGETSIZE "get_size() -> (width, height)\nReturns the size of the mask"
@@ -25,6 +28,7 @@
 #define DOC_MASKCONNECTEDCOMPONENT "connected_component() -> Mask\nconnected_component((x, y)) -> Mask\nReturns a mask containing a connected component"
 #define DOC_MASKCONNECTEDCOMPONENTS "connected_components() -> [Mask, ...]\nconnected_components(min=0) -> [Mask, ...]\nReturns a list of masks of connected components"
 #define DOC_MASKGETBOUNDINGRECTS "get_bounding_rects() -> [Rect, ...]\nReturns a list of bounding rects of connected components"
+#define DOC_MASKGETCOMPONENTSTATS "get_component_stats() -> [(area, Rect, (x, y)), ...]\nget_component_stats(min=0) -> [(area, Rect, (x, y)), ...]\nReturns the size, bounding rect and centroid of each connected component"
 #define DOC_MASKTOSURFACE "to_surface() -> Surface\nto_surface(surface=None, setcolor=(255, 255, 255, 255), unsetcolor=(0, 0, 0, 255)) -> Surface\nReturns a surface with the mask drawn on it"
 
 
@@ -45,6 +49,18 @@ pygame.mask.from_threshold
  from_threshold(Surface, color, threshold=(0, 0, 0, 255), othersurface=None, palette_colors=1) -> Mask
 Creates a mask by thresholding Surfaces
 
+pygame.mask.set_cache_size
+ set_cache_size(size) -> None
+Sets how many masks from_surface() keeps
+
+pygame.mask.get_cache_size
+ get_cache_size() -> int
+Gets how many masks from_surface() keeps
+
+pygame.mask.clear_cache
+ clear_cache() -> None
+Forgets the masks kept by from_surface()
+
 pygame.mask.Mask
  Mask(size=(width, height)) -> Mask
  Mask(size=(width, height), fill=False) -> Mask
@@ -144,6 +160,11 @@ pygame.mask.Mask.get_bounding_rects
  get_bounding_rects() -> [Rect, ...]
 Returns a list of bounding rects of connected components
 
+pygame.mask.Mask.get_component_stats
+ get_component_stats() -> [(area, Rect, (x, y)), ...]
+ get_component_stats(min=0) -> [(area, Rect, (x, y)), ...]
+Returns the size, bounding rect and centroid of each connected component
+
 pygame.mask.Mask.to_surface
  to_surface() -> Surface
  to_surface(surface=None, setcolor=(255, 255, 255, 255), unsetcolor=(0, 0, 0, 255)) -> Surface
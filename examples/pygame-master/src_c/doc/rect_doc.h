@@ -21,6 +21,10 @@
 #define DOC_RECTCOLLIDELISTALL "collidelistall(list) -> indices\ntest if all rectangles in a list intersect"
 #define DOC_RECTCOLLIDEDICT "collidedict(dict) -> (key, value)\ntest if one rectangle in a dictionary intersects"
 #define DOC_RECTCOLLIDEDICTALL "collidedictall(dict) -> [(key, value), ...]\ntest if all rectangles in a dictionary intersect"
+#define DOC_PYGAMERECTARRAY "RectArray() -> RectArray\nRectArray(rects) -> RectArray\npygame object for storing many rectangles in packed arrays"
+#define DOC_RECTARRAYAPPEND "append(Rect) -> None\nadd a rectangle to the end of the array"
+#define DOC_RECTARRAYCOLLIDERECT "colliderect(Rect) -> indices\nfind the rectangles that overlap a rectangle"
+#define DOC_RECTARRAYCOLLIDEPOINT "collidepoint(x, y) -> indices\ncollidepoint((x,y)) -> indices\nfind the rectangles that contain a point"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -118,4 +122,22 @@ pygame.Rect.collidedictall
  collidedictall(dict) -> [(key, value), ...]
 test if all rectangles in a dictionary intersect
 
+pygame.RectArray
+ RectArray() -> RectArray
+ RectArray(rects) -> RectArray
+pygame object for storing many rectangles in packed arrays
+
+pygame.RectArray.append
+ append(Rect) -> None
+add a rectangle to the end of the array
+
+pygame.RectArray.colliderect
+ colliderect(Rect) -> indices
+find the rectangles that overlap a rectangle
+
+pygame.RectArray.collidepoint
+ collidepoint(x, y) -> indices
+ collidepoint((x,y)) -> indices
+find the rectangles that contain a point
+
 */
\ No newline at end of file
@@ -4,12 +4,19 @@
 #define DOC_PYGAMETIMEWAIT "wait(milliseconds) -> time\npause the program for an amount of time"
 #define DOC_PYGAMETIMEDELAY "delay(milliseconds) -> time\npause the program for an amount of time"
 #define DOC_PYGAMETIMESETTIMER "set_timer(eventid, milliseconds) -> None\nrepeatedly create an event on the event queue"
-#define DOC_PYGAMETIMECLOCK "Clock() -> Clock\ncreate an object to help track time"
+#define DOC_PYGAMETIMECLOCK "Clock(low_power=False) -> Clock\ncreate an object to help track time"
 #define DOC_CLOCKTICK "tick(framerate=0) -> milliseconds\nupdate the clock"
 #define DOC_CLOCKTICKBUSYLOOP "tick_busy_loop(framerate=0) -> milliseconds\nupdate the clock"
 #define DOC_CLOCKGETTIME "get_time() -> milliseconds\ntime used in the previous tick"
 #define DOC_CLOCKGETRAWTIME "get_rawtime() -> milliseconds\nactual time used in the previous tick"
 #define DOC_CLOCKGETFPS "get_fps() -> float\ncompute the clock framerate"
+#define DOC_CLOCKGETFRAMETIME "get_frametime() -> float\nfractional time used in the previous tick"
+#define DOC_CLOCKGETJITTER "get_jitter(percentile=50) -> float\npercentile of the frame time error over recent ticks"
+#define DOC_PYGAMETIMEFIXEDSTEPCLOCK "FixedStepClock(rate, max_steps=5, low_power=False) -> FixedStepClock\ncreate a clock that schedules fixed simulation steps"
+#define DOC_FIXEDSTEPCLOCKTICK "tick(framerate=0) -> (steps, alpha)\nupdate the clock and get the steps due"
+#define DOC_FIXEDSTEPCLOCKTICKBUSYLOOP "tick_busy_loop(framerate=0) -> (steps, alpha)\nupdate the clock and get the steps due"
+#define DOC_FIXEDSTEPCLOCKMARKRENDER "mark_render() -> None\nmark the end of the update phase of a frame"
+#define DOC_FIXEDSTEPCLOCKGETCOUNTERS "get_counters() -> dict\nget the step and phase timing counters"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -36,7 +43,7 @@ pygame.time.set_timer
 repeatedly create an event on the event queue
 
 pygame.time.Clock
- Clock() -> Clock
+ Clock(low_power=False) -> Clock
 create an object to help track time
 
 pygame.time.Clock.tick
@@ -59,4 +66,32 @@ pygame.time.Clock.get_fps
  get_fps() -> float
 compute the clock framerate
 
+pygame.time.Clock.get_frametime
+ get_frametime() -> float
+fractional time used in the previous tick
+
+pygame.time.Clock.get_jitter
+ get_jitter(percentile=50) -> float
+percentile of the frame time error over recent ticks
+
+pygame.time.FixedStepClock
+ FixedStepClock(rate, max_steps=5, low_power=False) -> FixedStepClock
+create a clock that schedules fixed simulation steps
+
+pygame.time.FixedStepClock.tick
+ tick(framerate=0) -> (steps, alpha)
+update the clock and get the steps due
+
+pygame.time.FixedStepClock.tick_busy_loop
+ tick_busy_loop(framerate=0) -> (steps, alpha)
+update the clock and get the steps due
+
+pygame.time.FixedStepClock.mark_render
+ mark_render() -> None
+mark the end of the update phase of a frame
+
+pygame.time.FixedStepClock.get_counters
+ get_counters() -> dict
+get the step and phase timing counters
+
 */
\ No newline at end of file
@@ -2,14 +2,18 @@
 #define DOC_PYGAMETRANSFORM "pygame module to transform surfaces"
 #define DOC_PYGAMETRANSFORMFLIP "flip(Surface, xbool, ybool) -> Surface\nflip vertically and horizontally"
 #define DOC_PYGAMETRANSFORMSCALE "scale(Surface, (width, height), DestSurface = None) -> Surface\nresize to new resolution"
-#define DOC_PYGAMETRANSFORMROTATE "rotate(Surface, angle) -> Surface\nrotate an image"
-#define DOC_PYGAMETRANSFORMROTOZOOM "rotozoom(Surface, angle, scale) -> Surface\nfiltered scale and rotation"
+#define DOC_PYGAMETRANSFORMROTATE "rotate(Surface, angle, filter='nearest', dest_surface=None) -> Surface\nrotate an image"
+#define DOC_PYGAMETRANSFORMROTOZOOM "rotozoom(Surface, angle, scale, dest_surface=None) -> Surface\nfiltered scale and rotation"
 #define DOC_PYGAMETRANSFORMSCALE2X "scale2x(Surface, DestSurface = None) -> Surface\nspecialized image doubler"
 #define DOC_PYGAMETRANSFORMSMOOTHSCALE "smoothscale(Surface, (width, height), DestSurface = None) -> Surface\nscale a surface to an arbitrary size smoothly"
-#define DOC_PYGAMETRANSFORMGETSMOOTHSCALEBACKEND "get_smoothscale_backend() -> String\nreturn smoothscale filter version in use: 'GENERIC', 'MMX', or 'SSE'"
-#define DOC_PYGAMETRANSFORMSETSMOOTHSCALEBACKEND "set_smoothscale_backend(type) -> None\nset smoothscale filter version to one of: 'GENERIC', 'MMX', or 'SSE'"
+#define DOC_PYGAMETRANSFORMGETSMOOTHSCALEBACKEND "get_smoothscale_backend() -> String\nreturn smoothscale filter version in use: 'GENERIC', 'MMX', 'SSE', or 'AVX2'"
+#define DOC_PYGAMETRANSFORMSETSMOOTHSCALEBACKEND "set_smoothscale_backend(type) -> None\nset smoothscale filter version to one of: 'GENERIC', 'MMX', 'SSE', or 'AVX2'"
+#define DOC_PYGAMETRANSFORMSETCACHESIZE "set_cache_size(size) -> None\nsets how many bytes of results rotate() and rotozoom() keep"
+#define DOC_PYGAMETRANSFORMGETCACHESIZE "get_cache_size() -> int\ngets how many bytes of results rotate() and rotozoom() keep"
+#define DOC_PYGAMETRANSFORMCLEARCACHE "clear_cache() -> None\nforgets the results kept by rotate() and rotozoom()"
 #define DOC_PYGAMETRANSFORMCHOP "chop(Surface, rect) -> Surface\ngets a copy of an image with an interior area removed"
 #define DOC_PYGAMETRANSFORMLAPLACIAN "laplacian(Surface, DestSurface = None) -> Surface\nfind edges in a surface"
+#define DOC_PYGAMETRANSFORMCONVOLVE "convolve(Surface, kernel, divisor=None, offset=0, border='clamp', dest_surface=None) -> Surface\nfilter a surface with a convolution kernel"
 #define DOC_PYGAMETRANSFORMAVERAGESURFACES "average_surfaces(Surfaces, DestSurface = None, palette_colors = 1) -> Surface\nfind the average surface from many surfaces."
 #define DOC_PYGAMETRANSFORMAVERAGECOLOR "average_color(Surface, Rect = None) -> Color\nfinds the average color of a surface"
 #define DOC_PYGAMETRANSFORMTHRESHOLD "threshold(dest_surf, surf, search_color, threshold=(0,0,0,0), set_color=(0,0,0,0), set_behavior=1, search_surf=None, inverse_set=False) -> num_threshold_pixels\nfinds which, and how many pixels in a surface are within a threshold of a 'search_color' or a 'search_surf'."
@@ -31,11 +35,11 @@ pygame.transform.scale
 resize to new resolution
 
 pygame.transform.rotate
- rotate(Surface, angle) -> Surface
+ rotate(Surface, angle, filter='nearest', dest_surface=None) -> Surface
 rotate an image
 
 pygame.transform.rotozoom
- rotozoom(Surface, angle, scale) -> Surface
+ rotozoom(Surface, angle, scale, dest_surface=None) -> Surface
 filtered scale and rotation
 
 pygame.transform.scale2x
@@ -48,11 +52,23 @@ scale a surface to an arbitrary size smoothly
 
 pygame.transform.get_smoothscale_backend
  get_smoothscale_backend() -> String
-return smoothscale filter version in use: 'GENERIC', 'MMX', or 'SSE'
+return smoothscale filter version in use: 'GENERIC', 'MMX', 'SSE', or 'AVX2'
 
 pygame.transform.set_smoothscale_backend
  set_smoothscale_backend(type) -> None
-set smoothscale filter version to one of: 'GENERIC', 'MMX', or 'SSE'
+set smoothscale filter version to one of: 'GENERIC', 'MMX', 'SSE', or 'AVX2'
+
+pygame.transform.set_cache_size
+ set_cache_size(size) -> None
+sets how many bytes of results rotate() and rotozoom() keep
+
+pygame.transform.get_cache_size
+ get_cache_size() -> int
+gets how many bytes of results rotate() and rotozoom() keep
+
+pygame.transform.clear_cache
+ clear_cache() -> None
+forgets the results kept by rotate() and rotozoom()
 
 pygame.transform.chop
  chop(Surface, rect) -> Surface
@@ -62,6 +78,10 @@ pygame.transform.laplacian
  laplacian(Surface, DestSurface = None) -> Surface
 find edges in a surface
 
+pygame.transform.convolve
+ convolve(Surface, kernel, divisor=None, offset=0, border='clamp', dest_surface=None) -> Surface
+filter a surface with a convolution kernel
+
 pygame.transform.average_surfaces
  average_surfaces(Surfaces, DestSurface = None, palette_colors = 1) -> Surface
 find the average surface from many surfaces.
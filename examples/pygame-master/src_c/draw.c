@@ -29,6 +29,8 @@
 
 #include "doc/draw_doc.h"
 
+#include "polygon_fill.h"
+
 #include <math.h>
 
 #include <float.h>
@@ -66,6 +68,32 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+/* Primitive types of a draw.batch record. */
+#define BATCH_LINE 0
+#define BATCH_AALINE 1
+#define BATCH_CIRCLE 2
+#define BATCH_RECT 3
+#define BATCH_ELLIPSE 4
+
+/* One draw.batch record, eight native 32 bit ints. The coordinates are
+ * x1, y1, x2, y2 for lines, x, y, radius for circles and x, y, w, h for
+ * rects and ellipses. The color is a mapped surface color.
+ */
+typedef struct {
+    Sint32 type;
+    Sint32 a, b, c, d;
+    Uint32 color;
+    Sint32 width;
+    Sint32 reserved;
+} BatchRecord;
+
+/* State passed through the polygon filler to the span callbacks. */
+typedef struct {
+    SDL_Surface *dst;
+    Uint32 color;
+    Uint8 rgba[4];
+} FillPolyData;
+
 static int
 clip_and_draw_line(SDL_Surface *surf, SDL_Rect *rect, Uint32 color, int *pts);
 static int
@@ -95,8 +123,17 @@ draw_arc(SDL_Surface *dst, int x, int y, int radius1, int radius2,
 static void
 draw_ellipse(SDL_Surface *dst, int x, int y, int width, int height, int solid,
              Uint32 color);
-static void
+static int
 draw_fillpoly(SDL_Surface *dst, int *vx, int *vy, Py_ssize_t n, Uint32 color);
+static int
+draw_fillpoly_aa(SDL_Surface *dst, double *vx, double *vy, Py_ssize_t n,
+                 Uint32 color);
+static const char *
+batch_check(const BatchRecord *rec);
+static void
+batch_draw(SDL_Surface *surf, const BatchRecord *rec, GAME_Rect *dirty);
+static void
+batch_union(GAME_Rect *total, const GAME_Rect *area);
 
 // validation of a draw color
 #define CHECK_LOAD_COLOR(colorobj)                                         \
@@ -818,7 +855,7 @@ polygon(PyObject *self, PyObject *arg, PyObject *kwargs)
         return RAISE(PyExc_RuntimeError, "error locking surface");
     }
 
-    draw_fillpoly(surf, xlist, ylist, length, color);
+    result = draw_fillpoly(surf, xlist, ylist, length, color);
     PyMem_Del(xlist);
     PyMem_Del(ylist);
 
@@ -826,6 +863,11 @@ polygon(PyObject *self, PyObject *arg, PyObject *kwargs)
         return RAISE(PyExc_RuntimeError, "error unlocking surface");
     }
 
+    if (result) {
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory to draw polygon");
+    }
+
     left = MAX(left, surf->clip_rect.x);
     top = MAX(top, surf->clip_rect.y);
     right = MIN(right, surf->clip_rect.x + surf->clip_rect.w);
@@ -833,6 +875,235 @@ polygon(PyObject *self, PyObject *arg, PyObject *kwargs)
     return pgRect_New4(left, top, right - left + 1, bottom - top + 1);
 }
 
+/* Draws a filled antialiased polygon on the given surface.
+ *
+ * Returns a Rect bounding the drawn area.
+ */
+static PyObject *
+aapolygon(PyObject *self, PyObject *arg, PyObject *kwargs)
+{
+    PyObject *surfobj = NULL, *colorobj = NULL, *points = NULL, *item = NULL;
+    SDL_Surface *surf = NULL;
+    Uint8 rgba[4];
+    Uint32 color;
+    double *xlist = NULL, *ylist = NULL;
+    double top = DBL_MAX, left = DBL_MAX;
+    double bottom = -DBL_MAX, right = -DBL_MAX;
+    float x, y;
+    int l, t, r, b, result;
+    Py_ssize_t loop, length;
+    static char *keywords[] = {"surface", "color", "points", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OO", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &points)) {
+        return NULL; /* Exception already set. */
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    CHECK_LOAD_COLOR(colorobj)
+
+    if (!PySequence_Check(points)) {
+        return RAISE(PyExc_TypeError,
+                     "points argument must be a sequence of number pairs");
+    }
+
+    length = PySequence_Length(points);
+
+    if (length < 3) {
+        return RAISE(PyExc_ValueError,
+                     "points argument must contain more than 2 points");
+    }
+
+    xlist = PyMem_New(double, length);
+    ylist = PyMem_New(double, length);
+
+    if (NULL == xlist || NULL == ylist) {
+        PyMem_Del(xlist);
+        PyMem_Del(ylist);
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory to draw polygon");
+    }
+
+    for (loop = 0; loop < length; ++loop) {
+        item = PySequence_GetItem(points, loop);
+        result = pg_TwoFloatsFromObj(item, &x, &y);
+        Py_DECREF(item);
+
+        if (!result) {
+            PyMem_Del(xlist);
+            PyMem_Del(ylist);
+            return RAISE(PyExc_TypeError, "points must be number pairs");
+        }
+
+        xlist[loop] = x;
+        ylist[loop] = y;
+        left = MIN(x, left);
+        top = MIN(y, top);
+        right = MAX(x, right);
+        bottom = MAX(y, bottom);
+    }
+
+    if (!pgSurface_Lock(surfobj)) {
+        PyMem_Del(xlist);
+        PyMem_Del(ylist);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    result = draw_fillpoly_aa(surf, xlist, ylist, length, color);
+    PyMem_Del(xlist);
+    PyMem_Del(ylist);
+
+    if (!pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    if (result) {
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory to draw polygon");
+    }
+
+    /* Clamp in floating point, the points may be far outside the surface. */
+    l = surf->clip_rect.x;
+    t = surf->clip_rect.y;
+    r = l + surf->clip_rect.w;
+    b = t + surf->clip_rect.h;
+    left = MIN(MAX(floor(left), l), r);
+    top = MIN(MAX(floor(top), t), b);
+    right = MIN(MAX(ceil(right), l), r);
+    bottom = MIN(MAX(ceil(bottom), t), b);
+    return pgRect_New4((int)left, (int)top, (int)(right - left),
+                       (int)(bottom - top));
+}
+
+/* Draws many primitives from a buffer of records under one surface lock,
+ * with the GIL released.
+ *
+ * Returns a Rect bounding all the drawn areas, or a list of the Rects
+ * bounding each record's area.
+ */
+static PyObject *
+batch(PyObject *self, PyObject *arg, PyObject *kwargs)
+{
+    PyObject *surfobj = NULL, *recordsobj = NULL, *ret = NULL;
+    SDL_Surface *surf = NULL;
+    Py_buffer view;
+    BatchRecord rec;
+    GAME_Rect *dirty = NULL, area, total = {0, 0, 0, 0};
+    const char *error;
+    Py_ssize_t loop, count;
+    int anydraw = 0;
+    int rects = 0; /* Default: return one union rect. */
+    static char *keywords[] = {"surface", "records", "rects", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!O|i", keywords,
+                                     &pgSurface_Type, &surfobj, &recordsobj,
+                                     &rects)) {
+        return NULL; /* Exception already set. */
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    if (PyObject_GetBuffer(recordsobj, &view, PyBUF_C_CONTIGUOUS)) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (view.len % sizeof(BatchRecord)) {
+        PyBuffer_Release(&view);
+        return PyErr_Format(PyExc_ValueError,
+                            "records size must be a multiple of %d bytes",
+                            (int)sizeof(BatchRecord));
+    }
+    count = view.len / sizeof(BatchRecord);
+
+    /* Records may be unaligned, so they are copied out one at a time. */
+    for (loop = 0; loop < count; ++loop) {
+        memcpy(&rec, (char *)view.buf + loop * sizeof(BatchRecord),
+               sizeof(BatchRecord));
+        if ((error = batch_check(&rec))) {
+            PyBuffer_Release(&view);
+            return PyErr_Format(PyExc_ValueError, "record %d: %s",
+                                (int)loop, error);
+        }
+    }
+
+    if (rects) {
+        dirty = PyMem_New(GAME_Rect, count ? count : 1);
+        if (!dirty) {
+            PyBuffer_Release(&view);
+            return PyErr_NoMemory();
+        }
+    }
+
+    if (!pgSurface_Lock(surfobj)) {
+        PyBuffer_Release(&view);
+        PyMem_Del(dirty);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    for (loop = 0; loop < count; ++loop) {
+        memcpy(&rec, (char *)view.buf + loop * sizeof(BatchRecord),
+               sizeof(BatchRecord));
+        batch_draw(surf, &rec, &area);
+        if (dirty) {
+            dirty[loop] = area;
+        }
+        if (!area.w || !area.h) {
+            if (!loop) {
+                total = area;
+            }
+        }
+        else if (!anydraw) {
+            total = area;
+            anydraw = 1;
+        }
+        else {
+            batch_union(&total, &area);
+        }
+    }
+    Py_END_ALLOW_THREADS;
+
+    PyBuffer_Release(&view);
+
+    if (!pgSurface_Unlock(surfobj)) {
+        PyMem_Del(dirty);
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    if (!dirty) {
+        return pgRect_New4(total.x, total.y, total.w, total.h);
+    }
+
+    ret = PyList_New(count);
+    for (loop = 0; ret && loop < count; ++loop) {
+        PyObject *item = pgRect_New4(dirty[loop].x, dirty[loop].y,
+                                     dirty[loop].w, dirty[loop].h);
+
+        if (!item) {
+            Py_DECREF(ret);
+            ret = NULL;
+            break;
+        }
+        PyList_SET_ITEM(ret, loop, item);
+    }
+    PyMem_Del(dirty);
+    return ret;
+}
+
 static PyObject *
 rect(PyObject *self, PyObject *args, PyObject *kwargs)
 {
@@ -1862,13 +2133,19 @@ draw_ellipse(SDL_Surface *dst, int x, int y, int width, int height, int solid,
     }
 }
 
-static int
-compare_int(const void *a, const void *b)
+/* Span callback for pg_fill_polygon, fills each pair of intersections. */
+static void
+fillpoly_span(void *data, int y, const int *xs, int count)
 {
-    return (*(const int *)a) - (*(const int *)b);
+    FillPolyData *fill = (FillPolyData *)data;
+    int i;
+
+    for (i = 0; i + 1 < count; i += 2) {
+        drawhorzlineclip(fill->dst, fill->color, xs[i], y, xs[i + 1]);
+    }
 }
 
-static void
+static int
 draw_fillpoly(SDL_Surface *dst, int *point_x, int *point_y,
               Py_ssize_t num_points, Uint32 color)
 {
@@ -1878,15 +2155,7 @@ draw_fillpoly(SDL_Surface *dst, int *point_x, int *point_y,
      */
     Py_ssize_t i, i_previous;  // i_previous is the index of the point before i
     int y, miny, maxy;
-    int x1, y1;
-    int x2, y2;
-    /* x_intersect are the x-coordinates of intersections of the polygon
-     * with some horizontal line */
-    int *x_intersect = PyMem_New(int, num_points);
-    if (x_intersect == NULL) {
-        PyErr_NoMemory();
-        return;
-    }
+    FillPolyData fill;
 
     /* Determine Y maxima */
     miny = point_y[0];
@@ -1907,54 +2176,22 @@ draw_fillpoly(SDL_Surface *dst, int *point_x, int *point_y,
             maxx = MAX(maxx, point_x[i]);
         }
         drawhorzlineclip(dst, color, minx, miny, maxx);
-        PyMem_Free(x_intersect);
-        return;
+        return 0;
     }
 
     /* Draw, scanning y
      * ----------------
-     * The algorithm uses a horizontal line (y) that moves from top to the
-     * bottom of the polygon:
-     *
-     * 1. search intersections with the border lines
-     * 2. sort intersections (x_intersect)
-     * 3. each two x-coordinates in x_intersect are then inside the polygon
-     *    (drawhorzlineclip for a pair of two such points)
+     * pg_fill_polygon moves a horizontal line from the top to the bottom of
+     * the polygon, keeping the intersections with the border lines sorted,
+     * and each two x-coordinates are then inside the polygon. Only the
+     * scanlines inside the clip rect are visited.
      */
-    for (y = miny; (y <= maxy); y++) {
-        // n_intersections is the number of intersections with the polygon
-        int n_intersections = 0;
-        for (i = 0; (i < num_points); i++) {
-            i_previous = ((i) ? (i - 1) : (num_points - 1));
-
-            y1 = point_y[i_previous];
-            y2 = point_y[i];
-            if (y1 < y2) {
-                x1 = point_x[i_previous];
-                x2 = point_x[i];
-            }
-            else if (y1 > y2) {
-                y2 = point_y[i_previous];
-                y1 = point_y[i];
-                x2 = point_x[i_previous];
-                x1 = point_x[i];
-            }
-            else {  // y1 == y2 : has to be handled as special case (below)
-                continue;
-            }
-            if (((y >= y1) && (y < y2)) || ((y == maxy) && (y2 == maxy))) {
-                // add intersection if y crosses the edge (excluding the lower
-                // end), or when we are on the lowest line (maxy)
-                x_intersect[n_intersections++] =
-                    (y - y1) * (x2 - x1) / (y2 - y1) + x1;
-            }
-        }
-        qsort(x_intersect, n_intersections, sizeof(int), compare_int);
-
-        for (i = 0; (i < n_intersections); i += 2) {
-            drawhorzlineclip(dst, color, x_intersect[i], y,
-                             x_intersect[i + 1]);
-        }
+    fill.dst = dst;
+    fill.color = color;
+    if (pg_fill_polygon(point_x, point_y, (int)num_points, dst->clip_rect.y,
+                        dst->clip_rect.y + dst->clip_rect.h - 1, PG_POLY_INT,
+                        fillpoly_span, &fill)) {
+        return -1;
     }
 
     /* Finally, a special case is not handled by above algorithm:
@@ -1974,7 +2211,240 @@ draw_fillpoly(SDL_Surface *dst, int *point_x, int *point_y,
             drawhorzlineclip(dst, color, point_x[i], y, point_x[i_previous]);
         }
     }
-    PyMem_Free(x_intersect);
+    return 0;
+}
+
+/* Coverage callback for pg_fill_polygon_aa, blends the color into each
+ * pixel by the fraction of it the polygon covers.
+ */
+static void
+fillpoly_aa_cover(void *data, int y, int x, const float *cover, int count)
+{
+    FillPolyData *fill = (FillPolyData *)data;
+    SDL_Surface *surf = fill->dst;
+    int bpp = surf->format->BytesPerPixel;
+    Uint8 *pixel = (Uint8 *)surf->pixels + y * surf->pitch + x * bpp;
+    int i;
+
+    for (i = 0; i < count; i++, pixel += bpp) {
+        if (cover[i] >= 1.0f) {
+            set_pixel_32(pixel, surf->format, fill->color);
+        }
+        else if (cover[i] > 0.0f) {
+            draw_pixel_blended_32(pixel, fill->rgba, cover[i], surf->format);
+        }
+    }
+}
+
+static int
+draw_fillpoly_aa(SDL_Surface *dst, double *point_x, double *point_y,
+                 Py_ssize_t num_points, Uint32 color)
+{
+    FillPolyData fill;
+
+    fill.dst = dst;
+    fill.color = color;
+    SDL_GetRGBA(color, dst->format, &fill.rgba[0], &fill.rgba[1],
+                &fill.rgba[2], &fill.rgba[3]);
+    return pg_fill_polygon_aa(point_x, point_y, (int)num_points,
+                              &dst->clip_rect, fillpoly_aa_cover, &fill);
+}
+
+/* Returns why a draw.batch record cannot be drawn, or NULL if it can. */
+static const char *
+batch_check(const BatchRecord *rec)
+{
+    switch (rec->type) {
+        case BATCH_LINE:
+        case BATCH_AALINE:
+            return NULL;
+        case BATCH_CIRCLE:
+            if (rec->c < 0) {
+                return "negative radius";
+            }
+            if (rec->width < 0) {
+                return "negative width";
+            }
+            if (rec->width > rec->c) {
+                return "width greater than radius";
+            }
+            return NULL;
+        case BATCH_RECT:
+            if (rec->c < 0 || rec->d < 0) {
+                return "negative size";
+            }
+            return NULL;
+        case BATCH_ELLIPSE:
+            if (rec->c < 0 || rec->d < 0) {
+                return "negative size";
+            }
+            if (rec->width < 0) {
+                return "negative width";
+            }
+            if (rec->width > rec->c / 2 || rec->width > rec->d / 2) {
+                return "width greater than ellipse radius";
+            }
+            return NULL;
+    }
+    return "unknown primitive type";
+}
+
+/* Grows total, which may be empty, to also bound area. */
+static void
+batch_union(GAME_Rect *total, const GAME_Rect *area)
+{
+    int l, t, r, b;
+
+    if (!total->w || !total->h) {
+        *total = *area;
+        return;
+    }
+    l = MIN(total->x, area->x);
+    t = MIN(total->y, area->y);
+    r = MAX(total->x + total->w, area->x + area->w);
+    b = MAX(total->y + total->h, area->y + area->h);
+    total->x = l;
+    total->y = t;
+    total->w = r - l;
+    total->h = b - t;
+}
+
+/* Draws one draw.batch record, the surface must be locked. Sets dirty to
+ * the area changed, the same rect the single primitive function returns.
+ * Does not touch any Python objects, so it can run without the GIL.
+ */
+static void
+batch_draw(SDL_Surface *surf, const BatchRecord *rec, GAME_Rect *dirty)
+{
+    SDL_Rect *clip = &surf->clip_rect;
+    GAME_Rect side;
+    int pts[4];
+    float fpts[4];
+    int l, t, r, b, loop;
+
+    dirty->x = rec->a;
+    dirty->y = rec->b;
+    dirty->w = 0;
+    dirty->h = 0;
+
+    /* The buffer is shared, it may have changed since it was checked. */
+    if (batch_check(rec)) {
+        return;
+    }
+
+    switch (rec->type) {
+        case BATCH_LINE:
+            if (rec->width < 1) {
+                return;
+            }
+            pts[0] = rec->a;
+            pts[1] = rec->b;
+            pts[2] = rec->c;
+            pts[3] = rec->d;
+            if (clip_and_draw_line_width(surf, clip, rec->color, rec->width,
+                                         pts)) {
+                dirty->x = pts[0];
+                dirty->y = pts[1];
+                dirty->w = pts[2] - pts[0] + 1;
+                dirty->h = pts[3] - pts[1] + 1;
+            }
+            return;
+
+        case BATCH_AALINE:
+            fpts[0] = (float)rec->a;
+            fpts[1] = (float)rec->b;
+            fpts[2] = (float)rec->c;
+            fpts[3] = (float)rec->d;
+            if (clip_and_draw_aaline(surf, clip, rec->color, fpts,
+                                     rec->width)) {
+                l = (int)MIN(fpts[0], fpts[2]);
+                t = (int)MIN(fpts[1], fpts[3]);
+                r = (int)MAX(fpts[0], fpts[2]);
+                b = (int)MAX(fpts[1], fpts[3]);
+                dirty->x = l;
+                dirty->y = t;
+                dirty->w = r - l + 2;
+                dirty->h = b - t + 2;
+            }
+            return;
+
+        case BATCH_CIRCLE:
+            if (!rec->width) {
+                draw_ellipse(surf, rec->a, rec->b, rec->c * 2, rec->c * 2, 1,
+                             rec->color);
+            }
+            for (loop = 0; loop < rec->width; ++loop) {
+                draw_ellipse(surf, rec->a, rec->b, 2 * (rec->c - loop),
+                             2 * (rec->c - loop), 0, rec->color);
+                draw_ellipse(surf, rec->a + 1, rec->b, 2 * (rec->c - loop),
+                             2 * (rec->c - loop), 0, rec->color);
+            }
+            l = MAX(rec->a - rec->c, clip->x);
+            t = MAX(rec->b - rec->c, clip->y);
+            r = MIN(rec->a + rec->c, clip->x + clip->w);
+            b = MIN(rec->b + rec->c, clip->y + clip->h);
+            break;
+
+        case BATCH_ELLIPSE:
+            if (!rec->width) {
+                draw_ellipse(surf, rec->a + rec->c / 2, rec->b + rec->d / 2,
+                             rec->c, rec->d, 1, rec->color);
+            }
+            for (loop = 0; loop < rec->width; ++loop) {
+                draw_ellipse(surf, rec->a + rec->c / 2, rec->b + rec->d / 2,
+                             rec->c - loop, rec->d - loop, 0, rec->color);
+            }
+            l = MAX(rec->a, clip->x);
+            t = MAX(rec->b, clip->y);
+            r = MIN(rec->a + rec->c, clip->x + clip->w);
+            b = MIN(rec->b + rec->d, clip->y + clip->h);
+            break;
+
+        case BATCH_RECT:
+            if (!rec->c || !rec->d || rec->width < 0) {
+                return;
+            }
+            if (rec->width) {
+                /* The outline is drawn like draw.lines with closed set. */
+                int xs[4], ys[4];
+
+                xs[0] = xs[3] = rec->a;
+                xs[1] = xs[2] = rec->a + rec->c - 1;
+                ys[0] = ys[1] = rec->b;
+                ys[2] = ys[3] = rec->b + rec->d - 1;
+                for (loop = 0; loop < 4; ++loop) {
+                    pts[0] = xs[loop];
+                    pts[1] = ys[loop];
+                    pts[2] = xs[(loop + 1) % 4];
+                    pts[3] = ys[(loop + 1) % 4];
+                    if (clip_and_draw_line_width(surf, clip, rec->color,
+                                                 rec->width, pts)) {
+                        side.x = pts[0];
+                        side.y = pts[1];
+                        side.w = pts[2] - pts[0] + 1;
+                        side.h = pts[3] - pts[1] + 1;
+                        batch_union(dirty, &side);
+                    }
+                }
+                return;
+            }
+            l = MAX(rec->a, clip->x);
+            t = MAX(rec->b, clip->y);
+            r = MIN(rec->a + rec->c, clip->x + clip->w);
+            b = MIN(rec->b + rec->d, clip->y + clip->h);
+            for (loop = t; loop < b && l < r; ++loop) {
+                drawhorzline(surf, rec->color, l, loop, r - 1);
+            }
+            break;
+
+        default:
+            return;
+    }
+
+    dirty->x = l;
+    dirty->y = t;
+    dirty->w = MAX(r - l, 0);
+    dirty->h = MAX(b - t, 0);
 }
 
 static PyMethodDef _draw_methods[] = {
@@ -1993,13 +2463,19 @@ static PyMethodDef _draw_methods[] = {
      DOC_PYGAMEDRAWCIRCLE},
     {"polygon", (PyCFunction)polygon, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMEDRAWPOLYGON},
+    {"aapolygon", (PyCFunction)aapolygon, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWAAPOLYGON},
     {"rect", (PyCFunction)rect, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMEDRAWRECT},
+    {"batch", (PyCFunction)batch, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWBATCH},
 
     {NULL, NULL, 0, NULL}};
 
 MODINIT_DEFINE(draw)
 {
+    PyObject *module;
+
 #if PY3
     static struct PyModuleDef _module = {PyModuleDef_HEAD_INIT,
                                          "draw",
@@ -2034,8 +2510,22 @@ MODINIT_DEFINE(draw)
 
 /* create the module */
 #if PY3
-    return PyModule_Create(&_module);
+    module = PyModule_Create(&_module);
 #else
-    Py_InitModule3(MODPREFIX "draw", _draw_methods, DOC_PYGAMEDRAW);
+    module = Py_InitModule3(MODPREFIX "draw", _draw_methods, DOC_PYGAMEDRAW);
 #endif
+    if (module == NULL) {
+        MODINIT_ERROR;
+    }
+
+    /* draw.batch record types */
+    if (PyModule_AddIntConstant(module, "BATCH_LINE", BATCH_LINE) ||
+        PyModule_AddIntConstant(module, "BATCH_AALINE", BATCH_AALINE) ||
+        PyModule_AddIntConstant(module, "BATCH_CIRCLE", BATCH_CIRCLE) ||
+        PyModule_AddIntConstant(module, "BATCH_RECT", BATCH_RECT) ||
+        PyModule_AddIntConstant(module, "BATCH_ELLIPSE", BATCH_ELLIPSE)) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+    MODINIT_RETURN(module);
 }
@@ -470,6 +470,40 @@ _pg_our_empty_ustr(void)
 
 #endif /* Py_USING_UNICODE */
 
+#if IS_SDLv2
+/* The gain and state of an ACTIVEEVENT made from a window event */
+static void
+_pg_active_gain_state(SDL_Event *event, long *gain, long *state)
+{
+    switch (event->window.event) {
+        case SDL_WINDOWEVENT_ENTER:
+            *gain = 1;
+            *state = (long)SDL_APPFOCUSMOUSE;
+            break;
+        case SDL_WINDOWEVENT_LEAVE:
+            *gain = 0;
+            *state = (long)SDL_APPFOCUSMOUSE;
+            break;
+        case SDL_WINDOWEVENT_FOCUS_GAINED:
+            *gain = 1;
+            *state = (long)SDL_APPINPUTFOCUS;
+            break;
+        case SDL_WINDOWEVENT_FOCUS_LOST:
+            *gain = 0;
+            *state = (long)SDL_APPINPUTFOCUS;
+            break;
+        case SDL_WINDOWEVENT_MINIMIZED:
+            *gain = 0;
+            *state = (long)SDL_APPACTIVE;
+            break;
+        default:
+            assert(event->window.event == SDL_WINDOWEVENT_RESTORED);
+            *gain = 1;
+            *state = (long)SDL_APPACTIVE;
+    }
+}
+#endif /* IS_SDLv2 */
+
 static PyObject *
 dict_from_event(SDL_Event *event)
 {
@@ -516,32 +550,7 @@ dict_from_event(SDL_Event *event)
             }
             break;
         case SDL_ACTIVEEVENT:
-            switch (event->window.event) {
-                case SDL_WINDOWEVENT_ENTER:
-                    gain = 1;
-                    state = (long)SDL_APPFOCUSMOUSE;
-                    break;
-                case SDL_WINDOWEVENT_LEAVE:
-                    gain = 0;
-                    state = (long)SDL_APPFOCUSMOUSE;
-                    break;
-                case SDL_WINDOWEVENT_FOCUS_GAINED:
-                    gain = 1;
-                    state = (long)SDL_APPINPUTFOCUS;
-                    break;
-                case SDL_WINDOWEVENT_FOCUS_LOST:
-                    gain = 0;
-                    state = (long)SDL_APPINPUTFOCUS;
-                    break;
-                case SDL_WINDOWEVENT_MINIMIZED:
-                    gain = 0;
-                    state = (long)SDL_APPACTIVE;
-                    break;
-                default:
-                    assert(event->window.event == SDL_WINDOWEVENT_RESTORED);
-                    gain = 1;
-                    state = (long)SDL_APPACTIVE;
-            }
+            _pg_active_gain_state(event, &gain, &state);
             _pg_insobj(dict, "gain", PyInt_FromLong(gain));
             _pg_insobj(dict, "state", PyInt_FromLong(state));
             break;
@@ -1453,6 +1462,284 @@ pg_event_get(PyObject *self, PyObject *args, PyObject *kwargs)
 }
 #endif /* IS_SDLv2 */
 
+/* Layout of the records written by get_into(): EVREC_FIELDS native
+ * 32 bit ints per event. */
+#define EVREC_TYPE 0
+#define EVREC_TIMESTAMP 1
+#define EVREC_X 2
+#define EVREC_Y 3
+#define EVREC_RELX 4
+#define EVREC_RELY 5
+#define EVREC_BUTTON 6
+#define EVREC_KEY 7
+#define EVREC_MOD 8
+#define EVREC_WHICH 9
+#define EVREC_FIELDS 10
+
+#if IS_SDLv2
+/* The first code point of a UTF-8 string, or 0 */
+static Sint32
+_pg_utf8_first(const char *text)
+{
+    const unsigned char *u = (const unsigned char *)text;
+
+    if (u[0] < 0x80)
+        return u[0];
+    if ((u[0] & 0xE0) == 0xC0 && u[1])
+        return ((u[0] & 0x1F) << 6) | (u[1] & 0x3F);
+    if ((u[0] & 0xF0) == 0xE0 && u[1] && u[2])
+        return ((u[0] & 0x0F) << 12) | ((u[1] & 0x3F) << 6) | (u[2] & 0x3F);
+    if ((u[0] & 0xF8) == 0xF0 && u[1] && u[2] && u[3])
+        return ((u[0] & 0x07) << 18) | ((u[1] & 0x3F) << 12) |
+               ((u[2] & 0x3F) << 6) | (u[3] & 0x3F);
+    return 0;
+}
+
+/* The code point of a UTF-8 string of exactly one code point, or 0 */
+static Sint32
+_pg_utf8_single(const char *text)
+{
+    Sint32 ch = _pg_utf8_first(text);
+    size_t size = ch < 0x80 ? 1 : ch < 0x800 ? 2 : ch < 0x10000 ? 3 : 4;
+
+    return ch && text[size] == '\0' ? ch : 0;
+}
+#endif /* IS_SDLv2 */
+
+static PG_INLINE int
+_pg_event_is_posted(SDL_Event *event)
+{
+    return event->user.code == USEROBJECT_CHECK1 &&
+           event->user.data1 == (void *)USEROBJECT_CHECK2;
+}
+
+/* Fill rec with the fields of event. Events with no fields of their own
+ * get a record of just the type and timestamp. Returns 0 for events whose
+ * data does not fit a record: posted events with attributes, text longer
+ * than one code point and dropped files or text. */
+static int
+_pg_event_record(SDL_Event *event, Sint32 *rec)
+{
+    UserEventObject *hunt;
+#if IS_SDLv2
+    long gain, state;
+#endif /* IS_SDLv2 */
+
+    memset(rec, 0, sizeof(Sint32) * EVREC_FIELDS);
+    rec[EVREC_TYPE] = event->type;
+#if IS_SDLv1
+    rec[EVREC_TIMESTAMP] = (Sint32)SDL_GetTicks();
+#else  /* IS_SDLv2 */
+    rec[EVREC_TIMESTAMP] = (Sint32)event->common.timestamp;
+#endif /* IS_SDLv2 */
+
+    if (_pg_event_is_posted(event)) {
+        /* only an Event without attributes fits */
+        hunt = user_event_objects;
+        while (hunt && hunt != (UserEventObject *)event->user.data2)
+            hunt = hunt->next;
+        return hunt && PyDict_Check(hunt->object) &&
+               PyDict_Size(hunt->object) == 0;
+    }
+    if (event->type >= SDL_USEREVENT && event->type < SDL_NUMEVENTS) {
+        if (event->type == SDL_USEREVENT && event->user.code == 0x1000)
+            return 0; /* a dropped file name */
+        rec[EVREC_X] = event->user.code;
+        return 1;
+    }
+
+    switch (event->type) {
+        case SDL_QUIT:
+        case SDL_VIDEOEXPOSE:
+            break;
+        case SDL_ACTIVEEVENT:
+#if IS_SDLv1
+            rec[EVREC_X] = event->active.gain;
+            rec[EVREC_Y] = event->active.state;
+#else  /* IS_SDLv2 */
+            _pg_active_gain_state(event, &gain, &state);
+            rec[EVREC_X] = gain;
+            rec[EVREC_Y] = state;
+#endif /* IS_SDLv2 */
+            break;
+        case SDL_KEYDOWN:
+#if IS_SDLv1
+            rec[EVREC_Y] = event->key.keysym.unicode;
+#else  /* IS_SDLv2 */
+            rec[EVREC_Y] = _pg_utf8_first(_pg_last_unicode_char);
+#endif /* IS_SDLv2 */
+            /* fall through */
+        case SDL_KEYUP:
+            rec[EVREC_X] = event->key.keysym.scancode;
+            rec[EVREC_KEY] = event->key.keysym.sym;
+            rec[EVREC_MOD] = event->key.keysym.mod;
+            break;
+        case SDL_MOUSEMOTION:
+            rec[EVREC_X] = event->motion.x;
+            rec[EVREC_Y] = event->motion.y;
+            rec[EVREC_RELX] = event->motion.xrel;
+            rec[EVREC_RELY] = event->motion.yrel;
+            rec[EVREC_BUTTON] = event->motion.state;
+            rec[EVREC_WHICH] = event->motion.which;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            rec[EVREC_X] = event->button.x;
+            rec[EVREC_Y] = event->button.y;
+            rec[EVREC_BUTTON] = event->button.button;
+            rec[EVREC_WHICH] = event->button.which;
+            break;
+        case SDL_JOYAXISMOTION:
+            rec[EVREC_X] = event->jaxis.value;
+            rec[EVREC_BUTTON] = event->jaxis.axis;
+            rec[EVREC_WHICH] = event->jaxis.which;
+            break;
+        case SDL_JOYBALLMOTION:
+            rec[EVREC_RELX] = event->jball.xrel;
+            rec[EVREC_RELY] = event->jball.yrel;
+            rec[EVREC_BUTTON] = event->jball.ball;
+            rec[EVREC_WHICH] = event->jball.which;
+            break;
+        case SDL_JOYHATMOTION:
+            if (event->jhat.value & SDL_HAT_UP)
+                rec[EVREC_Y] = 1;
+            else if (event->jhat.value & SDL_HAT_DOWN)
+                rec[EVREC_Y] = -1;
+            if (event->jhat.value & SDL_HAT_RIGHT)
+                rec[EVREC_X] = 1;
+            else if (event->jhat.value & SDL_HAT_LEFT)
+                rec[EVREC_X] = -1;
+            rec[EVREC_BUTTON] = event->jhat.hat;
+            rec[EVREC_WHICH] = event->jhat.which;
+            break;
+        case SDL_JOYBUTTONUP:
+        case SDL_JOYBUTTONDOWN:
+            rec[EVREC_BUTTON] = event->jbutton.button;
+            rec[EVREC_WHICH] = event->jbutton.which;
+            break;
+#if IS_SDLv1
+        case SDL_VIDEORESIZE:
+            rec[EVREC_X] = event->resize.w;
+            rec[EVREC_Y] = event->resize.h;
+            break;
+#else  /* IS_SDLv2 */
+        case SDL_VIDEORESIZE:
+            rec[EVREC_X] = event->window.data1;
+            rec[EVREC_Y] = event->window.data2;
+            break;
+        case SDL_WINDOWEVENT:
+            rec[EVREC_X] = event->window.event;
+            break;
+        case SDL_TEXTINPUT:
+            /* one per key press while typing, so it has to fit */
+            rec[EVREC_X] = _pg_utf8_single(event->text.text);
+            return rec[EVREC_X] != 0;
+        case SDL_TEXTEDITING:
+        case SDL_DROPFILE:
+#ifdef SDL_DROPTEXT
+        case SDL_DROPTEXT:
+#endif
+            return 0;
+        case SDL_MOUSEWHEEL:
+            rec[EVREC_X] = event->wheel.x;
+            rec[EVREC_Y] = event->wheel.y;
+            rec[EVREC_BUTTON] =
+                event->wheel.direction == SDL_MOUSEWHEEL_FLIPPED;
+            rec[EVREC_WHICH] = event->wheel.which;
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            rec[EVREC_X] = event->caxis.value;
+            rec[EVREC_BUTTON] = event->caxis.axis;
+            rec[EVREC_WHICH] = event->caxis.which;
+            break;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            rec[EVREC_BUTTON] = event->cbutton.button;
+            rec[EVREC_WHICH] = event->cbutton.which;
+            break;
+        case SDL_CONTROLLERDEVICEADDED:
+        case SDL_CONTROLLERDEVICEREMOVED:
+        case SDL_CONTROLLERDEVICEREMAPPED:
+            rec[EVREC_WHICH] = event->cdevice.which;
+            break;
+        case SDL_JOYDEVICEADDED:
+        case SDL_JOYDEVICEREMOVED:
+            rec[EVREC_WHICH] = event->jdevice.which;
+            break;
+#endif /* IS_SDLv2 */
+        default:
+            break;
+    }
+    return 1;
+}
+
+static PG_INLINE int
+_pg_event_next(SDL_Event *event, int action)
+{
+#if IS_SDLv1
+    return SDL_PeepEvents(event, 1, action, SDL_ALLEVENTS);
+#else  /* IS_SDLv2 */
+    return SDL_PeepEvents(event, 1, action, SDL_FIRSTEVENT, SDL_LASTEVENT);
+#endif /* IS_SDLv2 */
+}
+
+static PyObject *
+pg_event_get_into(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    SDL_Event event;
+    Sint32 rec[EVREC_FIELDS];
+    PyObject *buffer;
+    pg_buffer pg_view;
+    Py_buffer *view_p = (Py_buffer *)&pg_view;
+    Py_ssize_t count = 0, capacity;
+    char *dst;
+    int dopump = 1;
+
+    static char *kwids[] = {
+        "buffer",
+        "pump",
+        NULL
+    };
+
+#if PY3
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", kwids,
+                                     &buffer, &dopump))
+        return NULL;
+#else
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", kwids,
+                                     &buffer, &dopump))
+        return NULL;
+#endif
+
+    VIDEO_INIT_CHECK();
+
+    if (pgObject_GetBuffer(buffer, &pg_view, PyBUF_WRITABLE))
+        return NULL;
+    capacity = view_p->len / (Py_ssize_t)sizeof(rec);
+    dst = (char *)view_p->buf;
+
+    if (dopump)
+        SDL_PumpEvents();
+
+    /* Stop before an event that does not fit a record, leaving it at the
+     * head of the queue for get() or poll(), so no event is lost and the
+     * order is kept. */
+    while (count < capacity && _pg_event_next(&event, SDL_PEEKEVENT) == 1) {
+        if (!_pg_event_record(&event, rec))
+            break;
+        _pg_event_next(&event, SDL_GETEVENT);
+        if (_pg_event_is_posted(&event)) {
+            Py_XDECREF(_pg_user_pg_event_getobject(
+                (UserEventObject *)event.user.data2));
+        }
+        memcpy(dst + count * sizeof(rec), rec, sizeof(rec));
+        ++count;
+    }
+
+    pgBuffer_Release(&pg_view);
+    return PyInt_FromSsize_t(count);
+}
+
 #if IS_SDLv1
 static PyObject *
 pg_event_peek(PyObject *self, PyObject *args, PyObject *kwargs)
@@ -1765,6 +2052,8 @@ static PyMethodDef _event_methods[] = {
     {"poll", pg_event_poll, METH_NOARGS, DOC_PYGAMEEVENTPOLL},
     {"clear", (PyCFunction)pg_event_clear, METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEEVENTCLEAR},
     {"get", (PyCFunction)pg_event_get, METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEEVENTGET},
+    {"get_into", (PyCFunction)pg_event_get_into,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEEVENTGETINTO},
     {"peek", (PyCFunction)pg_event_peek, METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEEVENTPEEK},
     {"post", pg_event_post, METH_VARARGS, DOC_PYGAMEEVENTPOST},
 
@@ -31,6 +31,7 @@ typedef struct keyfields_ {
     unsigned short render_flags;
     unsigned short rotation;
     FT_Fixed strength;
+    FT_Matrix transform;
 } KeyFields;
 
 typedef union cachenodekey_ {
@@ -41,6 +42,10 @@ typedef union cachenodekey_ {
 typedef struct cachenode_ {
     FontGlyph glyph;
     struct cachenode_ *next;
+    struct cachenode_ *lru_prev;
+    struct cachenode_ *lru_next;
+    FontCache *face;
+    size_t bytes;
     NodeKey key;
     FT_UInt32 hash;
 } CacheNode;
@@ -50,6 +55,11 @@ static CacheNode *allocate_node(FontCache *,
                                 const FontRenderMode *,
                                 GlyphIndex_t, void *);
 static void free_node(FontCache *, CacheNode *);
+static void unlink_node(FontCache *, CacheNode *);
+static void evict_to_limit(GlyphCache *);
+static void lru_remove(GlyphCache *, CacheNode *);
+static void lru_push(GlyphCache *, CacheNode *);
+static int grow_table(FontCache *);
 static void set_node_key(NodeKey *, GlyphIndex_t, const FontRenderMode *);
 static int equal_node_keys(const NodeKey *, const NodeKey *);
 
@@ -57,6 +67,9 @@ const int render_flags_mask = (FT_RFLAG_ANTIALIAS |
                                FT_RFLAG_HINTED |
                                FT_RFLAG_AUTOHINT);
 
+/* Grow a face's hash table once it holds this many glyphs per bucket */
+#define MAX_BUCKET_LOAD 2
+
 static void
 set_node_key(NodeKey *key, GlyphIndex_t id, const FontRenderMode *mode)
 {
@@ -72,6 +85,9 @@ set_node_key(NodeKey *key, GlyphIndex_t id, const FontRenderMode *mode)
     fields->render_flags = mode->render_flags & rflag_mask;
     fields->rotation = rot;
     fields->strength = mode->strength;
+    if (mode->render_flags & FT_RFLAG_TRANSFORM) {
+        fields->transform = mode->transform;
+    }
 }
 
 static int
@@ -127,55 +143,97 @@ get_hash(const NodeKey *key)
     return h1;
 }
 
-int
-_PGFT_Cache_Init(FreeTypeInstance *ft, FontCache *cache)
+void
+_PGFT_GlyphCache_Init(GlyphCache *glyph_cache, int cache_size, size_t limit)
 {
-    int cache_size = MAX(ft->cache_size - 1, PGFT_MIN_CACHE_SIZE - 1);
-    int i;
+    FT_UInt32 buckets = (FT_UInt32)MAX(cache_size - 1,
+                                       PGFT_MIN_CACHE_SIZE - 1);
 
     /*
      * Make sure this is a power of 2.
      */
-    cache_size = cache_size | (cache_size >> 1);
-    cache_size = cache_size | (cache_size >> 2);
-    cache_size = cache_size | (cache_size >> 4);
-    cache_size = cache_size | (cache_size >> 8);
-    cache_size = cache_size | (cache_size >>16);
+    buckets = buckets | (buckets >> 1);
+    buckets = buckets | (buckets >> 2);
+    buckets = buckets | (buckets >> 4);
+    buckets = buckets | (buckets >> 8);
+    buckets = buckets | (buckets >>16);
+
+    memset(glyph_cache, 0, sizeof(GlyphCache));
+    glyph_cache->min_buckets = buckets + 1;
+    glyph_cache->limit = limit ? limit : PGFT_DEFAULT_CACHE_LIMIT;
+}
 
-    cache_size = cache_size + 1;
+void
+_PGFT_GlyphCache_SetLimit(GlyphCache *glyph_cache, size_t limit)
+{
+    glyph_cache->limit = limit ? limit : PGFT_DEFAULT_CACHE_LIMIT;
+    evict_to_limit(glyph_cache);
+}
 
-    cache->nodes = _PGFT_malloc((size_t)cache_size * sizeof(FontGlyph *));
-    if (!cache->nodes)
-        return -1;
-    for (i=0; i < cache_size; ++i)
-        cache->nodes[i] = 0;
-    cache->depths = _PGFT_malloc((size_t)cache_size);
-    if (!cache->depths) {
-        _PGFT_free(cache->nodes);
-        cache->nodes = 0;
-        return -1;
+FontCache *
+_PGFT_Cache_Acquire(FreeTypeInstance *ft, pgFontObject *fontobj)
+{
+    GlyphCache *glyph_cache = &ft->glyph_cache;
+    const char *path = 0;
+    FontCache *cache;
+    size_t path_len;
+    FT_UInt32 i;
+
+    if (fontobj->id.open_args.flags == FT_OPEN_PATHNAME) {
+        path = fontobj->id.open_args.pathname;
+        for (cache = glyph_cache->faces; cache; cache = cache->next) {
+            if (cache->path && !strcmp(cache->path, path) &&
+                cache->font_index == fontobj->id.font_index &&
+                cache->resolution == fontobj->resolution) {
+                cache->ref_count++;
+                return cache;
+            }
+        }
     }
-    memset(cache->depths, 0, cache_size);
-    cache->free_nodes = 0;
-    cache->size_mask = (FT_UInt32)(cache_size - 1);
 
-#ifdef PGFT_DEBUG_CACHE
-    cache->_debug_count = 0;
-    cache->_debug_delete_count = 0;
-    cache->_debug_access = 0;
-    cache->_debug_hit = 0;
-    cache->_debug_miss = 0;
-#endif
-    return 0;
+    cache = _PGFT_malloc(sizeof(FontCache));
+    if (!cache) {
+        return 0;
+    }
+    memset(cache, 0, sizeof(FontCache));
+    cache->nodes = _PGFT_malloc((size_t)glyph_cache->min_buckets *
+                                sizeof(CacheNode *));
+    if (!cache->nodes) {
+        _PGFT_free(cache);
+        return 0;
+    }
+    for (i = 0; i < glyph_cache->min_buckets; ++i) {
+        cache->nodes[i] = 0;
+    }
+    if (path) {
+        path_len = strlen(path);
+        cache->path = _PGFT_malloc(path_len + 1);
+        if (!cache->path) {
+            _PGFT_free(cache->nodes);
+            _PGFT_free(cache);
+            return 0;
+        }
+        memcpy(cache->path, path, path_len + 1);
+    }
+    cache->font_index = fontobj->id.font_index;
+    cache->resolution = fontobj->resolution;
+    cache->ref_count = 1;
+    cache->size_mask = glyph_cache->min_buckets - 1;
+    cache->owner = glyph_cache;
+    cache->next = glyph_cache->faces;
+    glyph_cache->faces = cache;
+
+    return cache;
 }
 
 void
-_PGFT_Cache_Destroy(FontCache *cache)
+_PGFT_Cache_Release(FontCache *cache)
 {
+    FontCache **link;
     FT_UInt i;
     CacheNode *node, *next;
 
-    if (!cache) {
+    if (!cache || --cache->ref_count > 0) {
         return;
     }
 
@@ -183,51 +241,49 @@ _PGFT_Cache_Destroy(FontCache *cache)
      * to examine _debug fields.
      */
 
-    if (cache->nodes) {
-        for (i = 0; i <= cache->size_mask; ++i) {
-            node = cache->nodes[i];
+    for (link = &cache->owner->faces; *link != cache; link = &(*link)->next)
+        ;
+    *link = cache->next;
 
-            while (node) {
-                next = node->next;
-                free_node(cache, node);
-                node = next;
-            }
+    for (i = 0; i <= cache->size_mask; ++i) {
+        node = cache->nodes[i];
+
+        while (node) {
+            next = node->next;
+            free_node(cache, node);
+            node = next;
         }
-        _PGFT_free(cache->nodes);
-        cache->nodes = 0;
     }
-    _PGFT_free(cache->depths);
-    cache->depths = 0;
+    _PGFT_free(cache->nodes);
+    _PGFT_free(cache->path);
+    _PGFT_free(cache);
 }
 
 void
 _PGFT_Cache_Cleanup(FontCache *cache)
 {
-    const FT_Byte MAX_BUCKET_DEPTH = 2;
-    CacheNode *node, *prev;
-    FT_UInt32 i;
+    /* Called before a layout loads its glyphs. Any other Layout that
+     * loses a glyph here sees the eviction count change, and is loaded
+     * again before it is used.
+     */
+    evict_to_limit(cache->owner);
+}
 
-    for (i = 0; i <= cache->size_mask; ++i) {
-        while (cache->depths[i] > MAX_BUCKET_DEPTH) {
-            node = cache->nodes[i];
-            prev = 0;
+void
+_PGFT_Cache_Touch(FontCache *cache, FontGlyph *glyph)
+{
+    /* The glyph is the first field of its node */
+    CacheNode *node = (CacheNode *)glyph;
+
+    /* A reused layout still counts as a hit for each of its glyphs */
+    lru_remove(cache->owner, node);
+    lru_push(cache->owner, node);
+    cache->owner->hits++;
 
-            for (;;) {
-                if (!node->next) {
 #ifdef PGFT_DEBUG_CACHE
-                    cache->_debug_delete_count++;
+    cache->_debug_access++;
+    cache->_debug_hit++;
 #endif
-
-                    prev->next = 0;
-                    free_node(cache, node);
-                    break;
-                }
-
-                prev = node;
-                node = node->next;
-            }
-        }
-    }
 }
 
 FontGlyph *
@@ -252,12 +308,15 @@ _PGFT_Cache_FindGlyph(GlyphIndex_t id, const FontRenderMode *render,
 #endif
 
     while (node) {
-        if (equal_node_keys(&node->key, &key)) {
+        if (node->hash == hash && equal_node_keys(&node->key, &key)) {
             if (prev) {
                 prev->next = node->next;
                 node->next = nodes[bucket];
                 nodes[bucket] = node;
             }
+            lru_remove(cache->owner, node);
+            lru_push(cache->owner, node);
+            cache->owner->hits++;
 
 #ifdef PGFT_DEBUG_CACHE
             cache->_debug_hit++;
@@ -271,6 +330,7 @@ _PGFT_Cache_FindGlyph(GlyphIndex_t id, const FontRenderMode *render,
     }
 
     node = allocate_node(cache, render, id, internal);
+    cache->owner->misses++;
 
 #ifdef PGFT_DEBUG_CACHE
     cache->_debug_miss++;
@@ -279,9 +339,100 @@ _PGFT_Cache_FindGlyph(GlyphIndex_t id, const FontRenderMode *render,
     return node ? &node->glyph : 0;
 }
 
+static void
+evict_to_limit(GlyphCache *glyph_cache)
+{
+    CacheNode *node;
+
+    while (glyph_cache->bytes > glyph_cache->limit) {
+        node = glyph_cache->lru_last;
+
+#ifdef PGFT_DEBUG_CACHE
+        node->face->_debug_delete_count++;
+#endif
+
+        unlink_node(node->face, node);
+        free_node(node->face, node);
+        glyph_cache->evictions++;
+    }
+}
+
+static void
+lru_remove(GlyphCache *glyph_cache, CacheNode *node)
+{
+    if (node->lru_prev) {
+        node->lru_prev->lru_next = node->lru_next;
+    }
+    else {
+        glyph_cache->lru_first = node->lru_next;
+    }
+    if (node->lru_next) {
+        node->lru_next->lru_prev = node->lru_prev;
+    }
+    else {
+        glyph_cache->lru_last = node->lru_prev;
+    }
+    node->lru_prev = node->lru_next = 0;
+}
+
+static void
+lru_push(GlyphCache *glyph_cache, CacheNode *node)
+{
+    node->lru_prev = 0;
+    node->lru_next = glyph_cache->lru_first;
+    if (glyph_cache->lru_first) {
+        glyph_cache->lru_first->lru_prev = node;
+    }
+    else {
+        glyph_cache->lru_last = node;
+    }
+    glyph_cache->lru_first = node;
+}
+
+static void
+unlink_node(FontCache *cache, CacheNode *node)
+{
+    CacheNode **link = &cache->nodes[node->hash & cache->size_mask];
+
+    while (*link != node) {
+        link = &(*link)->next;
+    }
+    *link = node->next;
+}
+
+static int
+grow_table(FontCache *cache)
+{
+    FT_UInt32 size = (cache->size_mask + 1) * 2;
+    CacheNode **nodes;
+    CacheNode *node, *next;
+    FT_UInt32 i;
+
+    nodes = _PGFT_malloc((size_t)size * sizeof(CacheNode *));
+    if (!nodes) {
+        return -1;
+    }
+    for (i = 0; i < size; ++i) {
+        nodes[i] = 0;
+    }
+    for (i = 0; i <= cache->size_mask; ++i) {
+        for (node = cache->nodes[i]; node; node = next) {
+            next = node->next;
+            node->next = nodes[node->hash & (size - 1)];
+            nodes[node->hash & (size - 1)] = node;
+        }
+    }
+    _PGFT_free(cache->nodes);
+    cache->nodes = nodes;
+    cache->size_mask = size - 1;
+    return 0;
+}
+
 static void
 free_node(FontCache *cache, CacheNode *node)
 {
+    GlyphCache *glyph_cache = cache->owner;
+
     if (!node) {
         return;
     }
@@ -290,7 +441,10 @@ free_node(FontCache *cache, CacheNode *node)
     cache->_debug_count--;
 #endif
 
-    cache->depths[node->hash & cache->size_mask]--;
+    lru_remove(glyph_cache, node);
+    glyph_cache->bytes -= node->bytes;
+    glyph_cache->glyphs--;
+    cache->count--;
 
     FT_Done_Glyph((FT_Glyph)(node->glyph.image));
     _PGFT_free(node);
@@ -300,7 +454,9 @@ static CacheNode *
 allocate_node(FontCache *cache, const FontRenderMode *render,
               GlyphIndex_t id, void *internal)
 {
+    GlyphCache *glyph_cache = cache->owner;
     CacheNode *node = _PGFT_malloc(sizeof(CacheNode));
+    FT_Bitmap *bitmap;
     FT_UInt32 bucket;
 
     if (!node) {
@@ -312,13 +468,25 @@ allocate_node(FontCache *cache, const FontRenderMode *render,
         goto cleanup;
     }
 
+    /* A failed resize only leaves the buckets deeper */
+    if (cache->count >= (cache->size_mask + 1) * MAX_BUCKET_LOAD) {
+        grow_table(cache);
+    }
+
     set_node_key(&node->key, id, render);
     node->hash = get_hash(&node->key);
+    node->face = cache;
     bucket = node->hash & cache->size_mask;
     node->next = cache->nodes[bucket];
     cache->nodes[bucket] = node;
-
-    cache->depths[bucket]++;
+    cache->count++;
+
+    bitmap = &node->glyph.image->bitmap;
+    node->bytes = (sizeof(CacheNode) + sizeof(FT_BitmapGlyphRec) +
+                   (size_t)bitmap->rows * (size_t)abs(bitmap->pitch));
+    glyph_cache->bytes += node->bytes;
+    glyph_cache->glyphs++;
+    lru_push(glyph_cache, node);
 
 #ifdef PGFT_DEBUG_CACHE
     cache->_debug_count++;
@@ -99,26 +99,43 @@ static void position_glyphs(Layout *);
 static void fill_text_bounding_box(Layout *,
                                    FT_Vector,
                                    FT_Pos, FT_Pos, FT_Pos, FT_Pos, FT_Pos);
+static Layout *load_layout(FreeTypeInstance *, pgFontObject *, Layout *,
+                           const FontRenderMode *, PGFT_String *);
 static UpdateLevel_t mode_compare(const FontRenderMode *,
                                   const FontRenderMode *);
+static int same_layout_modes(const FontRenderMode *, const FontRenderMode *);
+static FT_UInt32 hash_text(const PGFT_char *, Py_ssize_t);
 static int same_sizes(const Scale_t *, const Scale_t * );
 static int same_transforms(const FT_Matrix *, const FT_Matrix *);
 static void copy_mode(FontRenderMode *, const FontRenderMode *);
+static int copy_layout(Layout *, const Layout *);
 
 
 int
 _PGFT_LayoutInit(FreeTypeInstance *ft, pgFontObject *fontobj)
 {
-    Layout *ftext = &fontobj->_internals->active_text;
-    FontCache *cache = &fontobj->_internals->glyph_cache;
+    FontInternals *internals = fontobj->_internals;
+    Layout *ftext = &internals->active_text;
 
+    ftext->length = 0;
     ftext->buffer_size = 0;
     ftext->glyphs = 0;
+    ftext->evictions = ft->glyph_cache.evictions - 1;
 
-    if (_PGFT_Cache_Init(ft, cache)) {
+    internals->layouts = 0;
+    internals->layout_count = 0;
+    internals->layout_capacity = 0;
+
+    internals->glyph_cache = _PGFT_Cache_Acquire(ft, fontobj);
+    if (!internals->glyph_cache) {
         PyErr_NoMemory();
         return -1;
     }
+    if (_PGFT_LayoutSetCacheSize(fontobj, PGFT_DEFAULT_LAYOUT_CACHE_SIZE)) {
+        _PGFT_Cache_Release(internals->glyph_cache);
+        internals->glyph_cache = 0;
+        return -1;
+    }
 
     return 0;
 }
@@ -127,26 +144,150 @@ void
 _PGFT_LayoutFree(pgFontObject *fontobj)
 {
     Layout *ftext = &(fontobj->_internals->active_text);
-    FontCache *cache = &fontobj->_internals->glyph_cache;
 
     if (ftext->buffer_size > 0) {
         _PGFT_free(ftext->glyphs);
         ftext->glyphs = 0;
     }
-    _PGFT_Cache_Destroy(cache);
+    _PGFT_LayoutSetCacheSize(fontobj, 0);
+    _PGFT_Cache_Release(fontobj->_internals->glyph_cache);
+    fontobj->_internals->glyph_cache = 0;
+}
+
+int
+_PGFT_LayoutSetCacheSize(pgFontObject *fontobj, int capacity)
+{
+    FontInternals *internals = fontobj->_internals;
+    LayoutMemo *layouts;
+    LayoutMemo *memo;
+    int i;
+
+    while (internals->layout_count > capacity) {
+        memo = &internals->layouts[--internals->layout_count];
+        _PGFT_free(memo->layout.glyphs);
+        _PGFT_free(memo->text);
+    }
+    if (!capacity) {
+        _PGFT_free(internals->layouts);
+        internals->layouts = 0;
+    }
+    else if (capacity != internals->layout_capacity) {
+        layouts = _PGFT_malloc((size_t)capacity * sizeof(LayoutMemo));
+        if (!layouts) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        for (i = 0; i < internals->layout_count; ++i) {
+            layouts[i] = internals->layouts[i];
+        }
+        _PGFT_free(internals->layouts);
+        internals->layouts = layouts;
+    }
+    internals->layout_capacity = capacity;
+    return 0;
 }
 
 Layout *
 _PGFT_LoadLayout(FreeTypeInstance *ft, pgFontObject *fontobj,
                  const FontRenderMode *mode, PGFT_String *text)
 {
-    Layout *ftext = &fontobj->_internals->active_text;
-    FontCache *cache = &fontobj->_internals->glyph_cache;
+    FontInternals *internals = fontobj->_internals;
+    GlyphCache *glyph_cache = internals->glyph_cache->owner;
+    Py_ssize_t length;
+    const PGFT_char *chars;
+    FT_UInt32 hash;
+    LayoutMemo memo;
+    LayoutMemo *layouts = internals->layouts;
+    Py_ssize_t j;
+    int i;
+
+    if (!text || !internals->layout_capacity) {
+        return load_layout(ft, fontobj, &internals->active_text, mode, text);
+    }
+
+    length = PGFT_String_GET_LENGTH(text);
+    chars = PGFT_String_GET_DATA(text);
+    hash = hash_text(chars, length);
+
+    for (i = 0; i < internals->layout_count; ++i) {
+        if (layouts[i].hash == hash && layouts[i].text_length == length &&
+            layouts[i].layout.evictions == glyph_cache->evictions &&
+            same_layout_modes(&layouts[i].layout.mode, mode) &&
+            (!length || !memcmp(layouts[i].text, chars,
+                                (size_t)length * sizeof(PGFT_char)))) {
+            break;
+        }
+    }
+
+    if (i < internals->layout_count) {
+        glyph_cache->layout_hits++;
+        for (j = 0; j < layouts[i].layout.length; ++j) {
+            _PGFT_Cache_Touch(internals->glyph_cache,
+                              layouts[i].layout.glyphs[j].glyph);
+        }
+    }
+    else {
+        /* Lay the text out in the least recently used entry */
+        glyph_cache->layout_misses++;
+        if (internals->layout_count < internals->layout_capacity) {
+            i = internals->layout_count++;
+            memset(&layouts[i], 0, sizeof(LayoutMemo));
+        }
+        else {
+            i = internals->layout_count - 1;
+        }
+        layouts[i].text_length = -1;
+        if (!load_layout(ft, fontobj, &layouts[i].layout, mode, text)) {
+            return 0;
+        }
+        if (length > layouts[i].text_size) {
+            _PGFT_free(layouts[i].text);
+            layouts[i].text_size = 0;
+            layouts[i].text = _PGFT_malloc((size_t)length *
+                                           sizeof(PGFT_char));
+            if (!layouts[i].text) {
+                PyErr_NoMemory();
+                return 0;
+            }
+            layouts[i].text_size = length;
+        }
+        if (length) {
+            memcpy(layouts[i].text, chars,
+                   (size_t)length * sizeof(PGFT_char));
+        }
+        layouts[i].text_length = length;
+        layouts[i].hash = hash;
+    }
+
+    /* Keep the entries most recently used first */
+    if (i) {
+        memo = layouts[i];
+        memmove(layouts + 1, layouts, (size_t)i * sizeof(LayoutMemo));
+        layouts[0] = memo;
+    }
+
+    /* The text=None calls lay out the last text again from active_text */
+    if (copy_layout(&internals->active_text, &layouts[0].layout)) {
+        return 0;
+    }
+    return &internals->active_text;
+}
+
+static Layout *
+load_layout(FreeTypeInstance *ft, pgFontObject *fontobj, Layout *ftext,
+            const FontRenderMode *mode, PGFT_String *text)
+{
+    FontCache *cache = fontobj->_internals->glyph_cache;
     UpdateLevel_t level = (text ?
                            UPDATE_GLYPHS : mode_compare(&ftext->mode, mode));
     FT_Face font = 0;
     TextContext context;
 
+    /* Rendering any font may have evicted glyphs this layout points at */
+    if (ftext->evictions != cache->owner->evictions) {
+        level = UPDATE_GLYPHS;
+    }
+
     if (level != UPDATE_NONE) {
         copy_mode(&ftext->mode, mode);
         font = _PGFT_GetFontSized(ft, fontobj, mode->face_size);
@@ -160,6 +301,8 @@ _PGFT_LoadLayout(FreeTypeInstance *ft, pgFontObject *fontobj,
 
     case UPDATE_GLYPHS:
         _PGFT_Cache_Cleanup(cache);
+        /* Out of date until all its glyphs are loaded */
+        ftext->evictions = cache->owner->evictions - 1;
         fill_context(&context, ft, fontobj, mode, font);
         if (text) {
             if (size_text(ftext, ft, &context, text)) {
@@ -169,6 +312,7 @@ _PGFT_LoadLayout(FreeTypeInstance *ft, pgFontObject *fontobj,
         if (load_glyphs(ftext, &context, cache)) {
             return 0;
         }
+        ftext->evictions = cache->owner->evictions;
         /* fall through */
 
     case UPDATE_LAYOUT:
@@ -472,7 +616,7 @@ int _PGFT_GetMetrics(FreeTypeInstance *ft, pgFontObject *fontobj,
                     long *miny, long *maxy,
                     double *advance_x, double *advance_y)
 {
-    FontCache *cache = &(fontobj->_internals->glyph_cache);
+    FontCache *cache = fontobj->_internals->glyph_cache;
     FT_UInt32 ch = (FT_UInt32)character;
     GlyphIndex_t id;
     FontGlyph *glyph = 0;
@@ -765,6 +909,30 @@ mode_compare(const FontRenderMode *a, const FontRenderMode *b)
     return UPDATE_NONE;
 }
 
+/* Equal when a layout made in one mode can be used for the other */
+static int
+same_layout_modes(const FontRenderMode *a, const FontRenderMode *b)
+{
+    if (mode_compare(a, b) != UPDATE_NONE) {
+        return 0;
+    }
+    return (!(a->style & (FT_STYLE_STRONG | FT_STYLE_WIDE)) ||
+            a->strength == b->strength);
+}
+
+static FT_UInt32
+hash_text(const PGFT_char *chars, Py_ssize_t length)
+{
+    /* 32 bit FNV-1a over the character codes */
+    FT_UInt32 hash = 2166136261U;
+    Py_ssize_t i;
+
+    for (i = 0; i < length; ++i) {
+        hash = (hash ^ chars[i]) * 16777619U;
+    }
+    return hash;
+}
+
 static int
 same_sizes(const Scale_t *a, const Scale_t *b)
 {
@@ -782,3 +950,30 @@ copy_mode(FontRenderMode *d, const FontRenderMode *s)
 {
     memcpy(d, s, sizeof(FontRenderMode));
 }
+
+static int
+copy_layout(Layout *d, const Layout *s)
+{
+    GlyphSlot *glyphs = d->glyphs;
+    int buffer_size = d->buffer_size;
+
+    if (s->length > buffer_size) {
+        _PGFT_free(glyphs);
+        glyphs = _PGFT_malloc((size_t)s->length * sizeof(GlyphSlot));
+        if (!glyphs) {
+            d->glyphs = 0;
+            d->buffer_size = 0;
+            d->length = 0;
+            PyErr_NoMemory();
+            return -1;
+        }
+        buffer_size = s->length;
+    }
+    memcpy(d, s, sizeof(Layout));
+    d->glyphs = glyphs;
+    d->buffer_size = buffer_size;
+    if (s->length) {
+        memcpy(glyphs, s->glyphs, (size_t)s->length * sizeof(GlyphSlot));
+    }
+    return 0;
+}
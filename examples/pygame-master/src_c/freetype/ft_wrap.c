@@ -534,7 +534,7 @@ _PGFT_UnloadFont(FreeTypeInstance *ft, pgFontObject *fontobj)
  *
  *********************************************************/
 int
-_PGFT_Init(FreeTypeInstance **_instance, int cache_size)
+_PGFT_Init(FreeTypeInstance **_instance, int cache_size, size_t cache_limit)
 {
     FreeTypeInstance *inst = 0;
     int error;
@@ -550,6 +550,7 @@ _PGFT_Init(FreeTypeInstance **_instance, int cache_size)
     inst->cache_manager = 0;
     inst->library = 0;
     inst->cache_size = cache_size;
+    _PGFT_GlyphCache_Init(&inst->glyph_cache, cache_size, cache_limit);
 
     error = FT_Init_FreeType(&inst->library);
     if (error) {
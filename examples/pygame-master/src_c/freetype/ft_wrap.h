@@ -52,6 +52,8 @@
 /* Internal configuration variables */
 #define PGFT_DEFAULT_CACHE_SIZE 64
 #define PGFT_MIN_CACHE_SIZE 32
+#define PGFT_DEFAULT_CACHE_LIMIT (8 * 1024 * 1024) /* bytes */
+#define PGFT_DEFAULT_LAYOUT_CACHE_SIZE 8
 #if defined(PGFT_DEBUG_CACHE)
 #undef  PGFT_DEBUG_CACHE
 #endif
@@ -74,6 +76,68 @@ typedef FT_UInt GlyphIndex_t;
  * Internal data structures
  **********************************************************/
 
+#if defined(Py_DEBUG) && !defined(PGFT_DEBUG_CACHE)
+#define PGFT_DEBUG_CACHE 1
+#endif
+
+struct cachenode_;
+struct glyphcache_;
+
+/* FontCache: the rendered glyphs of one font face.
+ *
+ * Font objects opened on the same file, face index and resolution
+ * share a single FontCache, found with _PGFT_Cache_Acquire and
+ * handed back with _PGFT_Cache_Release. The hash table grows with
+ * the number of glyphs; the memory use is bounded by the GlyphCache
+ * that owns it.
+ */
+typedef struct fontcache_ {
+    struct cachenode_ **nodes;
+    struct glyphcache_ *owner;
+    struct fontcache_ *next;
+
+    char *path;           /* 0 for a face read from a stream */
+    FT_Long font_index;
+    FT_UInt resolution;
+    Py_ssize_t ref_count;
+    FT_UInt32 count;
+
+#ifdef PGFT_DEBUG_CACHE
+    FT_UInt32 _debug_count;
+    FT_UInt32 _debug_delete_count;
+    FT_UInt32 _debug_access;
+    FT_UInt32 _debug_hit;
+    FT_UInt32 _debug_miss;
+#endif
+
+    FT_UInt32 size_mask;
+} FontCache;
+
+/* GlyphCache: the FontCaches of a FreeTypeInstance.
+ *
+ * Every cached glyph, whatever its face, is on one least recently
+ * used list. _PGFT_Cache_Cleanup evicts from the far end of the list
+ * until the glyphs fit in limit bytes again. An eviction can free a
+ * glyph that a Layout of any font points at, so a Layout is only good
+ * while evictions is still the count recorded when it was loaded.
+ */
+typedef struct glyphcache_ {
+    FontCache *faces;
+    struct cachenode_ *lru_first;  /* most recently used */
+    struct cachenode_ *lru_last;
+
+    size_t bytes;
+    size_t limit;
+    unsigned long glyphs;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long layout_hits;
+    unsigned long layout_misses;
+
+    FT_UInt32 min_buckets;
+} GlyphCache;
+
 /* FreeTypeInstance: the global freetype 2 library state.
  *
  * Instances of this struct are created by _PGFT_Init, and
@@ -91,6 +155,7 @@ typedef struct freetypeinstance_ {
     FT_Library library;
     FTC_Manager cache_manager;
     FTC_CMapCache cache_charmap;
+    GlyphCache glyph_cache;
 
     int cache_size;
     char _error_msg[1024];
@@ -115,29 +180,6 @@ typedef struct rendermode_ {
     FT_Matrix transform;
 } FontRenderMode;
 
-#if defined(Py_DEBUG) && !defined(PGFT_DEBUG_CACHE)
-#define PGFT_DEBUG_CACHE 1
-#endif
-
-struct cachenode_;
-
-typedef struct fontcache_ {
-    struct cachenode_ **nodes;
-    struct cachenode_ *free_nodes;
-
-    FT_Byte *depths;
-
-#ifdef PGFT_DEBUG_CACHE
-    FT_UInt32 _debug_count;
-    FT_UInt32 _debug_delete_count;
-    FT_UInt32 _debug_access;
-    FT_UInt32 _debug_hit;
-    FT_UInt32 _debug_miss;
-#endif
-
-    FT_UInt32 size_mask;
-} FontCache;
-
 typedef struct fontmetrics_ {
     /* All these are 26.6 precision */
     FT_Pos bearing_x;
@@ -183,6 +225,8 @@ typedef struct layout_ {
     FT_Fixed underline_size;
     FT_Pos underline_pos;
 
+    unsigned long evictions;  /* glyph cache evictions when loaded */
+
     int buffer_size;
     GlyphSlot *glyphs;
 } Layout;
@@ -210,9 +254,26 @@ typedef struct fontsurface_ {
 
 } FontSurface;
 
+/* LayoutMemo: a laid out string kept for _PGFT_LoadLayout to reuse.
+ *
+ * Like any Layout, it is only good while its eviction count is still
+ * the glyph cache's.
+ */
+typedef struct layoutmemo_ {
+    Layout layout;
+    PGFT_char *text;
+    Py_ssize_t text_length;  /* -1 if the entry is unused */
+    Py_ssize_t text_size;
+    FT_UInt32 hash;
+} LayoutMemo;
+
 typedef struct fontinternals_ {
     Layout active_text;
-    FontCache glyph_cache;
+    FontCache *glyph_cache;
+
+    LayoutMemo *layouts;  /* most recently used first */
+    int layout_count;
+    int layout_capacity;
 } FontInternals;
 
 typedef struct PGFT_String_ {
@@ -221,7 +282,7 @@ typedef struct PGFT_String_ {
 } PGFT_String;
 
 #if defined(PGFT_DEBUG_CACHE)
-#define PGFT_FONT_CACHE(f) ((f)->_internals->glyph_cache)
+#define PGFT_FONT_CACHE(f) (*(f)->_internals->glyph_cache)
 #endif
 
 /**********************************************************
@@ -230,6 +291,7 @@ typedef struct PGFT_String_ {
 typedef struct {
     FreeTypeInstance *freetype;
     int cache_size;
+    size_t cache_limit;
     FT_UInt resolution;
 } _FreeTypeState;
 
@@ -262,7 +324,7 @@ typedef struct {
 /**************************************** General functions ******************/
 const char *_PGFT_GetError(FreeTypeInstance *);
 void _PGFT_Quit(FreeTypeInstance *);
-int _PGFT_Init(FreeTypeInstance **, int);
+int _PGFT_Init(FreeTypeInstance **, int, size_t);
 long _PGFT_Font_GetAscender(FreeTypeInstance *, pgFontObject *);
 long _PGFT_Font_GetAscenderSized(FreeTypeInstance *, pgFontObject *,
                                  Scale_t);
@@ -371,15 +433,19 @@ void __render_glyph_MONO_as_INT(int, int, FontSurface *, const FT_Bitmap *,
 /**************************************** Layout management ******************/
 int _PGFT_LayoutInit(FreeTypeInstance *, pgFontObject *);
 void _PGFT_LayoutFree(pgFontObject *);
+int _PGFT_LayoutSetCacheSize(pgFontObject *, int);
 Layout *_PGFT_LoadLayout(FreeTypeInstance *, pgFontObject *,
                          const FontRenderMode *, PGFT_String *);
 int _PGFT_LoadGlyph(FontGlyph *, GlyphIndex_t, const FontRenderMode *, void *);
 
 
 /**************************************** Glyph cache management *************/
-int _PGFT_Cache_Init(FreeTypeInstance *, FontCache *);
-void _PGFT_Cache_Destroy(FontCache *);
+void _PGFT_GlyphCache_Init(GlyphCache *, int, size_t);
+void _PGFT_GlyphCache_SetLimit(GlyphCache *, size_t);
+FontCache *_PGFT_Cache_Acquire(FreeTypeInstance *, pgFontObject *);
+void _PGFT_Cache_Release(FontCache *);
 void _PGFT_Cache_Cleanup(FontCache *);
+void _PGFT_Cache_Touch(FontCache *, FontGlyph *);
 FontGlyph *_PGFT_Cache_FindGlyph(FT_UInt32, const FontRenderMode *,
                                  FontCache *, void *);
 
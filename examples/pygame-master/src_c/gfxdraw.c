@@ -169,6 +169,7 @@ _gfx_pixelcolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -198,6 +199,7 @@ _gfx_hlinecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -228,6 +230,7 @@ _gfx_vlinecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -259,6 +262,7 @@ _gfx_rectanglecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     sdlrect = pgRect_FromObject(rect, &temprect);
     if (sdlrect == NULL) {
         return NULL;
@@ -300,6 +304,7 @@ _gfx_boxcolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     sdlrect = pgRect_FromObject(rect, &temprect);
     if (sdlrect == NULL) {
         return NULL;
@@ -339,6 +344,7 @@ _gfx_linecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -368,6 +374,7 @@ _gfx_circlecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -398,6 +405,7 @@ _gfx_arccolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -428,6 +436,7 @@ _gfx_aacirclecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -458,6 +467,7 @@ _gfx_filledcirclecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -488,6 +498,7 @@ _gfx_ellipsecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -518,6 +529,7 @@ _gfx_aaellipsecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -548,6 +560,7 @@ _gfx_filledellipsecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -578,6 +591,7 @@ _gfx_piecolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -608,6 +622,7 @@ _gfx_trigoncolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -638,6 +653,7 @@ _gfx_aatrigoncolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -668,6 +684,7 @@ _gfx_filledtrigoncolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -699,6 +716,7 @@ _gfx_polygoncolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -777,6 +795,7 @@ _gfx_aapolygoncolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -856,6 +875,7 @@ _gfx_filledpolygoncolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -935,6 +955,7 @@ _gfx_texturedpolygon(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     s_surface = pgSurface_AsSurface(surface);
     if (!pgSurface_Check(texture)) {
         PyErr_SetString(PyExc_TypeError, "texture must be a Surface");
@@ -1022,6 +1043,7 @@ _gfx_beziercolor(PyObject *self, PyObject *args)
         PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
         return NULL;
     }
+    pgSurface_Changed(surface);
     if (!pg_RGBAFromObj(color, rgba)) {
         PyErr_SetString(PyExc_TypeError, "invalid color argument");
         return NULL;
@@ -366,7 +366,7 @@ image_tostring(PyObject *self, PyObject *arg)
             return NULL;
         Bytes_AsStringAndSize(string, &data, &len);
 
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
         pixels = (char *)surf->pixels;
         for (h = 0; h < surf->h; ++h)
             memcpy(DATAROW(data, h, surf->w, surf->h, flipped),
@@ -380,7 +380,7 @@ image_tostring(PyObject *self, PyObject *arg)
         Bytes_AsStringAndSize(string, &data, &len);
 
         if (!temp)
-            pgSurface_Lock(surfobj);
+            pgSurface_LockForRead(surfobj);
         pixels = (char *)surf->pixels;
         switch (surf->format->BytesPerPixel) {
             case 1:
@@ -453,7 +453,7 @@ image_tostring(PyObject *self, PyObject *arg)
             return NULL;
         Bytes_AsStringAndSize(string, &data, &len);
 
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
         pixels = (char *)surf->pixels;
         switch (surf->format->BytesPerPixel) {
             case 1:
@@ -544,7 +544,7 @@ image_tostring(PyObject *self, PyObject *arg)
             return NULL;
         Bytes_AsStringAndSize(string, &data, &len);
 
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
         pixels = (char *)surf->pixels;
         switch (surf->format->BytesPerPixel) {
             case 1:
@@ -640,7 +640,7 @@ image_tostring(PyObject *self, PyObject *arg)
             return NULL;
         Bytes_AsStringAndSize(string, &data, &len);
 
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
         pixels = (char *)surf->pixels;
         switch (surf->format->BytesPerPixel) {
             case 2:
@@ -732,7 +732,7 @@ image_tostring(PyObject *self, PyObject *arg)
             return NULL;
         Bytes_AsStringAndSize(string, &data, &len);
 
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
         pixels = (char *)surf->pixels;
         switch (surf->format->BytesPerPixel) {
             case 2:
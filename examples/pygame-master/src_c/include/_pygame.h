@@ -363,6 +363,7 @@ typedef struct {
     PyObject *weakreflist;
     PyObject *locklist;
     PyObject *dependency;
+    unsigned long changes; /* bumped by pgSurface_Changed() */
 } pgSurfaceObject;
 #define pgSurface_AsSurface(x) (((pgSurfaceObject *)x)->surf)
 
@@ -444,6 +445,18 @@ typedef struct {
 #define pgSurface_LockLifetime                 \
     (*(PyObject * (*)(PyObject *, PyObject *)) \
         PYGAMEAPI_GET_SLOT(surflock, 7))
+
+#define pgSurface_Changed \
+    (*(void (*)(PyObject *)) \
+        PYGAMEAPI_GET_SLOT(surflock, 8))
+
+#define pgSurface_LockForRead \
+    (*(int (*)(PyObject *)) \
+        PYGAMEAPI_GET_SLOT(surflock, 9))
+
+#define pgSurface_GetChanges \
+    (*(int (*)(PyObject *, unsigned long *)) \
+        PYGAMEAPI_GET_SLOT(surflock, 10))
 #endif
 
 /*
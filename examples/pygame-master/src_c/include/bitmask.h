@@ -142,6 +142,31 @@ bitmask_t *bitmask_scale(const bitmask_t *m, int w, int h);
  *                [yoffset ... yoffset + a->h + b->h - 1). */
 void bitmask_convolve(const bitmask_t *a, const bitmask_t *b, bitmask_t *o, int xoffset, int yoffset);
 
+/* Instruction sets the overlap functions can use, numbered like
+   PG_BACKEND_* in simd_backend.h. Only GENERIC is always built in; the
+   caller must check that the CPU supports the others. */
+#define BITMASK_BACKEND_GENERIC 0
+#define BITMASK_BACKEND_SSE2 1
+#define BITMASK_BACKEND_AVX2 2
+
+/* Selects the backend for bitmask_overlap() and friends. Returns 0 on
+   success, or -1 if that backend is not part of this build. */
+int bitmask_set_backend(int backend);
+
+/* Returns the backend in use. */
+int bitmask_get_backend(void);
+
+/* Overwrites row y of m from m->w 32 bit pixels. A bit is set if, for
+   every byte that is nonzero in bytes, the same byte of the pixel differs
+   from that byte of color by less than that byte of dist. If others is not
+   NULL its pixels are used in place of color. invert sets the bits of the
+   other pixels instead. Uses the backend chosen with
+   bitmask_set_backend(). */
+void bitmask_set_row_within(bitmask_t *m, int y, const unsigned int *pixels,
+                            const unsigned int *others, unsigned int color,
+                            unsigned int dist, unsigned int bytes,
+                            int invert);
+
 #ifdef __cplusplus
 } /* End of extern "C" { */
 #endif
@@ -37,6 +37,10 @@
 
 #include "structmember.h"
 
+#include "simd_backend.h"
+#include "surface_cache.h"
+#include "thread_pool.h"
+
 #include <math.h>
 
 #ifndef M_PI
@@ -632,34 +636,165 @@ set_pixel_color(Uint8 *pixel, Uint8 bpp, Uint32 color)
     }
 }
 
+/*
+ * Building masks from surfaces.
+ *
+ * from_surface() and from_threshold() fill their mask through a
+ * MaskFromArgs, a band of rows at a time. On 32 bit surfaces whose tested
+ * channels are whole bytes every test becomes a byte compare against a
+ * color (see bitmask_set_row_within()), which packs whole BITMASK_W words
+ * using the SSE2 or AVX2 kernels picked with _set_overlap_backend. Other
+ * surfaces are read a pixel at a time through SDL_GetRGBA().
+ *
+ * When enabled with _set_threads, the rows of a large surface are cut into
+ * bands that the shared thread pool fills in parallel. Every row of a mask
+ * has its own words, so the bands never write to the same word.
+ */
+typedef struct MaskFromArgs MaskFromArgs;
+typedef void (*MASK_ROWS_P)(MaskFromArgs *, int, int);
+
+struct MaskFromArgs {
+    MASK_ROWS_P rows; /* fills rows start to end - 1 of mask */
+    SDL_Surface *surf;
+    SDL_Surface *surf2; /* from_threshold() othersurface, or NULL */
+    bitmask_t *mask;
+    Uint32 color;     /* colorkey, or the color to compare with */
+    Uint32 threshold; /* from_threshold() threshold */
+    Uint32 dist;      /* bitmask_set_row_within() byte distances */
+    Uint32 bytes;     /* bitmask_set_row_within() bytes to test */
+    int invert;
+    int alpha; /* from_surface() alpha threshold */
+    int palette_colors;
+};
+
+#define MASK_MIN_PIXELS (256 * 256)
+#define MASK_MIN_BAND 16
+
+typedef struct {
+    MaskFromArgs *args;
+    int start;
+    int end;
+} MaskBand;
+
+static pg_thread_pool mask_pool = PG_THREAD_POOL_INIT("pygame mask");
+static MaskBand mask_bands[PG_POOL_MAX_THREADS];
+
+static void
+_mask_band(void *data, int i)
+{
+    MaskBand *band = (MaskBand *)data + i;
+    band->args->rows(band->args, band->start, band->end);
+}
+
+/* Fill every row of args->mask, in bands if the surface is large enough.
+ */
+static void
+mask_run_rows(MaskFromArgs *args)
+{
+    int count = args->surf->h;
+    int nbands = mask_pool.threads;
+    int start, end, i;
+
+    if (count / MASK_MIN_BAND < nbands) {
+        nbands = count / MASK_MIN_BAND;
+    }
+    /* Another thread may be building a mask with the GIL released; it
+     * keeps the pool and this call simply runs on its own.
+     */
+    if (nbands < 2 || args->surf->w < MASK_MIN_PIXELS / count ||
+        !pg_pool_acquire(&mask_pool, nbands)) {
+        args->rows(args, 0, count);
+        return;
+    }
+
+    for (i = 0, start = 0; i < nbands; ++i, start = end) {
+        end = count * (i + 1) / nbands;
+        mask_bands[i].args = args;
+        mask_bands[i].start = start;
+        mask_bands[i].end = end;
+    }
+    pg_pool_run(&mask_pool, _mask_band, mask_bands, nbands);
+}
+
+/* Join the worker threads. They are started again by the next large
+ * from_surface() or from_threshold() if threads are still enabled.
+ */
+static void
+_mask_quit_threads(void)
+{
+    pg_pool_quit(&mask_pool);
+}
+
+/* Nonzero if the channel with the given mask and shift is a whole byte of
+ * a 32 bit pixel, so that bitmask_set_row_within() can test it.
+ */
+static int
+_mask_is_byte_channel(Uint32 chmask, Uint8 shift)
+{
+    return (shift & 7) == 0 && shift < 32 && chmask == (Uint32)0xff << shift;
+}
+
+/* Fills rows with bitmask_set_row_within(), for 32 bit surfaces.
+ *
+ * Params:
+ *     args: the surfaces, mask and the color, dist, bytes and invert
+ *         arguments to bitmask_set_row_within()
+ *     start: first row to fill
+ *     end: row after the last one to fill
+ *
+ * Returns:
+ *     void
+ */
+static void
+set_from_within(MaskFromArgs *args, int start, int end)
+{
+    SDL_Surface *surf = args->surf;
+    SDL_Surface *surf2 = args->surf2;
+    const unsigned int *others = NULL;
+    int y;
+
+    for (y = start; y < end; ++y) {
+        if (surf2) {
+            others = (const unsigned int *)((Uint8 *)surf2->pixels +
+                                            y * surf2->pitch);
+        }
+        bitmask_set_row_within(
+            args->mask, y,
+            (const unsigned int *)((Uint8 *)surf->pixels + y * surf->pitch),
+            others, args->color, args->dist, args->bytes, args->invert);
+    }
+}
+
 /* For each surface pixel's alpha that is greater than the threshold,
  * the corresponding bitmask bit is set.
  *
  * Params:
- *     surf: surface
- *     bitmask: bitmask to alter
- *     threshold: threshold used check surface pixels (alpha) against
+ *     args: surf, the surface, mask, the bitmask to alter and alpha, the
+ *         threshold used check surface pixels (alpha) against
+ *     start: first row to alter
+ *     end: row after the last one to alter
  *
  * Returns:
  *     void
  */
 static void
-set_from_threshold(SDL_Surface *surf, bitmask_t *bitmask, int threshold)
+set_from_threshold(MaskFromArgs *args, int start, int end)
 {
+    SDL_Surface *surf = args->surf;
     SDL_PixelFormat *format = surf->format;
     Uint8 bpp = format->BytesPerPixel;
     Uint8 *pixel = NULL;
     Uint8 rgba[4];
     int x, y;
 
-    for (y = 0; y < surf->h; ++y) {
+    for (y = start; y < end; ++y) {
         pixel = (Uint8 *)surf->pixels + y * surf->pitch;
 
         for (x = 0; x < surf->w; ++x, pixel += bpp) {
             SDL_GetRGBA(get_pixel_color(pixel, bpp), format, rgba, rgba + 1,
                         rgba + 2, rgba + 3);
-            if (rgba[3] > threshold) {
-                bitmask_setbit(bitmask, x, y);
+            if (rgba[3] > args->alpha) {
+                bitmask_setbit(args->mask, x, y);
             }
         }
     }
@@ -669,31 +804,159 @@ set_from_threshold(SDL_Surface *surf, bitmask_t *bitmask, int threshold)
  * corresponding bitmask bit is set.
  *
  * Params:
- *     surf: surface
- *     bitmask: bitmask to alter
- *     colorkey: color used to check surface pixels against
+ *     args: surf, the surface, mask, the bitmask to alter and color, the
+ *         colorkey used to check surface pixels against
+ *     start: first row to alter
+ *     end: row after the last one to alter
  *
  * Returns:
  *     void
  */
 static void
-set_from_colorkey(SDL_Surface *surf, bitmask_t *bitmask, Uint32 colorkey)
+set_from_colorkey(MaskFromArgs *args, int start, int end)
 {
+    SDL_Surface *surf = args->surf;
     Uint8 bpp = surf->format->BytesPerPixel;
     Uint8 *pixel = NULL;
     int x, y;
 
-    for (y = 0; y < surf->h; ++y) {
+    for (y = start; y < end; ++y) {
         pixel = (Uint8 *)surf->pixels + y * surf->pitch;
 
         for (x = 0; x < surf->w; ++x, pixel += bpp) {
-            if (get_pixel_color(pixel, bpp) != colorkey) {
-                bitmask_setbit(bitmask, x, y);
+            if (get_pixel_color(pixel, bpp) != args->color) {
+                bitmask_setbit(args->mask, x, y);
             }
         }
     }
 }
 
+/* Sets the bits of a mask for the pixels of a surface whose alpha is
+ * greater than the threshold. 32 bit surfaces with a whole byte of alpha,
+ * or none, take the word at a time path.
+ */
+static void
+mask_set_from_alpha(SDL_Surface *surf, bitmask_t *bitmask, int threshold)
+{
+    SDL_PixelFormat *format = surf->format;
+    MaskFromArgs args = {set_from_threshold};
+
+    args.surf = surf;
+    args.mask = bitmask;
+    args.alpha = threshold;
+
+    if (format->BytesPerPixel == 4 && !format->Amask) {
+        /* SDL_GetRGBA() gives every pixel an alpha of 255. */
+        if (threshold < 255) {
+            bitmask_fill(bitmask);
+        }
+        return;
+    }
+    if (format->BytesPerPixel == 4 &&
+        _mask_is_byte_channel(format->Amask, format->Ashift)) {
+        if (threshold < 0 || threshold >= 255) {
+            if (threshold < 0) {
+                bitmask_fill(bitmask);
+            }
+            return;
+        }
+        /* alpha > threshold is the same as 255 - alpha < 255 - threshold */
+        args.rows = set_from_within;
+        args.color = args.bytes = format->Amask;
+        args.dist = (Uint32)(255 - threshold) << format->Ashift;
+    }
+    mask_run_rows(&args);
+}
+
+/* Sets the bits of a mask for the pixels of a surface that are not the
+ * colorkey. On 32 bit surfaces all four bytes must match the colorkey.
+ */
+static void
+mask_set_from_colorkey(SDL_Surface *surf, bitmask_t *bitmask,
+                       Uint32 colorkey)
+{
+    MaskFromArgs args = {set_from_colorkey};
+
+    args.surf = surf;
+    args.mask = bitmask;
+    args.color = colorkey;
+
+    if (surf->format->BytesPerPixel == 4) {
+        args.rows = set_from_within;
+        args.dist = 0x01010101;
+        args.bytes = 0xffffffff;
+        args.invert = 1;
+    }
+    mask_run_rows(&args);
+}
+
+/*
+ * Mask cache.
+ *
+ * from_surface() keeps copies of the masks it builds, so that asking again
+ * for the mask of an unchanged surface, as sprite.collide_mask() does for
+ * sprites without a mask attribute, copies the kept mask instead of
+ * reading every pixel. An entry belongs to a surface and an alpha
+ * threshold, and each one costs 1 against the cache size. See
+ * surface_cache.h for when entries are used and dropped.
+ */
+#define MASK_CACHE_DEFAULT_SIZE 64
+
+typedef struct {
+    int use_thresh;
+    int threshold;
+} MaskCacheKey;
+
+static void
+_mask_cache_free(void *mask)
+{
+    bitmask_free((bitmask_t *)mask);
+}
+
+static pg_surface_cache mask_cache =
+    PG_SURFACE_CACHE_INIT(_mask_cache_free, MASK_CACHE_DEFAULT_SIZE);
+
+static void
+_mask_cache_clear(void)
+{
+    pg_surface_cache_clear(&mask_cache);
+}
+
+static void
+_mask_cache_key(MaskCacheKey *key, int use_thresh, int threshold)
+{
+    key->use_thresh = use_thresh;
+    key->threshold = use_thresh ? threshold : 0;
+}
+
+/* Keeps a copy of a mask just built from a surface, whose change count
+ * was changes before it was read. Running out of memory only means the
+ * mask is not kept.
+ */
+static void
+_mask_cache_store(PyObject *surfobj, int use_thresh, int threshold,
+                  unsigned long changes, bitmask_t *mask)
+{
+    static int quit_registered = 0;
+    MaskCacheKey key;
+    bitmask_t *copy;
+
+    if (mask_cache.budget == 0) {
+        return;
+    }
+    if (!quit_registered) {
+        pg_RegisterQuit(_mask_cache_clear);
+        quit_registered = 1;
+    }
+    copy = bitmask_copy(mask);
+    if (!copy) {
+        return;
+    }
+    _mask_cache_key(&key, use_thresh, threshold);
+    pg_surface_cache_store(&mask_cache, surfobj, &key, sizeof(key), changes,
+                           copy, 1);
+}
+
 /* Creates a mask from a given surface.
  *
  * Returns:
@@ -705,7 +968,11 @@ mask_from_surface(PyObject *self, PyObject *args)
     SDL_Surface *surf = NULL;
     PyObject *surfobj = NULL;
     pgMaskObject *maskobj = NULL;
+    bitmask_t *cached;
+    MaskCacheKey key;
     Uint32 colorkey;
+    unsigned long changes;
+    int cacheable;
     int threshold = 127; /* default value */
     int use_thresh = 1;
 
@@ -721,6 +988,32 @@ mask_from_surface(PyObject *self, PyObject *args)
                      "cannot create mask with negative size");
     }
 
+#if IS_SDLv1
+    if (surf->flags & SDL_SRCCOLORKEY) {
+        colorkey = surf->format->colorkey;
+        use_thresh = 0;
+    }
+#else  /* IS_SDLv2 */
+    use_thresh = (SDL_GetColorKey(surf, &colorkey) == -1);
+#endif /* IS_SDLv2 */
+
+    /* Counted before the pixels are read, so that a change made by another
+     * thread while the GIL is released leaves the kept mask out of date.
+     */
+    cacheable = pgSurface_GetChanges(surfobj, &changes);
+    _mask_cache_key(&key, use_thresh, threshold);
+    cached = cacheable ? (bitmask_t *)pg_surface_cache_find(
+                             &mask_cache, surfobj, &key, sizeof(key), changes)
+                       : NULL;
+    if (cached) {
+        cached = bitmask_copy(cached);
+        if (!cached) {
+            return RAISE(PyExc_MemoryError,
+                         "cannot allocate memory for bitmask");
+        }
+        return (PyObject *)create_mask_using_bitmask(cached);
+    }
+
     maskobj = CREATE_MASK_OBJ(surf->w, surf->h, 0);
 
     if (NULL == maskobj) {
@@ -732,27 +1025,18 @@ mask_from_surface(PyObject *self, PyObject *args)
         return (PyObject *)maskobj;
     }
 
-    if (!pgSurface_Lock(surfobj)) {
+    if (!pgSurface_LockForRead(surfobj)) {
         Py_DECREF((PyObject *)maskobj);
         return RAISE(PyExc_RuntimeError, "cannot lock surface");
     }
 
     Py_BEGIN_ALLOW_THREADS; /* Release the GIL. */
 
-#if IS_SDLv1
-    if (surf->flags & SDL_SRCCOLORKEY) {
-        colorkey = surf->format->colorkey;
-        use_thresh = 0;
-    }
-#else  /* IS_SDLv2 */
-    use_thresh = (SDL_GetColorKey(surf, &colorkey) == -1);
-#endif /* IS_SDLv2 */
-
     if (use_thresh) {
-        set_from_threshold(surf, maskobj->mask, threshold);
+        mask_set_from_alpha(surf, maskobj->mask, threshold);
     }
     else {
-        set_from_colorkey(surf, maskobj->mask, colorkey);
+        mask_set_from_colorkey(surf, maskobj->mask, colorkey);
     }
 
     Py_END_ALLOW_THREADS; /* Obtain the GIL. */
@@ -762,6 +1046,11 @@ mask_from_surface(PyObject *self, PyObject *args)
         return RAISE(PyExc_RuntimeError, "cannot unlock surface");
     }
 
+    if (cacheable) {
+        _mask_cache_store(surfobj, use_thresh, threshold, changes,
+                          maskobj->mask);
+    }
+
     return (PyObject *)maskobj;
 }
 
@@ -774,10 +1063,13 @@ palette_colors - this only affects surfaces with a palette
 
 */
 
-void
-bitmask_threshold(bitmask_t *m, SDL_Surface *surf, SDL_Surface *surf2,
-                  Uint32 color, Uint32 threshold, int palette_colors)
+static void
+bitmask_threshold(MaskFromArgs *args, int start, int end)
 {
+    bitmask_t *m = args->mask;
+    SDL_Surface *surf = args->surf, *surf2 = args->surf2;
+    Uint32 color = args->color, threshold = args->threshold;
+    int palette_colors = args->palette_colors;
     int x, y, rshift, gshift, bshift, rshift2, gshift2, bshift2;
     int rloss, gloss, bloss, rloss2, gloss2, bloss2;
     Uint8 *pixels, *pixels2;
@@ -813,7 +1105,7 @@ bitmask_threshold(bitmask_t *m, SDL_Surface *surf, SDL_Surface *surf2,
         gloss2 = format2->Gloss;
         bloss2 = format2->Bloss;
         pixels2 = (Uint8 *)surf2->pixels;
-        bpp2 = surf->format->BytesPerPixel;
+        bpp2 = surf2->format->BytesPerPixel;
     }
     else { /* make gcc stop complaining */
         rmask2 = gmask2 = bmask2 = 0;
@@ -827,7 +1119,7 @@ bitmask_threshold(bitmask_t *m, SDL_Surface *surf, SDL_Surface *surf2,
     SDL_GetRGBA(color, format, &r, &g, &b, &a);
     SDL_GetRGBA(threshold, format, &tr, &tg, &tb, &ta);
 
-    for (y = 0; y < surf->h; y++) {
+    for (y = start; y < end; y++) {
         pixels = (Uint8 *)surf->pixels + y * surf->pitch;
         if (surf2) {
             pixels2 = (Uint8 *)surf2->pixels + y * surf2->pitch;
@@ -938,6 +1230,8 @@ mask_from_threshold(PyObject *self, PyObject *args)
     Uint32 color;
     Uint32 color_threshold;
     int palette_colors = 1;
+    SDL_PixelFormat *format;
+    MaskFromArgs from = {bitmask_threshold};
 
     if (!PyArg_ParseTuple(args, "O!O|OO!i", &pgSurface_Type, &surfobj,
                           &rgba_obj_color, &rgba_obj_threshold,
@@ -989,14 +1283,46 @@ mask_from_threshold(PyObject *self, PyObject *args)
         return NULL; /* Exception already set. */
     }
 
-    pgSurface_Lock(surfobj);
+    from.surf = surf;
+    from.surf2 = surf2;
+    from.mask = maskobj->mask;
+    from.color = color;
+    from.threshold = color_threshold;
+    from.palette_colors = palette_colors;
+
+    /* Compare whole words of pixels when the color channels are bytes in
+     * the same places of both surfaces. */
+    format = surf->format;
+    if (bpp == 4 && _mask_is_byte_channel(format->Rmask, format->Rshift) &&
+        _mask_is_byte_channel(format->Gmask, format->Gshift) &&
+        _mask_is_byte_channel(format->Bmask, format->Bshift) &&
+        (!surf2 || (surf2->format->BytesPerPixel == 4 &&
+                    surf2->format->Rmask == format->Rmask &&
+                    surf2->format->Gmask == format->Gmask &&
+                    surf2->format->Bmask == format->Bmask &&
+                    surf2->w >= surf->w && surf2->h >= surf->h))) {
+        SDL_GetRGBA(color, format, rgba_color, rgba_color + 1, rgba_color + 2,
+                    rgba_color + 3);
+        SDL_GetRGBA(color_threshold, format, rgba_threshold,
+                    rgba_threshold + 1, rgba_threshold + 2,
+                    rgba_threshold + 3);
+        from.rows = set_from_within;
+        from.color = ((Uint32)rgba_color[0] << format->Rshift) |
+                     ((Uint32)rgba_color[1] << format->Gshift) |
+                     ((Uint32)rgba_color[2] << format->Bshift);
+        from.dist = ((Uint32)rgba_threshold[0] << format->Rshift) |
+                    ((Uint32)rgba_threshold[1] << format->Gshift) |
+                    ((Uint32)rgba_threshold[2] << format->Bshift);
+        from.bytes = format->Rmask | format->Gmask | format->Bmask;
+    }
+
+    pgSurface_LockForRead(surfobj);
     if (surfobj2) {
-        pgSurface_Lock(surfobj2);
+        pgSurface_LockForRead(surfobj2);
     }
 
     Py_BEGIN_ALLOW_THREADS;
-    bitmask_threshold(maskobj->mask, surf, surf2, color, color_threshold,
-                      palette_colors);
+    mask_run_rows(&from);
     Py_END_ALLOW_THREADS;
 
     pgSurface_Unlock(surfobj);
@@ -1007,205 +1333,309 @@ mask_from_threshold(PyObject *self, PyObject *args)
     return (PyObject *)maskobj;
 }
 
-/* The initial labelling phase of the connected components algorithm.
+/* Connected component labelling.
  *
- * Connected component labeling based on the SAUF algorithm by Kesheng Wu,
- * Ekow Otoo, and Kenji Suzuki. The algorithm is best explained by their
- * paper, "Two Strategies to Speed up Connected Component Labeling Algorithms",
- * but in summary, it is a very efficient two pass method for 8-connected
- * components. It uses a decision tree to minimize the number of neighbors that
- * need to be checked. It stores equivalence information in an array based
- * union-find.
+ * The mask is first cut into runs, horizontal spans of set bits in a row,
+ * found a whole BITMASK_W word at a time by counting trailing zero and one
+ * bits. A run is 8-connected to every run in the row above that touches
+ * the span from one bit left of it to one bit right of it, and these
+ * connections are joined in a union-find over the runs. Each find root is
+ * the earliest run of its component in raster order, so the components
+ * come out in the order of their first bit, as with a pixel by pixel scan.
+ * The work and memory depend on the number of runs, not on the mask area.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CC_CTZ(w) __builtin_ctzl(w)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+static PG_INLINE int
+CC_CTZ(BITMASK_W w)
+{
+    unsigned long i;
+    _BitScanForward(&i, w); /* unsigned long is 32 bits on Windows */
+    return (int)i;
+}
+#else
+static PG_INLINE int
+CC_CTZ(BITMASK_W w)
+{
+    int i = 0;
+    while (!(w & 1)) {
+        w >>= 1;
+        ++i;
+    }
+    return i;
+}
+#endif
+
+/* A run of set bits from x0 up to (not including) x1 in row y. While
+ * labelling, label is the union-find parent run; afterwards it is the
+ * index of the run's component, or -1 if that component was filtered out.
+ */
+typedef struct {
+    int x0, x1, y;
+    int label;
+} cc_run;
+
+/* The statistics of one connected component */
+typedef struct {
+    long area;
+    int x0, y0, x1, y1; /* bounding box, x1 and y1 are exclusive */
+    Sint64 sumx, sumy;  /* sums of the set bits' coordinates */
+} cc_component;
+
+/* The runs and components of a mask, filled in by cc_label_runs() */
+typedef struct {
+    cc_run *runs;
+    int nruns;
+    cc_component *comps;
+    int ncomps;
+} cc_labels;
+
+static void
+cc_labels_free(cc_labels *labels)
+{
+    free(labels->runs);
+    free(labels->comps);
+    labels->runs = NULL;
+    labels->comps = NULL;
+    labels->nruns = labels->ncomps = 0;
+}
+
+/* Appends the run [x0, x1) of row y, growing the array as needed.
+ * Returns 0 on success and -2 on memory allocation error.
+ */
+static int
+cc_add_run(cc_labels *labels, int *capacity, int x0, int x1, int y)
+{
+    cc_run *run;
+
+    if (labels->nruns == *capacity) {
+        int newcap = *capacity ? *capacity * 2 : 256;
+        cc_run *runs =
+            (cc_run *)realloc(labels->runs, sizeof(cc_run) * newcap);
+        if (!runs) {
+            return -2;
+        }
+        labels->runs = runs;
+        *capacity = newcap;
+    }
+    run = labels->runs + labels->nruns;
+    run->x0 = x0;
+    run->x1 = x1;
+    run->y = y;
+    run->label = labels->nruns++;
+    return 0;
+}
+
+/* Finds the root run of the given run, halving the path on the way */
+static PG_INLINE int
+cc_find(cc_run *runs, int i)
+{
+    while (runs[i].label != i) {
+        runs[i].label = runs[runs[i].label].label;
+        i = runs[i].label;
+    }
+    return i;
+}
+
+/* Joins the components of runs i and j, keeping the earlier root */
+static PG_INLINE void
+cc_union(cc_run *runs, int i, int j)
+{
+    i = cc_find(runs, i);
+    j = cc_find(runs, j);
+    if (i < j) {
+        runs[j].label = i;
+    }
+    else if (j < i) {
+        runs[i].label = j;
+    }
+}
+
+/* Labels the 8-connected components of a mask.
  *
  * Params:
- *     input - the input mask
- *     image - an array to store labelled pixels
- *     ufind - the union-find label equivalence array
- *     largest - an array to store the number of pixels for each label
+ *     mask - the mask to label
+ *     min - components with fewer set bits than this are left out
+ *     labels - passes back the runs and component statistics, the caller
+ *         frees them with cc_labels_free()
  *
  * Returns:
- *     the highest label in the labelled image
+ *     0 on success
+ *     -2 on memory allocation error
  */
-unsigned int
-cc_label(bitmask_t *input, unsigned int *image, unsigned int *ufind,
-         unsigned int *largest)
+static int
+cc_label_runs(const bitmask_t *mask, int min, cc_labels *labels)
 {
-    unsigned int *buf;
-    unsigned int x, y, w, h, root, aroot, croot, temp, label;
+    const int w = mask->w, h = mask->h;
+    const int nwords = (w - 1) / (int)BITMASK_W_LEN + 1;
+    const BITMASK_W endmask =
+        ~(BITMASK_W)0 >> ((BITMASK_W_LEN - w % BITMASK_W_LEN) % BITMASK_W_LEN);
+    int capacity = 0, prev_start = 0, row_start, i, j, p, k, y;
+    cc_component *comp;
 
-    label = 0;
-    w = input->w;
-    h = input->h;
+    labels->runs = NULL;
+    labels->comps = NULL;
+    labels->nruns = labels->ncomps = 0;
 
-    ufind[0] = 0;
-    buf = image;
-
-    /* special case for first pixel */
-    if (bitmask_getbit(input, 0, 0)) { /* process for a new connected comp: */
-        label++;                       /* create a new label */
-        *buf = label;                  /* give the pixel the label */
-        ufind[label] = label; /* put the label in the equivalence array */
-        largest[label] = 1;   /* the label has 1 pixel associated with it */
-    }
-    else {
-        *buf = 0;
+    if (!w || !h) {
+        return 0;
     }
-    buf++;
 
-    /* special case for first row.
-           Go over the first row except the first pixel.
-    */
-    for (x = 1; x < w; x++) {
-        if (bitmask_getbit(input, x, 0)) {
-            if (*(buf - 1)) { /* d label */
-                *buf = *(buf - 1);
-            }
-            else { /* create label */
-                label++;
-                *buf = label;
-                ufind[label] = label;
-                largest[label] = 0;
-            }
-            largest[*buf]++;
-        }
-        else {
-            *buf = 0;
-        }
-        buf++;
-    }
+    for (y = 0; y < h; ++y) {
+        int open = -1; /* start of a run carried over from the last word */
 
-    /* the rest of the image */
-    for (y = 1; y < h; y++) {
-        /* first pixel of the row */
-        if (bitmask_getbit(input, 0, y)) {
-            if (*(buf - w)) { /* b label */
-                *buf = *(buf - w);
-            }
-            else if (*(buf - w + 1)) { /* c label */
-                *buf = *(buf - w + 1);
-            }
-            else { /* create label */
-                label++;
-                *buf = label;
-                ufind[label] = label;
-                largest[label] = 0;
+        row_start = labels->nruns;
+        for (k = 0; k < nwords; ++k) {
+            BITMASK_W word = mask->bits[k * h + y];
+            int base = k * (int)BITMASK_W_LEN;
+
+            if (k == nwords - 1) {
+                word &= endmask;
             }
-            largest[*buf]++;
-        }
-        else {
-            *buf = 0;
-        }
-        buf++;
-        /* middle pixels of the row */
-        for (x = 1; x < (w - 1); x++) {
-            if (bitmask_getbit(input, x, y)) {
-                if (*(buf - w)) { /* b label */
-                    *buf = *(buf - w);
-                }
-                else if (*(buf - w + 1)) { /* c branch of tree */
-                    if (*(buf - w - 1)) {  /* union(c, a) */
-                        croot = root = *(buf - w + 1);
-                        while (ufind[root] < root) { /* find root */
-                            root = ufind[root];
-                        }
-                        if (croot != *(buf - w - 1)) {
-                            temp = aroot = *(buf - w - 1);
-                            while (ufind[aroot] < aroot) { /* find root */
-                                aroot = ufind[aroot];
-                            }
-                            if (root > aroot) {
-                                root = aroot;
-                            }
-                            while (ufind[temp] > root) { /* set root */
-                                aroot = ufind[temp];
-                                ufind[temp] = root;
-                                temp = aroot;
-                            }
-                        }
-                        while (ufind[croot] > root) { /* set root */
-                            temp = ufind[croot];
-                            ufind[croot] = root;
-                            croot = temp;
-                        }
-                        *buf = root;
+            for (;;) {
+                int bit;
+                if (open >= 0) {
+                    if (!~word) {
+                        break; /* the run goes on into the next word */
                     }
-                    else if (*(buf - 1)) { /* union(c, d) */
-                        croot = root = *(buf - w + 1);
-                        while (ufind[root] < root) { /* find root */
-                            root = ufind[root];
-                        }
-                        if (croot != *(buf - 1)) {
-                            temp = aroot = *(buf - 1);
-                            while (ufind[aroot] < aroot) { /* find root */
-                                aroot = ufind[aroot];
-                            }
-                            if (root > aroot) {
-                                root = aroot;
-                            }
-                            while (ufind[temp] > root) { /* set root */
-                                aroot = ufind[temp];
-                                ufind[temp] = root;
-                                temp = aroot;
-                            }
-                        }
-                        while (ufind[croot] > root) { /* set root */
-                            temp = ufind[croot];
-                            ufind[croot] = root;
-                            croot = temp;
-                        }
-                        *buf = root;
+                    bit = CC_CTZ(~word);
+                    if (cc_add_run(labels, &capacity, open, base + bit, y)) {
+                        cc_labels_free(labels);
+                        return -2;
                     }
-                    else { /* c label */
-                        *buf = *(buf - w + 1);
-                    }
-                }
-                else if (*(buf - w - 1)) { /* a label */
-                    *buf = *(buf - w - 1);
-                }
-                else if (*(buf - 1)) { /* d label */
-                    *buf = *(buf - 1);
+                    open = -1;
+                    word &= ~(BITMASK_N(bit) - 1);
                 }
-                else { /* create label */
-                    label++;
-                    *buf = label;
-                    ufind[label] = label;
-                    largest[label] = 0;
+                if (!word) {
+                    break;
                 }
-                largest[*buf]++;
-            }
-            else {
-                *buf = 0;
+                bit = CC_CTZ(word);
+                open = base + bit;
+                word |= BITMASK_N(bit) - 1;
             }
-            buf++;
         }
-        /* last pixel of the row, if its not also the first pixel of the row */
-        if (w > 1) {
-            if (bitmask_getbit(input, x, y)) {
-                if (*(buf - w)) { /* b label */
-                    *buf = *(buf - w);
-                }
-                else if (*(buf - w - 1)) { /* a label */
-                    *buf = *(buf - w - 1);
-                }
-                else if (*(buf - 1)) { /* d label */
-                    *buf = *(buf - 1);
+        if (open >= 0 && cc_add_run(labels, &capacity, open, w, y)) {
+            cc_labels_free(labels);
+            return -2;
+        }
+
+        /* join each run to the runs above it, both rows are sorted by x */
+        if (y > 0) {
+            p = prev_start;
+            for (i = row_start; i < labels->nruns; ++i) {
+                cc_run *run = labels->runs + i;
+                while (p < row_start && labels->runs[p].x1 < run->x0) {
+                    ++p;
                 }
-                else { /* create label */
-                    label++;
-                    *buf = label;
-                    ufind[label] = label;
-                    largest[label] = 0;
+                for (j = p; j < row_start && labels->runs[j].x0 <= run->x1;
+                     ++j) {
+                    cc_union(labels->runs, i, j);
                 }
-                largest[*buf]++;
+            }
+        }
+        prev_start = row_start;
+    }
+
+    /* Number the components in the order of their root runs. A root's
+     * parent is itself and every other run's parent comes before it and
+     * already holds its component index. */
+    for (i = 0; i < labels->nruns; ++i) {
+        p = labels->runs[i].label;
+        labels->runs[i].label =
+            (p == i) ? labels->ncomps++ : labels->runs[p].label;
+    }
+    if (labels->ncomps == 0) {
+        return 0;
+    }
+
+    labels->comps =
+        (cc_component *)calloc(labels->ncomps, sizeof(cc_component));
+    if (!labels->comps) {
+        cc_labels_free(labels);
+        return -2;
+    }
+    for (i = 0; i < labels->nruns; ++i) {
+        cc_run *run = labels->runs + i;
+        long n = run->x1 - run->x0;
+        comp = labels->comps + run->label;
+        if (!comp->area) {
+            comp->x0 = run->x0;
+            comp->y0 = run->y;
+            comp->x1 = run->x1;
+        }
+        comp->x0 = MIN(comp->x0, run->x0);
+        comp->x1 = MAX(comp->x1, run->x1);
+        comp->y1 = run->y + 1;
+        comp->area += n;
+        comp->sumx += (Sint64)n * (run->x0 + run->x1 - 1) / 2;
+        comp->sumy += (Sint64)n * run->y;
+    }
+
+    /* drop the components below the minimum size */
+    if (min > 1) {
+        int *remap = (int *)malloc(sizeof(int) * labels->ncomps);
+        if (!remap) {
+            cc_labels_free(labels);
+            return -2;
+        }
+        for (i = j = 0; i < labels->ncomps; ++i) {
+            if (labels->comps[i].area >= min) {
+                labels->comps[j] = labels->comps[i];
+                remap[i] = j++;
             }
             else {
-                *buf = 0;
+                remap[i] = -1;
             }
-            buf++;
         }
+        for (i = 0; i < labels->nruns; ++i) {
+            labels->runs[i].label = remap[labels->runs[i].label];
+        }
+        labels->ncomps = j;
+        free(remap);
     }
 
-    return label;
+    return 0;
+}
+
+/* Sets the bits of the run [x0, x1) in row y of mask m */
+static void
+cc_set_run(bitmask_t *m, int x0, int x1, int y)
+{
+    BITMASK_W *word = m->bits + (x0 / BITMASK_W_LEN) * m->h + y;
+    BITMASK_W first = ~(BITMASK_W)0 << (x0 & BITMASK_W_MASK);
+    BITMASK_W last =
+        ~(BITMASK_W)0 >> (BITMASK_W_MASK - ((x1 - 1) & BITMASK_W_MASK));
+    int k, k1 = (x1 - 1) / BITMASK_W_LEN;
+
+    k = x0 / BITMASK_W_LEN;
+    if (k == k1) {
+        *word |= first & last;
+        return;
+    }
+    *word |= first;
+    for (++k; k < k1; ++k) {
+        word += m->h;
+        *word = ~(BITMASK_W)0;
+    }
+    word += m->h;
+    *word |= last;
+}
+
+/* Draws the component with the given index into m */
+static void
+cc_draw_component(bitmask_t *m, const cc_labels *labels, int index)
+{
+    int i;
+
+    for (i = 0; i < labels->nruns; ++i) {
+        const cc_run *run = labels->runs + i;
+        if (run->label == index) {
+            cc_set_run(m, run->x0, run->x1, run->y);
+        }
+    }
 }
 
 /* Creates a bounding rect for each connected component in the given mask.
@@ -1226,107 +1656,39 @@ static int
 get_bounding_rects(bitmask_t *input, int *num_bounding_boxes,
                    GAME_Rect **ret_rects)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    int x, y, w, h, temp, label, relabel;
-    GAME_Rect *rects;
-
-    rects = NULL;
-    label = 0;
+    cc_labels labels;
+    GAME_Rect *rects = NULL;
+    int i;
 
-    w = input->w;
-    h = input->h;
+    *num_bounding_boxes = 0;
+    *ret_rects = NULL;
 
-    if (!w || !h) {
-        *ret_rects = rects;
-        return 0;
-    }
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *)malloc(sizeof(int) * w * h);
-    if (!image) {
-        return -2;
-    }
-
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!ufind) {
-        return -2;
-    }
-
-    largest = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!largest) {
+    if (cc_label_runs(input, 0, &labels)) {
         return -2;
     }
-
-    /* do the initial labelling */
-    label = cc_label(input, image, ufind, largest);
-
-    relabel = 0;
-    /* flatten and relabel the union-find equivalence array.  Start at label 1
-       because label 0 indicates an unset pixel.  For this reason, we also use
-       <= label rather than < label. */
-    for (x = 1; x <= label; x++) {
-        if (ufind[x] < x) {             /* is it a union find root? */
-            ufind[x] = ufind[ufind[x]]; /* relabel it to its root */
-        }
-        else { /* its a root */
-            relabel++;
-            ufind[x] = relabel; /* assign the lowest label available */
-        }
-    }
-
-    *num_bounding_boxes = relabel;
-
-    if (relabel == 0) {
+    if (labels.ncomps == 0) {
         /* early out, as we didn't find anything. */
-        free(image);
-        free(ufind);
-        free(largest);
-        *ret_rects = rects;
+        cc_labels_free(&labels);
         return 0;
     }
 
-    /* the bounding rects, need enough space for the number of labels */
-    rects = (GAME_Rect *)malloc(sizeof(GAME_Rect) * (relabel + 1));
+    /* the first rect is at index 1, as it was for the old labels */
+    rects = (GAME_Rect *)malloc(sizeof(GAME_Rect) * (labels.ncomps + 1));
     if (!rects) {
+        cc_labels_free(&labels);
         return -2;
     }
-
-    for (temp = 0; temp <= relabel; temp++) {
-        rects[temp].h = 0; /* so we know if its a new rect or not */
-    }
-
-    /* find the bounding rect of each connected component */
-    buf = image;
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf]) { /* if the pixel is part of a component */
-                if (rects[ufind[*buf]].h) { /* the component has a rect */
-                    temp = rects[ufind[*buf]].x;
-                    rects[ufind[*buf]].x = MIN(x, temp);
-                    rects[ufind[*buf]].y = MIN(y, rects[ufind[*buf]].y);
-                    rects[ufind[*buf]].w =
-                        MAX(rects[ufind[*buf]].w + temp, x + 1) -
-                        rects[ufind[*buf]].x;
-                    rects[ufind[*buf]].h = MAX(rects[ufind[*buf]].h,
-                                               y - rects[ufind[*buf]].y + 1);
-                }
-                else { /* otherwise, start the rect */
-                    rects[ufind[*buf]].x = x;
-                    rects[ufind[*buf]].y = y;
-                    rects[ufind[*buf]].w = 1;
-                    rects[ufind[*buf]].h = 1;
-                }
-            }
-            buf++;
-        }
+    for (i = 0; i < labels.ncomps; ++i) {
+        cc_component *comp = labels.comps + i;
+        rects[i + 1].x = comp->x0;
+        rects[i + 1].y = comp->y0;
+        rects[i + 1].w = comp->x1 - comp->x0;
+        rects[i + 1].h = comp->y1 - comp->y0;
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    *num_bounding_boxes = labels.ncomps;
     *ret_rects = rects;
-
+    cc_labels_free(&labels);
     return 0;
 }
 
@@ -1395,108 +1757,52 @@ mask_get_bounding_rects(PyObject *self, PyObject *args)
 static int
 get_connected_components(bitmask_t *mask, bitmask_t ***components, int min)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    int x, y, w, h, label, relabel;
+    cc_labels labels;
     bitmask_t **comps;
+    int i, n;
 
-    label = 0;
-
-    w = mask->w;
-    h = mask->h;
-
-    if (!w || !h) {
-        return 0;
-    }
-
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *)malloc(sizeof(int) * w * h);
-    if (!image) {
-        return -2;
-    }
-
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!ufind) {
-        free(image);
+    if (cc_label_runs(mask, min, &labels)) {
         return -2;
     }
-
-    largest = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!largest) {
-        free(image);
-        free(ufind);
-        return -2;
-    }
-
-    /* do the initial labelling */
-    label = cc_label(mask, image, ufind, largest);
-
-    for (x = 1; x <= label; x++) {
-        if (ufind[x] < x) {
-            largest[ufind[x]] += largest[x];
-        }
-    }
-
-    relabel = 0;
-    /* flatten and relabel the union-find equivalence array.  Start at label 1
-       because label 0 indicates an unset pixel.  For this reason, we also use
-       <= label rather than < label. */
-    for (x = 1; x <= label; x++) {
-        if (ufind[x] < x) {             /* is it a union find root? */
-            ufind[x] = ufind[ufind[x]]; /* relabel it to its root */
-        }
-        else { /* its a root */
-            if (largest[x] >= min) {
-                relabel++;
-                ufind[x] = relabel; /* assign the lowest label available */
-            }
-            else {
-                ufind[x] = 0;
-            }
-        }
-    }
-
-    if (relabel == 0) {
+    n = labels.ncomps;
+    if (n == 0) {
         /* early out, as we didn't find anything. */
-        free(image);
-        free(ufind);
-        free(largest);
+        cc_labels_free(&labels);
         return 0;
     }
 
     /* allocate space for the mask array */
-    comps = (bitmask_t **)malloc(sizeof(bitmask_t *) * (relabel + 1));
+    comps = (bitmask_t **)malloc(sizeof(bitmask_t *) * (n + 1));
     if (!comps) {
-        free(image);
-        free(ufind);
-        free(largest);
+        cc_labels_free(&labels);
         return -2;
     }
 
     /* create the empty masks */
-    for (x = 1; x <= relabel; x++) {
-        comps[x] = bitmask_create(w, h);
-    }
-
-    /* set the bits in each mask */
-    buf = image;
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf]) { /* if the pixel is part of a component */
-                bitmask_setbit(comps[ufind[*buf]], x, y);
+    for (i = 1; i <= n; ++i) {
+        comps[i] = bitmask_create(mask->w, mask->h);
+        if (!comps[i]) {
+            while (--i > 0) {
+                bitmask_free(comps[i]);
             }
-            buf++;
+            free(comps);
+            cc_labels_free(&labels);
+            return -2;
         }
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    /* set the bits of each run in its component's mask */
+    for (i = 0; i < labels.nruns; ++i) {
+        cc_run *run = labels.runs + i;
+        if (run->label >= 0) {
+            cc_set_run(comps[run->label + 1], run->x0, run->x1, run->y);
+        }
+    }
 
+    cc_labels_free(&labels);
     *components = comps;
 
-    return relabel;
+    return n;
 }
 
 static PyObject *
@@ -1556,9 +1862,9 @@ mask_connected_components(PyObject *self, PyObject *args)
 
 /* Finds the largest connected component in a given mask.
  *
- * Tracks the number of pixels in each label, finding the biggest one while
- * flattening the union-find equivalence array. It then writes an output mask
- * containing only the largest connected component.
+ * Labels the components of the input mask and writes the largest one, or
+ * the one containing the given bit, to the output mask. Of several
+ * components with the same largest size, the first in raster order wins.
  *
  * Params:
  *     input - mask to search in for the largest connected component
@@ -1575,69 +1881,88 @@ mask_connected_components(PyObject *self, PyObject *args)
 static int
 largest_connected_comp(bitmask_t *input, bitmask_t *output, int ccx, int ccy)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    unsigned int max, x, y, w, h, label;
-
-    w = input->w;
-    h = input->h;
+    cc_labels labels;
+    int i, index = -1;
 
-    if (!w || !h) {
-        return 0;
+    if (cc_label_runs(input, 0, &labels)) {
+        return -2;
     }
 
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *)malloc(sizeof(int) * w * h);
-    if (!image) {
-        return -2;
+    if (ccx >= 0) {
+        for (i = 0; i < labels.nruns; ++i) {
+            cc_run *run = labels.runs + i;
+            if (run->y == ccy && run->x0 <= ccx && ccx < run->x1) {
+                index = run->label;
+                break;
+            }
+        }
     }
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!ufind) {
-        free(image);
-        return -2;
+    else {
+        for (i = 0; i < labels.ncomps; ++i) {
+            if (index < 0 || labels.comps[i].area > labels.comps[index].area) {
+                index = i;
+            }
+        }
     }
-    /* an array to track the number of pixels associated with each label */
-    largest = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!largest) {
-        free(image);
-        free(ufind);
-        return -2;
+
+    if (index >= 0) {
+        cc_draw_component(output, &labels, index);
     }
 
-    /* do the initial labelling */
-    label = cc_label(input, image, ufind, largest);
+    cc_labels_free(&labels);
+    return 0;
+}
 
-    max = 1;
-    /* flatten the union-find equivalence array */
-    for (x = 2; x <= label; x++) {
-        if (ufind[x] != x) {                 /* is it a union find root? */
-            largest[ufind[x]] += largest[x]; /* add its pixels to its root */
-            ufind[x] = ufind[ufind[x]];      /* relabel it to its root */
-        }
-        if (largest[ufind[x]] > largest[max]) { /* is it the new biggest? */
-            max = ufind[x];
-        }
+static PyObject *
+mask_get_component_stats(PyObject *self, PyObject *args)
+{
+    bitmask_t *mask = pgMask_AsBitmap(self);
+    PyObject *stats_list, *stats, *rect;
+    cc_labels labels;
+    int i, r, min = 0; /* Default min value. */
+
+    if (!PyArg_ParseTuple(args, "|i", &min)) {
+        return NULL; /* Exception already set. */
     }
 
-    /* write out the final image */
-    buf = image;
-    if (ccx >= 0)
-        max = ufind[*(buf + ccy * w + ccx)];
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf] == max) {         /* if the label is the max one */
-                bitmask_setbit(output, x, y); /* set the bit in the mask */
-            }
-            buf++;
-        }
+    Py_BEGIN_ALLOW_THREADS;
+    r = cc_label_runs(mask, min, &labels);
+    Py_END_ALLOW_THREADS;
+
+    if (r == -2) {
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory for connected components");
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    stats_list = PyList_New(labels.ncomps);
+    if (!stats_list) {
+        cc_labels_free(&labels);
+        return NULL; /* Exception already set. */
+    }
 
-    return 0;
+    for (i = 0; i < labels.ncomps; ++i) {
+        cc_component *comp = labels.comps + i;
+
+        rect = pgRect_New4(comp->x0, comp->y0, comp->x1 - comp->x0,
+                           comp->y1 - comp->y0);
+        if (!rect) {
+            cc_labels_free(&labels);
+            Py_DECREF(stats_list);
+            return NULL; /* Exception already set. */
+        }
+        stats = Py_BuildValue("(lN(ll))", comp->area, rect,
+                              (long)(comp->sumx / comp->area),
+                              (long)(comp->sumy / comp->area));
+        if (!stats) {
+            cc_labels_free(&labels);
+            Py_DECREF(stats_list);
+            return NULL; /* Exception already set. */
+        }
+        PyList_SET_ITEM(stats_list, i, stats);
+    }
+
+    cc_labels_free(&labels);
+    return stats_list;
 }
 
 static PyObject *
@@ -1887,6 +2212,8 @@ static PyMethodDef mask_methods[] = {
      DOC_MASKCONNECTEDCOMPONENTS},
     {"get_bounding_rects", mask_get_bounding_rects, METH_NOARGS,
      DOC_MASKGETBOUNDINGRECTS},
+    {"get_component_stats", mask_get_component_stats, METH_VARARGS,
+     DOC_MASKGETCOMPONENTSTATS},
     {"to_surface", (PyCFunction)mask_to_surface, METH_VARARGS | METH_KEYWORDS,
      DOC_MASKTOSURFACE},
 
@@ -2129,11 +2456,116 @@ static PyTypeObject pgMask_Type = {
 };
 
 /*mask module methods*/
+
+static PyObject *
+mask_get_overlap_backend(PyObject *self, PyObject *args)
+{
+    return Text_FromUTF8(pg_backend_name(bitmask_get_backend()));
+}
+
+static PyObject *
+mask_set_overlap_backend(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"type", NULL};
+    const char *type;
+    int status;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s:_set_overlap_backend",
+                                     keywords, &type)) {
+        return NULL;
+    }
+
+    status = pg_backend_set(type, bitmask_set_backend);
+    if (status) {
+        return pg_backend_error(type, status);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mask_get_threads(PyObject *self, PyObject *args)
+{
+    return PyInt_FromLong(mask_pool.threads);
+}
+
+static PyObject *
+mask_set_threads(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"count", NULL};
+    static int quit_registered = 0;
+    int count;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:_set_threads", keywords,
+                                     &count)) {
+        return NULL;
+    }
+    if (count < 0) {
+        return RAISE(PyExc_ValueError, "count must not be negative");
+    }
+    if (pg_pool_set_threads(&mask_pool, count)) {
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    if (!quit_registered && mask_pool.threads > 1) {
+        pg_RegisterQuit(_mask_quit_threads);
+        quit_registered = 1;
+    }
+    Py_RETURN_NONE;
+}
+static PyObject *
+mask_set_cache_size(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"size", NULL};
+    int size;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:set_cache_size",
+                                     keywords, &size)) {
+        return NULL;
+    }
+    if (size < 0) {
+        return RAISE(PyExc_ValueError, "size must not be negative");
+    }
+    pg_surface_cache_resize(&mask_cache, (size_t)size);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mask_get_cache_size(PyObject *self, PyObject *args)
+{
+    return PyInt_FromLong((long)mask_cache.budget);
+}
+
+static PyObject *
+mask_clear_cache(PyObject *self, PyObject *args)
+{
+    _mask_cache_clear();
+    Py_RETURN_NONE;
+}
+
 static PyMethodDef _mask_methods[] = {
     {"from_surface", mask_from_surface, METH_VARARGS,
      DOC_PYGAMEMASKFROMSURFACE},
     {"from_threshold", mask_from_threshold, METH_VARARGS,
      DOC_PYGAMEMASKFROMTHRESHOLD},
+    {"set_cache_size", (PyCFunction)mask_set_cache_size,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEMASKSETCACHESIZE},
+    {"get_cache_size", mask_get_cache_size, METH_NOARGS,
+     DOC_PYGAMEMASKGETCACHESIZE},
+    {"clear_cache", mask_clear_cache, METH_NOARGS, DOC_PYGAMEMASKCLEARCACHE},
+    {"_get_overlap_backend", mask_get_overlap_backend, METH_NOARGS,
+     "_get_overlap_backend() -> String\n"
+     "return the overlap test version in use: 'GENERIC', 'SSE2' or 'AVX2'"},
+    {"_set_overlap_backend", (PyCFunction)mask_set_overlap_backend,
+     METH_VARARGS | METH_KEYWORDS,
+     "_set_overlap_backend(type) -> None\n"
+     "set the overlap test version to one of: 'GENERIC', 'SSE2' or 'AVX2'"},
+    {"_get_threads", mask_get_threads, METH_NOARGS,
+     "_get_threads() -> int\n"
+     "return how many threads from_surface and from_threshold may use"},
+    {"_set_threads", (PyCFunction)mask_set_threads,
+     METH_VARARGS | METH_KEYWORDS,
+     "_set_threads(count) -> None\n"
+     "let from_surface and from_threshold use count threads, "
+     "0 for one per CPU"},
     {NULL, NULL, 0, NULL}};
 
 MODINIT_DEFINE(mask)
@@ -2178,6 +2610,9 @@ MODINIT_DEFINE(mask)
         MODINIT_ERROR;
     }
 
+    /* use the widest overlap kernels the CPU can run */
+    pg_backend_set_best(bitmask_set_backend);
+
     /* create the module */
 #if PY3
     module = PyModule_Create(&_module);
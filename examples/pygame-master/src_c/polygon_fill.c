@@ -0,0 +1,423 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "polygon_fill.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+/* An edge of an aliased polygon. Its intersection with scanline y is
+ *
+ *     trunc(a * (y - top) / dy) * mul + base
+ *
+ * which is stepped from one scanline to the next by keeping the floored
+ * quotient and remainder of the division, like a Bresenham line.
+ */
+typedef struct {
+    int top, bottom;
+    Sint64 a, dy, mul, base;
+    Sint64 q, r;         /* floor(a * (y - top) / dy) and its remainder */
+    Sint64 qstep, rstep; /* floor(a / dy) and a - qstep * dy */
+    int x;               /* intersection with the current scanline */
+} PolyEdge;
+
+/* An edge of an anti-aliased polygon, stepped once per sub-scanline. */
+typedef struct {
+    double top, bottom;
+    double x0, y0, dxdy;
+    double x;
+} PolyEdgeAA;
+
+static int
+_poly_compare_top(const void *a, const void *b)
+{
+    int ta = ((const PolyEdge *)a)->top;
+    int tb = ((const PolyEdge *)b)->top;
+
+    return (ta > tb) - (ta < tb);
+}
+
+static int
+_poly_compare_top_aa(const void *a, const void *b)
+{
+    double ta = ((const PolyEdgeAA *)a)->top;
+    double tb = ((const PolyEdgeAA *)b)->top;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/* Position edge e on scanline y, where y >= e->top. */
+static void
+_poly_edge_start(PolyEdge *e, int y)
+{
+    Uint64 k = (Uint64)((Sint64)y - e->top);
+    /* rstep < dy and k <= dy, so this cannot overflow for 32 bit input */
+    Uint64 rk = (Uint64)e->rstep * k;
+
+    e->q = e->qstep * (Sint64)k + (Sint64)(rk / (Uint64)e->dy);
+    e->r = (Sint64)(rk % (Uint64)e->dy);
+}
+
+int
+pg_fill_polygon(const int *vx, const int *vy, int n, int top, int bottom,
+                int mode, pg_poly_span_func span, void *data)
+{
+    PolyEdge *edges, *e;
+    PolyEdge **active;
+    int *xs;
+    int i, j, y, miny, maxy;
+    int nedges = 0, nactive = 0, next = 0;
+
+    if (n < 3) {
+        return 0;
+    }
+
+    miny = maxy = vy[0];
+    for (i = 1; i < n; i++) {
+        if (vy[i] < miny) {
+            miny = vy[i];
+        }
+        else if (vy[i] > maxy) {
+            maxy = vy[i];
+        }
+    }
+    if (top < miny) {
+        top = miny;
+    }
+    if (bottom > maxy) {
+        bottom = maxy;
+    }
+    if (top > bottom) {
+        return 0;
+    }
+
+    edges = (PolyEdge *)malloc(sizeof(PolyEdge) * n);
+    active = (PolyEdge **)malloc(sizeof(PolyEdge *) * n);
+    xs = (int *)malloc(sizeof(int) * n);
+    if (!edges || !active || !xs) {
+        free(edges);
+        free(active);
+        free(xs);
+        return -1;
+    }
+
+    /* Build the edge table, leaving out horizontal edges and edges that
+     * cannot reach a visited scanline.
+     */
+    for (i = 0; i < n; i++) {
+        int prev = i ? i - 1 : n - 1;
+        int x1, y1, x2, y2;
+
+        if (vy[prev] < vy[i]) {
+            x1 = vx[prev];
+            y1 = vy[prev];
+            x2 = vx[i];
+            y2 = vy[i];
+        }
+        else if (vy[prev] > vy[i]) {
+            x1 = vx[i];
+            y1 = vy[i];
+            x2 = vx[prev];
+            y2 = vy[prev];
+        }
+        else {
+            continue;
+        }
+        if (y2 < top || y1 > bottom) {
+            continue;
+        }
+
+        e = edges + nedges++;
+        e->top = y1;
+        e->bottom = y2;
+        e->dy = (Sint64)y2 - y1;
+        if (mode == PG_POLY_FIXED16) {
+            e->a = 65536;
+            e->mul = (Sint64)x2 - x1;
+            e->base = (Sint64)x1 * 65536;
+        }
+        else {
+            e->a = (Sint64)x2 - x1;
+            e->mul = 1;
+            e->base = x1;
+        }
+        e->qstep = e->a / e->dy;
+        e->rstep = e->a % e->dy;
+        if (e->rstep < 0) {
+            e->qstep--;
+            e->rstep += e->dy;
+        }
+    }
+    qsort(edges, nedges, sizeof(PolyEdge), _poly_compare_top);
+
+    for (y = top; y <= bottom; y++) {
+        /* Retire finished edges. The last scanline of the polygon keeps
+         * the edges ending on it, so its bottom border gets drawn.
+         */
+        for (i = j = 0; i < nactive; i++) {
+            e = active[i];
+            if (e->bottom > y || (e->bottom == y && y == maxy)) {
+                active[j++] = e;
+            }
+        }
+        nactive = j;
+
+        /* On the first scanline this also picks up edges starting above
+         * top; after that only edges starting on y are left to add.
+         */
+        while (next < nedges && edges[next].top <= y) {
+            e = edges + next++;
+            if (e->bottom > y || (e->bottom == y && y == maxy)) {
+                _poly_edge_start(e, y);
+                active[nactive++] = e;
+            }
+        }
+
+        /* The table stays almost sorted between scanlines, so an
+         * insertion sort is close to linear here.
+         */
+        for (i = 0; i < nactive; i++) {
+            Sint64 t;
+
+            e = active[i];
+            t = e->q + (e->r != 0 && e->a < 0);
+            e->x = (int)(t * e->mul + e->base);
+            for (j = i; j > 0 && active[j - 1]->x > e->x; j--) {
+                active[j] = active[j - 1];
+            }
+            active[j] = e;
+        }
+        for (i = 0; i < nactive; i++) {
+            xs[i] = active[i]->x;
+        }
+
+        span(data, y, xs, nactive);
+
+        for (i = 0; i < nactive; i++) {
+            e = active[i];
+            e->q += e->qstep;
+            e->r += e->rstep;
+            if (e->r >= e->dy) {
+                e->q++;
+                e->r -= e->dy;
+            }
+        }
+    }
+
+    free(edges);
+    free(active);
+    free(xs);
+    return 0;
+}
+
+/* Add the sub-scanline span xa to xb, relative to the clip rect, to the
+ * coverage of a row. Whole pixels go into delta as a running sum.
+ */
+static void
+_poly_cover_span(float *cover, float *delta, int w, double xa, double xb,
+                 float weight, int *lo, int *hi)
+{
+    int ia, ib;
+
+    if (xa < 0.0) {
+        xa = 0.0;
+    }
+    if (xb > w) {
+        xb = w;
+    }
+    if (xa >= xb) {
+        return;
+    }
+
+    ia = (int)xa;
+    ib = (int)xb;
+    if (ia == ib) {
+        cover[ia] += (float)(xb - xa) * weight;
+    }
+    else {
+        cover[ia] += (float)(ia + 1 - xa) * weight;
+        delta[ia + 1] += weight;
+        delta[ib] -= weight;
+        if (ib < w) {
+            cover[ib] += (float)(xb - ib) * weight;
+        }
+        else {
+            ib = w - 1;
+        }
+    }
+    if (ia < *lo) {
+        *lo = ia;
+    }
+    if (ib > *hi) {
+        *hi = ib;
+    }
+}
+
+int
+pg_fill_polygon_aa(const double *vx, const double *vy, int n,
+                   const SDL_Rect *clip, pg_poly_cover_func cover_func,
+                   void *data)
+{
+    PolyEdgeAA *edges, *e;
+    PolyEdgeAA **active;
+    double *xs;
+    float *cover, *delta;
+    const float weight = 1.0f / PG_POLY_AA_SUBSAMPLES;
+    const double step = 1.0 / PG_POLY_AA_SUBSAMPLES;
+    double miny, maxy, first, last;
+    int i, j, s, y, top, bottom;
+    int nedges = 0, nactive = 0, next = 0;
+    int w = clip->w;
+
+    if (n < 3 || clip->w <= 0 || clip->h <= 0) {
+        return 0;
+    }
+
+    miny = maxy = vy[0];
+    for (i = 0; i < n; i++) {
+        /* x - x is only zero for finite x */
+        if (vx[i] - vx[i] != 0.0 || vy[i] - vy[i] != 0.0) {
+            return 0;
+        }
+        if (vy[i] < miny) {
+            miny = vy[i];
+        }
+        else if (vy[i] > maxy) {
+            maxy = vy[i];
+        }
+    }
+
+    /* Rows whose sub-scanlines can hit the polygon, clamped to the clip
+     * rect before converting to int.
+     */
+    first = floor(miny);
+    last = ceil(maxy) - 1.0;
+    if (first < clip->y) {
+        first = clip->y;
+    }
+    if (last > clip->y + clip->h - 1) {
+        last = clip->y + clip->h - 1;
+    }
+    if (first > last) {
+        return 0;
+    }
+    top = (int)first;
+    bottom = (int)last;
+
+    edges = (PolyEdgeAA *)malloc(sizeof(PolyEdgeAA) * n);
+    active = (PolyEdgeAA **)malloc(sizeof(PolyEdgeAA *) * n);
+    xs = (double *)malloc(sizeof(double) * n);
+    cover = (float *)calloc(w + 1, sizeof(float));
+    delta = (float *)calloc(w + 2, sizeof(float));
+    if (!edges || !active || !xs || !cover || !delta) {
+        free(edges);
+        free(active);
+        free(xs);
+        free(cover);
+        free(delta);
+        return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+        int prev = i ? i - 1 : n - 1;
+        int upper = vy[prev] < vy[i] ? prev : i;
+        int lower = vy[prev] < vy[i] ? i : prev;
+
+        if (vy[prev] == vy[i] || vy[lower] <= top ||
+            vy[upper] >= bottom + 1) {
+            continue;
+        }
+        e = edges + nedges++;
+        e->top = vy[upper];
+        e->bottom = vy[lower];
+        e->x0 = vx[upper];
+        e->y0 = vy[upper];
+        e->dxdy = (vx[lower] - vx[upper]) / (vy[lower] - vy[upper]);
+    }
+    qsort(edges, nedges, sizeof(PolyEdgeAA), _poly_compare_top_aa);
+
+    for (y = top; y <= bottom; y++) {
+        int lo = w, hi = -1;
+
+        for (s = 0; s < PG_POLY_AA_SUBSAMPLES; s++) {
+            double yc = y + (s + 0.5) * step;
+
+            for (i = j = 0; i < nactive; i++) {
+                e = active[i];
+                if (e->bottom > yc) {
+                    e->x += e->dxdy * step;
+                    active[j++] = e;
+                }
+            }
+            nactive = j;
+
+            while (next < nedges && edges[next].top <= yc) {
+                e = edges + next++;
+                if (e->bottom > yc) {
+                    e->x = e->x0 + (yc - e->y0) * e->dxdy;
+                    active[nactive++] = e;
+                }
+            }
+
+            for (i = 0; i < nactive; i++) {
+                e = active[i];
+                for (j = i; j > 0 && active[j - 1]->x > e->x; j--) {
+                    active[j] = active[j - 1];
+                }
+                active[j] = e;
+            }
+            for (i = 0; i < nactive; i++) {
+                xs[i] = active[i]->x - clip->x;
+            }
+            for (i = 0; i + 1 < nactive; i += 2) {
+                _poly_cover_span(cover, delta, w, xs[i], xs[i + 1], weight,
+                                 &lo, &hi);
+            }
+        }
+
+        if (lo <= hi) {
+            float acc = 0.0f;
+
+            for (i = lo; i <= hi; i++) {
+                acc += delta[i];
+                delta[i] = 0.0f;
+                cover[i] += acc;
+                if (cover[i] > 1.0f) {
+                    cover[i] = 1.0f;
+                }
+                else if (cover[i] < 0.0f) {
+                    cover[i] = 0.0f;
+                }
+            }
+            delta[hi + 1] = 0.0f;
+
+            cover_func(data, y, clip->x + lo, cover + lo, hi - lo + 1);
+
+            for (i = lo; i <= hi; i++) {
+                cover[i] = 0.0f;
+            }
+        }
+    }
+
+    free(edges);
+    free(active);
+    free(xs);
+    free(cover);
+    free(delta);
+    return 0;
+}
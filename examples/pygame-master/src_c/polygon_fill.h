@@ -0,0 +1,79 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Scanline polygon filler shared by draw.polygon and gfxdraw's
+ * filled/textured polygons.
+ *
+ * Edges are bucketed by their top scanline once and then kept in an active
+ * edge table whose x intersections are stepped incrementally, so filling
+ * costs O(N log N + H * active edges) instead of rescanning and sorting
+ * every edge on every scanline.
+ *
+ * The edge tables come from malloc, not PyMem, so draw.c and gfxdraw.c
+ * fill with the GIL released; the span and cover callbacks are called on
+ * the filling thread.
+ */
+#if !defined(POLYGON_FILL_HEADER)
+#define POLYGON_FILL_HEADER
+
+#include <SDL.h>
+
+/* Intersections are the truncated integer x of each edge. */
+#define PG_POLY_INT 0
+/* Intersections are 16.16 fixed point values, as SDL_gfx used. */
+#define PG_POLY_FIXED16 1
+
+/* Number of sub-scanlines sampled per row in anti-aliased mode. */
+#define PG_POLY_AA_SUBSAMPLES 16
+
+/* Called once per scanline with the edge intersections sorted ascending.
+ * Each pair xs[i], xs[i + 1] (i even) bounds one span inside the polygon.
+ */
+typedef void (*pg_poly_span_func)(void *data, int y, const int *xs,
+                                  int count);
+
+/* Called once per covered row in anti-aliased mode. cover[i] is the
+ * fraction, 0.0 to 1.0, of pixel (x + i, y) inside the polygon.
+ */
+typedef void (*pg_poly_cover_func)(void *data, int y, int x,
+                                   const float *cover, int count);
+
+/* Scan convert the polygon vx, vy with n vertices, using the even-odd rule.
+ * Only scanlines top to bottom, inclusive, are visited. Edges cover the
+ * scanlines from their upper vertex up to, but not including, the lower
+ * one, except on the polygon's last scanline, which includes the edges
+ * ending there.
+ *
+ * Returns 0 on success and -1 if memory could not be allocated.
+ */
+int
+pg_fill_polygon(const int *vx, const int *vy, int n, int top, int bottom,
+                int mode, pg_poly_span_func span, void *data);
+
+/* Anti-aliased version of pg_fill_polygon. Vertices are in continuous
+ * coordinates, where pixel (x, y) is the unit square with (x, y) as its top
+ * left corner. Only pixels inside clip are reported.
+ *
+ * Returns 0 on success and -1 if memory could not be allocated.
+ */
+int
+pg_fill_polygon_aa(const double *vx, const double *vy, int n,
+                   const SDL_Rect *clip, pg_poly_cover_func cover,
+                   void *data);
+
+#endif /* POLYGON_FILL_HEADER */
@@ -34,9 +34,32 @@
 
 #include <limits.h>
 
+/* Vector versions of the RectArray collide tests, picked at run time; see
+   simd_backend.h. */
+#include "simd_backend.h"
+
 static PyTypeObject pgRect_Type;
 #define pgRect_Check(x) ((x)->ob_type == &pgRect_Type)
 
+/* RectArray keeps its rects as four planes of ints, x, y, w then h, each
+   capacity long, so the collide tests can load several rects at once. */
+typedef struct {
+    PyObject_HEAD int *data;
+    Py_ssize_t length;
+    Py_ssize_t capacity;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+    int nexports; /* buffer views; the planes cannot move while > 0 */
+} pgRectArrayObject;
+
+static PyTypeObject pgRectArray_Type;
+#define pgRectArray_Check(x) (PyObject_TypeCheck((x), &pgRectArray_Type))
+
+#define RECTARRAY_X(a) ((a)->data)
+#define RECTARRAY_Y(a) ((a)->data + (a)->capacity)
+#define RECTARRAY_W(a) ((a)->data + 2 * (a)->capacity)
+#define RECTARRAY_H(a) ((a)->data + 3 * (a)->capacity)
+
 static int
 pg_rect_init(pgRectObject *, PyObject *, PyObject *);
 
@@ -231,6 +254,242 @@ _pg_do_rects_intersect(GAME_Rect *A, GAME_Rect *B)
             A->y + A->h > B->y);
 }
 
+/* RectArray collide kernels. Each writes the indices of up to max_hits
+   matching rects to hits, in order, and returns how many it wrote. The
+   tests are the same as Rect.colliderect() and Rect.collidepoint(). */
+typedef Py_ssize_t (*rectarray_rect_func)(pgRectArrayObject *, GAME_Rect *,
+                                          int *, Py_ssize_t);
+typedef Py_ssize_t (*rectarray_point_func)(pgRectArrayObject *, int, int,
+                                           int *, Py_ssize_t);
+
+static Py_ssize_t
+_rectarray_collide_rect_generic(pgRectArrayObject *self, GAME_Rect *r,
+                                int *hits, Py_ssize_t max_hits)
+{
+    int *x = RECTARRAY_X(self), *y = RECTARRAY_Y(self);
+    int *w = RECTARRAY_W(self), *h = RECTARRAY_H(self);
+    Py_ssize_t i, count = 0;
+
+    for (i = 0; i < self->length && count < max_hits; ++i) {
+        if (r->x < x[i] + w[i] && r->y < y[i] + h[i] && r->x + r->w > x[i] &&
+            r->y + r->h > y[i]) {
+            hits[count++] = (int)i;
+        }
+    }
+    return count;
+}
+
+static Py_ssize_t
+_rectarray_collide_point_generic(pgRectArrayObject *self, int px, int py,
+                                 int *hits, Py_ssize_t max_hits)
+{
+    int *x = RECTARRAY_X(self), *y = RECTARRAY_Y(self);
+    int *w = RECTARRAY_W(self), *h = RECTARRAY_H(self);
+    Py_ssize_t i, count = 0;
+
+    for (i = 0; i < self->length && count < max_hits; ++i) {
+        if (px >= x[i] && px < x[i] + w[i] && py >= y[i] && py < y[i] + h[i]) {
+            hits[count++] = (int)i;
+        }
+    }
+    return count;
+}
+
+/* Appends the lanes set in bits, starting at index first. */
+#define RECTARRAY_EMIT_HITS(bits, first)                   \
+    for (k = 0; (bits) && count < max_hits; ++k, (bits) >>= 1) { \
+        if ((bits)&1) {                                    \
+            hits[count++] = (int)((first) + k);            \
+        }                                                  \
+    }
+
+#ifdef PG_HAS_SSE2
+static Py_ssize_t
+_rectarray_collide_rect_sse2(pgRectArrayObject *self, GAME_Rect *r,
+                             int *hits, Py_ssize_t max_hits)
+{
+    int *x = RECTARRAY_X(self), *y = RECTARRAY_Y(self);
+    int *w = RECTARRAY_W(self), *h = RECTARRAY_H(self);
+    __m128i left = _mm_set1_epi32(r->x), top = _mm_set1_epi32(r->y);
+    __m128i right = _mm_set1_epi32(r->x + r->w);
+    __m128i bottom = _mm_set1_epi32(r->y + r->h);
+    __m128i vx, vy, m;
+    Py_ssize_t i, count = 0;
+    int k, bits;
+
+    for (i = 0; i + 4 <= self->length && count < max_hits; i += 4) {
+        vx = _mm_loadu_si128((__m128i *)(x + i));
+        vy = _mm_loadu_si128((__m128i *)(y + i));
+        m = _mm_cmpgt_epi32(
+            _mm_add_epi32(vx, _mm_loadu_si128((__m128i *)(w + i))), left);
+        m = _mm_and_si128(
+            m, _mm_cmpgt_epi32(
+                   _mm_add_epi32(vy, _mm_loadu_si128((__m128i *)(h + i))),
+                   top));
+        m = _mm_and_si128(m, _mm_cmpgt_epi32(right, vx));
+        m = _mm_and_si128(m, _mm_cmpgt_epi32(bottom, vy));
+        bits = _mm_movemask_ps(_mm_castsi128_ps(m));
+        RECTARRAY_EMIT_HITS(bits, i)
+    }
+    for (; i < self->length && count < max_hits; ++i) {
+        if (r->x < x[i] + w[i] && r->y < y[i] + h[i] && r->x + r->w > x[i] &&
+            r->y + r->h > y[i]) {
+            hits[count++] = (int)i;
+        }
+    }
+    return count;
+}
+
+static Py_ssize_t
+_rectarray_collide_point_sse2(pgRectArrayObject *self, int px, int py,
+                              int *hits, Py_ssize_t max_hits)
+{
+    int *x = RECTARRAY_X(self), *y = RECTARRAY_Y(self);
+    int *w = RECTARRAY_W(self), *h = RECTARRAY_H(self);
+    __m128i vpx = _mm_set1_epi32(px), vpy = _mm_set1_epi32(py);
+    __m128i vx, vy, m;
+    Py_ssize_t i, count = 0;
+    int k, bits;
+
+    for (i = 0; i + 4 <= self->length && count < max_hits; i += 4) {
+        vx = _mm_loadu_si128((__m128i *)(x + i));
+        vy = _mm_loadu_si128((__m128i *)(y + i));
+        m = _mm_andnot_si128(
+            _mm_cmpgt_epi32(vx, vpx),
+            _mm_cmpgt_epi32(
+                _mm_add_epi32(vx, _mm_loadu_si128((__m128i *)(w + i))),
+                vpx));
+        m = _mm_and_si128(
+            m, _mm_andnot_si128(
+                   _mm_cmpgt_epi32(vy, vpy),
+                   _mm_cmpgt_epi32(
+                       _mm_add_epi32(vy,
+                                     _mm_loadu_si128((__m128i *)(h + i))),
+                       vpy)));
+        bits = _mm_movemask_ps(_mm_castsi128_ps(m));
+        RECTARRAY_EMIT_HITS(bits, i)
+    }
+    for (; i < self->length && count < max_hits; ++i) {
+        if (px >= x[i] && px < x[i] + w[i] && py >= y[i] && py < y[i] + h[i]) {
+            hits[count++] = (int)i;
+        }
+    }
+    return count;
+}
+#endif /* PG_HAS_SSE2 */
+
+#ifdef PG_HAS_AVX2
+PG_FUNCTION_TARGET_AVX2 static Py_ssize_t
+_rectarray_collide_rect_avx2(pgRectArrayObject *self, GAME_Rect *r,
+                             int *hits, Py_ssize_t max_hits)
+{
+    int *x = RECTARRAY_X(self), *y = RECTARRAY_Y(self);
+    int *w = RECTARRAY_W(self), *h = RECTARRAY_H(self);
+    __m256i left = _mm256_set1_epi32(r->x), top = _mm256_set1_epi32(r->y);
+    __m256i right = _mm256_set1_epi32(r->x + r->w);
+    __m256i bottom = _mm256_set1_epi32(r->y + r->h);
+    __m256i vx, vy, m;
+    Py_ssize_t i, count = 0;
+    int k, bits;
+
+    for (i = 0; i + 8 <= self->length && count < max_hits; i += 8) {
+        vx = _mm256_loadu_si256((__m256i *)(x + i));
+        vy = _mm256_loadu_si256((__m256i *)(y + i));
+        m = _mm256_cmpgt_epi32(
+            _mm256_add_epi32(vx, _mm256_loadu_si256((__m256i *)(w + i))),
+            left);
+        m = _mm256_and_si256(
+            m, _mm256_cmpgt_epi32(
+                   _mm256_add_epi32(vy,
+                                    _mm256_loadu_si256((__m256i *)(h + i))),
+                   top));
+        m = _mm256_and_si256(m, _mm256_cmpgt_epi32(right, vx));
+        m = _mm256_and_si256(m, _mm256_cmpgt_epi32(bottom, vy));
+        bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        RECTARRAY_EMIT_HITS(bits, i)
+    }
+    for (; i < self->length && count < max_hits; ++i) {
+        if (r->x < x[i] + w[i] && r->y < y[i] + h[i] && r->x + r->w > x[i] &&
+            r->y + r->h > y[i]) {
+            hits[count++] = (int)i;
+        }
+    }
+    return count;
+}
+
+PG_FUNCTION_TARGET_AVX2 static Py_ssize_t
+_rectarray_collide_point_avx2(pgRectArrayObject *self, int px, int py,
+                              int *hits, Py_ssize_t max_hits)
+{
+    int *x = RECTARRAY_X(self), *y = RECTARRAY_Y(self);
+    int *w = RECTARRAY_W(self), *h = RECTARRAY_H(self);
+    __m256i vpx = _mm256_set1_epi32(px), vpy = _mm256_set1_epi32(py);
+    __m256i vx, vy, m;
+    Py_ssize_t i, count = 0;
+    int k, bits;
+
+    for (i = 0; i + 8 <= self->length && count < max_hits; i += 8) {
+        vx = _mm256_loadu_si256((__m256i *)(x + i));
+        vy = _mm256_loadu_si256((__m256i *)(y + i));
+        m = _mm256_andnot_si256(
+            _mm256_cmpgt_epi32(vx, vpx),
+            _mm256_cmpgt_epi32(
+                _mm256_add_epi32(vx, _mm256_loadu_si256((__m256i *)(w + i))),
+                vpx));
+        m = _mm256_and_si256(
+            m, _mm256_andnot_si256(
+                   _mm256_cmpgt_epi32(vy, vpy),
+                   _mm256_cmpgt_epi32(
+                       _mm256_add_epi32(
+                           vy, _mm256_loadu_si256((__m256i *)(h + i))),
+                       vpy)));
+        bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        RECTARRAY_EMIT_HITS(bits, i)
+    }
+    for (; i < self->length && count < max_hits; ++i) {
+        if (px >= x[i] && px < x[i] + w[i] && py >= y[i] && py < y[i] + h[i]) {
+            hits[count++] = (int)i;
+        }
+    }
+    return count;
+}
+#endif /* PG_HAS_AVX2 */
+
+static int rectarray_backend = PG_BACKEND_GENERIC;
+static rectarray_rect_func rectarray_collide_rect =
+    _rectarray_collide_rect_generic;
+static rectarray_point_func rectarray_collide_point =
+    _rectarray_collide_point_generic;
+
+/* Switches the RectArray kernels if this build has the backend. Returns 0
+ * on success. */
+static int
+_rectarray_use_backend(int backend)
+{
+    switch (backend) {
+        case PG_BACKEND_GENERIC:
+            rectarray_collide_rect = _rectarray_collide_rect_generic;
+            rectarray_collide_point = _rectarray_collide_point_generic;
+            break;
+#ifdef PG_HAS_SSE2
+        case PG_BACKEND_SSE2:
+            rectarray_collide_rect = _rectarray_collide_rect_sse2;
+            rectarray_collide_point = _rectarray_collide_point_sse2;
+            break;
+#endif
+#ifdef PG_HAS_AVX2
+        case PG_BACKEND_AVX2:
+            rectarray_collide_rect = _rectarray_collide_rect_avx2;
+            rectarray_collide_point = _rectarray_collide_point_avx2;
+            break;
+#endif
+        default:
+            return -1;
+    }
+    rectarray_backend = backend;
+    return 0;
+}
+
 static PyObject *
 pg_rect_normalize(pgRectObject *self, PyObject *args)
 {
@@ -465,6 +724,31 @@ pg_rect_colliderect(pgRectObject *self, PyObject *args)
     return PyInt_FromLong(_pg_do_rects_intersect(&self->r, argrect));
 }
 
+/* The indices of the rects in array that collide with r, as a list */
+static PyObject *
+_pg_rectarray_hits_list(pgRectArrayObject *array, GAME_Rect *r)
+{
+    PyObject *ret, *num;
+    Py_ssize_t count, i;
+    int *hits = PyMem_New(int, array->length ? array->length : 1);
+
+    if (!hits) {
+        return PyErr_NoMemory();
+    }
+    count = rectarray_collide_rect(array, r, hits, array->length);
+    ret = PyList_New(count);
+    for (i = 0; ret && i < count; ++i) {
+        num = PyInt_FromLong(hits[i]);
+        if (!num) {
+            Py_CLEAR(ret);
+            break;
+        }
+        PyList_SET_ITEM(ret, i, num);
+    }
+    PyMem_Free(hits);
+    return ret;
+}
+
 static PyObject *
 pg_rect_collidelist(pgRectObject *self, PyObject *args)
 {
@@ -477,6 +761,14 @@ pg_rect_collidelist(pgRectObject *self, PyObject *args)
         return NULL;
     }
 
+    if (pgRectArray_Check(list)) {
+        if (rectarray_collide_rect((pgRectArrayObject *)list, &self->r,
+                                   &loop, 1)) {
+            return PyInt_FromLong(loop);
+        }
+        return PyInt_FromLong(-1);
+    }
+
     if (!PySequence_Check(list)) {
         return RAISE(PyExc_TypeError,
                      "Argument must be a sequence of rectstyle objects.");
@@ -517,6 +809,10 @@ pg_rect_collidelistall(pgRectObject *self, PyObject *args)
         return NULL;
     }
 
+    if (pgRectArray_Check(list)) {
+        return _pg_rectarray_hits_list((pgRectArrayObject *)list, &self->r);
+    }
+
     if (!PySequence_Check(list)) {
         return RAISE(PyExc_TypeError,
                      "Argument must be a sequence of rectstyle objects.");
@@ -1721,7 +2017,406 @@ pg_rect_init(pgRectObject *self, PyObject *args, PyObject *kwds)
     return 0;
 }
 
-static PyMethodDef _pg_module_methods[] = {{NULL, NULL, 0, NULL}};
+/* RectArray */
+
+static PyObject *rectarray_array_type = NULL; /* array.array */
+
+/* Makes room for at least n rects. The planes move, so this is refused
+ * while a buffer view is held. */
+static int
+_rectarray_reserve(pgRectArrayObject *self, Py_ssize_t n)
+{
+    Py_ssize_t capacity;
+    int *data;
+
+    if (n <= self->capacity) {
+        return 0;
+    }
+    if (self->nexports) {
+        PyErr_SetString(PyExc_BufferError,
+                        "cannot resize a RectArray with buffer views");
+        return -1;
+    }
+    if (n > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "too many rects");
+        return -1;
+    }
+    capacity = MAX(MAX(n, self->capacity * 2), 8);
+    if (capacity > INT_MAX) {
+        capacity = INT_MAX;
+    }
+    data = PyMem_New(int, 4 * capacity);
+    if (!data) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (self->length) {
+        memcpy(data, RECTARRAY_X(self), self->length * sizeof(int));
+        memcpy(data + capacity, RECTARRAY_Y(self), self->length * sizeof(int));
+        memcpy(data + 2 * capacity, RECTARRAY_W(self),
+               self->length * sizeof(int));
+        memcpy(data + 3 * capacity, RECTARRAY_H(self),
+               self->length * sizeof(int));
+    }
+    PyMem_Free(self->data);
+    self->data = data;
+    self->capacity = capacity;
+    return 0;
+}
+
+static void
+_rectarray_set(pgRectArrayObject *self, Py_ssize_t i, GAME_Rect *r)
+{
+    RECTARRAY_X(self)[i] = r->x;
+    RECTARRAY_Y(self)[i] = r->y;
+    RECTARRAY_W(self)[i] = r->w;
+    RECTARRAY_H(self)[i] = r->h;
+}
+
+static int
+_rectarray_append(pgRectArrayObject *self, PyObject *obj)
+{
+    GAME_Rect temp, *r;
+
+    if (!(r = pgRect_FromObject(obj, &temp))) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be rect style object");
+        return -1;
+    }
+    if (_rectarray_reserve(self, self->length + 1)) {
+        return -1;
+    }
+    _rectarray_set(self, self->length++, r);
+    return 0;
+}
+
+/* The hit indices as an array.array('i'), one object for all of them */
+static PyObject *
+_rectarray_index_array(int *hits, Py_ssize_t count)
+{
+    PyObject *module, *bytes, *ret;
+
+    if (!rectarray_array_type) {
+        module = PyImport_ImportModule("array");
+        if (!module) {
+            return NULL;
+        }
+        rectarray_array_type = PyObject_GetAttrString(module, "array");
+        Py_DECREF(module);
+        if (!rectarray_array_type) {
+            return NULL;
+        }
+    }
+    bytes = Bytes_FromStringAndSize((char *)hits, count * sizeof(int));
+    if (!bytes) {
+        return NULL;
+    }
+    ret = PyObject_CallFunction(rectarray_array_type, "sO", "i", bytes);
+    Py_DECREF(bytes);
+    return ret;
+}
+
+static PyObject *
+pg_rectarray_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    pgRectArrayObject *self = (pgRectArrayObject *)type->tp_alloc(type, 0);
+
+    if (self) {
+        self->data = NULL;
+        self->length = self->capacity = 0;
+        self->nexports = 0;
+    }
+    return (PyObject *)self;
+}
+
+static int
+pg_rectarray_init(pgRectArrayObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"rects", NULL};
+    PyObject *rects = NULL, *seq;
+    Py_ssize_t i, n;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:RectArray", keywords,
+                                     &rects)) {
+        return -1;
+    }
+    if (self->nexports) {
+        PyErr_SetString(PyExc_BufferError,
+                        "cannot resize a RectArray with buffer views");
+        return -1;
+    }
+    self->length = 0;
+    if (!rects) {
+        return 0;
+    }
+    seq = PySequence_Fast(rects, "Argument must be a sequence of rectstyle "
+                                 "objects.");
+    if (!seq) {
+        return -1;
+    }
+    n = PySequence_Fast_GET_SIZE(seq);
+    if (_rectarray_reserve(self, n)) {
+        Py_DECREF(seq);
+        return -1;
+    }
+    for (i = 0; i < n; ++i) {
+        if (_rectarray_append(self, PySequence_Fast_GET_ITEM(seq, i))) {
+            Py_DECREF(seq);
+            return -1;
+        }
+    }
+    Py_DECREF(seq);
+    return 0;
+}
+
+static void
+pg_rectarray_dealloc(pgRectArrayObject *self)
+{
+    PyMem_Free(self->data);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+pg_rectarray_repr(pgRectArrayObject *self)
+{
+    return Text_FromFormat("<RectArray(%d rects)>", (int)self->length);
+}
+
+static PyObject *
+pg_rectarray_append(pgRectArrayObject *self, PyObject *arg)
+{
+    if (_rectarray_append(self, arg)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+pg_rectarray_colliderect(pgRectArrayObject *self, PyObject *args)
+{
+    GAME_Rect *argrect, temp;
+    PyObject *ret;
+    Py_ssize_t count;
+    int *hits;
+
+    if (!(argrect = pgRect_FromObject(args, &temp))) {
+        return RAISE(PyExc_TypeError, "Argument must be rect style object");
+    }
+    hits = PyMem_New(int, self->length ? self->length : 1);
+    if (!hits) {
+        return PyErr_NoMemory();
+    }
+    count = rectarray_collide_rect(self, argrect, hits, self->length);
+    ret = _rectarray_index_array(hits, count);
+    PyMem_Free(hits);
+    return ret;
+}
+
+static PyObject *
+pg_rectarray_collidepoint(pgRectArrayObject *self, PyObject *args)
+{
+    PyObject *ret;
+    Py_ssize_t count;
+    int x, y;
+    int *hits;
+
+    if (!pg_TwoIntsFromObj(args, &x, &y)) {
+        return RAISE(PyExc_TypeError, "argument must contain two numbers");
+    }
+    hits = PyMem_New(int, self->length ? self->length : 1);
+    if (!hits) {
+        return PyErr_NoMemory();
+    }
+    count = rectarray_collide_point(self, x, y, hits, self->length);
+    ret = _rectarray_index_array(hits, count);
+    PyMem_Free(hits);
+    return ret;
+}
+
+static Py_ssize_t
+pg_rectarray_length(pgRectArrayObject *self)
+{
+    return self->length;
+}
+
+static PyObject *
+pg_rectarray_item(pgRectArrayObject *self, Py_ssize_t i)
+{
+    if (i < 0 || i >= self->length) {
+        return RAISE(PyExc_IndexError, "Invalid RectArray index");
+    }
+    return pgRect_New4(RECTARRAY_X(self)[i], RECTARRAY_Y(self)[i],
+                       RECTARRAY_W(self)[i], RECTARRAY_H(self)[i]);
+}
+
+static int
+pg_rectarray_ass_item(pgRectArrayObject *self, Py_ssize_t i, PyObject *v)
+{
+    GAME_Rect *argrect, temp;
+
+    if (v == NULL) {
+        PyErr_SetString(PyExc_TypeError, "RectArray items cannot be deleted");
+        return -1;
+    }
+    if (i < 0 || i >= self->length) {
+        PyErr_SetString(PyExc_IndexError, "Invalid RectArray index");
+        return -1;
+    }
+    if (!(argrect = pgRect_FromObject(v, &temp))) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be rect style object");
+        return -1;
+    }
+    _rectarray_set(self, i, argrect);
+    return 0;
+}
+
+#if PY3
+static int
+pg_rectarray_getbuffer(pgRectArrayObject *self, Py_buffer *view, int flags)
+{
+    Py_ssize_t n = self->length;
+
+    /* close the gaps between the planes so the view is contiguous */
+    if (!self->nexports && n != self->capacity) {
+        if (n) {
+            memmove(self->data + n, RECTARRAY_Y(self), n * sizeof(int));
+            memmove(self->data + 2 * n, RECTARRAY_W(self), n * sizeof(int));
+            memmove(self->data + 3 * n, RECTARRAY_H(self), n * sizeof(int));
+        }
+        self->capacity = n;
+    }
+    self->shape[0] = 4;
+    self->shape[1] = n;
+    self->strides[0] = n * sizeof(int);
+    self->strides[1] = sizeof(int);
+
+    view->buf = self->data ? (void *)self->data : (void *)self->shape;
+    view->len = 4 * n * sizeof(int);
+    view->readonly = 0;
+    view->itemsize = sizeof(int);
+    view->ndim = 2;
+    view->internal = NULL;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) ? self->strides : NULL;
+    view->format = (flags & PyBUF_FORMAT) ? "i" : NULL;
+    view->suboffsets = NULL;
+
+    self->nexports++;
+    Py_INCREF(self);
+    view->obj = (PyObject *)self;
+    return 0;
+}
+
+static void
+pg_rectarray_releasebuffer(pgRectArrayObject *self, Py_buffer *view)
+{
+    self->nexports--;
+}
+
+static PyBufferProcs pg_rectarray_as_buffer = {
+    (getbufferproc)pg_rectarray_getbuffer,
+    (releasebufferproc)pg_rectarray_releasebuffer};
+#endif /* PY3 */
+
+static struct PyMethodDef pg_rectarray_methods[] = {
+    {"append", (PyCFunction)pg_rectarray_append, METH_O,
+     DOC_RECTARRAYAPPEND},
+    {"colliderect", (PyCFunction)pg_rectarray_colliderect, METH_VARARGS,
+     DOC_RECTARRAYCOLLIDERECT},
+    {"collidepoint", (PyCFunction)pg_rectarray_collidepoint, METH_VARARGS,
+     DOC_RECTARRAYCOLLIDEPOINT},
+    {NULL, NULL, 0, NULL}};
+
+static PySequenceMethods pg_rectarray_as_sequence = {
+    (lenfunc)pg_rectarray_length,         /* sq_length */
+    NULL,                                 /* sq_concat */
+    NULL,                                 /* sq_repeat */
+    (ssizeargfunc)pg_rectarray_item,      /* sq_item */
+    NULL,                                 /* sq_slice */
+    (ssizeobjargproc)pg_rectarray_ass_item, /* sq_ass_item */
+    NULL,                                 /* sq_ass_slice */
+};
+
+static PyTypeObject pgRectArray_Type = {
+    TYPE_HEAD(NULL, 0) "pygame.RectArray", /*name*/
+    sizeof(pgRectArrayObject),             /*basicsize*/
+    0,                                     /*itemsize*/
+    /* methods */
+    (destructor)pg_rectarray_dealloc, /*dealloc*/
+    (printfunc)NULL,                  /*print*/
+    NULL,                             /*getattr*/
+    NULL,                             /*setattr*/
+    NULL,                             /*compare/reserved*/
+    (reprfunc)pg_rectarray_repr,      /*repr*/
+    NULL,                             /*as_number*/
+    &pg_rectarray_as_sequence,        /*as_sequence*/
+    NULL,                             /*as_mapping*/
+    (hashfunc)NULL,                   /*hash*/
+    (ternaryfunc)NULL,                /*call*/
+    (reprfunc)NULL,                   /*str*/
+    0L,                               /* tp_getattro */
+    0L,                               /* tp_setattro */
+#if PY3
+    &pg_rectarray_as_buffer, /* tp_as_buffer */
+#else
+    0L, /* tp_as_buffer */
+#endif
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+    DOC_PYGAMERECTARRAY,                      /* Documentation string */
+    NULL,                                     /* tp_traverse */
+    NULL,                                     /* tp_clear */
+    NULL,                                     /* tp_richcompare */
+    0,                                        /* tp_weaklistoffset */
+    NULL,                                     /* tp_iter */
+    NULL,                                     /* tp_iternext */
+    pg_rectarray_methods,                     /* tp_methods */
+    NULL,                                     /* tp_members */
+    NULL,                                     /* tp_getset */
+    NULL,                                     /* tp_base */
+    NULL,                                     /* tp_dict */
+    NULL,                                     /* tp_descr_get */
+    NULL,                                     /* tp_descr_set */
+    0,                                        /* tp_dictoffset */
+    (initproc)pg_rectarray_init,              /* tp_init */
+    NULL,                                     /* tp_alloc */
+    pg_rectarray_new,                         /* tp_new */
+};
+
+static PyObject *
+pg_get_rectarray_backend(PyObject *self, PyObject *args)
+{
+    return Text_FromUTF8(pg_backend_name(rectarray_backend));
+}
+
+static PyObject *
+pg_set_rectarray_backend(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"type", NULL};
+    const char *type;
+    int status;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s:_set_rectarray_backend",
+                                     keywords, &type)) {
+        return NULL;
+    }
+
+    status = pg_backend_set(type, _rectarray_use_backend);
+    if (status) {
+        return pg_backend_error(type, status);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef _pg_module_methods[] = {
+    {"_get_rectarray_backend", pg_get_rectarray_backend, METH_NOARGS,
+     "_get_rectarray_backend() -> String\n"
+     "return the RectArray test version in use: 'GENERIC', 'SSE2' or "
+     "'AVX2'"},
+    {"_set_rectarray_backend", (PyCFunction)pg_set_rectarray_backend,
+     METH_VARARGS | METH_KEYWORDS,
+     "_set_rectarray_backend(type) -> None\n"
+     "set the RectArray test version to one of: 'GENERIC', 'SSE2' or "
+     "'AVX2'"},
+    {NULL, NULL, 0, NULL}};
 
 /*DOC*/ static char _pg_module_doc[] =
     /*DOC*/ "Module for the rectangle object\n";
@@ -1756,6 +2451,12 @@ MODINIT_DEFINE(rect)
     if (PyType_Ready(&pgRect_Type) < 0) {
         MODINIT_ERROR;
     }
+    if (PyType_Ready(&pgRectArray_Type) < 0) {
+        MODINIT_ERROR;
+    }
+
+    /* use the widest RectArray tests the CPU can run */
+    pg_backend_set_best(_rectarray_use_backend);
 
 #if PY3
     module = PyModule_Create(&_module);
@@ -1776,6 +2477,11 @@ MODINIT_DEFINE(rect)
         DECREF_MOD(module);
         MODINIT_ERROR;
     }
+    if (PyDict_SetItemString(dict, "RectArray",
+                             (PyObject *)&pgRectArray_Type)) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
 
     /* export the c api */
     c_api[0] = &pgRect_Type;
@@ -0,0 +1,226 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "region.h"
+
+#include <stdlib.h>
+
+#define REGION_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define REGION_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+int
+pg_region_add(pg_region *region, Sint64 x0, Sint64 y0, Sint64 x1,
+              Sint64 y1, const pg_region_rect *clip)
+{
+    pg_region_rect *r;
+
+    x0 = REGION_MAX(x0, clip->x0);
+    y0 = REGION_MAX(y0, clip->y0);
+    x1 = REGION_MIN(x1, clip->x1);
+    y1 = REGION_MIN(y1, clip->y1);
+    if (x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+    if (region->count == region->size) {
+        int size = region->size ? region->size * 2 : 64;
+
+        r = (pg_region_rect *)realloc(region->rects,
+                                      sizeof(pg_region_rect) * size);
+        if (!r) {
+            return -1;
+        }
+        region->rects = r;
+        region->size = size;
+    }
+    r = region->rects + region->count++;
+    r->x0 = (int)x0;
+    r->y0 = (int)y0;
+    r->x1 = (int)x1;
+    r->y1 = (int)y1;
+    return 0;
+}
+
+static int
+_region_compare_tops(const void *a, const void *b)
+{
+    const pg_region_rect *ra = (const pg_region_rect *)a;
+    const pg_region_rect *rb = (const pg_region_rect *)b;
+
+    if (ra->y0 != rb->y0) {
+        return ra->y0 < rb->y0 ? -1 : 1;
+    }
+    return (ra->x0 > rb->x0) - (ra->x0 < rb->x0);
+}
+
+static int
+_region_compare_ints(const void *a, const void *b)
+{
+    int ia = *(const int *)a;
+    int ib = *(const int *)b;
+
+    return (ia > ib) - (ia < ib);
+}
+
+/* The plane is swept in bands between consecutive top and bottom edges.
+ * The rects crossing a band are kept sorted on x0, so its spans are found
+ * in one pass. A band with the same spans as the band right above it
+ * extends that band instead of adding rects.
+ */
+int
+pg_region_union(pg_region *region)
+{
+    pg_region_rect *in = region->rects, *out = NULL, *r;
+    const pg_region_rect **active, **merged, **swap;
+    int *ys;
+    int n = region->count, nys = 0, nactive = 0, nmerged;
+    int nout = 0, size = 0, next = 0, first, band, above = -1;
+    int i, j, k, y, ynext, x0, x1;
+
+    if (n < 2) {
+        return 0;
+    }
+    ys = (int *)malloc(sizeof(int) * 2 * n);
+    active = (const pg_region_rect **)malloc(sizeof(pg_region_rect *) * n);
+    merged = (const pg_region_rect **)malloc(sizeof(pg_region_rect *) * n);
+    if (!ys || !active || !merged) {
+        goto memory_error;
+    }
+
+    qsort(in, n, sizeof(pg_region_rect), _region_compare_tops);
+    for (i = 0; i < n; ++i) {
+        ys[2 * i] = in[i].y0;
+        ys[2 * i + 1] = in[i].y1;
+    }
+    qsort(ys, 2 * n, sizeof(int), _region_compare_ints);
+    for (i = 0; i < 2 * n; ++i) {
+        if (!nys || ys[nys - 1] != ys[i]) {
+            ys[nys++] = ys[i];
+        }
+    }
+
+    for (k = 0; k + 1 < nys; ++k) {
+        y = ys[k];
+        ynext = ys[k + 1];
+
+        /* Merge the rects starting on y into the ones still open; both
+         * are sorted on x0. */
+        first = next;
+        while (next < n && in[next].y0 == y) {
+            ++next;
+        }
+        i = 0;
+        j = first;
+        nmerged = 0;
+        while (i < nactive || j < next) {
+            if (i < nactive && active[i]->y1 <= y) {
+                ++i;
+            }
+            else if (j == next ||
+                     (i < nactive && active[i]->x0 <= in[j].x0)) {
+                merged[nmerged++] = active[i++];
+            }
+            else {
+                merged[nmerged++] = in + j++;
+            }
+        }
+        swap = active;
+        active = merged;
+        merged = swap;
+        nactive = nmerged;
+        if (!nactive) {
+            continue;
+        }
+
+        if (nout + nactive > size) {
+            size = REGION_MAX(size * 2, nout + nactive);
+            r = (pg_region_rect *)realloc(out, sizeof(pg_region_rect) * size);
+            if (!r) {
+                goto memory_error;
+            }
+            out = r;
+        }
+        band = nout;
+        for (i = 0; i < nactive;) {
+            x0 = active[i]->x0;
+            x1 = active[i]->x1;
+            for (++i; i < nactive && active[i]->x0 <= x1; ++i) {
+                x1 = REGION_MAX(x1, active[i]->x1);
+            }
+            r = out + nout++;
+            r->x0 = x0;
+            r->y0 = y;
+            r->x1 = x1;
+            r->y1 = ynext;
+        }
+
+        if (above >= 0 && out[above].y1 == y && nout - band == band - above) {
+            for (i = 0; i < band - above; ++i) {
+                if (out[above + i].x0 != out[band + i].x0 ||
+                    out[above + i].x1 != out[band + i].x1) {
+                    break;
+                }
+            }
+            if (i == band - above) {
+                for (i = above; i < band; ++i) {
+                    out[i].y1 = ynext;
+                }
+                nout = band;
+                continue;
+            }
+        }
+        above = band;
+    }
+
+    free(ys);
+    free(active);
+    free(merged);
+    free(in);
+    region->rects = out;
+    region->count = nout;
+    region->size = size;
+    return 0;
+
+memory_error:
+    free(ys);
+    free(active);
+    free(merged);
+    free(out);
+    return -1;
+}
+
+Sint64
+pg_region_area(const pg_region *region)
+{
+    const pg_region_rect *r;
+    Sint64 area = 0;
+    int i;
+
+    for (i = 0; i < region->count; ++i) {
+        r = region->rects + i;
+        area += ((Sint64)r->x1 - r->x0) * ((Sint64)r->y1 - r->y0);
+    }
+    return area;
+}
+
+void
+pg_region_clear(pg_region *region)
+{
+    free(region->rects);
+    region->rects = NULL;
+    region->count = region->size = 0;
+}
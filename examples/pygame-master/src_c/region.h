@@ -0,0 +1,72 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Rectangle regions shared by display.update and LayeredDirty.draw.
+ *
+ * A region is filled with possibly overlapping rects and then replaced by
+ * their union as disjoint rects, so every pixel of it is redrawn or
+ * presented once.
+ *
+ * The rects are plain ints in memory from realloc, released again by
+ * pg_region_clear(); display.update copies the union into SDL_Rects before
+ * presenting it.
+ */
+#if !defined(REGION_HEADER)
+#define REGION_HEADER
+
+#include <SDL.h>
+
+/* Half open screen area, x0 <= x < x1 and y0 <= y < y1 */
+typedef struct {
+    int x0, y0, x1, y1;
+} pg_region_rect;
+
+typedef struct {
+    pg_region_rect *rects;
+    int count;
+    int size;
+} pg_region;
+
+/* Add the part of the rect x0, y0, x1, y1 inside clip to the region.
+ * Empty parts are left out.
+ *
+ * Returns 0 on success and -1 if memory could not be allocated.
+ */
+int
+pg_region_add(pg_region *region, Sint64 x0, Sint64 y0, Sint64 x1,
+              Sint64 y1, const pg_region_rect *clip);
+
+/* Replace the rects of the region with their union as disjoint rects. The
+ * result is ordered in bands from top to bottom, with the rects of a band
+ * sharing their top and bottom and ordered left to right.
+ *
+ * Returns 0 on success and -1 if memory could not be allocated, in which
+ * case the region is unchanged.
+ */
+int
+pg_region_union(pg_region *region);
+
+/* Total area of the rects; the area of the region after a union. */
+Sint64
+pg_region_area(const pg_region *region);
+
+/* Free the rects and empty the region. */
+void
+pg_region_clear(pg_region *region);
+
+#endif /* REGION_HEADER */
@@ -0,0 +1,166 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Compile-time gating and run-time selection for the SSE2 and AVX2
+ * kernels in the blitters, RectArray, bitmask and transform code.
+ *
+ * PG_HAS_SSE2 is set when the compiler targets SSE2, which every x86-64
+ * CPU has. PG_HAS_AVX2 is set when the compiler can also build single
+ * functions for AVX2; those functions are marked with
+ * PG_FUNCTION_TARGET_AVX2 (or PG_FUNCTION_TARGET_AVX2_POPCNT) and must only
+ * be called once pg_backend_runs() says the CPU has AVX2.
+ *
+ * Every module names its kernels GENERIC, SSE2 or AVX2 and keeps a function
+ * that switches to one of them, returning 0 if that build has it.
+ * pg_backend_set() and pg_backend_set_best() check the CPU around it, and
+ * pg_backend_error() raises the ValueError the _set_*_backend functions
+ * share. That part needs SDL and Python; pure C files such as bitmask.c
+ * define PG_SIMD_GATING_ONLY before including this header to skip it.
+ */
+#ifndef SIMD_BACKEND_H
+#define SIMD_BACKEND_H
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PG_HAS_SSE2 1
+#include <emmintrin.h>
+#endif /* SSE2 target */
+
+#if defined(PG_HAS_SSE2)
+#if defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define PG_HAS_AVX2 1
+#define PG_FUNCTION_TARGET_AVX2 __attribute__((target("avx2")))
+#define PG_FUNCTION_TARGET_AVX2_POPCNT \
+    __attribute__((target("avx2,popcnt")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1800
+#define PG_HAS_AVX2 1
+#define PG_FUNCTION_TARGET_AVX2
+#define PG_FUNCTION_TARGET_AVX2_POPCNT
+#endif
+#endif /* PG_HAS_SSE2 */
+
+#if defined(PG_HAS_AVX2)
+#include <immintrin.h>
+#endif /* PG_HAS_AVX2 */
+
+#define PG_BACKEND_GENERIC 0
+#define PG_BACKEND_SSE2 1
+#define PG_BACKEND_AVX2 2
+
+#if !defined(PG_SIMD_GATING_ONLY)
+
+#include <Python.h>
+#include <SDL.h>
+#include <string.h>
+
+#include "include/pgplatform.h"
+
+/* Switches a module to the kernels for backend, returning 0 if this build
+ * has them and -1 otherwise. The CPU has already been checked.
+ */
+typedef int (*pg_backend_use_func)(int backend);
+
+static PG_INLINE const char *
+pg_backend_name(int backend)
+{
+    switch (backend) {
+        case PG_BACKEND_SSE2:
+            return "SSE2";
+        case PG_BACKEND_AVX2:
+            return "AVX2";
+        default:
+            return "GENERIC";
+    }
+}
+
+/* Whether the CPU can run backend. AVX2 can only be detected from
+ * SDL 2.0.4 on, so it is never picked with older SDL versions.
+ */
+static PG_INLINE int
+pg_backend_runs(int backend)
+{
+    switch (backend) {
+        case PG_BACKEND_GENERIC:
+            return 1;
+#if defined(PG_HAS_SSE2)
+        case PG_BACKEND_SSE2:
+            return SDL_HasSSE2();
+#endif /* PG_HAS_SSE2 */
+#if defined(PG_HAS_AVX2) && SDL_VERSION_ATLEAST(2, 0, 4)
+        case PG_BACKEND_AVX2:
+            return SDL_HasAVX2();
+#endif /* PG_HAS_AVX2 */
+        default:
+            return 0;
+    }
+}
+
+/* Switches to the backend called name. Returns 0 on success, -1 for an
+ * unknown name and -2 for a backend this build or machine cannot run.
+ */
+static PG_INLINE int
+pg_backend_set(const char *name, pg_backend_use_func use)
+{
+    int backend;
+
+    for (backend = PG_BACKEND_GENERIC; backend <= PG_BACKEND_AVX2;
+         ++backend) {
+        if (strcmp(name, pg_backend_name(backend)) == 0) {
+            if (!pg_backend_runs(backend) || use(backend)) {
+                return -2;
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Switches to the widest backend this build and machine can run, and
+ * returns it.
+ */
+static PG_INLINE int
+pg_backend_set_best(pg_backend_use_func use)
+{
+    int backend;
+
+    for (backend = PG_BACKEND_AVX2; backend > PG_BACKEND_GENERIC;
+         --backend) {
+        if (pg_backend_runs(backend) && use(backend) == 0) {
+            return backend;
+        }
+    }
+    use(PG_BACKEND_GENERIC);
+    return PG_BACKEND_GENERIC;
+}
+
+/* Raises the ValueError for a failed pg_backend_set() and returns NULL. */
+static PG_INLINE PyObject *
+pg_backend_error(const char *name, int status)
+{
+    if (status == -2) {
+        return PyErr_Format(PyExc_ValueError,
+                            "%s not supported on this machine", name);
+    }
+    return PyErr_Format(PyExc_ValueError, "Unknown backend type %s", name);
+}
+
+#endif /* !PG_SIMD_GATING_ONLY */
+
+#endif /* SIMD_BACKEND_H */
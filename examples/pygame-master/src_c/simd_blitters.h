@@ -0,0 +1,88 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Vectorized versions of the alphablit.c blitters.
+ *
+ * The kernels only handle forward 32 bit blits where every colour channel
+ * is a full byte and the source and destination keep R, G and B in the
+ * same place; SoftBlitPyGame checks that (see _simd_blit_ok) and falls
+ * back to the per-pixel code otherwise. Every kernel gives bit-identical
+ * results to its scalar counterpart.
+ *
+ * See simd_backend.h for when the SSE2 and AVX2 kernels are built and how
+ * pygame_SetBlitBackend picks between them.
+ */
+
+#ifndef SIMD_BLITTERS_H
+#define SIMD_BLITTERS_H
+
+#include "_blit_info.h"
+#include "simd_backend.h"
+
+/* The vector blitters are only built for SDL 2. */
+#if IS_SDLv2 && defined(PG_HAS_SSE2)
+#define PG_ENABLE_SSE2 1
+#if defined(PG_HAS_AVX2)
+#define PG_ENABLE_AVX2 1
+#endif /* PG_HAS_AVX2 */
+#endif /* PG_HAS_SSE2 */
+
+#if defined(PG_ENABLE_SSE2)
+void
+alphablit_alpha_sse2_argb(SDL_BlitInfo *info);
+void
+alphablit_colorkey_sse2_argb(SDL_BlitInfo *info);
+void
+alphablit_solid_sse2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_add_sse2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_sub_sse2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_mul_sse2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_min_sse2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_max_sse2_argb(SDL_BlitInfo *info);
+void
+blit_blend_premultiplied_sse2_argb(SDL_BlitInfo *info);
+#endif /* PG_ENABLE_SSE2 */
+
+#if defined(PG_ENABLE_AVX2)
+void
+alphablit_alpha_avx2_argb(SDL_BlitInfo *info);
+void
+alphablit_colorkey_avx2_argb(SDL_BlitInfo *info);
+void
+alphablit_solid_avx2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_add_avx2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_sub_avx2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_mul_avx2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_min_avx2_argb(SDL_BlitInfo *info);
+void
+blit_blend_rgba_max_avx2_argb(SDL_BlitInfo *info);
+void
+blit_blend_premultiplied_avx2_argb(SDL_BlitInfo *info);
+#endif /* PG_ENABLE_AVX2 */
+
+#endif /* SIMD_BLITTERS_H */
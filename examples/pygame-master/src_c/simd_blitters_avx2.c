@@ -0,0 +1,395 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#define NO_PYGAME_C_API
+#include "simd_blitters.h"
+
+#if defined(PG_ENABLE_AVX2)
+
+#include <immintrin.h>
+
+/* Where the source alpha of a pixel comes from */
+#define PG_ALPHA_FROM_PIXEL 0    /* alphablit_alpha */
+#define PG_ALPHA_FROM_COLORKEY 1 /* alphablit_colorkey */
+#define PG_ALPHA_FROM_BLANKET 2  /* alphablit_solid */
+
+/* ALPHA_BLEND for four pixels unpacked to 16 bit channels.
+ *
+ * The colour equation dC + (((sC - dC) * sA + sC) >> 8) is computed as
+ * (dC * (256 - sA) + sC * (sA + 1)) >> 8, which is the same value but never
+ * leaves the 0..65535 range, and sA * dA / 255 as (x + 1 + (x >> 8)) >> 8,
+ * which is exact for every x up to 255 * 255.
+ */
+static PG_INLINE PG_FUNCTION_TARGET_AVX2 void
+_alpha_blend_epi16_avx2(__m256i s, __m256i d, __m256i a, __m256i *colour,
+                        __m256i *alpha)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i c256 = _mm256_set1_epi16(256);
+    __m256i x;
+
+    *colour = _mm256_srli_epi16(
+        _mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_sub_epi16(c256, a)),
+                         _mm256_mullo_epi16(s, _mm256_add_epi16(a, one))),
+        8);
+
+    x = _mm256_mullo_epi16(a, d);
+    x = _mm256_srli_epi16(
+        _mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)),
+        8);
+    *alpha = _mm256_sub_epi16(_mm256_add_epi16(a, d), x);
+}
+
+/* ALPHA_BLEND for eight pixels.
+ *
+ * a holds the source alpha of each pixel in the low byte of its lane.
+ * amask is the destination alpha channel (zero if it has none), keep the
+ * destination channels that get written and has_alpha is all ones when
+ * the destination has an alpha channel.
+ */
+static PG_INLINE PG_FUNCTION_TARGET_AVX2 __m256i
+_alpha_blend_avx2(__m256i s, __m256i d, __m256i a, __m256i amask,
+                  __m256i keep, __m256i has_alpha)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i col_lo, col_hi, alp_lo, alp_hi;
+    __m256i blended, copy, transparent;
+
+    /* spread the alpha over all four bytes of its pixel */
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 8));
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+
+    _alpha_blend_epi16_avx2(
+        _mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero),
+        _mm256_unpacklo_epi8(a, zero), &col_lo, &alp_lo);
+    _alpha_blend_epi16_avx2(
+        _mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero),
+        _mm256_unpackhi_epi8(a, zero), &col_hi, &alp_hi);
+
+    blended = _mm256_or_si256(
+        _mm256_andnot_si256(amask, _mm256_packus_epi16(col_lo, col_hi)),
+        _mm256_and_si256(amask, _mm256_packus_epi16(alp_lo, alp_hi)));
+
+    /* A fully transparent destination pixel is replaced by the source */
+    copy = _mm256_or_si256(_mm256_andnot_si256(amask, s),
+                           _mm256_and_si256(amask, a));
+    transparent = _mm256_and_si256(
+        has_alpha, _mm256_cmpeq_epi32(_mm256_and_si256(d, amask), zero));
+    blended = _mm256_or_si256(_mm256_and_si256(transparent, copy),
+                              _mm256_andnot_si256(transparent, blended));
+
+    return _mm256_and_si256(blended, keep);
+}
+
+static PG_INLINE PG_FUNCTION_TARGET_AVX2 void
+_alphablit_avx2(SDL_BlitInfo *info, int alpha_from)
+{
+    int n;
+    int width = info->width;
+    int height = info->height;
+    int tail = width & 7;
+    Uint8 *src = info->s_pixels;
+    int srcskip = info->s_skip;
+    Uint8 *dst = info->d_pixels;
+    int dstskip = info->d_skip;
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+    Uint32 s_tail[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    Uint32 d_tail[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    const __m256i amask = _mm256_set1_epi32((int)dstfmt->Amask);
+    const __m256i keep = _mm256_set1_epi32(
+        (int)(dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask | dstfmt->Amask));
+    const __m256i has_alpha = _mm256_set1_epi32(dstfmt->Amask ? -1 : 0);
+    const __m128i ashift = _mm_cvtsi32_si128(srcfmt->Ashift);
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    const __m256i colorkey = _mm256_set1_epi32((int)info->src_colorkey);
+    const __m256i blanket = _mm256_set1_epi32(info->src_blanket_alpha);
+    __m256i s, d, a;
+
+#define _SOURCE_ALPHA                                                     \
+    switch (alpha_from) {                                                 \
+        case PG_ALPHA_FROM_PIXEL:                                         \
+            a = _mm256_and_si256(_mm256_srl_epi32(s, ashift), low_byte);  \
+            break;                                                        \
+        case PG_ALPHA_FROM_COLORKEY:                                      \
+            a = _mm256_andnot_si256(_mm256_cmpeq_epi32(s, colorkey),      \
+                                    blanket);                             \
+            break;                                                        \
+        default:                                                          \
+            a = blanket;                                                  \
+            break;                                                        \
+    }
+
+    while (height--) {
+        for (n = width >> 3; n > 0; --n) {
+            s = _mm256_loadu_si256((const __m256i *)src);
+            d = _mm256_loadu_si256((const __m256i *)dst);
+            _SOURCE_ALPHA;
+            _mm256_storeu_si256(
+                (__m256i *)dst,
+                _alpha_blend_avx2(s, d, a, amask, keep, has_alpha));
+            src += 32;
+            dst += 32;
+        }
+        if (tail) {
+            /* finish the row on a padded copy so the result is the same
+               as for whole groups of eight */
+            memcpy(s_tail, src, tail * 4);
+            memcpy(d_tail, dst, tail * 4);
+            s = _mm256_loadu_si256((const __m256i *)s_tail);
+            d = _mm256_loadu_si256((const __m256i *)d_tail);
+            _SOURCE_ALPHA;
+            _mm256_storeu_si256(
+                (__m256i *)d_tail,
+                _alpha_blend_avx2(s, d, a, amask, keep, has_alpha));
+            memcpy(dst, d_tail, tail * 4);
+            src += tail * 4;
+            dst += tail * 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+
+#undef _SOURCE_ALPHA
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+alphablit_alpha_avx2_argb(SDL_BlitInfo *info)
+{
+    _alphablit_avx2(info, PG_ALPHA_FROM_PIXEL);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+alphablit_colorkey_avx2_argb(SDL_BlitInfo *info)
+{
+    _alphablit_avx2(info, PG_ALPHA_FROM_COLORKEY);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+alphablit_solid_avx2_argb(SDL_BlitInfo *info)
+{
+    _alphablit_avx2(info, PG_ALPHA_FROM_BLANKET);
+}
+
+/* The BLEND_RGBA_* fast paths work on the rows as runs of bytes */
+#define PG_BLEND_RGBA_ADD 0
+#define PG_BLEND_RGBA_SUB 1
+#define PG_BLEND_RGBA_MULT 2
+#define PG_BLEND_RGBA_MIN 3
+#define PG_BLEND_RGBA_MAX 4
+
+static PG_INLINE PG_FUNCTION_TARGET_AVX2 __m256i
+_blend_rgba_avx2(__m256i s, __m256i d, int op)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo, hi;
+
+    switch (op) {
+        case PG_BLEND_RGBA_ADD:
+            return _mm256_adds_epu8(d, s);
+        case PG_BLEND_RGBA_SUB:
+            return _mm256_subs_epu8(d, s);
+        case PG_BLEND_RGBA_MIN:
+            return _mm256_min_epu8(d, s);
+        case PG_BLEND_RGBA_MAX:
+            return _mm256_max_epu8(d, s);
+        default:
+            /* (d * s) >> 8 is already 0 when either side is 0 */
+            lo = _mm256_srli_epi16(
+                _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero),
+                                   _mm256_unpacklo_epi8(s, zero)),
+                8);
+            hi = _mm256_srli_epi16(
+                _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero),
+                                   _mm256_unpackhi_epi8(s, zero)),
+                8);
+            return _mm256_packus_epi16(lo, hi);
+    }
+}
+
+static PG_INLINE PG_FUNCTION_TARGET_AVX2 void
+_blit_blend_rgba_avx2(SDL_BlitInfo *info, int op)
+{
+    int n;
+    int bytes = info->width * 4;
+    int height = info->height;
+    int tail = bytes & 31;
+    Uint8 *src = info->s_pixels;
+    int srcskip = info->s_skip;
+    Uint8 *dst = info->d_pixels;
+    int dstskip = info->d_skip;
+    Uint8 s_tail[32] = {0};
+    Uint8 d_tail[32] = {0};
+    __m256i s, d;
+
+    while (height--) {
+        for (n = bytes >> 5; n > 0; --n) {
+            s = _mm256_loadu_si256((const __m256i *)src);
+            d = _mm256_loadu_si256((const __m256i *)dst);
+            _mm256_storeu_si256((__m256i *)dst, _blend_rgba_avx2(s, d, op));
+            src += 32;
+            dst += 32;
+        }
+        if (tail) {
+            memcpy(s_tail, src, tail);
+            memcpy(d_tail, dst, tail);
+            s = _mm256_loadu_si256((const __m256i *)s_tail);
+            d = _mm256_loadu_si256((const __m256i *)d_tail);
+            _mm256_storeu_si256((__m256i *)d_tail, _blend_rgba_avx2(s, d, op));
+            memcpy(dst, d_tail, tail);
+            src += tail;
+            dst += tail;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+blit_blend_rgba_add_avx2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_avx2(info, PG_BLEND_RGBA_ADD);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+blit_blend_rgba_sub_avx2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_avx2(info, PG_BLEND_RGBA_SUB);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+blit_blend_rgba_mul_avx2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_avx2(info, PG_BLEND_RGBA_MULT);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+blit_blend_rgba_min_avx2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_avx2(info, PG_BLEND_RGBA_MIN);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+blit_blend_rgba_max_avx2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_avx2(info, PG_BLEND_RGBA_MAX);
+}
+
+/* ALPHA_BLEND_PREMULTIPLIED for eight pixels, with the same conventions as
+ * _alpha_blend_avx2. sC + dC - ((dC * sA) >> 8) can reach 510; the pack
+ * back to bytes saturates it to 255 like the scalar code does.
+ */
+static PG_INLINE PG_FUNCTION_TARGET_AVX2 __m256i
+_premul_blend_avx2(__m256i s, __m256i d, __m256i a, __m256i amask,
+                   __m256i keep)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i s16, d16, a16, x;
+    __m256i col_lo, col_hi, alp_lo, alp_hi;
+
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 8));
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+
+#define _PREMUL_HALF(unpack, colour, alpha)                                 \
+    s16 = unpack(s, zero);                                                  \
+    d16 = unpack(d, zero);                                                  \
+    a16 = unpack(a, zero);                                                  \
+    colour = _mm256_sub_epi16(                                              \
+        _mm256_add_epi16(s16, d16),                                         \
+        _mm256_srli_epi16(_mm256_mullo_epi16(d16, a16), 8));                \
+    x = _mm256_mullo_epi16(a16, d16);                                       \
+    x = _mm256_srli_epi16(                                                  \
+        _mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), \
+        8);                                                                 \
+    alpha = _mm256_sub_epi16(_mm256_add_epi16(a16, d16), x);
+
+    _PREMUL_HALF(_mm256_unpacklo_epi8, col_lo, alp_lo);
+    _PREMUL_HALF(_mm256_unpackhi_epi8, col_hi, alp_hi);
+#undef _PREMUL_HALF
+
+    return _mm256_and_si256(
+        _mm256_or_si256(
+            _mm256_andnot_si256(amask, _mm256_packus_epi16(col_lo, col_hi)),
+            _mm256_and_si256(amask, _mm256_packus_epi16(alp_lo, alp_hi))),
+        keep);
+}
+
+PG_FUNCTION_TARGET_AVX2 void
+blit_blend_premultiplied_avx2_argb(SDL_BlitInfo *info)
+{
+    int n;
+    int width = info->width;
+    int height = info->height;
+    int tail = width & 7;
+    Uint8 *src = info->s_pixels;
+    int srcskip = info->s_skip;
+    Uint8 *dst = info->d_pixels;
+    int dstskip = info->d_skip;
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+    int srcppa = info->src_blend != SDL_BLENDMODE_NONE && srcfmt->Amask;
+    int dstppa = info->dst_blend != SDL_BLENDMODE_NONE && dstfmt->Amask;
+    Uint32 s_tail[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    Uint32 d_tail[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    const __m256i amask = _mm256_set1_epi32((int)dstfmt->Amask);
+    const __m256i keep = _mm256_set1_epi32(
+        (int)(dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask | dstfmt->Amask));
+    /* pixels without usable alpha count as opaque */
+    const __m256i d_opaque =
+        _mm256_set1_epi32(dstppa ? 0 : (int)dstfmt->Amask);
+    const __m128i ashift = _mm_cvtsi32_si128(srcppa ? srcfmt->Ashift : 0);
+    const __m256i a_mask = _mm256_set1_epi32(srcppa ? 0xFF : 0);
+    const __m256i a_opaque = _mm256_set1_epi32(srcppa ? 0 : 0xFF);
+    __m256i s, d, a;
+
+    while (height--) {
+        for (n = width >> 3; n > 0; --n) {
+            s = _mm256_loadu_si256((const __m256i *)src);
+            d = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)dst),
+                                d_opaque);
+            a = _mm256_or_si256(
+                _mm256_and_si256(_mm256_srl_epi32(s, ashift), a_mask),
+                a_opaque);
+            _mm256_storeu_si256((__m256i *)dst,
+                                _premul_blend_avx2(s, d, a, amask, keep));
+            src += 32;
+            dst += 32;
+        }
+        if (tail) {
+            memcpy(s_tail, src, tail * 4);
+            memcpy(d_tail, dst, tail * 4);
+            s = _mm256_loadu_si256((const __m256i *)s_tail);
+            d = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)d_tail),
+                                d_opaque);
+            a = _mm256_or_si256(
+                _mm256_and_si256(_mm256_srl_epi32(s, ashift), a_mask),
+                a_opaque);
+            _mm256_storeu_si256((__m256i *)d_tail,
+                                _premul_blend_avx2(s, d, a, amask, keep));
+            memcpy(dst, d_tail, tail * 4);
+            src += tail * 4;
+            dst += tail * 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+#endif /* PG_ENABLE_AVX2 */
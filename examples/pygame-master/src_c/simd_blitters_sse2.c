@@ -0,0 +1,384 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#define NO_PYGAME_C_API
+#include "simd_blitters.h"
+
+#if defined(PG_ENABLE_SSE2)
+
+#include <emmintrin.h>
+
+/* Where the source alpha of a pixel comes from */
+#define PG_ALPHA_FROM_PIXEL 0    /* alphablit_alpha */
+#define PG_ALPHA_FROM_COLORKEY 1 /* alphablit_colorkey */
+#define PG_ALPHA_FROM_BLANKET 2  /* alphablit_solid */
+
+/* ALPHA_BLEND for two pixels unpacked to 16 bit channels.
+ *
+ * The colour equation dC + (((sC - dC) * sA + sC) >> 8) is computed as
+ * (dC * (256 - sA) + sC * (sA + 1)) >> 8, which is the same value but never
+ * leaves the 0..65535 range, and sA * dA / 255 as (x + 1 + (x >> 8)) >> 8,
+ * which is exact for every x up to 255 * 255.
+ */
+static PG_INLINE void
+_alpha_blend_epi16_sse2(__m128i s, __m128i d, __m128i a, __m128i *colour,
+                        __m128i *alpha)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i c256 = _mm_set1_epi16(256);
+    __m128i x;
+
+    *colour = _mm_srli_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(c256, a)),
+                      _mm_mullo_epi16(s, _mm_add_epi16(a, one))),
+        8);
+
+    x = _mm_mullo_epi16(a, d);
+    x = _mm_srli_epi16(
+        _mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+    *alpha = _mm_sub_epi16(_mm_add_epi16(a, d), x);
+}
+
+/* ALPHA_BLEND for four pixels.
+ *
+ * a holds the source alpha of each pixel in the low byte of its lane.
+ * amask is the destination alpha channel (zero if it has none), keep the
+ * destination channels that get written and has_alpha is all ones when
+ * the destination has an alpha channel.
+ */
+static PG_INLINE __m128i
+_alpha_blend_sse2(__m128i s, __m128i d, __m128i a, __m128i amask,
+                  __m128i keep, __m128i has_alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i col_lo, col_hi, alp_lo, alp_hi;
+    __m128i blended, copy, transparent;
+
+    /* spread the alpha over all four bytes of its pixel */
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+    _alpha_blend_epi16_sse2(
+        _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero),
+        _mm_unpacklo_epi8(a, zero), &col_lo, &alp_lo);
+    _alpha_blend_epi16_sse2(
+        _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero),
+        _mm_unpackhi_epi8(a, zero), &col_hi, &alp_hi);
+
+    blended = _mm_or_si128(
+        _mm_andnot_si128(amask, _mm_packus_epi16(col_lo, col_hi)),
+        _mm_and_si128(amask, _mm_packus_epi16(alp_lo, alp_hi)));
+
+    /* A fully transparent destination pixel is replaced by the source */
+    copy = _mm_or_si128(_mm_andnot_si128(amask, s), _mm_and_si128(amask, a));
+    transparent = _mm_and_si128(
+        has_alpha, _mm_cmpeq_epi32(_mm_and_si128(d, amask), zero));
+    blended = _mm_or_si128(_mm_and_si128(transparent, copy),
+                           _mm_andnot_si128(transparent, blended));
+
+    return _mm_and_si128(blended, keep);
+}
+
+static PG_INLINE void
+_alphablit_sse2(SDL_BlitInfo *info, int alpha_from)
+{
+    int n;
+    int width = info->width;
+    int height = info->height;
+    int tail = width & 3;
+    Uint8 *src = info->s_pixels;
+    int srcskip = info->s_skip;
+    Uint8 *dst = info->d_pixels;
+    int dstskip = info->d_skip;
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+    Uint32 s_tail[4] = {0, 0, 0, 0};
+    Uint32 d_tail[4] = {0, 0, 0, 0};
+    const __m128i amask = _mm_set1_epi32((int)dstfmt->Amask);
+    const __m128i keep = _mm_set1_epi32((int)(dstfmt->Rmask | dstfmt->Gmask |
+                                              dstfmt->Bmask | dstfmt->Amask));
+    const __m128i has_alpha = _mm_set1_epi32(dstfmt->Amask ? -1 : 0);
+    const __m128i ashift = _mm_cvtsi32_si128(srcfmt->Ashift);
+    const __m128i low_byte = _mm_set1_epi32(0xFF);
+    const __m128i colorkey = _mm_set1_epi32((int)info->src_colorkey);
+    const __m128i blanket = _mm_set1_epi32(info->src_blanket_alpha);
+    __m128i s, d, a;
+
+#define _SOURCE_ALPHA                                                    \
+    switch (alpha_from) {                                                \
+        case PG_ALPHA_FROM_PIXEL:                                        \
+            a = _mm_and_si128(_mm_srl_epi32(s, ashift), low_byte);       \
+            break;                                                       \
+        case PG_ALPHA_FROM_COLORKEY:                                     \
+            a = _mm_andnot_si128(_mm_cmpeq_epi32(s, colorkey), blanket); \
+            break;                                                       \
+        default:                                                         \
+            a = blanket;                                                 \
+            break;                                                       \
+    }
+
+    while (height--) {
+        for (n = width >> 2; n > 0; --n) {
+            s = _mm_loadu_si128((const __m128i *)src);
+            d = _mm_loadu_si128((const __m128i *)dst);
+            _SOURCE_ALPHA;
+            _mm_storeu_si128(
+                (__m128i *)dst,
+                _alpha_blend_sse2(s, d, a, amask, keep, has_alpha));
+            src += 16;
+            dst += 16;
+        }
+        if (tail) {
+            /* finish the row on a padded copy so the result is the same
+               as for whole groups of four */
+            memcpy(s_tail, src, tail * 4);
+            memcpy(d_tail, dst, tail * 4);
+            s = _mm_loadu_si128((const __m128i *)s_tail);
+            d = _mm_loadu_si128((const __m128i *)d_tail);
+            _SOURCE_ALPHA;
+            _mm_storeu_si128(
+                (__m128i *)d_tail,
+                _alpha_blend_sse2(s, d, a, amask, keep, has_alpha));
+            memcpy(dst, d_tail, tail * 4);
+            src += tail * 4;
+            dst += tail * 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+
+#undef _SOURCE_ALPHA
+}
+
+void
+alphablit_alpha_sse2_argb(SDL_BlitInfo *info)
+{
+    _alphablit_sse2(info, PG_ALPHA_FROM_PIXEL);
+}
+
+void
+alphablit_colorkey_sse2_argb(SDL_BlitInfo *info)
+{
+    _alphablit_sse2(info, PG_ALPHA_FROM_COLORKEY);
+}
+
+void
+alphablit_solid_sse2_argb(SDL_BlitInfo *info)
+{
+    _alphablit_sse2(info, PG_ALPHA_FROM_BLANKET);
+}
+
+/* The BLEND_RGBA_* fast paths work on the rows as runs of bytes */
+#define PG_BLEND_RGBA_ADD 0
+#define PG_BLEND_RGBA_SUB 1
+#define PG_BLEND_RGBA_MULT 2
+#define PG_BLEND_RGBA_MIN 3
+#define PG_BLEND_RGBA_MAX 4
+
+static PG_INLINE __m128i
+_blend_rgba_sse2(__m128i s, __m128i d, int op)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo, hi;
+
+    switch (op) {
+        case PG_BLEND_RGBA_ADD:
+            return _mm_adds_epu8(d, s);
+        case PG_BLEND_RGBA_SUB:
+            return _mm_subs_epu8(d, s);
+        case PG_BLEND_RGBA_MIN:
+            return _mm_min_epu8(d, s);
+        case PG_BLEND_RGBA_MAX:
+            return _mm_max_epu8(d, s);
+        default:
+            /* (d * s) >> 8 is already 0 when either side is 0 */
+            lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                                                _mm_unpacklo_epi8(s, zero)),
+                                8);
+            hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                                                _mm_unpackhi_epi8(s, zero)),
+                                8);
+            return _mm_packus_epi16(lo, hi);
+    }
+}
+
+static PG_INLINE void
+_blit_blend_rgba_sse2(SDL_BlitInfo *info, int op)
+{
+    int n;
+    int bytes = info->width * 4;
+    int height = info->height;
+    int tail = bytes & 15;
+    Uint8 *src = info->s_pixels;
+    int srcskip = info->s_skip;
+    Uint8 *dst = info->d_pixels;
+    int dstskip = info->d_skip;
+    Uint8 s_tail[16] = {0};
+    Uint8 d_tail[16] = {0};
+    __m128i s, d;
+
+    while (height--) {
+        for (n = bytes >> 4; n > 0; --n) {
+            s = _mm_loadu_si128((const __m128i *)src);
+            d = _mm_loadu_si128((const __m128i *)dst);
+            _mm_storeu_si128((__m128i *)dst, _blend_rgba_sse2(s, d, op));
+            src += 16;
+            dst += 16;
+        }
+        if (tail) {
+            memcpy(s_tail, src, tail);
+            memcpy(d_tail, dst, tail);
+            s = _mm_loadu_si128((const __m128i *)s_tail);
+            d = _mm_loadu_si128((const __m128i *)d_tail);
+            _mm_storeu_si128((__m128i *)d_tail, _blend_rgba_sse2(s, d, op));
+            memcpy(dst, d_tail, tail);
+            src += tail;
+            dst += tail;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+void
+blit_blend_rgba_add_sse2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_sse2(info, PG_BLEND_RGBA_ADD);
+}
+
+void
+blit_blend_rgba_sub_sse2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_sse2(info, PG_BLEND_RGBA_SUB);
+}
+
+void
+blit_blend_rgba_mul_sse2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_sse2(info, PG_BLEND_RGBA_MULT);
+}
+
+void
+blit_blend_rgba_min_sse2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_sse2(info, PG_BLEND_RGBA_MIN);
+}
+
+void
+blit_blend_rgba_max_sse2_argb(SDL_BlitInfo *info)
+{
+    _blit_blend_rgba_sse2(info, PG_BLEND_RGBA_MAX);
+}
+
+/* ALPHA_BLEND_PREMULTIPLIED for four pixels, with the same conventions as
+ * _alpha_blend_sse2. sC + dC - ((dC * sA) >> 8) can reach 510; the pack
+ * back to bytes saturates it to 255 like the scalar code does.
+ */
+static PG_INLINE __m128i
+_premul_blend_sse2(__m128i s, __m128i d, __m128i a, __m128i amask,
+                   __m128i keep)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i s16, d16, a16, x;
+    __m128i col_lo, col_hi, alp_lo, alp_hi;
+
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+#define _PREMUL_HALF(unpack, colour, alpha)                                \
+    s16 = unpack(s, zero);                                                 \
+    d16 = unpack(d, zero);                                                 \
+    a16 = unpack(a, zero);                                                 \
+    colour = _mm_sub_epi16(_mm_add_epi16(s16, d16),                        \
+                           _mm_srli_epi16(_mm_mullo_epi16(d16, a16), 8));  \
+    x = _mm_mullo_epi16(a16, d16);                                         \
+    x = _mm_srli_epi16(                                                    \
+        _mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);    \
+    alpha = _mm_sub_epi16(_mm_add_epi16(a16, d16), x);
+
+    _PREMUL_HALF(_mm_unpacklo_epi8, col_lo, alp_lo);
+    _PREMUL_HALF(_mm_unpackhi_epi8, col_hi, alp_hi);
+#undef _PREMUL_HALF
+
+    return _mm_and_si128(
+        _mm_or_si128(
+            _mm_andnot_si128(amask, _mm_packus_epi16(col_lo, col_hi)),
+            _mm_and_si128(amask, _mm_packus_epi16(alp_lo, alp_hi))),
+        keep);
+}
+
+void
+blit_blend_premultiplied_sse2_argb(SDL_BlitInfo *info)
+{
+    int n;
+    int width = info->width;
+    int height = info->height;
+    int tail = width & 3;
+    Uint8 *src = info->s_pixels;
+    int srcskip = info->s_skip;
+    Uint8 *dst = info->d_pixels;
+    int dstskip = info->d_skip;
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+    int srcppa = info->src_blend != SDL_BLENDMODE_NONE && srcfmt->Amask;
+    int dstppa = info->dst_blend != SDL_BLENDMODE_NONE && dstfmt->Amask;
+    Uint32 s_tail[4] = {0, 0, 0, 0};
+    Uint32 d_tail[4] = {0, 0, 0, 0};
+    const __m128i amask = _mm_set1_epi32((int)dstfmt->Amask);
+    const __m128i keep = _mm_set1_epi32((int)(dstfmt->Rmask | dstfmt->Gmask |
+                                              dstfmt->Bmask | dstfmt->Amask));
+    /* pixels without usable alpha count as opaque */
+    const __m128i d_opaque = _mm_set1_epi32(dstppa ? 0 : (int)dstfmt->Amask);
+    const __m128i ashift = _mm_cvtsi32_si128(srcppa ? srcfmt->Ashift : 0);
+    const __m128i a_mask = _mm_set1_epi32(srcppa ? 0xFF : 0);
+    const __m128i a_opaque = _mm_set1_epi32(srcppa ? 0 : 0xFF);
+    __m128i s, d, a;
+
+    while (height--) {
+        for (n = width >> 2; n > 0; --n) {
+            s = _mm_loadu_si128((const __m128i *)src);
+            d = _mm_or_si128(_mm_loadu_si128((const __m128i *)dst), d_opaque);
+            a = _mm_or_si128(_mm_and_si128(_mm_srl_epi32(s, ashift), a_mask),
+                             a_opaque);
+            _mm_storeu_si128((__m128i *)dst,
+                             _premul_blend_sse2(s, d, a, amask, keep));
+            src += 16;
+            dst += 16;
+        }
+        if (tail) {
+            memcpy(s_tail, src, tail * 4);
+            memcpy(d_tail, dst, tail * 4);
+            s = _mm_loadu_si128((const __m128i *)s_tail);
+            d = _mm_or_si128(_mm_loadu_si128((const __m128i *)d_tail),
+                             d_opaque);
+            a = _mm_or_si128(_mm_and_si128(_mm_srl_epi32(s, ashift), a_mask),
+                             a_opaque);
+            _mm_storeu_si128((__m128i *)d_tail,
+                             _premul_blend_sse2(s, d, a, amask, keep));
+            memcpy(dst, d_tail, tail * 4);
+            src += tail * 4;
+            dst += tail * 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+#endif /* PG_ENABLE_SSE2 */
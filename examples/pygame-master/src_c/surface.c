@@ -37,6 +37,8 @@
 
 #include "pgbufferproxy.h"
 
+#include "simd_backend.h"
+
 typedef enum {
     VIEWKIND_0D = 0,
     VIEWKIND_1D = 1,
@@ -62,6 +64,11 @@ typedef struct pg_bufferinternal_s {
 int
 pgSurface_Blit(PyObject *dstobj, PyObject *srcobj, SDL_Rect *dstrect,
                SDL_Rect *srcrect, int the_args);
+static int
+_pg_blit_surfaces(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst,
+                  SDL_Rect *dstrect, int the_args);
+static SDL_Surface *
+_pg_blit_owner(PyObject *dstobj, int *offsetx, int *offsety);
 
 /* statics */
 #if IS_SDLv1
@@ -462,6 +469,7 @@ surface_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         self->weakreflist = NULL;
         self->dependency = NULL;
         self->locklist = NULL;
+        self->changes = 0;
     }
     return (PyObject *)self;
 }
@@ -843,7 +851,7 @@ surf_get_at(PyObject *self, PyObject *args)
     if (format->BytesPerPixel < 1 || format->BytesPerPixel > 4)
         return RAISE(PyExc_RuntimeError, "invalid color depth for surface");
 
-    if (!pgSurface_Lock(self))
+    if (!pgSurface_LockForRead(self))
         return NULL;
 
     pixels = (Uint8 *)surf->pixels;
@@ -1006,7 +1014,7 @@ surf_get_at_mapped(PyObject *self, PyObject *args)
     if (format->BytesPerPixel < 1 || format->BytesPerPixel > 4)
         return RAISE(PyExc_RuntimeError, "invalid color depth for surface");
 
-    if (!pgSurface_Lock(self))
+    if (!pgSurface_LockForRead(self))
         return NULL;
 
     pixels = (Uint8 *)surf->pixels;
@@ -1289,6 +1297,7 @@ surf_set_palette(PyObject *self, PyObject *args)
 #endif /* IS_SDLv2 */
     }
 
+    pgSurface_Changed(self);
 #if IS_SDLv1
     SDL_SetColors(surf, colors, 0, len);
     free(colors);
@@ -1339,6 +1348,7 @@ surf_set_palette_at(PyObject *self, PyObject *args)
         return RAISE(pgExc_SDLError,
                      "cannot set palette without pygame.display initialized");
 
+    pgSurface_Changed(self);
 #if IS_SDLv1
     color.r = rgba[0];
     color.g = rgba[1];
@@ -1410,6 +1420,7 @@ surf_set_colorkey(PyObject *self, PyObject *args)
         flags |= SDL_SRCCOLORKEY;
 #endif /* IS_SDLv1 */
 
+    pgSurface_Changed(self);
     pgSurface_Prep(self);
 #if IS_SDLv1
     result = SDL_SetColorKey(surf, flags, color);
@@ -2086,11 +2097,21 @@ surf_fill(PyObject *self, PyObject *args, PyObject *keywds)
         /* printf("%d, %d, %d, %d\n", sdlrect.x, sdlrect.y, sdlrect.w,
          * sdlrect.h); */
 
+        pgSurface_Changed(self);
+
         if (blendargs != 0) {
             /*
             printf ("Using blendargs: %d\n", blendargs);
             */
-            result = surface_fill_blend(surf, &sdlrect, color, blendargs);
+            if (pygame_GetFillThreads() > 1) {
+                Py_BEGIN_ALLOW_THREADS;
+                result =
+                    surface_fill_blend(surf, &sdlrect, color, blendargs);
+                Py_END_ALLOW_THREADS;
+            }
+            else {
+                result = surface_fill_blend(surf, &sdlrect, color, blendargs);
+            }
         }
         else {
             pgSurface_Prep(self);
@@ -2182,14 +2203,98 @@ surf_blit(PyObject *self, PyObject *args, PyObject *keywds)
 #define BLITS_ERR_MUST_ASSIGN_NUMERIC 7
 #define BLITS_ERR_BLIT_FAIL 8
 
+/* One parsed Surface.blits() entry. The source reference is owned. */
+typedef struct {
+    PyObject *srcobj;
+    SDL_Rect srcrect;
+    SDL_Rect dstrect;
+    int the_args;
+} pg_BlitsItem;
+
+static void
+_blits_free_items(pg_BlitsItem *items, Py_ssize_t nitems)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < nitems; ++i) {
+        Py_DECREF(items[i].srcobj);
+    }
+    PyMem_Free(items);
+}
+
+/* Run every parsed blit onto dstobj with the GIL released. Sources are
+ * prepped once per run of consecutive entries that share a surface, and a
+ * subsurface destination is resolved to its owner once for the whole batch.
+ * Returns the index of the first failed blit, or nitems if all succeeded.
+ */
+static Py_ssize_t
+_blits_run(PyObject *dstobj, pg_BlitsItem *items, Py_ssize_t nitems)
+{
+    SDL_Surface *dst = pgSurface_AsSurface(dstobj);
+    SDL_Surface *subsurface, *src = NULL;
+    SDL_Rect orig_clip, sub_clip;
+    int suboffsetx, suboffsety;
+    Py_ssize_t i, failed = nitems;
+
+    pgSurface_Changed(dstobj);
+    subsurface = _pg_blit_owner(dstobj, &suboffsetx, &suboffsety);
+    if (subsurface) {
+        SDL_GetClipRect(subsurface, &orig_clip);
+        SDL_GetClipRect(dst, &sub_clip);
+        sub_clip.x += suboffsetx;
+        sub_clip.y += suboffsety;
+        SDL_SetClipRect(subsurface, &sub_clip);
+        dst = subsurface;
+    }
+    else {
+        pgSurface_Prep(dstobj);
+    }
+    for (i = 0; i < nitems; ++i) {
+        if (i == 0 || items[i].srcobj != items[i - 1].srcobj) {
+            pgSurface_Prep(items[i].srcobj);
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    for (i = 0; i < nitems; ++i) {
+        pg_BlitsItem *item = items + i;
+
+        if (i == 0 || item->srcobj != items[i - 1].srcobj) {
+            src = pgSurface_AsSurface(item->srcobj);
+        }
+        item->dstrect.x += suboffsetx;
+        item->dstrect.y += suboffsety;
+        if (_pg_blit_surfaces(src, &item->srcrect, dst, &item->dstrect,
+                              item->the_args) != 0) {
+            failed = i;
+            break;
+        }
+        item->dstrect.x -= suboffsetx;
+        item->dstrect.y -= suboffsety;
+    }
+    Py_END_ALLOW_THREADS;
+
+    for (i = 0; i < nitems; ++i) {
+        if (i == 0 || items[i].srcobj != items[i - 1].srcobj) {
+            pgSurface_Unprep(items[i].srcobj);
+        }
+    }
+    if (subsurface) {
+        SDL_SetClipRect(subsurface, &orig_clip);
+    }
+    else {
+        pgSurface_Unprep(dstobj);
+    }
+    return failed;
+}
+
 static PyObject *
 surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
 {
     SDL_Surface *src, *dest = pgSurface_AsSurface(self);
     GAME_Rect *src_rect, temp;
     PyObject *srcobject = NULL, *argpos = NULL, *argrect = NULL;
-    int dx, dy, result;
-    SDL_Rect dest_rect, sdlsrc_rect;
+    int dx, dy;
     int sx, sy;
     int the_args = 0;
 
@@ -2200,6 +2305,8 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
     PyObject *ret = NULL;
     PyObject *retrect = NULL;
     Py_ssize_t itemlength;
+    pg_BlitsItem *items = NULL, *newitems, *blit;
+    Py_ssize_t nitems = 0, maxitems = 0, i;
     int doreturn = 1;
     int bliterrornum = 0;
     static char *kwids[] = {"blit_sequence", "doreturn", NULL};
@@ -2207,11 +2314,6 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
                                      &doreturn))
         return NULL;
 
-    if (doreturn) {
-        ret = PyList_New(0);
-        if (!ret)
-            return NULL;
-    }
     if (!PyIter_Check(blitsequence) && !PySequence_Check(blitsequence)) {
         bliterrornum = BLITS_ERR_SEQUENCE_REQUIRED;
         goto bliterror;
@@ -2221,6 +2323,9 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
         return NULL;
     }
 
+    /* First convert the whole sequence, so the blits themselves can run
+     * without touching any Python objects.
+     */
     while ((item = PyIter_Next(iterator))) {
         if (PySequence_Check(item)) {
             itemlength = PySequence_Length(item);
@@ -2234,10 +2339,6 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
             goto bliterror;
         }
         bliterrornum = 0;
-        srcobject = NULL;
-        argpos = NULL;
-        argrect = NULL;
-        special_flags = NULL;
         the_args = 0;
         if (itemlength >= 2) {
             /* (Surface, dest) */
@@ -2253,13 +2354,14 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
             special_flags = PySequence_GetItem(item, 3);
         }
         Py_DECREF(item);
+        item = NULL;
 
-        src = pgSurface_AsSurface(srcobject);
         if (!dest) {
             bliterrornum = BLITS_ERR_DISPLAY_SURF_QUIT;
             goto bliterror;
         }
-        if (!src) {
+        if (!srcobject || !pgSurface_Check(srcobject) ||
+            !(src = pgSurface_AsSurface(srcobject))) {
             bliterrornum = BLITS_ERR_SEQUENCE_SURF;
             goto bliterror;
         }
@@ -2297,15 +2399,6 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
             src_rect = &temp;
         }
 
-        dest_rect.x = (short)dx;
-        dest_rect.y = (short)dy;
-        dest_rect.w = (unsigned short)src_rect->w;
-        dest_rect.h = (unsigned short)src_rect->h;
-        sdlsrc_rect.x = (short)src_rect->x;
-        sdlsrc_rect.y = (short)src_rect->y;
-        sdlsrc_rect.w = (unsigned short)src_rect->w;
-        sdlsrc_rect.h = (unsigned short)src_rect->h;
-
         if (special_flags) {
             if (!pg_IntFromObj(special_flags, &the_args)) {
                 bliterrornum = BLITS_ERR_MUST_ASSIGN_NUMERIC;
@@ -2313,31 +2406,65 @@ surf_blits(PyObject *self, PyObject *args, PyObject *keywds)
             }
         }
 
-        Py_DECREF(srcobject);
+        if (nitems == maxitems) {
+            maxitems = maxitems ? maxitems * 2 : 64;
+            newitems = PyMem_Resize(items, pg_BlitsItem, maxitems);
+            if (!newitems) {
+                PyErr_NoMemory();
+                goto bliterror;
+            }
+            items = newitems;
+        }
+        blit = items + nitems++;
+        blit->srcobj = srcobject;
+        blit->dstrect.x = (short)dx;
+        blit->dstrect.y = (short)dy;
+        blit->dstrect.w = (unsigned short)src_rect->w;
+        blit->dstrect.h = (unsigned short)src_rect->h;
+        blit->srcrect.x = (short)src_rect->x;
+        blit->srcrect.y = (short)src_rect->y;
+        blit->srcrect.w = (unsigned short)src_rect->w;
+        blit->srcrect.h = (unsigned short)src_rect->h;
+        blit->the_args = the_args;
+
+        /* the new entry now owns the source reference */
+        srcobject = NULL;
         Py_DECREF(argpos);
+        argpos = NULL;
         Py_XDECREF(argrect);
+        argrect = NULL;
         Py_XDECREF(special_flags);
-
-        result = pgSurface_Blit(self, srcobject, &dest_rect, &sdlsrc_rect,
-                                the_args);
-        if (result != 0) {
-            bliterrornum = BLITS_ERR_BLIT_FAIL;
-            goto bliterror;
-        }
-
-        if (doreturn) {
-            retrect = NULL;
-            retrect = pgRect_New(&dest_rect);
-            PyList_Append(ret, retrect);
-            Py_DECREF(retrect);
-        }
+        special_flags = NULL;
     }
 
     Py_DECREF(iterator);
+    iterator = NULL;
     if (PyErr_Occurred()) {
         goto bliterror;
     }
 
+    if (nitems && _blits_run(self, items, nitems) != nitems) {
+        bliterrornum = BLITS_ERR_BLIT_FAIL;
+        goto bliterror;
+    }
+
+    if (doreturn) {
+        ret = PyList_New(nitems);
+        if (!ret) {
+            goto bliterror;
+        }
+        for (i = 0; i < nitems; ++i) {
+            retrect = pgRect_New(&items[i].dstrect);
+            if (!retrect) {
+                goto bliterror;
+            }
+            PyList_SET_ITEM(ret, i, retrect);
+        }
+    }
+    if (items) {
+        _blits_free_items(items, nitems);
+    }
+
     if (doreturn) {
         return ret;
     }
@@ -2352,6 +2479,13 @@ bliterror:
     Py_XDECREF(special_flags);
     Py_XDECREF(iterator);
     Py_XDECREF(item);
+    Py_XDECREF(ret);
+    if (items) {
+        _blits_free_items(items, nitems);
+    }
+    if (PyErr_Occurred() && !bliterrornum) {
+        return NULL;
+    }
 
     switch (bliterrornum) {
         case BLITS_ERR_SEQUENCE_REQUIRED:
@@ -2920,7 +3054,7 @@ surf_get_bounding_rect(PyObject *self, PyObject *args, PyObject *kwargs)
     if (!surf)
         return RAISE(pgExc_SDLError, "display Surface quit");
 
-    if (!pgSurface_Lock(self))
+    if (!pgSurface_LockForRead(self))
         return RAISE(pgExc_SDLError, "could not lock surface");
 
 #if IS_SDLv1
@@ -3856,56 +3990,19 @@ surface_do_overlap(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst,
     return dstoffset < span || dstoffset > src->pitch - span;
 }
 
-/*this internal blit function is accessable through the C api*/
-int
-pgSurface_Blit(PyObject *dstobj, PyObject *srcobj, SDL_Rect *dstrect,
-               SDL_Rect *srcrect, int the_args)
+/* Pick the right blitter for src and dst and run it. Only SDL and the
+ * pygame blitters are called, so this is safe with the GIL released.
+ */
+static int
+_pg_blit_surfaces(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst,
+                  SDL_Rect *dstrect, int the_args)
 {
-    SDL_Surface *src = pgSurface_AsSurface(srcobj);
-    SDL_Surface *dst = pgSurface_AsSurface(dstobj);
-    SDL_Surface *subsurface = NULL;
-    int result, suboffsetx = 0, suboffsety = 0;
-    SDL_Rect orig_clip, sub_clip;
+    int result;
 #if IS_SDLv2
     Uint8 alpha;
     Uint32 key;
 #endif /* IS_SDLv2 */
 
-    /* passthrough blits to the real surface */
-    if (((pgSurfaceObject *)dstobj)->subsurface) {
-        PyObject *owner;
-        struct pgSubSurface_Data *subdata;
-
-        subdata = ((pgSurfaceObject *)dstobj)->subsurface;
-        owner = subdata->owner;
-        subsurface = pgSurface_AsSurface(owner);
-        suboffsetx = subdata->offsetx;
-        suboffsety = subdata->offsety;
-
-        while (((pgSurfaceObject *)owner)->subsurface) {
-            subdata = ((pgSurfaceObject *)owner)->subsurface;
-            owner = subdata->owner;
-            subsurface = pgSurface_AsSurface(owner);
-            suboffsetx += subdata->offsetx;
-            suboffsety += subdata->offsety;
-        }
-
-        SDL_GetClipRect(subsurface, &orig_clip);
-        SDL_GetClipRect(dst, &sub_clip);
-        sub_clip.x += suboffsetx;
-        sub_clip.y += suboffsety;
-        SDL_SetClipRect(subsurface, &sub_clip);
-        dstrect->x += suboffsetx;
-        dstrect->y += suboffsety;
-        dst = subsurface;
-    }
-    else {
-        pgSurface_Prep(dstobj);
-        subsurface = NULL;
-    }
-
-    pgSurface_Prep(srcobj);
-
 #if IS_SDLv1
     /* This test fails if this first condition is not used.
        File "test/surface_test.py", in test_pixel_alpha
@@ -4030,6 +4127,66 @@ pgSurface_Blit(PyObject *dstobj, PyObject *srcobj, SDL_Rect *dstrect,
         /* Py_END_ALLOW_THREADS */
     }
 
+    return result;
+}
+
+/* Blits to a subsurface land on the surface that owns its pixels. Return
+ * that root owner and the subsurface offset within it, or NULL if dstobj
+ * is not a subsurface.
+ */
+static SDL_Surface *
+_pg_blit_owner(PyObject *dstobj, int *offsetx, int *offsety)
+{
+    PyObject *owner;
+    struct pgSubSurface_Data *subdata;
+
+    *offsetx = *offsety = 0;
+    if (!((pgSurfaceObject *)dstobj)->subsurface) {
+        return NULL;
+    }
+    owner = dstobj;
+    while (((pgSurfaceObject *)owner)->subsurface) {
+        subdata = ((pgSurfaceObject *)owner)->subsurface;
+        owner = subdata->owner;
+        *offsetx += subdata->offsetx;
+        *offsety += subdata->offsety;
+    }
+    return pgSurface_AsSurface(owner);
+}
+
+/*this internal blit function is accessable through the C api*/
+int
+pgSurface_Blit(PyObject *dstobj, PyObject *srcobj, SDL_Rect *dstrect,
+               SDL_Rect *srcrect, int the_args)
+{
+    SDL_Surface *src = pgSurface_AsSurface(srcobj);
+    SDL_Surface *dst = pgSurface_AsSurface(dstobj);
+    SDL_Surface *subsurface = NULL;
+    int result, suboffsetx = 0, suboffsety = 0;
+    SDL_Rect orig_clip, sub_clip;
+
+    pgSurface_Changed(dstobj);
+
+    /* passthrough blits to the real surface */
+    subsurface = _pg_blit_owner(dstobj, &suboffsetx, &suboffsety);
+    if (subsurface) {
+        SDL_GetClipRect(subsurface, &orig_clip);
+        SDL_GetClipRect(dst, &sub_clip);
+        sub_clip.x += suboffsetx;
+        sub_clip.y += suboffsety;
+        SDL_SetClipRect(subsurface, &sub_clip);
+        dstrect->x += suboffsetx;
+        dstrect->y += suboffsety;
+        dst = subsurface;
+    }
+    else {
+        pgSurface_Prep(dstobj);
+    }
+
+    pgSurface_Prep(srcobj);
+
+    result = _pg_blit_surfaces(src, srcrect, dst, dstrect, the_args);
+
     if (subsurface) {
         SDL_SetClipRect(subsurface, &orig_clip);
         dstrect->x -= suboffsetx;
@@ -4047,7 +4204,78 @@ pgSurface_Blit(PyObject *dstobj, PyObject *srcobj, SDL_Rect *dstrect,
     return result != 0;
 }
 
-static PyMethodDef _surface_methods[] = {{NULL, NULL, 0, NULL}};
+static PyObject *
+surf_get_blit_backend(PyObject *self, PyObject *args)
+{
+    return Text_FromUTF8(pygame_GetBlitBackend());
+}
+
+static PyObject *
+surf_set_blit_backend(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"type", NULL};
+    const char *type;
+    int status;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s:_set_blit_backend",
+                                     keywords, &type)) {
+        return NULL;
+    }
+
+    status = pygame_SetBlitBackend(type);
+    if (status) {
+        return pg_backend_error(type, status);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+surf_get_threads(PyObject *self, PyObject *args)
+{
+    return PyInt_FromLong(pygame_GetFillThreads());
+}
+
+static PyObject *
+surf_set_threads(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"count", NULL};
+    static int quit_registered = 0;
+    int count;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:_set_threads",
+                                     keywords, &count)) {
+        return NULL;
+    }
+    if (count < 0) {
+        return RAISE(PyExc_ValueError, "count must not be negative");
+    }
+    if (pygame_SetFillThreads(count)) {
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    if (!quit_registered && pygame_GetFillThreads() > 1) {
+        pg_RegisterQuit(pygame_QuitFillThreads);
+        quit_registered = 1;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef _surface_methods[] = {
+    {"_get_blit_backend", surf_get_blit_backend, METH_NOARGS,
+     "_get_blit_backend() -> String\n"
+     "return the blitter version in use: 'GENERIC', 'SSE2' or 'AVX2'"},
+    {"_set_blit_backend", (PyCFunction)surf_set_blit_backend,
+     METH_VARARGS | METH_KEYWORDS,
+     "_set_blit_backend(type) -> None\n"
+     "set the blitter version to one of: 'GENERIC', 'SSE2' or 'AVX2'"},
+    {"_get_threads", surf_get_threads, METH_NOARGS,
+     "_get_threads() -> int\n"
+     "return how many threads Surface.fill with special_flags may use"},
+    {"_set_threads", (PyCFunction)surf_set_threads,
+     METH_VARARGS | METH_KEYWORDS,
+     "_set_threads(count) -> None\n"
+     "let Surface.fill with special_flags use count threads, "
+     "0 for one per CPU"},
+    {NULL, NULL, 0, NULL}};
 
 MODINIT_DEFINE(surface)
 {
@@ -4096,6 +4324,8 @@ MODINIT_DEFINE(surface)
         MODINIT_ERROR;
     }
 
+    pygame_InitBlitBackend();
+
     /* create the module */
 #if PY3
     module = PyModule_Create(&_module);
@@ -372,6 +372,15 @@ surface_fill_blend (SDL_Surface *surface, SDL_Rect *rect, Uint32 color,
 void
 surface_respect_clip_rect (SDL_Surface *surface, SDL_Rect *rect);
 
+int
+pygame_SetFillThreads (int count);
+
+int
+pygame_GetFillThreads (void);
+
+void
+pygame_QuitFillThreads (void);
+
 int
 pygame_AlphaBlit (SDL_Surface * src, SDL_Rect * srcrect,
                   SDL_Surface * dst, SDL_Rect * dstrect, int the_args);
@@ -380,4 +389,13 @@ int
 pygame_Blit (SDL_Surface * src, SDL_Rect * srcrect,
              SDL_Surface * dst, SDL_Rect * dstrect, int the_args);
 
+void
+pygame_InitBlitBackend (void);
+
+const char *
+pygame_GetBlitBackend (void);
+
+int
+pygame_SetBlitBackend (const char *type);
+
 #endif /* SURFACE_H */
@@ -0,0 +1,171 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "surface_cache.h"
+
+#include <string.h>
+
+static void
+_cache_drop(pg_surface_cache *cache, int index)
+{
+    pg_surface_cache_entry *entry = cache->entries + index;
+
+    Py_DECREF(entry->ref);
+    cache->free_value(entry->value);
+    cache->cost -= entry->cost;
+    *entry = cache->entries[--cache->count];
+}
+
+static void
+_cache_drop_lru(pg_surface_cache *cache)
+{
+    int i, lru;
+
+    for (lru = 0, i = 1; i < cache->count; ++i) {
+        if (cache->entries[i].used < cache->entries[lru].used) {
+            lru = i;
+        }
+    }
+    _cache_drop(cache, lru);
+}
+
+/* Return the index of the entry for a source and key, whatever its change
+ * count, or -1. Entries left by a dead surface at the same address are
+ * dropped on the way.
+ */
+static int
+_cache_index(pg_surface_cache *cache, PyObject *surfobj, const void *key,
+             size_t keysize)
+{
+    pg_surface_cache_entry *entry;
+    int i = 0;
+
+    while (i < cache->count) {
+        entry = cache->entries + i;
+        if (entry->surfobj != surfobj ||
+            memcmp(entry->key, key, keysize) != 0) {
+            ++i;
+        }
+        else if (PyWeakref_GetObject(entry->ref) != surfobj) {
+            _cache_drop(cache, i);
+        }
+        else {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void *
+pg_surface_cache_find(pg_surface_cache *cache, PyObject *surfobj,
+                      const void *key, size_t keysize,
+                      unsigned long changes)
+{
+    pg_surface_cache_entry *entry;
+    int i;
+
+    if (cache->count == 0) {
+        return NULL;
+    }
+    i = _cache_index(cache, surfobj, key, keysize);
+    if (i < 0) {
+        return NULL;
+    }
+    entry = cache->entries + i;
+    if (entry->changes != changes) {
+        _cache_drop(cache, i);
+        return NULL;
+    }
+    entry->used = ++cache->clock;
+    return entry->value;
+}
+
+int
+pg_surface_cache_store(pg_surface_cache *cache, PyObject *surfobj,
+                       const void *key, size_t keysize,
+                       unsigned long changes, void *value, size_t cost)
+{
+    pg_surface_cache_entry *entry;
+    PyObject *ref;
+    int i;
+
+    if (cost > cache->budget) {
+        cache->free_value(value);
+        return -1;
+    }
+
+    i = _cache_index(cache, surfobj, key, keysize);
+    if (i >= 0) {
+        _cache_drop(cache, i);
+    }
+    while (cache->cost + cost > cache->budget) {
+        _cache_drop_lru(cache);
+    }
+    if (cache->count == cache->alloc) {
+        int alloc = cache->alloc ? cache->alloc * 2 : 16;
+        pg_surface_cache_entry *entries = cache->entries;
+
+        PyMem_Resize(entries, pg_surface_cache_entry, alloc);
+        if (!entries) {
+            cache->free_value(value);
+            return -1;
+        }
+        cache->entries = entries;
+        cache->alloc = alloc;
+    }
+
+    ref = PyWeakref_NewRef(surfobj, NULL);
+    if (!ref) {
+        PyErr_Clear();
+        cache->free_value(value);
+        return -1;
+    }
+    entry = cache->entries + cache->count++;
+    entry->surfobj = surfobj;
+    entry->ref = ref;
+    memset(entry->key, 0, sizeof(entry->key));
+    memcpy(entry->key, key, keysize);
+    entry->changes = changes;
+    entry->used = ++cache->clock;
+    entry->cost = cost;
+    entry->value = value;
+    cache->cost += cost;
+    return 0;
+}
+
+void
+pg_surface_cache_resize(pg_surface_cache *cache, size_t budget)
+{
+    while (cache->cost > budget) {
+        _cache_drop_lru(cache);
+    }
+    if (cache->count == 0) {
+        PyMem_Free(cache->entries);
+        cache->entries = NULL;
+        cache->alloc = 0;
+    }
+    cache->budget = budget;
+}
+
+void
+pg_surface_cache_clear(pg_surface_cache *cache)
+{
+    while (cache->count > 0) {
+        _cache_drop(cache, cache->count - 1);
+    }
+}
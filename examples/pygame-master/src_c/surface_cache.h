@@ -0,0 +1,96 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Results computed from the pixels of a surface, kept for the mask and
+ * rotation caches.
+ *
+ * An entry belongs to a source surface and a small key, such as an alpha
+ * threshold or an angle, and holds a value the caller built. It is only
+ * handed back while the change count of the source, as given by
+ * pgSurface_GetChanges(), is what it was before the value was made.
+ * Sources are held by weak references. Each entry has a cost, and when the
+ * costs would go over the budget the least recently used entries are
+ * dropped.
+ *
+ * Callers own the values: they pass a function to free them, and copy
+ * values in and out as their payload needs. The functions here take the
+ * GIL for granted, and take no C API slots, so that each module they are
+ * compiled into passes in the change counts it got through its own.
+ */
+#if !defined(SURFACE_CACHE_HEADER)
+#define SURFACE_CACHE_HEADER
+
+#include <Python.h>
+
+#define PG_SURFACE_CACHE_KEY_SIZE 16
+
+typedef struct {
+    PyObject *surfobj; /* compared first, then confirmed with ref */
+    PyObject *ref;
+    char key[PG_SURFACE_CACHE_KEY_SIZE];
+    unsigned long changes;
+    unsigned long used;
+    size_t cost;
+    void *value;
+} pg_surface_cache_entry;
+
+typedef struct {
+    void (*free_value)(void *value);
+    size_t budget; /* 0 keeps nothing */
+    size_t cost;
+    pg_surface_cache_entry *entries;
+    int count;
+    int alloc;
+    unsigned long clock;
+} pg_surface_cache;
+
+#define PG_SURFACE_CACHE_INIT(free_value, budget) {(free_value), (budget)}
+
+/* Return the value kept for surfobj and key, or NULL if there is none or
+ * the source had another change count than changes when it was made. The
+ * key is keysize bytes, at most PG_SURFACE_CACHE_KEY_SIZE, compared as
+ * bytes, so callers clear any padding in it.
+ */
+void *
+pg_surface_cache_find(pg_surface_cache *cache, PyObject *surfobj,
+                      const void *key, size_t keysize,
+                      unsigned long changes);
+
+/* Keep value for surfobj and key, made while the source had the change
+ * count changes, replacing any value kept before. The cache owns value
+ * from then on, and frees it at once if its cost does not fit the budget.
+ *
+ * Returns 0 if value is kept, or -1, with no Python error set, if it was
+ * freed instead.
+ */
+int
+pg_surface_cache_store(pg_surface_cache *cache, PyObject *surfobj,
+                       const void *key, size_t keysize,
+                       unsigned long changes, void *value, size_t cost);
+
+/* Change the budget, dropping the least recently used values that no
+ * longer fit.
+ */
+void
+pg_surface_cache_resize(pg_surface_cache *cache, size_t budget);
+
+/* Drop every value, keeping the budget. */
+void
+pg_surface_cache_clear(pg_surface_cache *cache);
+
+#endif /* SURFACE_CACHE_HEADER */
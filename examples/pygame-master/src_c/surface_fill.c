@@ -19,6 +19,7 @@
 
 #define NO_PYGAME_C_API
 #include "_surface.h"
+#include "thread_pool.h"
 
 /*
  * Changes SDL_Rect to respect any clipping rect defined on the surface.
@@ -928,12 +929,111 @@ surface_fill_blend_rgba_max(SDL_Surface *surface, SDL_Rect *rect, Uint32 color)
     return result;
 }
 
+/* ------------------------- */
+
+/*
+ * Parallel blend fills.
+ *
+ * When enabled with pygame_SetFillThreads, a large fill rect is cut into
+ * bands of whole rows and each band is handed to the ordinary fill
+ * function above, on the shared thread pool. The bands touch disjoint
+ * pixels, so no locking is needed beyond handing out the work.
+ */
+#define PG_FILL_MIN_PIXELS (256 * 256)
+#define PG_FILL_MIN_ROWS 16
+
+typedef int (*fill_func)(SDL_Surface *, SDL_Rect *, Uint32);
+
+typedef struct {
+    fill_func func;
+    SDL_Surface *surface;
+    SDL_Rect rect;
+    Uint32 color;
+    int result;
+} FillBand;
+
+static pg_thread_pool fill_pool = PG_THREAD_POOL_INIT("pygame fill");
+static FillBand fill_bands[PG_POOL_MAX_THREADS];
+
+static void
+_fill_band(void *data, int i)
+{
+    FillBand *band = (FillBand *)data + i;
+    band->result = band->func(band->surface, &band->rect, band->color);
+}
+
+static int
+surface_fill_parallel(fill_func func, SDL_Surface *surface, SDL_Rect *rect,
+                      Uint32 color)
+{
+    int nbands = fill_pool.threads;
+    int y, i, result = 0;
+
+    if (rect->h / PG_FILL_MIN_ROWS < nbands) {
+        nbands = rect->h / PG_FILL_MIN_ROWS;
+    }
+    /* Another thread may be filling with the GIL released; it keeps the
+     * pool and this fill simply runs on its own.
+     */
+    if (rect->w * rect->h < PG_FILL_MIN_PIXELS ||
+        !pg_pool_acquire(&fill_pool, nbands)) {
+        return func(surface, rect, color);
+    }
+
+    for (i = 0, y = rect->y; i < nbands; ++i) {
+        fill_bands[i].func = func;
+        fill_bands[i].surface = surface;
+        fill_bands[i].color = color;
+        fill_bands[i].rect.x = rect->x;
+        fill_bands[i].rect.y = y;
+        fill_bands[i].rect.w = rect->w;
+        fill_bands[i].rect.h = rect->h * (i + 1) / nbands - (y - rect->y);
+        y += fill_bands[i].rect.h;
+    }
+    pg_pool_run(&fill_pool, _fill_band, fill_bands, nbands);
+
+    for (i = 0; i < nbands; ++i) {
+        if (fill_bands[i].result) {
+            result = fill_bands[i].result;
+        }
+    }
+    return result;
+}
+
+/*
+ * Set how many threads a blend fill may use, counting the calling thread.
+ * 1 (the default) keeps every fill on the calling thread, 0 picks one
+ * thread per CPU (SDL 1 cannot count CPUs and stays at 1). Returns -1 if
+ * the synchronization objects could not be created.
+ */
+int
+pygame_SetFillThreads(int count)
+{
+    return pg_pool_set_threads(&fill_pool, count);
+}
+
+int
+pygame_GetFillThreads(void)
+{
+    return fill_pool.threads;
+}
+
+/* Join the worker threads. They are started again by the next large fill
+ * if parallel fills are still enabled.
+ */
+void
+pygame_QuitFillThreads(void)
+{
+    pg_pool_quit(&fill_pool);
+}
+
 int
 surface_fill_blend(SDL_Surface *surface, SDL_Rect *rect, Uint32 color,
                    int blendargs)
 {
     int result = -1;
     int locked = 0;
+    fill_func func;
 
     surface_respect_clip_rect(surface, rect);
 
@@ -946,53 +1046,57 @@ surface_fill_blend(SDL_Surface *surface, SDL_Rect *rect, Uint32 color,
 
     switch (blendargs) {
         case PYGAME_BLEND_ADD: {
-            result = surface_fill_blend_add(surface, rect, color);
+            func = surface_fill_blend_add;
             break;
         }
         case PYGAME_BLEND_SUB: {
-            result = surface_fill_blend_sub(surface, rect, color);
+            func = surface_fill_blend_sub;
             break;
         }
         case PYGAME_BLEND_MULT: {
-            result = surface_fill_blend_mult(surface, rect, color);
+            func = surface_fill_blend_mult;
             break;
         }
         case PYGAME_BLEND_MIN: {
-            result = surface_fill_blend_min(surface, rect, color);
+            func = surface_fill_blend_min;
             break;
         }
         case PYGAME_BLEND_MAX: {
-            result = surface_fill_blend_max(surface, rect, color);
+            func = surface_fill_blend_max;
             break;
         }
 
         case PYGAME_BLEND_RGBA_ADD: {
-            result = surface_fill_blend_rgba_add(surface, rect, color);
+            func = surface_fill_blend_rgba_add;
             break;
         }
         case PYGAME_BLEND_RGBA_SUB: {
-            result = surface_fill_blend_rgba_sub(surface, rect, color);
+            func = surface_fill_blend_rgba_sub;
             break;
         }
         case PYGAME_BLEND_RGBA_MULT: {
-            result = surface_fill_blend_rgba_mult(surface, rect, color);
+            func = surface_fill_blend_rgba_mult;
             break;
         }
         case PYGAME_BLEND_RGBA_MIN: {
-            result = surface_fill_blend_rgba_min(surface, rect, color);
+            func = surface_fill_blend_rgba_min;
             break;
         }
         case PYGAME_BLEND_RGBA_MAX: {
-            result = surface_fill_blend_rgba_max(surface, rect, color);
+            func = surface_fill_blend_rgba_max;
             break;
         }
 
         default: {
-            result = -1;
+            func = NULL;
             break;
         }
     }
 
+    if (func) {
+        result = surface_fill_parallel(func, surface, rect, color);
+    }
+
     if (locked) {
         SDL_UnlockSurface(surface);
     }
@@ -38,6 +38,14 @@ static int
 pgSurface_LockBy(PyObject *, PyObject *);
 static int
 pgSurface_UnlockBy(PyObject *, PyObject *);
+static int
+_pg_lock_by(PyObject *, PyObject *);
+static void
+pgSurface_Changed(PyObject *);
+static int
+pgSurface_LockForRead(PyObject *);
+static int
+pgSurface_GetChanges(PyObject *, unsigned long *);
 
 static void
 _lifelock_dealloc(PyObject *);
@@ -49,7 +57,7 @@ pgSurface_Prep(PyObject *surfobj)
     if (data != NULL) {
         SDL_Surface *surf = pgSurface_AsSurface(surfobj);
         SDL_Surface *owner = pgSurface_AsSurface(data->owner);
-        pgSurface_LockBy(data->owner, surfobj);
+        _pg_lock_by(data->owner, surfobj);
         surf->pixels = ((char *)owner->pixels) + data->pixeloffset;
     }
 }
@@ -75,8 +83,76 @@ pgSurface_Unlock(PyObject *surfobj)
     return pgSurface_UnlockBy(surfobj, surfobj);
 }
 
+/* Count a possible change to the pixels of a surface, and of the surfaces
+ * it is a subsurface of, as they share those pixels. Anything that keeps a
+ * result computed from the pixels, like the mask and rotation caches,
+ * compares these counts, summed by pgSurface_GetChanges(), to tell whether
+ * the result is still good. Locking a surface counts as a change, since
+ * its pixels can be written while it is locked.
+ */
+static void
+pgSurface_Changed(PyObject *surfobj)
+{
+    pgSurfaceObject *surf = (pgSurfaceObject *)surfobj;
+
+    while (surf != NULL) {
+        ++surf->changes;
+        surf = surf->subsurface != NULL
+                   ? (pgSurfaceObject *)surf->subsurface->owner
+                   : NULL;
+    }
+}
+
+/* Sum the change counts of a surface and the surfaces it is a subsurface
+ * of into changes. Returns 0 if no result computed from the pixels can be
+ * trusted to stay good: one of them is locked, so its pixels can change at
+ * any time, the pixels belong to something else that writes them without
+ * counting a change, like a frombuffer() image, or the display has quit.
+ * Subsurfaces are SDL_PREALLOC too, but share the pixels of their owner,
+ * which is checked instead.
+ */
+static int
+pgSurface_GetChanges(PyObject *surfobj, unsigned long *changes)
+{
+    pgSurfaceObject *surf = (pgSurfaceObject *)surfobj;
+
+    *changes = 0;
+    while (surf != NULL) {
+        if (!surf->surf || surf->surf->locked) {
+            return 0;
+        }
+        if (!surf->subsurface && (surf->surf->flags & SDL_PREALLOC)) {
+            return 0;
+        }
+        *changes += surf->changes;
+        surf = surf->subsurface != NULL
+                   ? (pgSurfaceObject *)surf->subsurface->owner
+                   : NULL;
+    }
+    return 1;
+}
+
 static int
 pgSurface_LockBy(PyObject *surfobj, PyObject *lockobj)
+{
+    pgSurface_Changed(surfobj);
+    return _pg_lock_by(surfobj, lockobj);
+}
+
+/* Lock a surface that is only read while locked, without counting a
+ * change. Unlock it with pgSurface_Unlock().
+ */
+static int
+pgSurface_LockForRead(PyObject *surfobj)
+{
+    return _pg_lock_by(surfobj, surfobj);
+}
+
+/* Lock a surface without counting a change, for pgSurface_Prep(), which
+ * locks the owner of a subsurface whenever the subsurface is used.
+ */
+static int
+_pg_lock_by(PyObject *surfobj, PyObject *lockobj)
 {
     PyObject *ref;
     pgSurfaceObject *surf = (pgSurfaceObject *)surfobj;
@@ -297,6 +373,9 @@ MODINIT_DEFINE(surflock)
     c_api[5] = pgSurface_LockBy;
     c_api[6] = pgSurface_UnlockBy;
     c_api[7] = pgSurface_LockLifetime;
+    c_api[8] = pgSurface_Changed;
+    c_api[9] = pgSurface_LockForRead;
+    c_api[10] = pgSurface_GetChanges;
     apiobj = encapsulate_api(c_api, "surflock");
     if (apiobj == NULL) {
         DECREF_MOD(module);
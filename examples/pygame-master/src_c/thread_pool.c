@@ -0,0 +1,204 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "thread_pool.h"
+
+/* Run bands until none are left. Called with pool->lock held. */
+static void
+_pool_run_bands(pg_thread_pool *pool)
+{
+    int band;
+
+    while (pool->next < pool->nbands) {
+        band = pool->next++;
+        SDL_UnlockMutex(pool->lock);
+        pool->func(pool->data, band);
+        SDL_LockMutex(pool->lock);
+        if (--pool->pending == 0) {
+            SDL_CondSignal(pool->done);
+        }
+    }
+}
+
+static int
+_pool_worker(void *data)
+{
+    pg_thread_pool *pool = (pg_thread_pool *)data;
+
+    SDL_LockMutex(pool->lock);
+    while (!pool->quit) {
+        _pool_run_bands(pool);
+        if (!pool->quit) {
+            SDL_CondWait(pool->wake, pool->lock);
+        }
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+/* Join all workers. The caller must own the pool (busy set). */
+static void
+_pool_stop_workers(pg_thread_pool *pool)
+{
+    int i;
+
+    SDL_LockMutex(pool->lock);
+    pool->quit = 1;
+    SDL_CondBroadcast(pool->wake);
+    SDL_UnlockMutex(pool->lock);
+    for (i = 0; i < pool->nworkers; ++i) {
+        SDL_WaitThread(pool->workers[i], NULL);
+    }
+    pool->nworkers = 0;
+    pool->quit = 0;
+}
+
+/* Bring the pool to threads - 1 workers, returning how many are running.
+ * Workers are only joined when the thread count was lowered. The caller
+ * must own the pool (busy set).
+ */
+static int
+_pool_start_workers(pg_thread_pool *pool)
+{
+    int nworkers = pool->threads - 1;
+
+    if (pool->nworkers > nworkers) {
+        _pool_stop_workers(pool);
+    }
+    while (pool->nworkers < nworkers) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+        pool->workers[pool->nworkers] =
+            SDL_CreateThread(_pool_worker, pool->name, pool);
+#else
+        pool->workers[pool->nworkers] = SDL_CreateThread(_pool_worker, pool);
+#endif
+        if (!pool->workers[pool->nworkers]) {
+            break;
+        }
+        ++pool->nworkers;
+    }
+    return pool->nworkers;
+}
+
+int
+pg_pool_set_threads(pg_thread_pool *pool, int count)
+{
+    if (count == 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+        count = SDL_GetCPUCount();
+#else
+        count = 1;
+#endif
+    }
+    if (count < 1) {
+        count = 1;
+    }
+    if (count > PG_POOL_MAX_THREADS) {
+        count = PG_POOL_MAX_THREADS;
+    }
+    if (count > 1 && !pool->lock) {
+        pool->lock = SDL_CreateMutex();
+        pool->wake = SDL_CreateCond();
+        pool->done = SDL_CreateCond();
+        if (!pool->lock || !pool->wake || !pool->done) {
+            if (pool->lock) {
+                SDL_DestroyMutex(pool->lock);
+            }
+            if (pool->wake) {
+                SDL_DestroyCond(pool->wake);
+            }
+            if (pool->done) {
+                SDL_DestroyCond(pool->done);
+            }
+            pool->lock = NULL;
+            pool->wake = pool->done = NULL;
+            return -1;
+        }
+    }
+    pool->threads = count;
+    return 0;
+}
+
+int
+pg_pool_acquire(pg_thread_pool *pool, int nbands)
+{
+    if (nbands < 2 || !pool->lock) {
+        return 0;
+    }
+
+    SDL_LockMutex(pool->lock);
+    if (pool->busy) {
+        SDL_UnlockMutex(pool->lock);
+        return 0;
+    }
+    pool->busy = 1;
+    SDL_UnlockMutex(pool->lock);
+
+    if (pool->nworkers == pool->threads - 1 ||
+        _pool_start_workers(pool) > 0) {
+        return 1;
+    }
+
+    SDL_LockMutex(pool->lock);
+    pool->busy = 0;
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+void
+pg_pool_run(pg_thread_pool *pool, pg_pool_band_func func, void *data,
+            int nbands)
+{
+    SDL_LockMutex(pool->lock);
+    pool->func = func;
+    pool->data = data;
+    pool->nbands = nbands;
+    pool->next = 0;
+    pool->pending = nbands;
+    SDL_CondBroadcast(pool->wake);
+    _pool_run_bands(pool);
+    while (pool->pending > 0) {
+        SDL_CondWait(pool->done, pool->lock);
+    }
+    pool->nbands = pool->next = 0;
+    pool->func = NULL;
+    pool->data = NULL;
+    pool->busy = 0;
+    SDL_UnlockMutex(pool->lock);
+}
+
+void
+pg_pool_quit(pg_thread_pool *pool)
+{
+    if (!pool->lock) {
+        return;
+    }
+    SDL_LockMutex(pool->lock);
+    if (pool->busy) {
+        SDL_UnlockMutex(pool->lock);
+        return;
+    }
+    pool->busy = 1;
+    SDL_UnlockMutex(pool->lock);
+
+    _pool_stop_workers(pool);
+
+    SDL_LockMutex(pool->lock);
+    pool->busy = 0;
+    SDL_UnlockMutex(pool->lock);
+}
@@ -0,0 +1,106 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* A small pool of SDL threads for work cut into bands, shared by the
+ * banded fills, smoothscale passes, rotations and mask builders.
+ *
+ * A pool allowed threads threads keeps threads - 1 workers, started by the
+ * first job that needs them and then sleeping on a condition variable
+ * between jobs. A job of nbands bands hands the bands out to the workers
+ * and the calling thread, which always takes a share itself. Only one job
+ * runs on a pool at a time; a thread that finds the pool busy runs its job
+ * on its own.
+ *
+ * thread_pool.c is linked into every module that runs banded jobs, so each
+ * of those modules has its own pools and shuts them down from its own quit
+ * handler. Band functions run on worker threads that never hold the GIL,
+ * so they may only touch pixels and plain C data.
+ *
+ * Every such module lets Python size its pool with the same private pair,
+ * _get_threads() and _set_threads(count), where count is passed to
+ * pg_pool_set_threads() and a negative count raises ValueError.
+ */
+#if !defined(THREAD_POOL_HEADER)
+#define THREAD_POOL_HEADER
+
+#include <SDL.h>
+
+#define PG_POOL_MAX_THREADS 16
+
+/* Run band number band of a job on data. */
+typedef void (*pg_pool_band_func)(void *data, int band);
+
+typedef struct {
+    const char *name;
+    int threads; /* threads a job may use, counting the calling thread */
+    SDL_Thread *workers[PG_POOL_MAX_THREADS];
+    int nworkers;
+    SDL_mutex *lock;
+    SDL_cond *wake;
+    SDL_cond *done;
+    pg_pool_band_func func;
+    void *data;
+    int nbands;
+    int next;
+    int pending;
+    int busy;
+    int quit;
+} pg_thread_pool;
+
+/* A pool that runs everything on the calling thread until
+ * pg_pool_set_threads() allows more.
+ */
+#define PG_THREAD_POOL_INIT(name) {(name), 1}
+
+/* Set how many threads a job may use, counting the calling thread. 1 keeps
+ * every job on the calling thread, 0 picks one thread per CPU (SDL 1
+ * cannot count CPUs and stays at 1). The workers are resized by the next
+ * job.
+ *
+ * Returns 0 on success and -1 if the synchronization objects could not be
+ * created.
+ */
+int
+pg_pool_set_threads(pg_thread_pool *pool, int count);
+
+/* Take the pool for a job of nbands bands, 2 <= nbands <= pool->threads,
+ * starting the workers if they are not running yet.
+ *
+ * Returns 1 if the pool was taken, and must then be given back with
+ * pg_pool_run(). Returns 0, leaving the pool alone, if the job has to run
+ * on the calling thread: the pool is in use by another thread, or no
+ * worker could be started.
+ */
+int
+pg_pool_acquire(pg_thread_pool *pool, int nbands);
+
+/* Call func(data, band) for band = 0 to nbands - 1 across the workers and
+ * the calling thread, wait for all of them to return, then give the pool
+ * back. The pool must have been taken with pg_pool_acquire().
+ */
+void
+pg_pool_run(pg_thread_pool *pool, pg_pool_band_func func, void *data,
+            int nbands);
+
+/* Join the workers. They are started again by the next job if the pool
+ * still allows more than one thread. Does nothing while a job is running.
+ */
+void
+pg_pool_quit(pg_thread_pool *pool);
+
+#endif /* THREAD_POOL_HEADER */
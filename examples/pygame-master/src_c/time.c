@@ -26,7 +26,25 @@
 
 #include "doc/time_doc.h"
 
-#define WORST_CLOCK_ACCURACY 12
+#include <time.h>
+#include <errno.h>
+
+#if !defined(_WIN32) && !defined(__APPLE__) && defined(CLOCK_MONOTONIC) && \
+    defined(TIMER_ABSTIME)
+#define PG_HAVE_CLOCK_NANOSLEEP 1
+#endif
+
+#define PG_NS_PER_SEC ((Sint64)1000000000)
+#define PG_NS_PER_MS ((Sint64)1000000)
+
+/* The final stretch of a wait is spun rather than slept. The spin covers
+   the measured oversleep of the scheduler plus a small margin, and is
+   never longer than the 2 ms the old busy loop used. */
+#define PG_SPIN_MARGIN ((Sint64)50000)
+#define PG_SPIN_MAX (2 * PG_NS_PER_MS)
+
+/* Number of frames Clock.get_jitter() computes its percentiles over */
+#define PG_JITTER_WINDOW 128
 
 #if IS_SDLv2
 #define pgNUMEVENTS (16 + (SDL_NUMEVENTS - SDL_USEREVENT))
@@ -91,10 +109,89 @@ timer_callback(Uint32 interval, void *param)
     return interval;
 }
 
+/* monotonic time in nanoseconds */
+static Sint64
+pg_time_ns(void)
+{
+#if defined(PG_HAVE_CLOCK_NANOSLEEP)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Sint64)ts.tv_sec * PG_NS_PER_SEC + ts.tv_nsec;
+#elif IS_SDLv2
+    Uint64 count = SDL_GetPerformanceCounter();
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    return (Sint64)((count / freq) * PG_NS_PER_SEC +
+                    (count % freq) * PG_NS_PER_SEC / freq);
+#else  /* IS_SDLv1 */
+    return (Sint64)SDL_GetTicks() * PG_NS_PER_MS;
+#endif /* IS_SDLv1 */
+}
+
+static int
+pg_ns_to_ms(Sint64 ns)
+{
+    return (int)((ns + PG_NS_PER_MS / 2) / PG_NS_PER_MS);
+}
+
+/* Sleep until the monotonic deadline, waking spin nanoseconds early and
+   busy waiting the rest. With no spin it only sleeps, never waking before
+   the deadline. Returns how late the sleep woke up relative to the point
+   it aimed for. Call it with the GIL released.
+*/
+static Sint64
+pg_sleep_until(Sint64 deadline, Sint64 spin)
+{
+    Sint64 wake = deadline - spin, now = pg_time_ns(), late = 0;
+
+    if (wake > now) {
+#if defined(PG_HAVE_CLOCK_NANOSLEEP)
+        struct timespec ts;
+        ts.tv_sec = (time_t)(wake / PG_NS_PER_SEC);
+        ts.tv_nsec = (long)(wake % PG_NS_PER_SEC);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+                               NULL) == EINTR)
+            ;
+#else
+        /* round up when there is no spin to finish the wait */
+        SDL_Delay((Uint32)((wake - now + (spin ? 0 : PG_NS_PER_MS - 1)) /
+                           PG_NS_PER_MS));
+#endif
+        now = pg_time_ns();
+        late = now - wake;
+    }
+    if (spin) {
+        while (now < deadline)
+            now = pg_time_ns();
+    }
+    return late;
+}
+
+/* Track the oversleep: jump up to a late wakeup at once, then decay
+   slowly so one preempted frame does not keep the spin long. */
+static void
+pg_slack_update(Sint64 *slack, Sint64 late)
+{
+    if (late > PG_SPIN_MAX)
+        late = PG_SPIN_MAX;
+    if (late > *slack)
+        *slack = late;
+    else
+        *slack -= (*slack - late) / 16;
+}
+
+static Sint64
+pg_spin_for(Sint64 slack)
+{
+    Sint64 spin = slack + PG_SPIN_MARGIN;
+    return spin > PG_SPIN_MAX ? PG_SPIN_MAX : spin;
+}
+
+static Sint64 pg_delay_slack = PG_SPIN_MAX / 2;
+
 static int
 accurate_delay(int ticks)
 {
-    int funcstart, delay;
+    Sint64 funcstart, late;
     if (ticks <= 0)
         return 0;
 
@@ -105,20 +202,14 @@ accurate_delay(int ticks)
         }
     }
 
-    funcstart = SDL_GetTicks();
-    if (ticks >= WORST_CLOCK_ACCURACY) {
-        delay = (ticks - 2) - (ticks % WORST_CLOCK_ACCURACY);
-        if (delay >= WORST_CLOCK_ACCURACY) {
-            Py_BEGIN_ALLOW_THREADS;
-            SDL_Delay(delay);
-            Py_END_ALLOW_THREADS;
-        }
-    }
-    do {
-        delay = ticks - (SDL_GetTicks() - funcstart);
-    } while (delay > 0);
+    funcstart = pg_time_ns();
+    Py_BEGIN_ALLOW_THREADS;
+    late = pg_sleep_until(funcstart + ticks * PG_NS_PER_MS,
+                          pg_spin_for(pg_delay_slack));
+    Py_END_ALLOW_THREADS;
+    pg_slack_update(&pg_delay_slack, late);
 
-    return SDL_GetTicks() - funcstart;
+    return pg_ns_to_ms(pg_time_ns() - funcstart);
 }
 
 static PyObject *
@@ -261,10 +352,15 @@ time_set_timer(PyObject *self, PyObject *arg)
 
 /*clock object interface*/
 typedef struct {
-    PyObject_HEAD int last_tick;
-    int fps_count, fps_tick;
+    PyObject_HEAD Sint64 last_tick;
+    int fps_count;
+    Sint64 fps_tick;
     float fps;
-    int timepassed, rawpassed;
+    Sint64 timepassed, rawpassed;
+    Sint64 slack;
+    int low_power;
+    float jitter[PG_JITTER_WINDOW];
+    int jitter_count, jitter_pos;
     PyObject *rendered;
 } PyClockObject;
 
@@ -274,15 +370,15 @@ clock_tick_base(PyObject *self, PyObject *arg, int use_accurate_delay)
 {
     PyClockObject *_clock = (PyClockObject *)self;
     float framerate = 0.0f;
-    int nowtime;
+    Sint64 nowtime, endtime = 0;
 
     if (!PyArg_ParseTuple(arg, "|f", &framerate))
         return NULL;
 
-    if (framerate) {
-        int delay, endtime = (int)((1.0f / framerate) * 1000.0f);
-        _clock->rawpassed = SDL_GetTicks() - _clock->last_tick;
-        delay = endtime - _clock->rawpassed;
+    if (framerate > 0.0f) {
+        Sint64 spin = 0, late;
+        endtime = (Sint64)(PG_NS_PER_SEC / framerate);
+        _clock->rawpassed = pg_time_ns() - _clock->last_tick;
 
         /*just doublecheck that timer is initialized*/
         if (!SDL_WasInit(SDL_INIT_TIMER)) {
@@ -292,41 +388,46 @@ clock_tick_base(PyObject *self, PyObject *arg, int use_accurate_delay)
             }
         }
 
-        if (use_accurate_delay)
-            delay = accurate_delay(delay);
-        else {
-            // this uses sdls delay, which can be inaccurate.
-            if (delay < 0)
-                delay = 0;
+        // tick() only sleeps, which can be late by the scheduler's wakeup
+        // latency. tick_busy_loop() spins the end, unless low power.
+        if (use_accurate_delay && !_clock->low_power)
+            spin = pg_spin_for(_clock->slack);
 
-            Py_BEGIN_ALLOW_THREADS;
-            SDL_Delay((Uint32)delay);
-            Py_END_ALLOW_THREADS;
-        }
+        Py_BEGIN_ALLOW_THREADS;
+        late = pg_sleep_until(_clock->last_tick + endtime, spin);
+        Py_END_ALLOW_THREADS;
 
-        if (delay == -1)
-            return NULL;
+        if (spin)
+            pg_slack_update(&_clock->slack, late);
     }
 
-    nowtime = SDL_GetTicks();
+    nowtime = pg_time_ns();
     _clock->timepassed = nowtime - _clock->last_tick;
     _clock->fps_count += 1;
     _clock->last_tick = nowtime;
-    if (!framerate)
+    if (!endtime)
         _clock->rawpassed = _clock->timepassed;
+    else {
+        _clock->jitter[_clock->jitter_pos] =
+            (float)(_clock->timepassed - endtime) / PG_NS_PER_MS;
+        _clock->jitter_pos = (_clock->jitter_pos + 1) % PG_JITTER_WINDOW;
+        if (_clock->jitter_count < PG_JITTER_WINDOW)
+            _clock->jitter_count++;
+    }
 
     if (!_clock->fps_tick) {
         _clock->fps_count = 0;
         _clock->fps_tick = nowtime;
     }
     else if (_clock->fps_count >= 10) {
-        _clock->fps =
-            _clock->fps_count / ((nowtime - _clock->fps_tick) / 1000.0f);
+        _clock->fps = (float)(_clock->fps_count /
+                              ((double)(nowtime - _clock->fps_tick) /
+                               PG_NS_PER_SEC));
         _clock->fps_count = 0;
         _clock->fps_tick = nowtime;
         Py_XDECREF(_clock->rendered);
     }
-    return PyInt_FromLong(_clock->timepassed);
+    return PyInt_FromLong(pg_ns_to_ms(_clock->timepassed));
 }
 
 static PyObject *
@@ -352,14 +453,53 @@ static PyObject *
 clock_get_time(PyObject *self, PyObject *args)
 {
     PyClockObject *_clock = (PyClockObject *)self;
-    return PyInt_FromLong(_clock->timepassed);
+    return PyInt_FromLong(pg_ns_to_ms(_clock->timepassed));
 }
 
 static PyObject *
 clock_get_rawtime(PyObject *self, PyObject *args)
 {
     PyClockObject *_clock = (PyClockObject *)self;
-    return PyInt_FromLong(_clock->rawpassed);
+    return PyInt_FromLong(pg_ns_to_ms(_clock->rawpassed));
+}
+
+static PyObject *
+clock_get_frametime(PyObject *self, PyObject *args)
+{
+    PyClockObject *_clock = (PyClockObject *)self;
+    return PyFloat_FromDouble((double)_clock->timepassed / PG_NS_PER_MS);
+}
+
+static int
+compare_float(const void *a, const void *b)
+{
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static PyObject *
+clock_get_jitter(PyObject *self, PyObject *args)
+{
+    PyClockObject *_clock = (PyClockObject *)self;
+    float sorted[PG_JITTER_WINDOW];
+    double percentile = 50.0;
+    int n = _clock->jitter_count, rank;
+
+    if (!PyArg_ParseTuple(args, "|d", &percentile))
+        return NULL;
+    if (percentile < 0.0 || percentile > 100.0)
+        return RAISE(PyExc_ValueError,
+                     "percentile must be between 0 and 100");
+    if (!n)
+        return PyFloat_FromDouble(0.0);
+
+    /* nearest rank over the frames in the window */
+    memcpy(sorted, _clock->jitter, n * sizeof(float));
+    qsort(sorted, n, sizeof(float), compare_float);
+    rank = (int)(percentile / 100.0 * n + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    return PyFloat_FromDouble(sorted[rank - 1]);
 }
 
 /* clock object internals */
@@ -372,6 +512,9 @@ static struct PyMethodDef clock_methods[] = {
      DOC_CLOCKGETRAWTIME},
     {"tick_busy_loop", clock_tick_busy_loop, METH_VARARGS,
      DOC_CLOCKTICKBUSYLOOP},
+    {"get_frametime", clock_get_frametime, METH_NOARGS,
+     DOC_CLOCKGETFRAMETIME},
+    {"get_jitter", clock_get_jitter, METH_VARARGS, DOC_CLOCKGETJITTER},
     {NULL, NULL, 0, NULL}};
 
 static void
@@ -433,32 +576,272 @@ static PyTypeObject PyClock_Type = {
     0,                          /* tp_new */
 };
 
-PyObject *
-ClockInit(PyObject *self)
+static int
+clock_init(PyClockObject *_clock, int low_power)
 {
-    PyClockObject *_clock = PyObject_NEW(PyClockObject, &PyClock_Type);
-
-    if (!_clock) {
-        return NULL;
-    }
+    _clock->rendered = NULL;
 
     /*just doublecheck that timer is initialized*/
     if (!SDL_WasInit(SDL_INIT_TIMER)) {
-        if (SDL_InitSubSystem(SDL_INIT_TIMER))
-            return RAISE(pgExc_SDLError, SDL_GetError());
+        if (SDL_InitSubSystem(SDL_INIT_TIMER)) {
+            RAISE(pgExc_SDLError, SDL_GetError());
+            return -1;
+        }
     }
 
     _clock->fps_tick = 0;
     _clock->timepassed = 0;
     _clock->rawpassed = 0;
-    _clock->last_tick = SDL_GetTicks();
+    _clock->last_tick = pg_time_ns();
     _clock->fps = 0.0f;
     _clock->fps_count = 0;
-    _clock->rendered = NULL;
+    _clock->slack = PG_SPIN_MAX / 2;
+    _clock->low_power = low_power;
+    _clock->jitter_count = 0;
+    _clock->jitter_pos = 0;
+
+    return 0;
+}
+
+PyObject *
+ClockInit(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyClockObject *_clock;
+    int low_power = 0;
+
+    static char *kwids[] = {
+        "low_power",
+        NULL
+    };
+
+#if PY3
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", kwids,
+                                     &low_power))
+        return NULL;
+#else
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", kwids,
+                                     &low_power))
+        return NULL;
+#endif
+
+    _clock = PyObject_NEW(PyClockObject, &PyClock_Type);
+    if (!_clock) {
+        return NULL;
+    }
+
+    if (clock_init(_clock, low_power)) {
+        Py_DECREF(_clock);
+        return NULL;
+    }
 
     return (PyObject *)_clock;
 }
 
+/* fixed step clock object interface */
+typedef struct {
+    PyClockObject clock;
+    Sint64 step, accumulator;
+    int max_steps;
+    Sint64 render_mark;
+    Sint64 frames, steps, dropped;
+    Sint64 update_time, render_time, wait_time;
+} PyFixedStepClockObject;
+
+/* Tick the underlying clock, then turn the frame's time into whole
+   simulation steps. Time for more than max_steps steps is dropped, so
+   a slow frame can not make the next one slower still. */
+static PyObject *
+fixed_step_tick_base(PyObject *self, PyObject *arg, int use_accurate_delay)
+{
+    PyFixedStepClockObject *_fixed = (PyFixedStepClockObject *)self;
+    PyClockObject *_clock = &_fixed->clock;
+    Sint64 start = _clock->last_tick, due;
+    PyObject *ret;
+
+    ret = clock_tick_base(self, arg, use_accurate_delay);
+    if (!ret)
+        return NULL;
+    Py_DECREF(ret);
+
+    if (_fixed->render_mark > start) {
+        Sint64 update = _fixed->render_mark - start;
+        if (update > _clock->rawpassed)
+            update = _clock->rawpassed;
+        _fixed->update_time += update;
+        _fixed->render_time += _clock->rawpassed - update;
+    }
+    else
+        _fixed->update_time += _clock->rawpassed;
+    _fixed->wait_time += _clock->timepassed - _clock->rawpassed;
+    _fixed->render_mark = 0;
+
+    _fixed->accumulator += _clock->timepassed;
+    due = _fixed->accumulator / _fixed->step;
+    _fixed->accumulator %= _fixed->step;
+    if (due > _fixed->max_steps) {
+        _fixed->dropped += due - _fixed->max_steps;
+        due = _fixed->max_steps;
+    }
+    _fixed->frames += 1;
+    _fixed->steps += due;
+
+    return Py_BuildValue("(id)", (int)due,
+                         (double)_fixed->accumulator / _fixed->step);
+}
+
+static PyObject *
+fixed_step_tick(PyObject *self, PyObject *arg)
+{
+    return fixed_step_tick_base(self, arg, 0);
+}
+
+static PyObject *
+fixed_step_tick_busy_loop(PyObject *self, PyObject *arg)
+{
+    return fixed_step_tick_base(self, arg, 1);
+}
+
+static PyObject *
+fixed_step_mark_render(PyObject *self, PyObject *args)
+{
+    PyFixedStepClockObject *_fixed = (PyFixedStepClockObject *)self;
+    _fixed->render_mark = pg_time_ns();
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+fixed_step_get_counters(PyObject *self, PyObject *args)
+{
+    PyFixedStepClockObject *_fixed = (PyFixedStepClockObject *)self;
+    return Py_BuildValue(
+        "{s:L,s:L,s:L,s:d,s:d,s:d}", "frames", (long long)_fixed->frames,
+        "steps", (long long)_fixed->steps, "dropped_steps",
+        (long long)_fixed->dropped, "update_time",
+        (double)_fixed->update_time / PG_NS_PER_MS, "render_time",
+        (double)_fixed->render_time / PG_NS_PER_MS, "wait_time",
+        (double)_fixed->wait_time / PG_NS_PER_MS);
+}
+
+static struct PyMethodDef fixed_step_methods[] = {
+    {"tick", fixed_step_tick, METH_VARARGS, DOC_FIXEDSTEPCLOCKTICK},
+    {"tick_busy_loop", fixed_step_tick_busy_loop, METH_VARARGS,
+     DOC_FIXEDSTEPCLOCKTICKBUSYLOOP},
+    {"mark_render", fixed_step_mark_render, METH_NOARGS,
+     DOC_FIXEDSTEPCLOCKMARKRENDER},
+    {"get_counters", fixed_step_get_counters, METH_NOARGS,
+     DOC_FIXEDSTEPCLOCKGETCOUNTERS},
+    {NULL, NULL, 0, NULL}};
+
+PyObject *
+fixed_step_str(PyObject *self)
+{
+    char str[1024];
+    PyFixedStepClockObject *_fixed = (PyFixedStepClockObject *)self;
+
+    sprintf(str, "<FixedStepClock(rate=%.2f, fps=%.2f)>",
+            (double)PG_NS_PER_SEC / _fixed->step, (float)_fixed->clock.fps);
+
+    return Text_FromUTF8(str);
+}
+
+static PyTypeObject PyFixedStepClock_Type = {
+    TYPE_HEAD(NULL, 0) "FixedStepClock", /* name */
+    sizeof(PyFixedStepClockObject),      /* basic size */
+    0,                                   /* itemsize */
+    clock_dealloc,                       /* dealloc */
+    0,                                   /* print */
+    0,                                   /* getattr */
+    0,                                   /* setattr */
+    0,                                   /* compare */
+    fixed_step_str,                      /* repr */
+    0,                                   /* as_number */
+    0,                                   /* as_sequence */
+    0,                                   /* as_mapping */
+    (hashfunc)0,                         /* hash */
+    (ternaryfunc)0,                      /* call */
+    fixed_step_str,                      /* str */
+    0,                                   /* tp_getattro */
+    0,                                   /* tp_setattro */
+    0,                                   /* tp_as_buffer */
+    0,                                   /* flags */
+    DOC_PYGAMETIMEFIXEDSTEPCLOCK,        /* Documentation string */
+    0,                                   /* tp_traverse */
+    0,                                   /* tp_clear */
+    0,                                   /* tp_richcompare */
+    0,                                   /* tp_weaklistoffset */
+    0,                                   /* tp_iter */
+    0,                                   /* tp_iternext */
+    fixed_step_methods,                  /* tp_methods */
+    0,                                   /* tp_members */
+    0,                                   /* tp_getset */
+    &PyClock_Type,                       /* tp_base */
+    0,                                   /* tp_dict */
+    0,                                   /* tp_descr_get */
+    0,                                   /* tp_descr_set */
+    0,                                   /* tp_dictoffset */
+    0,                                   /* tp_init */
+    0,                                   /* tp_alloc */
+    0,                                   /* tp_new */
+};
+
+PyObject *
+FixedStepClockInit(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyFixedStepClockObject *_fixed;
+    double rate;
+    int max_steps = 5, low_power = 0;
+
+    static char *kwids[] = {
+        "rate",
+        "max_steps",
+        "low_power",
+        NULL
+    };
+
+#if PY3
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "d|ip", kwids, &rate,
+                                     &max_steps, &low_power))
+        return NULL;
+#else
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "d|ii", kwids, &rate,
+                                     &max_steps, &low_power))
+        return NULL;
+#endif
+
+    if (!(rate > 0.0) || rate > (double)PG_NS_PER_SEC)
+        return RAISE(PyExc_ValueError,
+                     "rate must be a positive number of steps per second");
+    /* leave the accumulator room for a frame on top of a whole step */
+    if (PG_NS_PER_SEC / rate >= 9.2e18)
+        return RAISE(PyExc_ValueError, "rate is too small");
+    if (max_steps < 1)
+        return RAISE(PyExc_ValueError, "max_steps must be at least 1");
+
+    _fixed =
+        PyObject_NEW(PyFixedStepClockObject, &PyFixedStepClock_Type);
+    if (!_fixed) {
+        return NULL;
+    }
+
+    if (clock_init(&_fixed->clock, low_power)) {
+        Py_DECREF(_fixed);
+        return NULL;
+    }
+
+    _fixed->step = (Sint64)(PG_NS_PER_SEC / rate + 0.5);
+    _fixed->accumulator = 0;
+    _fixed->max_steps = max_steps;
+    _fixed->render_mark = 0;
+    _fixed->frames = 0;
+    _fixed->steps = 0;
+    _fixed->dropped = 0;
+    _fixed->update_time = 0;
+    _fixed->render_time = 0;
+    _fixed->wait_time = 0;
+
+    return (PyObject *)_fixed;
+}
+
 static PyMethodDef _time_methods[] = {
     {"get_ticks", (PyCFunction)time_get_ticks, METH_NOARGS,
      DOC_PYGAMETIMEGETTICKS},
@@ -466,7 +849,10 @@ static PyMethodDef _time_methods[] = {
     {"wait", time_wait, METH_VARARGS, DOC_PYGAMETIMEWAIT},
     {"set_timer", time_set_timer, METH_VARARGS, DOC_PYGAMETIMESETTIMER},
 
-    {"Clock", (PyCFunction)ClockInit, METH_NOARGS, DOC_PYGAMETIMECLOCK},
+    {"Clock", (PyCFunction)ClockInit, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETIMECLOCK},
+    {"FixedStepClock", (PyCFunction)FixedStepClockInit,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMETIMEFIXEDSTEPCLOCK},
 
     {NULL, NULL, 0, NULL}};
 
@@ -508,6 +894,9 @@ MODINIT_DEFINE(time)
     if (PyType_Ready(&PyClock_Type) < 0) {
         MODINIT_ERROR;
     }
+    if (PyType_Ready(&PyFixedStepClock_Type) < 0) {
+        MODINIT_ERROR;
+    }
 
     /* create the module */
 #if PY3
@@ -34,6 +34,18 @@
 #include <string.h>
 
 #include "scale.h"
+#include "surface_cache.h"
+#include "thread_pool.h"
+
+/* AVX2 smoothscale filters, picked at run time by smoothscale_init() or
+ * set_smoothscale_backend(), along with the SSE2 rotation and convolution;
+ * see simd_backend.h.
+ */
+#include "simd_backend.h"
+
+#if defined(SCALE_MMX_SUPPORT) && defined(PG_HAS_AVX2)
+#define SCALE_AVX2_SUPPORT
+#endif /* SCALE_AVX2_SUPPORT */
 
 typedef void (*SMOOTHSCALE_FILTER_P)(Uint8 *, Uint8 *, int, int, int, int,
                                      int);
@@ -79,6 +91,23 @@ void
 scale2x(SDL_Surface *src, SDL_Surface *dst);
 extern SDL_Surface *
 rotozoomSurface(SDL_Surface *src, double angle, double zoom, int smooth);
+extern void
+rotozoomSurfaceSizeTrig(int width, int height, double angle, double zoom,
+                        int *dstwidth, int *dstheight, double *canglezoom,
+                        double *sanglezoom);
+
+/* rotate filters */
+#define ROTATE_NEAREST 0
+#define ROTATE_BILINEAR 1
+#define ROTATE_BICUBIC 2
+
+static void
+rotate(SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor, double sangle,
+       double cangle, int filter);
+static SDL_Surface *
+rotozoom(SDL_Surface *src, double angle, double zoom);
+static void
+_rotate_init_cubic(void);
 
 
 #if IS_SDLv2
@@ -311,115 +340,6 @@ rotate90(SDL_Surface *src, int angle)
     return dst;
 }
 
-static void
-rotate(SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor, double sangle,
-       double cangle)
-{
-    int x, y, dx, dy;
-
-    Uint8 *srcpix = (Uint8 *)src->pixels;
-    Uint8 *dstrow = (Uint8 *)dst->pixels;
-    int srcpitch = src->pitch;
-    int dstpitch = dst->pitch;
-
-    int cy = dst->h / 2;
-    int xd = ((src->w - dst->w) << 15);
-    int yd = ((src->h - dst->h) << 15);
-
-    int isin = (int)(sangle * 65536);
-    int icos = (int)(cangle * 65536);
-
-    int ax = ((dst->w) << 15) - (int)(cangle * ((dst->w - 1) << 15));
-    int ay = ((dst->h) << 15) - (int)(sangle * ((dst->w - 1) << 15));
-
-    int xmaxval = ((src->w) << 16) - 1;
-    int ymaxval = ((src->h) << 16) - 1;
-
-    switch (src->format->BytesPerPixel) {
-        case 1:
-            for (y = 0; y < dst->h; y++) {
-                Uint8 *dstpos = (Uint8 *)dstrow;
-                dx = (ax + (isin * (cy - y))) + xd;
-                dy = (ay - (icos * (cy - y))) + yd;
-                for (x = 0; x < dst->w; x++) {
-                    if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                        *dstpos++ = bgcolor;
-                    else
-                        *dstpos++ =
-                            *(Uint8 *)(srcpix + ((dy >> 16) * srcpitch) +
-                                       (dx >> 16));
-                    dx += icos;
-                    dy += isin;
-                }
-                dstrow += dstpitch;
-            }
-            break;
-        case 2:
-            for (y = 0; y < dst->h; y++) {
-                Uint16 *dstpos = (Uint16 *)dstrow;
-                dx = (ax + (isin * (cy - y))) + xd;
-                dy = (ay - (icos * (cy - y))) + yd;
-                for (x = 0; x < dst->w; x++) {
-                    if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                        *dstpos++ = bgcolor;
-                    else
-                        *dstpos++ =
-                            *(Uint16 *)(srcpix + ((dy >> 16) * srcpitch) +
-                                        (dx >> 16 << 1));
-                    dx += icos;
-                    dy += isin;
-                }
-                dstrow += dstpitch;
-            }
-            break;
-        case 4:
-            for (y = 0; y < dst->h; y++) {
-                Uint32 *dstpos = (Uint32 *)dstrow;
-                dx = (ax + (isin * (cy - y))) + xd;
-                dy = (ay - (icos * (cy - y))) + yd;
-                for (x = 0; x < dst->w; x++) {
-                    if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                        *dstpos++ = bgcolor;
-                    else
-                        *dstpos++ =
-                            *(Uint32 *)(srcpix + ((dy >> 16) * srcpitch) +
-                                        (dx >> 16 << 2));
-                    dx += icos;
-                    dy += isin;
-                }
-                dstrow += dstpitch;
-            }
-            break;
-        default: /*case 3:*/
-            for (y = 0; y < dst->h; y++) {
-                Uint8 *dstpos = (Uint8 *)dstrow;
-                dx = (ax + (isin * (cy - y))) + xd;
-                dy = (ay - (icos * (cy - y))) + yd;
-                for (x = 0; x < dst->w; x++) {
-                    if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval) {
-                        dstpos[0] = ((Uint8 *)&bgcolor)[0];
-                        dstpos[1] = ((Uint8 *)&bgcolor)[1];
-                        dstpos[2] = ((Uint8 *)&bgcolor)[2];
-                        dstpos += 3;
-                    }
-                    else {
-                        Uint8 *srcpos =
-                            (Uint8 *)(srcpix + ((dy >> 16) * srcpitch) +
-                                      ((dx >> 16) * 3));
-                        dstpos[0] = srcpos[0];
-                        dstpos[1] = srcpos[1];
-                        dstpos[2] = srcpos[2];
-                        dstpos += 3;
-                    }
-                    dx += icos;
-                    dy += isin;
-                }
-                dstrow += dstpitch;
-            }
-            break;
-    }
-}
-
 static void
 stretch(SDL_Surface *src, SDL_Surface *dst)
 {
@@ -551,8 +471,10 @@ surf_scale(PyObject *self, PyObject *arg)
         if (!newsurf)
             return NULL;
     }
-    else
+    else {
         newsurf = pgSurface_AsSurface(surfobj2);
+        pgSurface_Changed(surfobj2);
+    }
 
     /* check to see if the size is twice as big. */
     if (newsurf->w != width || newsurf->h != height)
@@ -566,7 +488,7 @@ surf_scale(PyObject *self, PyObject *arg)
 
     if ((width && height) && (surf->w && surf->h)) {
         SDL_LockSurface(newsurf);
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
 
         Py_BEGIN_ALLOW_THREADS;
         stretch(surf, newsurf);
@@ -611,8 +533,10 @@ surf_scale2x(PyObject *self, PyObject *arg)
         if (!newsurf)
             return NULL;
     }
-    else
+    else {
         newsurf = pgSurface_AsSurface(surfobj2);
+        pgSurface_Changed(surfobj2);
+    }
 
     /* check to see if the size is twice as big. */
     if (newsurf->w != (surf->w * 2) || newsurf->h != (surf->h * 2))
@@ -641,29 +565,201 @@ surf_scale2x(PyObject *self, PyObject *arg)
         return pgSurface_New(newsurf);
 }
 
+/*
+ * Rotation cache.
+ *
+ * When given a budget with set_cache_size, rotate() and rotozoom() keep a
+ * copy of the surfaces they return, and for the same source surface,
+ * angle, scale and filter copy it out again instead of rotating again.
+ * Callers that rotate to a fixed set of angles every frame then only pay
+ * for each angle once. Angles and scales are compared exactly, so a cached
+ * result is always the one that would have been computed. The kept
+ * surfaces are never handed out, so callers may change what they get.
+ * Each entry costs the bytes of its pixels against the budget. See
+ * surface_cache.h for when entries are used and dropped.
+ */
+#define ROTATE_CACHE_ZOOM -1 /* entry kind for rotozoom, else a filter */
+
+typedef struct {
+    int kind;
+    float angle;
+    float zoom;
+} RotateCacheKey;
+
+static void
+_rotate_cache_free(void *result)
+{
+    Py_DECREF((PyObject *)result);
+}
+
+static pg_surface_cache rotate_cache =
+    PG_SURFACE_CACHE_INIT(_rotate_cache_free, 0);
+
+static void
+_rotate_cache_clear(void)
+{
+    pg_surface_cache_clear(&rotate_cache);
+}
+
+static void
+_rotate_cache_key(RotateCacheKey *key, int kind, float angle, float zoom)
+{
+    memset(key, 0, sizeof(*key));
+    key->kind = kind;
+    key->angle = angle;
+    key->zoom = zoom;
+}
+
+/* Returns a new Surface with the pixels and settings of result. */
 static PyObject *
-surf_rotate(PyObject *self, PyObject *arg)
+_rotate_cache_copy(PyObject *result)
 {
-    PyObject *surfobj;
-    SDL_Surface *surf, *newsurf;
-    float angle;
+    SDL_Surface *surf = pgSurface_AsSurface(result);
+    SDL_Surface *newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
+    Uint8 *srcrow, *dstrow;
+    int y;
+
+    if (!newsurf) {
+        return NULL;
+    }
+    SDL_LockSurface(newsurf);
+    SDL_LockSurface(surf);
+    srcrow = (Uint8 *)surf->pixels;
+    dstrow = (Uint8 *)newsurf->pixels;
+    for (y = 0; y < surf->h; ++y) {
+        memcpy(dstrow, srcrow, (size_t)surf->w * surf->format->BytesPerPixel);
+        srcrow += surf->pitch;
+        dstrow += newsurf->pitch;
+    }
+    SDL_UnlockSurface(surf);
+    SDL_UnlockSurface(newsurf);
+    return pgSurface_New(newsurf);
+}
+
+/* Returns a new reference to the kept result for a source and key if the
+ * source still has the change count changes, or NULL.
+ */
+static PyObject *
+_rotate_cache_find(PyObject *surfobj, int kind, float angle, float zoom,
+                   unsigned long changes)
+{
+    RotateCacheKey key;
+    PyObject *kept;
+
+    _rotate_cache_key(&key, kind, angle, zoom);
+    kept = (PyObject *)pg_surface_cache_find(&rotate_cache, surfobj, &key,
+                                             sizeof(key), changes);
+    Py_XINCREF(kept);
+    return kept;
+}
+
+/* Keeps a copy of a result just made from a source surface, whose change
+ * count was changes before it was read. Running out of memory only means
+ * the result is not kept.
+ */
+static void
+_rotate_cache_store(PyObject *surfobj, int kind, float angle, float zoom,
+                    unsigned long changes, PyObject *result)
+{
+    static int quit_registered = 0;
+    SDL_Surface *surf = pgSurface_AsSurface(result);
+    size_t bytes = (size_t)surf->pitch * surf->h;
+    RotateCacheKey key;
+    PyObject *kept;
+
+    if (bytes > rotate_cache.budget) {
+        return;
+    }
+    if (!quit_registered) {
+        pg_RegisterQuit(_rotate_cache_clear);
+        quit_registered = 1;
+    }
+    kept = _rotate_cache_copy(result);
+    if (!kept) {
+        PyErr_Clear();
+        return;
+    }
+    _rotate_cache_key(&key, kind, angle, zoom);
+    pg_surface_cache_store(&rotate_cache, surfobj, &key, sizeof(key),
+                           changes, kept, bytes);
+}
+
+/* Returns result, or copies it into destobj and returns that when the
+ * caller passed a destination surface. Steals the reference to result.
+ */
+static PyObject *
+_rotate_result(PyObject *result, PyObject *destobj)
+{
+    SDL_Surface *surf, *dest;
+    Uint8 *srcrow, *dstrow;
+    int y;
+
+    if (!result || !destobj || destobj == result) {
+        return result;
+    }
+    surf = pgSurface_AsSurface(result);
+    dest = pgSurface_AsSurface(destobj);
+    if (dest->w != surf->w || dest->h != surf->h) {
+        Py_DECREF(result);
+        return RAISE(PyExc_ValueError,
+                     "Destination surface not the same size.");
+    }
+    if (dest->format->BytesPerPixel != surf->format->BytesPerPixel ||
+        dest->format->Rmask != surf->format->Rmask ||
+        dest->format->Gmask != surf->format->Gmask ||
+        dest->format->Bmask != surf->format->Bmask ||
+        dest->format->Amask != surf->format->Amask) {
+        Py_DECREF(result);
+        return RAISE(PyExc_ValueError,
+                     "Source and destination surfaces need the same format.");
+    }
+
+    pgSurface_Lock(destobj);
+    SDL_LockSurface(surf);
+    srcrow = (Uint8 *)surf->pixels;
+    dstrow = (Uint8 *)dest->pixels;
+    for (y = 0; y < surf->h; ++y) {
+        memcpy(dstrow, srcrow, (size_t)surf->w * surf->format->BytesPerPixel);
+        srcrow += surf->pitch;
+        dstrow += dest->pitch;
+    }
+    SDL_UnlockSurface(surf);
+    pgSurface_Unlock(destobj);
+
+    Py_DECREF(result);
+    Py_INCREF(destobj);
+    return destobj;
+}
+
+/* Hands out a kept result: copied into destobj if given, else into a new
+ * Surface. Steals the reference to kept.
+ */
+static PyObject *
+_rotate_cache_result(PyObject *kept, PyObject *destobj)
+{
+    PyObject *result;
+
+    if (destobj) {
+        return _rotate_result(kept, destobj);
+    }
+    result = _rotate_cache_copy(kept);
+    Py_DECREF(kept);
+    return result;
+}
+
+static PyObject *
+_rotate_surface(PyObject *surfobj, float angle, int filter)
+{
+    SDL_Surface *surf = pgSurface_AsSurface(surfobj);
+    SDL_Surface *newsurf;
 
     double radangle, sangle, cangle;
     double x, y, cx, cy, sx, sy;
     int nxmax, nymax;
     Uint32 bgcolor;
 
-    /*get all the arguments*/
-    if (!PyArg_ParseTuple(arg, "O!f", &pgSurface_Type, &surfobj, &angle))
-        return NULL;
-    surf = pgSurface_AsSurface(surfobj);
-
-    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4)
-        return RAISE(PyExc_ValueError,
-                     "unsupport Surface bit depth for transform");
-
     if (!(fmod((double)angle, (double)90.0f))) {
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
 
         Py_BEGIN_ALLOW_THREADS;
         newsurf = rotate90(surf, (int)angle);
@@ -730,10 +826,10 @@ surf_rotate(PyObject *self, PyObject *arg)
     }
 
     SDL_LockSurface(newsurf);
-    pgSurface_Lock(surfobj);
+    pgSurface_LockForRead(surfobj);
 
     Py_BEGIN_ALLOW_THREADS;
-    rotate(surf, newsurf, bgcolor, sangle, cangle);
+    rotate(surf, newsurf, bgcolor, sangle, cangle, filter);
     Py_END_ALLOW_THREADS;
 
     pgSurface_Unlock(surfobj);
@@ -742,6 +838,64 @@ surf_rotate(PyObject *self, PyObject *arg)
     return pgSurface_New(newsurf);
 }
 
+static PyObject *
+surf_rotate(PyObject *self, PyObject *arg, PyObject *kwds)
+{
+    PyObject *surfobj, *destobj = NULL, *result;
+    SDL_Surface *surf;
+    float angle;
+    char *filtername = NULL;
+    int filter = ROTATE_NEAREST;
+    unsigned long changes;
+    int cacheable;
+    char *keywords[] = {"surface", "angle", "filter", "dest_surface", NULL};
+
+    /*get all the arguments*/
+    if (!PyArg_ParseTupleAndKeywords(arg, kwds, "O!f|zO!", keywords,
+                                     &pgSurface_Type, &surfobj, &angle,
+                                     &filtername, &pgSurface_Type, &destobj))
+        return NULL;
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4)
+        return RAISE(PyExc_ValueError,
+                     "unsupport Surface bit depth for transform");
+
+    if (filtername) {
+        if (strcmp(filtername, "nearest") == 0) {
+            filter = ROTATE_NEAREST;
+        }
+        else if (strcmp(filtername, "bilinear") == 0) {
+            filter = ROTATE_BILINEAR;
+        }
+        else if (strcmp(filtername, "bicubic") == 0) {
+            filter = ROTATE_BICUBIC;
+            _rotate_init_cubic();
+        }
+        else {
+            return RAISE(PyExc_ValueError,
+                         "filter must be 'nearest', 'bilinear' or 'bicubic'");
+        }
+    }
+    if (filter != ROTATE_NEAREST && surf->format->BytesPerPixel < 3)
+        return RAISE(PyExc_ValueError,
+                     "Only 24-bit or 32-bit surfaces can be filtered");
+
+    /* counted before the source is read, see the rotation cache */
+    cacheable = pgSurface_GetChanges(surfobj, &changes);
+    if (cacheable) {
+        result = _rotate_cache_find(surfobj, filter, angle, 1.0f, changes);
+        if (result)
+            return _rotate_cache_result(result, destobj);
+    }
+    result = _rotate_surface(surfobj, angle, filter);
+    if (!result)
+        return NULL;
+    if (cacheable)
+        _rotate_cache_store(surfobj, filter, angle, 1.0f, changes, result);
+    return _rotate_result(result, destobj);
+}
+
 static PyObject *
 surf_flip(PyObject *self, PyObject *arg)
 {
@@ -767,7 +921,7 @@ surf_flip(PyObject *self, PyObject *arg)
     dstpitch = newsurf->pitch;
 
     SDL_LockSurface(newsurf);
-    pgSurface_Lock(surfobj);
+    pgSurface_LockForRead(surfobj);
 
     srcpix = (Uint8 *)surf->pixels;
     dstpix = (Uint8 *)newsurf->pixels;
@@ -896,25 +1050,14 @@ surf_flip(PyObject *self, PyObject *arg)
 }
 
 static PyObject *
-surf_rotozoom(PyObject *self, PyObject *arg)
+_rotozoom_surface(PyObject *surfobj, float angle, float scale)
 {
-    PyObject *surfobj;
-    SDL_Surface *surf, *newsurf, *surf32;
-    float scale, angle;
-
-    /*get all the arguments*/
-    if (!PyArg_ParseTuple(arg, "O!ff", &pgSurface_Type, &surfobj, &angle,
-                          &scale))
-        return NULL;
-    surf = pgSurface_AsSurface(surfobj);
-    if (scale == 0.0) {
-        newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
-        return pgSurface_New(newsurf);
-    }
+    SDL_Surface *surf = pgSurface_AsSurface(surfobj);
+    SDL_Surface *newsurf, *surf32;
 
     if (surf->format->BitsPerPixel == 32) {
         surf32 = surf;
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
     }
     else {
         Py_BEGIN_ALLOW_THREADS;
@@ -926,16 +1069,58 @@ surf_rotozoom(PyObject *self, PyObject *arg)
     }
 
     Py_BEGIN_ALLOW_THREADS;
-    newsurf = rotozoomSurface(surf32, angle, scale, 1);
+    if (fabs(angle) > 0.001)
+        newsurf = rotozoom(surf32, angle, scale);
+    else
+        newsurf = rotozoomSurface(surf32, angle, scale, 1);
     Py_END_ALLOW_THREADS;
 
     if (surf32 == surf)
         pgSurface_Unlock(surfobj);
     else
         SDL_FreeSurface(surf32);
+    if (!newsurf)
+        return RAISE(pgExc_SDLError, SDL_GetError());
     return pgSurface_New(newsurf);
 }
 
+static PyObject *
+surf_rotozoom(PyObject *self, PyObject *arg, PyObject *kwds)
+{
+    PyObject *surfobj, *destobj = NULL, *result;
+    SDL_Surface *surf, *newsurf;
+    float scale, angle;
+    char *keywords[] = {"surface", "angle", "scale", "dest_surface", NULL};
+    unsigned long changes;
+    int cacheable;
+
+    /*get all the arguments*/
+    if (!PyArg_ParseTupleAndKeywords(arg, kwds, "O!ff|O!", keywords,
+                                     &pgSurface_Type, &surfobj, &angle,
+                                     &scale, &pgSurface_Type, &destobj))
+        return NULL;
+    surf = pgSurface_AsSurface(surfobj);
+    if (scale == 0.0) {
+        newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
+        return _rotate_result(pgSurface_New(newsurf), destobj);
+    }
+
+    cacheable = pgSurface_GetChanges(surfobj, &changes);
+    if (cacheable) {
+        result = _rotate_cache_find(surfobj, ROTATE_CACHE_ZOOM, angle, scale,
+                                    changes);
+        if (result)
+            return _rotate_cache_result(result, destobj);
+    }
+    result = _rotozoom_surface(surfobj, angle, scale);
+    if (!result)
+        return NULL;
+    if (cacheable)
+        _rotate_cache_store(surfobj, ROTATE_CACHE_ZOOM, angle, scale, changes,
+                            result);
+    return _rotate_result(result, destobj);
+}
+
 static SDL_Surface *
 chop(SDL_Surface *src, int x, int y, int width, int height)
 {
@@ -1177,6 +1362,7 @@ filter_expand_X_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch,
             free(xmult0);
         if (xmult1)
             free(xmult1);
+        return;
     }
 
     /* Create multiplier factors and starting indices and put them in arrays */
@@ -1212,6 +1398,7 @@ static void
 filter_expand_Y_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch,
                       int dstpitch, int srcheight, int dstheight)
 {
+    int dstdiff = dstpitch - (width * 4);
     int x, y;
 
     for (y = 0; y < dstheight; y++) {
@@ -1230,69 +1417,377 @@ filter_expand_Y_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch,
             *dstpix++ =
                 (Uint8)(((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
         }
+        dstpix += dstdiff;
     }
 }
 
-#if defined(SCALE_MMX_SUPPORT)
-static void
-smoothscale_init(struct _module_state *st)
+#if defined(SCALE_AVX2_SUPPORT)
+/*
+ * AVX2 filters. Unlike the MMX and SSE ones, these keep the 16-bit fixed
+ * point arithmetic of the C filters above, so they give exactly the same
+ * pixels as 'GENERIC'. Each channel is worked on in a 32-bit lane.
+ */
+
+/* Gather the low byte of each 32-bit lane of v into the low 8 bytes */
+PG_FUNCTION_TARGET_AVX2 static PG_INLINE __m128i
+avx2_pack_low_bytes(__m256i v)
 {
-    if (st->filter_shrink_X == 0) {
-        if (SDL_HasSSE()) {
-            st->filter_type = "SSE";
-            st->filter_shrink_X = filter_shrink_X_SSE;
-            st->filter_shrink_Y = filter_shrink_Y_SSE;
-            st->filter_expand_X = filter_expand_X_SSE;
-            st->filter_expand_Y = filter_expand_Y_SSE;
-        }
-        else if (SDL_HasMMX()) {
-            st->filter_type = "MMX";
-            st->filter_shrink_X = filter_shrink_X_MMX;
-            st->filter_shrink_Y = filter_shrink_Y_MMX;
-            st->filter_expand_X = filter_expand_X_MMX;
-            st->filter_expand_Y = filter_expand_Y_MMX;
-        }
-        else {
-            st->filter_type = "GENERIC";
-            st->filter_shrink_X = filter_shrink_X_ONLYC;
-            st->filter_shrink_Y = filter_shrink_Y_ONLYC;
-            st->filter_expand_X = filter_expand_X_ONLYC;
-            st->filter_expand_Y = filter_expand_Y_ONLYC;
-        }
-    }
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8,
+        12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    v = _mm256_shuffle_epi8(v, shuffle);
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1,
+                                                         1));
+    return _mm256_castsi256_si128(v);
 }
-#endif
 
-static void
-convert_24_32(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpitch,
-              int width, int height)
+/* The channels of two pixels, each in its own 128-bit lane */
+PG_FUNCTION_TARGET_AVX2 static PG_INLINE __m256i
+avx2_load_pixel_pair(const Uint8 *pixel0, const Uint8 *pixel1)
 {
-    int srcdiff = srcpitch - (width * 3);
-    int dstdiff = dstpitch - (width * 4);
-    int x, y;
+    Uint32 p0, p1;
 
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
-            *dstpix++ = *srcpix++;
-            *dstpix++ = *srcpix++;
-            *dstpix++ = *srcpix++;
-            *dstpix++ = 0xff;
-        }
-        srcpix += srcdiff;
-        dstpix += dstdiff;
-    }
+    memcpy(&p0, pixel0, 4);
+    memcpy(&p1, pixel1, 4);
+    return _mm256_cvtepu8_epi32(_mm_setr_epi32((int)p0, (int)p1, 0, 0));
 }
 
-static void
-convert_32_24(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpitch,
-              int width, int height)
+/* Store the results for two pixels, one from each 128-bit lane */
+PG_FUNCTION_TARGET_AVX2 static PG_INLINE void
+avx2_store_pixel_pair(Uint8 *pixel0, Uint8 *pixel1, __m256i v)
 {
-    int srcdiff = srcpitch - (width * 4);
-    int dstdiff = dstpitch - (width * 3);
-    int x, y;
+    Uint32 pixels[2];
 
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
+    _mm_storel_epi64((__m128i *)pixels, avx2_pack_low_bytes(v));
+    memcpy(pixel0, pixels, 4);
+    memcpy(pixel1, pixels + 1, 4);
+}
+
+/* Works on four rows at a time, since every row takes the same steps */
+PG_FUNCTION_TARGET_AVX2 static void
+filter_shrink_X_AVX2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch,
+                     int dstpitch, int srcwidth, int dstwidth)
+{
+    int xspace = 0x10000 * srcwidth / dstwidth; /* must be > 1 */
+    __m256i xrecip = _mm256_set1_epi32((int)(0x100000000LL / xspace));
+    __m256i mask16 = _mm256_set1_epi32(0xffff);
+    int x, y;
+
+    for (y = 0; y + 4 <= height; y += 4) {
+        Uint8 *src0 = srcpix + y * srcpitch;
+        Uint8 *src1 = src0 + srcpitch;
+        Uint8 *src2 = src1 + srcpitch;
+        Uint8 *src3 = src2 + srcpitch;
+        Uint8 *dst0 = dstpix + y * dstpitch;
+        Uint8 *dst1 = dst0 + dstpitch;
+        Uint8 *dst2 = dst1 + dstpitch;
+        Uint8 *dst3 = dst2 + dstpitch;
+        __m256i accumulate01 = _mm256_setzero_si256();
+        __m256i accumulate23 = _mm256_setzero_si256();
+        int xcounter = xspace;
+        for (x = 0; x < srcwidth; x++) {
+            __m256i pixels01 = avx2_load_pixel_pair(src0, src1);
+            __m256i pixels23 = avx2_load_pixel_pair(src2, src3);
+            src0 += 4;
+            src1 += 4;
+            src2 += 4;
+            src3 += 4;
+            if (xcounter > 0x10000) {
+                /* the C accumulators are Uint16 and wrap the same way */
+                accumulate01 = _mm256_and_si256(
+                    _mm256_add_epi32(accumulate01, pixels01), mask16);
+                accumulate23 = _mm256_and_si256(
+                    _mm256_add_epi32(accumulate23, pixels23), mask16);
+                xcounter -= 0x10000;
+            }
+            else {
+                int xfrac = 0x10000 - xcounter;
+                __m256i xc = _mm256_set1_epi32(xcounter);
+                __m256i xf = _mm256_set1_epi32(xfrac);
+                __m256i out01, out23;
+                /* write out a destination pixel for each row */
+                out01 = _mm256_add_epi32(
+                    accumulate01,
+                    _mm256_srli_epi32(_mm256_mullo_epi32(pixels01, xc), 16));
+                out23 = _mm256_add_epi32(
+                    accumulate23,
+                    _mm256_srli_epi32(_mm256_mullo_epi32(pixels23, xc), 16));
+                out01 = _mm256_srli_epi32(_mm256_mullo_epi32(out01, xrecip),
+                                          16);
+                out23 = _mm256_srli_epi32(_mm256_mullo_epi32(out23, xrecip),
+                                          16);
+                avx2_store_pixel_pair(dst0, dst1, out01);
+                avx2_store_pixel_pair(dst2, dst3, out23);
+                dst0 += 4;
+                dst1 += 4;
+                dst2 += 4;
+                dst3 += 4;
+                /* reload the accumulators with the remainder of the pixel */
+                accumulate01 =
+                    _mm256_srli_epi32(_mm256_mullo_epi32(pixels01, xf), 16);
+                accumulate23 =
+                    _mm256_srli_epi32(_mm256_mullo_epi32(pixels23, xf), 16);
+                xcounter = xspace - xfrac;
+            }
+        }
+    }
+    if (y < height) {
+        filter_shrink_X_ONLYC(srcpix + y * srcpitch, dstpix + y * dstpitch,
+                              height - y, srcpitch, dstpitch, srcwidth,
+                              dstwidth);
+    }
+}
+
+/* Works across the line, eight channels (two pixels) at a time */
+PG_FUNCTION_TARGET_AVX2 static void
+filter_shrink_Y_AVX2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch,
+                     int dstpitch, int srcheight, int dstheight)
+{
+    Uint16 *templine;
+    int count = width * 4;
+    int i, y;
+    int yspace = 0x10000 * srcheight / dstheight; /* must be > 1 */
+    int yrecip = (int)(0x100000000LL / yspace);
+    int ycounter = yspace;
+    __m256i vrecip = _mm256_set1_epi32(yrecip);
+
+    /* allocate and clear a memory area for storing the accumulator line */
+    templine = (Uint16 *)malloc(count * 2);
+    if (templine == NULL)
+        return;
+    memset(templine, 0, count * 2);
+
+    for (y = 0; y < srcheight; y++) {
+        if (ycounter > 0x10000) {
+            for (i = 0; i + 16 <= count; i += 16) {
+                __m256i src = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128((const __m128i *)(srcpix + i)));
+                __m256i *acc = (__m256i *)(templine + i);
+                _mm256_storeu_si256(
+                    acc, _mm256_add_epi16(_mm256_loadu_si256(acc), src));
+            }
+            for (; i < count; i++) {
+                templine[i] += (Uint16)srcpix[i];
+            }
+            ycounter -= 0x10000;
+        }
+        else {
+            int yfrac = 0x10000 - ycounter;
+            __m256i yc = _mm256_set1_epi32(ycounter);
+            __m256i yf = _mm256_set1_epi32(yfrac);
+            /* write out a destination line and reload the accumulator with
+             * the remainder of this line */
+            for (i = 0; i + 8 <= count; i += 8) {
+                __m256i src = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64((const __m128i *)(srcpix + i)));
+                __m256i acc = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128((const __m128i *)(templine + i)));
+                __m256i rest;
+                acc = _mm256_add_epi32(
+                    acc, _mm256_srli_epi32(_mm256_mullo_epi32(src, yc), 16));
+                acc = _mm256_srli_epi32(_mm256_mullo_epi32(acc, vrecip), 16);
+                _mm_storel_epi64((__m128i *)(dstpix + i),
+                                 avx2_pack_low_bytes(acc));
+                rest = _mm256_srli_epi32(_mm256_mullo_epi32(src, yf), 16);
+                rest = _mm256_permute4x64_epi64(
+                    _mm256_packus_epi32(rest, rest), 0x08);
+                _mm_storeu_si128((__m128i *)(templine + i),
+                                 _mm256_castsi256_si128(rest));
+            }
+            for (; i < count; i++) {
+                dstpix[i] = (Uint8)(((templine[i] +
+                                      ((srcpix[i] * ycounter) >> 16)) *
+                                     yrecip) >>
+                                    16);
+                templine[i] = (Uint16)((srcpix[i] * yfrac) >> 16);
+            }
+            dstpix += dstpitch;
+            ycounter = yspace - yfrac;
+        }
+        srcpix += srcpitch;
+    }
+
+    /* free the temporary memory */
+    free(templine);
+}
+
+/* Works on two destination pixels at a time */
+PG_FUNCTION_TARGET_AVX2 static void
+filter_expand_X_AVX2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch,
+                     int dstpitch, int srcwidth, int dstwidth)
+{
+    int *xidx0, *xmult0, *xmult1;
+    int x, y, c;
+
+    /* Allocate memory for factors, one multiplier for each channel */
+    xidx0 = malloc(dstwidth * sizeof(int));
+    if (xidx0 == NULL)
+        return;
+    xmult0 = (int *)malloc(dstwidth * 4 * sizeof(int));
+    xmult1 = (int *)malloc(dstwidth * 4 * sizeof(int));
+    if (xmult0 == NULL || xmult1 == NULL) {
+        free(xidx0);
+        if (xmult0)
+            free(xmult0);
+        if (xmult1)
+            free(xmult1);
+        return;
+    }
+
+    /* Create multiplier factors and starting indices and put them in arrays */
+    for (x = 0; x < dstwidth; x++) {
+        int xm1 = 0x10000 * ((x * (srcwidth - 1)) % dstwidth) / dstwidth;
+        xidx0[x] = x * (srcwidth - 1) / dstwidth;
+        for (c = 0; c < 4; c++) {
+            xmult0[x * 4 + c] = 0x10000 - xm1;
+            xmult1[x * 4 + c] = xm1;
+        }
+    }
+
+    for (y = 0; y < height; y++) {
+        Uint8 *srcrow0 = srcpix + y * srcpitch;
+        Uint8 *dstrow = dstpix + y * dstpitch;
+        for (x = 0; x + 2 <= dstwidth; x += 2) {
+            /* each load takes a source pixel and its right neighbour */
+            __m128i pair = _mm_unpacklo_epi32(
+                _mm_loadl_epi64((const __m128i *)(srcrow0 + xidx0[x] * 4)),
+                _mm_loadl_epi64(
+                    (const __m128i *)(srcrow0 + xidx0[x + 1] * 4)));
+            __m256i left = _mm256_cvtepu8_epi32(pair);
+            __m256i right = _mm256_cvtepu8_epi32(_mm_srli_si128(pair, 8));
+            __m256i out = _mm256_add_epi32(
+                _mm256_mullo_epi32(
+                    left,
+                    _mm256_loadu_si256((const __m256i *)(xmult0 + x * 4))),
+                _mm256_mullo_epi32(
+                    right,
+                    _mm256_loadu_si256((const __m256i *)(xmult1 + x * 4))));
+            _mm_storel_epi64((__m128i *)(dstrow + x * 4),
+                             avx2_pack_low_bytes(_mm256_srli_epi32(out, 16)));
+        }
+        for (; x < dstwidth; x++) {
+            Uint8 *src = srcrow0 + xidx0[x] * 4;
+            int xm0 = xmult0[x * 4];
+            int xm1 = xmult1[x * 4];
+            for (c = 0; c < 4; c++) {
+                dstrow[x * 4 + c] =
+                    (Uint8)(((src[c] * xm0) + (src[c + 4] * xm1)) >> 16);
+            }
+        }
+    }
+
+    /* free memory */
+    free(xidx0);
+    free(xmult0);
+    free(xmult1);
+}
+
+/* Works across each line, eight channels (two pixels) at a time */
+PG_FUNCTION_TARGET_AVX2 static void
+filter_expand_Y_AVX2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch,
+                     int dstpitch, int srcheight, int dstheight)
+{
+    int count = width * 4;
+    int i, y;
+
+    for (y = 0; y < dstheight; y++) {
+        int yidx0 = y * (srcheight - 1) / dstheight;
+        Uint8 *srcrow0 = srcpix + yidx0 * srcpitch;
+        Uint8 *srcrow1 = srcrow0 + srcpitch;
+        Uint8 *dstrow = dstpix + y * dstpitch;
+        int ymult1 = 0x10000 * ((y * (srcheight - 1)) % dstheight) / dstheight;
+        int ymult0 = 0x10000 - ymult1;
+        __m256i ym0 = _mm256_set1_epi32(ymult0);
+        __m256i ym1 = _mm256_set1_epi32(ymult1);
+        for (i = 0; i + 8 <= count; i += 8) {
+            __m256i row0 = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *)(srcrow0 + i)));
+            __m256i row1 = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *)(srcrow1 + i)));
+            __m256i out = _mm256_add_epi32(_mm256_mullo_epi32(row0, ym0),
+                                           _mm256_mullo_epi32(row1, ym1));
+            _mm_storel_epi64((__m128i *)(dstrow + i),
+                             avx2_pack_low_bytes(_mm256_srli_epi32(out, 16)));
+        }
+        for (; i < count; i++) {
+            dstrow[i] =
+                (Uint8)(((srcrow0[i] * ymult0) + (srcrow1[i] * ymult1)) >> 16);
+        }
+    }
+}
+#endif /* SCALE_AVX2_SUPPORT */
+
+#if defined(SCALE_MMX_SUPPORT)
+static void
+smoothscale_init(struct _module_state *st)
+{
+    if (st->filter_shrink_X == 0) {
+#if defined(SCALE_AVX2_SUPPORT)
+        if (pg_backend_runs(PG_BACKEND_AVX2)) {
+            st->filter_type = "AVX2";
+            st->filter_shrink_X = filter_shrink_X_AVX2;
+            st->filter_shrink_Y = filter_shrink_Y_AVX2;
+            st->filter_expand_X = filter_expand_X_AVX2;
+            st->filter_expand_Y = filter_expand_Y_AVX2;
+            return;
+        }
+#endif /* SCALE_AVX2_SUPPORT */
+        if (SDL_HasSSE()) {
+            st->filter_type = "SSE";
+            st->filter_shrink_X = filter_shrink_X_SSE;
+            st->filter_shrink_Y = filter_shrink_Y_SSE;
+            st->filter_expand_X = filter_expand_X_SSE;
+            st->filter_expand_Y = filter_expand_Y_SSE;
+        }
+        else if (SDL_HasMMX()) {
+            st->filter_type = "MMX";
+            st->filter_shrink_X = filter_shrink_X_MMX;
+            st->filter_shrink_Y = filter_shrink_Y_MMX;
+            st->filter_expand_X = filter_expand_X_MMX;
+            st->filter_expand_Y = filter_expand_Y_MMX;
+        }
+        else {
+            st->filter_type = "GENERIC";
+            st->filter_shrink_X = filter_shrink_X_ONLYC;
+            st->filter_shrink_Y = filter_shrink_Y_ONLYC;
+            st->filter_expand_X = filter_expand_X_ONLYC;
+            st->filter_expand_Y = filter_expand_Y_ONLYC;
+        }
+    }
+}
+#endif
+
+static void
+convert_24_32(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpitch,
+              int width, int height)
+{
+    int srcdiff = srcpitch - (width * 3);
+    int dstdiff = dstpitch - (width * 4);
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            *dstpix++ = *srcpix++;
+            *dstpix++ = *srcpix++;
+            *dstpix++ = *srcpix++;
+            *dstpix++ = 0xff;
+        }
+        srcpix += srcdiff;
+        dstpix += dstdiff;
+    }
+}
+
+static void
+convert_32_24(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpitch,
+              int width, int height)
+{
+    int srcdiff = srcpitch - (width * 4);
+    int dstdiff = dstpitch - (width * 3);
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
             *dstpix++ = *srcpix++;
             *dstpix++ = *srcpix++;
             *dstpix++ = *srcpix++;
@@ -1303,6 +1798,601 @@ convert_32_24(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpitch,
     }
 }
 
+/*
+ * Parallel smoothscale passes.
+ *
+ * When enabled with _set_threads, each filter pass of a large
+ * scale is cut into bands, rows for the X filters and columns for the Y
+ * filters, and the bands are run on the shared thread pool. A filter reads
+ * and writes whole pixels only inside its own band, so every backend gives
+ * the same result in bands as in one piece.
+ *
+ * rotate, rotozoom, convolve and the average functions hand their rows to
+ * the same pool through scale_rows.
+ */
+#define SCALE_MIN_PIXELS (256 * 256)
+#define SCALE_MIN_BAND 16
+
+typedef void (*SCALE_ROWS_P)(void *, int, int);
+
+typedef struct {
+    SMOOTHSCALE_FILTER_P filter;
+    SCALE_ROWS_P rows; /* set instead of filter by scale_rows */
+    void *data;
+    int start;
+    Uint8 *srcpix;
+    Uint8 *dstpix;
+    int count; /* rows for an X filter, columns for a Y filter */
+    int srcpitch;
+    int dstpitch;
+    int srcsize;
+    int dstsize;
+} ScaleBand;
+
+static pg_thread_pool scale_pool = PG_THREAD_POOL_INIT("pygame smoothscale");
+static ScaleBand scale_bands[PG_POOL_MAX_THREADS];
+
+static void
+_scale_band(void *data, int i)
+{
+    ScaleBand *band = (ScaleBand *)data + i;
+
+    if (band->rows) {
+        band->rows(band->data, band->start, band->start + band->count);
+    }
+    else {
+        band->filter(band->srcpix, band->dstpix, band->count,
+                     band->srcpitch, band->dstpitch, band->srcsize,
+                     band->dstsize);
+    }
+}
+
+/* Pick how many bands to cut a job of count rows or columns, pixels pixels
+ * in all, into. When that is more than one the pool is taken for the job
+ * and must be released with pg_pool_run.
+ */
+static int
+_scale_nbands(int count, int pixels)
+{
+    int nbands = scale_pool.threads;
+
+    if (count / SCALE_MIN_BAND < nbands) {
+        nbands = count / SCALE_MIN_BAND;
+    }
+    if (pixels < SCALE_MIN_PIXELS || !pg_pool_acquire(&scale_pool, nbands)) {
+        return 1;
+    }
+    return nbands;
+}
+
+/* Run one filter pass over count rows (by_rows set, the X filters) or
+ * count columns (the Y filters), in bands if the pass is large enough.
+ */
+static void
+scale_pass(SMOOTHSCALE_FILTER_P filter, int by_rows, Uint8 *srcpix,
+           Uint8 *dstpix, int count, int srcpitch, int dstpitch, int srcsize,
+           int dstsize)
+{
+    int nbands, start, end, i;
+
+    nbands = _scale_nbands(count,
+                           count * (srcsize > dstsize ? srcsize : dstsize));
+    if (nbands == 1) {
+        filter(srcpix, dstpix, count, srcpitch, dstpitch, srcsize, dstsize);
+        return;
+    }
+
+    for (i = 0, start = 0; i < nbands; ++i, start = end) {
+        end = count * (i + 1) / nbands;
+        if (!by_rows && i < nbands - 1) {
+            /* keep column bands from sharing cache lines */
+            end &= ~(SCALE_MIN_BAND - 1);
+        }
+        scale_bands[i].filter = filter;
+        scale_bands[i].rows = NULL;
+        scale_bands[i].srcpix =
+            srcpix + (by_rows ? start * srcpitch : start * 4);
+        scale_bands[i].dstpix =
+            dstpix + (by_rows ? start * dstpitch : start * 4);
+        scale_bands[i].count = end - start;
+        scale_bands[i].srcpitch = srcpitch;
+        scale_bands[i].dstpitch = dstpitch;
+        scale_bands[i].srcsize = srcsize;
+        scale_bands[i].dstsize = dstsize;
+    }
+    pg_pool_run(&scale_pool, _scale_band, scale_bands, nbands);
+}
+
+/* Call rows(data, start, end) over count destination rows of width pixels,
+ * in bands if there are enough pixels. rows must only write its own rows.
+ */
+static void
+scale_rows(SCALE_ROWS_P rows, void *data, int count, int width)
+{
+    int nbands, start, end, i;
+
+    nbands = _scale_nbands(count, count * width);
+    if (nbands == 1) {
+        rows(data, 0, count);
+        return;
+    }
+
+    for (i = 0, start = 0; i < nbands; ++i, start = end) {
+        end = count * (i + 1) / nbands;
+        scale_bands[i].filter = NULL;
+        scale_bands[i].rows = rows;
+        scale_bands[i].data = data;
+        scale_bands[i].start = start;
+        scale_bands[i].count = end - start;
+    }
+    pg_pool_run(&scale_pool, _scale_band, scale_bands, nbands);
+}
+
+/* Join the worker threads. They are started again by the next large
+ * smoothscale if threads are still enabled.
+ */
+static void
+_scale_quit_threads(void)
+{
+    pg_pool_quit(&scale_pool);
+}
+
+/*
+ * Rotation engine shared by rotate and rotozoom.
+ *
+ * The source position of each destination pixel is an affine function of
+ * its coordinates, kept in 16.16 fixed point. For every destination row the
+ * run of pixels that lands inside the source is solved for up front, which
+ * cuts out the bounding parallelogram of the rotated image: pixels outside
+ * it are filled with the background color as plain spans and the pixels
+ * inside are sampled without any per pixel bounds test. Rows are handed to
+ * the smoothscale thread pool.
+ *
+ * The nearest filter gives the same pixels rotate always has. The bilinear
+ * and bicubic filters need whole byte channels, so 24 and 32 bit surfaces,
+ * and clamp their taps to the source edge; a pixel centre is at +0.5.
+ */
+typedef struct {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    Uint32 bgcolor;
+    int filter;
+    int x0, y0;   /* source position of destination pixel (0, 0) */
+    int xdx, ydx; /* source step for one destination pixel right */
+    int xdy, ydy; /* source step for one destination row down */
+} RotateJob;
+
+/* Catmull-Rom weights for the 4 taps around each 1/256 pixel position,
+ * scaled to sum to 256.
+ */
+static Sint16 rotate_cubic[256][4];
+static int rotate_cubic_ready = 0;
+
+static void
+_rotate_init_cubic(void)
+{
+    int i;
+
+    if (rotate_cubic_ready) {
+        return;
+    }
+    for (i = 0; i < 256; ++i) {
+        double t = i / 256.0;
+        int w0 = (int)floor((((-0.5 * t + 1.0) * t - 0.5) * t) * 256 + 0.5);
+        int w2 = (int)floor((((-1.5 * t + 2.0) * t + 0.5) * t) * 256 + 0.5);
+        int w3 = (int)floor(((0.5 * t - 0.5) * t * t) * 256 + 0.5);
+
+        rotate_cubic[i][0] = (Sint16)w0;
+        rotate_cubic[i][1] = (Sint16)(256 - w0 - w2 - w3);
+        rotate_cubic[i][2] = (Sint16)w2;
+        rotate_cubic[i][3] = (Sint16)w3;
+    }
+    rotate_cubic_ready = 1;
+}
+
+static Sint64
+_rotate_floordiv(Sint64 n, Sint64 d)
+{
+    /* d > 0 */
+    return n >= 0 ? n / d : -((-n + d - 1) / d);
+}
+
+/* Narrow the pixel run lo to hi (exclusive) to the pixels x for which
+ * a + b * x is in 0 to m, inclusive.
+ */
+static void
+_rotate_clip(Sint64 a, Sint64 b, Sint64 m, int *lo, int *hi)
+{
+    Sint64 first, last;
+
+    if (b == 0) {
+        if (a < 0 || a > m) {
+            *hi = *lo;
+        }
+        return;
+    }
+    if (b > 0) {
+        first = -_rotate_floordiv(a, b);
+        last = _rotate_floordiv(m - a, b);
+    }
+    else {
+        first = -_rotate_floordiv(m - a, -b);
+        last = _rotate_floordiv(a, -b);
+    }
+    if (first > *lo) {
+        *lo = first < *hi ? (int)first : *hi;
+    }
+    if (last + 1 < *hi) {
+        *hi = last + 1 > *lo ? (int)(last + 1) : *lo;
+    }
+}
+
+static void
+_rotate_fill(Uint8 *dstpos, int bpp, int count, Uint32 bgcolor)
+{
+    int x;
+
+    switch (bpp) {
+        case 1:
+            memset(dstpos, (Uint8)bgcolor, count);
+            break;
+        case 2:
+            for (x = 0; x < count; ++x) {
+                ((Uint16 *)dstpos)[x] = (Uint16)bgcolor;
+            }
+            break;
+        case 4:
+            for (x = 0; x < count; ++x) {
+                ((Uint32 *)dstpos)[x] = bgcolor;
+            }
+            break;
+        default: /*case 3:*/
+            for (x = 0; x < count; ++x, dstpos += 3) {
+                dstpos[0] = ((Uint8 *)&bgcolor)[0];
+                dstpos[1] = ((Uint8 *)&bgcolor)[1];
+                dstpos[2] = ((Uint8 *)&bgcolor)[2];
+            }
+            break;
+    }
+}
+
+static void
+_rotate_nearest(const RotateJob *job, Uint8 *dstpos, int count, int sx,
+                int sy)
+{
+    Uint8 *srcpix = (Uint8 *)job->src->pixels;
+    int srcpitch = job->src->pitch;
+    int xdx = job->xdx, ydx = job->ydx;
+    int x;
+
+    switch (job->src->format->BytesPerPixel) {
+        case 1:
+            for (x = 0; x < count; ++x, sx += xdx, sy += ydx) {
+                dstpos[x] = srcpix[(sy >> 16) * srcpitch + (sx >> 16)];
+            }
+            break;
+        case 2:
+            for (x = 0; x < count; ++x, sx += xdx, sy += ydx) {
+                ((Uint16 *)dstpos)[x] =
+                    *(Uint16 *)(srcpix + (sy >> 16) * srcpitch +
+                                (sx >> 16 << 1));
+            }
+            break;
+        case 4:
+            for (x = 0; x < count; ++x, sx += xdx, sy += ydx) {
+                ((Uint32 *)dstpos)[x] =
+                    *(Uint32 *)(srcpix + (sy >> 16) * srcpitch +
+                                (sx >> 16 << 2));
+            }
+            break;
+        default: /*case 3:*/
+            for (x = 0; x < count; ++x, sx += xdx, sy += ydx) {
+                Uint8 *srcpos =
+                    srcpix + (sy >> 16) * srcpitch + (sx >> 16) * 3;
+                *dstpos++ = srcpos[0];
+                *dstpos++ = srcpos[1];
+                *dstpos++ = srcpos[2];
+            }
+            break;
+    }
+}
+
+/* Split a source position into the tap left of or above the sample point
+ * and the 8 bit weight of the tap after it. The position is at least -0.5
+ * pixels, so the tap is at least -1.
+ */
+#define ROTATE_TAP(pos, tap, frac)                  \
+    {                                               \
+        int _p = (pos) - 0x8000 + 0x10000;          \
+        tap = (_p >> 16) - 1;                       \
+        frac = (_p >> 8) & 0xff;                    \
+    }
+
+#define ROTATE_CLAMP(v, max) ((v) < 0 ? 0 : (v) > (max) ? (max) : (v))
+
+/* Bilinear samples, interpolating down then across with 8 bit weights and
+ * rounding after each step. Taps outside the source are clamped to its edge
+ * unless clamp is 0, when the caller has made sure all taps are inside.
+ */
+static void
+_rotate_bilinear(const RotateJob *job, Uint8 *dstpos, int count, int sx,
+                 int sy, int clamp)
+{
+    Uint8 *srcpix = (Uint8 *)job->src->pixels;
+    int srcpitch = job->src->pitch;
+    int bpp = job->src->format->BytesPerPixel;
+    int wmax = job->src->w - 1, hmax = job->src->h - 1;
+    int x, c;
+
+    for (x = 0; x < count; ++x, sx += job->xdx, sy += job->ydx) {
+        int i0, j0, i1, j1, fx, fy;
+        Uint8 *r0, *r1;
+
+        ROTATE_TAP(sx, i0, fx);
+        ROTATE_TAP(sy, j0, fy);
+        i1 = i0 + 1;
+        j1 = j0 + 1;
+        if (clamp) {
+            i0 = ROTATE_CLAMP(i0, wmax);
+            i1 = ROTATE_CLAMP(i1, wmax);
+            j0 = ROTATE_CLAMP(j0, hmax);
+            j1 = ROTATE_CLAMP(j1, hmax);
+        }
+        r0 = srcpix + j0 * srcpitch;
+        r1 = srcpix + j1 * srcpitch;
+        i0 *= bpp;
+        i1 *= bpp;
+        for (c = 0; c < bpp; ++c) {
+            int left = (r0[i0 + c] * (256 - fy) + r1[i0 + c] * fy + 128) >> 8;
+            int right = (r0[i1 + c] * (256 - fy) + r1[i1 + c] * fy + 128) >> 8;
+
+            *dstpos++ = (Uint8)((left * (256 - fx) + right * fx + 128) >> 8);
+        }
+    }
+}
+
+#ifdef PG_HAS_SSE2
+/* _rotate_bilinear for 32 bit pixels whose taps are all inside the source,
+ * one pixel per iteration with its four channels side by side. The sums
+ * stay below 65536, so 16 bit lanes give the same result as the C code.
+ */
+static void
+_rotate_bilinear_sse2(const RotateJob *job, Uint8 *dstpos, int count,
+                      int sx, int sy)
+{
+    Uint8 *srcpix = (Uint8 *)job->src->pixels;
+    int srcpitch = job->src->pitch;
+    __m128i zero = _mm_setzero_si128();
+    __m128i half = _mm_set1_epi16(128);
+    int x;
+
+    for (x = 0; x < count; ++x, sx += job->xdx, sy += job->ydx) {
+        int i0, j0, fx, fy;
+        Uint8 *r0;
+        Uint32 pixel;
+        __m128i top, bottom, mix;
+
+        ROTATE_TAP(sx, i0, fx);
+        ROTATE_TAP(sy, j0, fy);
+        r0 = srcpix + j0 * srcpitch + (i0 << 2);
+
+        /* left tap in the low four lanes, right tap in the high four */
+        top = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)r0), zero);
+        bottom = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((__m128i *)(r0 + srcpitch)), zero);
+        mix = _mm_add_epi16(_mm_mullo_epi16(top, _mm_set1_epi16(256 - fy)),
+                            _mm_mullo_epi16(bottom, _mm_set1_epi16(fy)));
+        mix = _mm_srli_epi16(_mm_add_epi16(mix, half), 8);
+        mix = _mm_mullo_epi16(
+            mix, _mm_set_epi16(fx, fx, fx, fx, 256 - fx, 256 - fx, 256 - fx,
+                               256 - fx));
+        mix = _mm_add_epi16(mix, _mm_srli_si128(mix, 8));
+        mix = _mm_srli_epi16(_mm_add_epi16(mix, half), 8);
+        pixel = (Uint32)_mm_cvtsi128_si32(_mm_packus_epi16(mix, mix));
+        memcpy(dstpos, &pixel, 4);
+        dstpos += 4;
+    }
+}
+#endif /* PG_HAS_SSE2 */
+
+/* Catmull-Rom samples from a 4 by 4 neighbourhood, filtered across then
+ * down. Taps outside the source are clamped to its edge.
+ */
+static void
+_rotate_bicubic(const RotateJob *job, Uint8 *dstpos, int count, int sx,
+                int sy)
+{
+    Uint8 *srcpix = (Uint8 *)job->src->pixels;
+    int srcpitch = job->src->pitch;
+    int bpp = job->src->format->BytesPerPixel;
+    int wmax = job->src->w - 1, hmax = job->src->h - 1;
+    int x, c, k, r;
+
+    for (x = 0; x < count; ++x, sx += job->xdx, sy += job->ydx) {
+        int i0, j0, fx, fy;
+        int taps[4];
+        Uint8 *rows[4];
+        const Sint16 *wx, *wy;
+
+        ROTATE_TAP(sx, i0, fx);
+        ROTATE_TAP(sy, j0, fy);
+        wx = rotate_cubic[fx];
+        wy = rotate_cubic[fy];
+        for (k = 0; k < 4; ++k) {
+            taps[k] = ROTATE_CLAMP(i0 - 1 + k, wmax) * bpp;
+            rows[k] = srcpix + ROTATE_CLAMP(j0 - 1 + k, hmax) * srcpitch;
+        }
+        for (c = 0; c < bpp; ++c) {
+            int sum = 32768;
+
+            for (r = 0; r < 4; ++r) {
+                Uint8 *row = rows[r] + c;
+
+                sum += wy[r] * (wx[0] * row[taps[0]] + wx[1] * row[taps[1]] +
+                                wx[2] * row[taps[2]] + wx[3] * row[taps[3]]);
+            }
+            *dstpos++ = sum < 0 ? 0 : sum > 0xffffff ? 255 : sum >> 16;
+        }
+    }
+}
+
+static void
+_rotate_rows(void *data, int start, int end)
+{
+    const RotateJob *job = (const RotateJob *)data;
+    SDL_Surface *src = job->src;
+    SDL_Surface *dst = job->dst;
+    int bpp = dst->format->BytesPerPixel;
+    Sint64 xmaxval = ((Sint64)src->w << 16) - 1;
+    Sint64 ymaxval = ((Sint64)src->h << 16) - 1;
+    int y;
+
+    for (y = start; y < end; ++y) {
+        Uint8 *dstrow = (Uint8 *)dst->pixels + y * dst->pitch;
+        int sx = (int)((Uint32)job->x0 + (Uint32)job->xdy * (Uint32)y);
+        int sy = (int)((Uint32)job->y0 + (Uint32)job->ydy * (Uint32)y);
+        int lo = 0, hi = dst->w;
+        int inlo, inhi;
+
+        /* the run of pixels inside the source */
+        _rotate_clip(sx, job->xdx, xmaxval, &lo, &hi);
+        _rotate_clip(sy, job->ydx, ymaxval, &lo, &hi);
+        if (lo >= hi) {
+            _rotate_fill(dstrow, bpp, dst->w, job->bgcolor);
+            continue;
+        }
+        _rotate_fill(dstrow, bpp, lo, job->bgcolor);
+        _rotate_fill(dstrow + hi * bpp, bpp, dst->w - hi, job->bgcolor);
+
+        sx += lo * job->xdx;
+        sy += lo * job->ydx;
+        dstrow += lo * bpp;
+        switch (job->filter) {
+            case ROTATE_BILINEAR:
+                /* the middle run, whose taps need no clamping */
+                inlo = lo;
+                inhi = hi;
+                _rotate_clip((Sint64)sx - 0x8000 - (Sint64)lo * job->xdx,
+                             job->xdx, xmaxval - 0x10000, &inlo, &inhi);
+                _rotate_clip((Sint64)sy - 0x8000 - (Sint64)lo * job->ydx,
+                             job->ydx, ymaxval - 0x10000, &inlo, &inhi);
+                if (inlo >= inhi) {
+                    inlo = inhi = hi;
+                }
+                _rotate_bilinear(job, dstrow, inlo - lo, sx, sy, 1);
+                sx += (inlo - lo) * job->xdx;
+                sy += (inlo - lo) * job->ydx;
+                dstrow += (inlo - lo) * bpp;
+#ifdef PG_HAS_SSE2
+                if (bpp == 4) {
+                    _rotate_bilinear_sse2(job, dstrow, inhi - inlo, sx, sy);
+                }
+                else
+#endif /* PG_HAS_SSE2 */
+                    _rotate_bilinear(job, dstrow, inhi - inlo, sx, sy, 0);
+                sx += (inhi - inlo) * job->xdx;
+                sy += (inhi - inlo) * job->ydx;
+                dstrow += (inhi - inlo) * bpp;
+                _rotate_bilinear(job, dstrow, hi - inhi, sx, sy, 1);
+                break;
+            case ROTATE_BICUBIC:
+                _rotate_bicubic(job, dstrow, hi - lo, sx, sy);
+                break;
+            default:
+                _rotate_nearest(job, dstrow, hi - lo, sx, sy);
+                break;
+        }
+    }
+}
+
+/* Rotate src into dst, which is large enough to hold the whole rotated
+ * image, about their centres. Pixels outside the source get bgcolor.
+ */
+static void
+rotate(SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor, double sangle,
+       double cangle, int filter)
+{
+    RotateJob job;
+
+    int cy = dst->h / 2;
+    int xd = ((src->w - dst->w) << 15);
+    int yd = ((src->h - dst->h) << 15);
+
+    int isin = (int)(sangle * 65536);
+    int icos = (int)(cangle * 65536);
+
+    int ax = ((dst->w) << 15) - (int)(cangle * ((dst->w - 1) << 15));
+    int ay = ((dst->h) << 15) - (int)(sangle * ((dst->w - 1) << 15));
+
+    job.src = src;
+    job.dst = dst;
+    job.bgcolor = bgcolor;
+    job.filter = filter;
+    job.x0 = ax + isin * cy + xd;
+    job.y0 = ay - icos * cy + yd;
+    job.xdx = icos;
+    job.ydx = isin;
+    job.xdy = -isin;
+    job.ydy = icos;
+    scale_rows(_rotate_rows, &job, dst->h, dst->w);
+}
+
+/* The rotating half of rotozoomSurface on the rotation engine, with the
+ * bilinear filter. src must be 32 bit; angle must not be 0.
+ */
+static SDL_Surface *
+rotozoom(SDL_Surface *src, double angle, double zoom)
+{
+    SDL_Surface *dst;
+    RotateJob job;
+    double zoominv, sanglezoom, canglezoom;
+    int dstwidth, dstheight, cx, cy, isin, icos;
+
+    if (zoom < 0.001) {
+        zoom = 0.001;
+    }
+    rotozoomSurfaceSizeTrig(src->w, src->h, angle, zoom, &dstwidth,
+                            &dstheight, &canglezoom, &sanglezoom);
+    dst = SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight, 32,
+                               src->format->Rmask, src->format->Gmask,
+                               src->format->Bmask, src->format->Amask);
+    if (!dst) {
+        return NULL;
+    }
+
+    zoominv = 65536.0 / (zoom * zoom);
+    isin = (int)(sanglezoom * zoominv);
+    icos = (int)(canglezoom * zoominv);
+    cx = dstwidth / 2;
+    cy = dstheight / 2;
+
+    /* rotozoom maps onto pixel corners, the engine onto pixel centres */
+    job.src = src;
+    job.dst = dst;
+    job.bgcolor = 0;
+    job.filter = ROTATE_BILINEAR;
+    job.x0 = (cx << 16) - icos * cx + isin * cy +
+             ((src->w - dstwidth) << 15) + 0x8000;
+    job.y0 = (cy << 16) - isin * cx - icos * cy +
+             ((src->h - dstheight) << 15) + 0x8000;
+    job.xdx = icos;
+    job.ydx = isin;
+    job.xdy = -isin;
+    job.ydy = icos;
+
+    SDL_LockSurface(src);
+    SDL_LockSurface(dst);
+    scale_rows(_rotate_rows, &job, dst->h, dst->w);
+    SDL_UnlockSurface(dst);
+    SDL_UnlockSurface(src);
+#if IS_SDLv1
+    SDL_SetAlpha(dst, SDL_SRCALPHA, 255);
+#else  /* IS_SDLv2 */
+    SDL_SetSurfaceAlphaMod(dst, SDL_ALPHA_OPAQUE);
+#endif /* IS_SDLv2 */
+    return dst;
+}
+
 static void
 scalesmooth(SDL_Surface *src, SDL_Surface *dst, struct _module_state *st)
 {
@@ -1361,39 +2451,39 @@ scalesmooth(SDL_Surface *src, SDL_Surface *dst, struct _module_state *st)
     if (dstwidth < srcwidth) /* shrink */
     {
         if (srcheight != dstheight)
-            st->filter_shrink_X(srcpix, temppix, srcheight, srcpitch,
-                                temppitch, srcwidth, dstwidth);
+            scale_pass(st->filter_shrink_X, 1, srcpix, temppix, srcheight,
+                       srcpitch, temppitch, srcwidth, dstwidth);
         else
-            st->filter_shrink_X(srcpix, dstpix, srcheight, srcpitch, dstpitch,
-                                srcwidth, dstwidth);
+            scale_pass(st->filter_shrink_X, 1, srcpix, dstpix, srcheight,
+                       srcpitch, dstpitch, srcwidth, dstwidth);
     }
     else if (dstwidth > srcwidth) /* expand */
     {
         if (srcheight != dstheight)
-            st->filter_expand_X(srcpix, temppix, srcheight, srcpitch,
-                                temppitch, srcwidth, dstwidth);
+            scale_pass(st->filter_expand_X, 1, srcpix, temppix, srcheight,
+                       srcpitch, temppitch, srcwidth, dstwidth);
         else
-            st->filter_expand_X(srcpix, dstpix, srcheight, srcpitch, dstpitch,
-                                srcwidth, dstwidth);
+            scale_pass(st->filter_expand_X, 1, srcpix, dstpix, srcheight,
+                       srcpitch, dstpitch, srcwidth, dstwidth);
     }
     /* Now do the Y scale */
     if (dstheight < srcheight) /* shrink */
     {
         if (srcwidth != dstwidth)
-            st->filter_shrink_Y(temppix, dstpix, tempwidth, temppitch,
-                                dstpitch, srcheight, dstheight);
+            scale_pass(st->filter_shrink_Y, 0, temppix, dstpix, tempwidth,
+                       temppitch, dstpitch, srcheight, dstheight);
         else
-            st->filter_shrink_Y(srcpix, dstpix, srcwidth, srcpitch, dstpitch,
-                                srcheight, dstheight);
+            scale_pass(st->filter_shrink_Y, 0, srcpix, dstpix, srcwidth,
+                       srcpitch, dstpitch, srcheight, dstheight);
     }
     else if (dstheight > srcheight) /* expand */
     {
         if (srcwidth != dstwidth)
-            st->filter_expand_Y(temppix, dstpix, tempwidth, temppitch,
-                                dstpitch, srcheight, dstheight);
+            scale_pass(st->filter_expand_Y, 0, temppix, dstpix, tempwidth,
+                       temppitch, dstpitch, srcheight, dstheight);
         else
-            st->filter_expand_Y(srcpix, dstpix, srcwidth, srcpitch, dstpitch,
-                                srcheight, dstheight);
+            scale_pass(st->filter_expand_Y, 0, srcpix, dstpix, srcwidth,
+                       srcpitch, dstpitch, srcheight, dstheight);
     }
 
     /* Convert back to 24-bit if necessary */
@@ -1438,8 +2528,10 @@ surf_scalesmooth(PyObject *self, PyObject *arg)
         if (!newsurf)
             return NULL;
     }
-    else
+    else {
         newsurf = pgSurface_AsSurface(surfobj2);
+        pgSurface_Changed(surfobj2);
+    }
 
     /* check to see if the size is twice as big. */
     if (newsurf->w != width || newsurf->h != height)
@@ -1453,7 +2545,7 @@ surf_scalesmooth(PyObject *self, PyObject *arg)
 
     if (width && height) {
         SDL_LockSurface(newsurf);
-        pgSurface_Lock(surfobj);
+        pgSurface_LockForRead(surfobj);
         Py_BEGIN_ALLOW_THREADS;
 
         /* handle trivial case */
@@ -1509,8 +2601,7 @@ surf_set_smoothscale_backend(PyObject *self, PyObject *args, PyObject *kwds)
     }
     else if (strcmp(type, "MMX") == 0) {
         if (!SDL_HasMMX()) {
-            return RAISE(PyExc_ValueError,
-                         "MMX not supported on this machine");
+            return pg_backend_error(type, -2);
         }
         st->filter_type = "MMX";
         st->filter_shrink_X = filter_shrink_X_MMX;
@@ -1520,8 +2611,7 @@ surf_set_smoothscale_backend(PyObject *self, PyObject *args, PyObject *kwds)
     }
     else if (strcmp(type, "SSE") == 0) {
         if (!SDL_HasSSE()) {
-            return RAISE(PyExc_ValueError,
-                         "SSE not supported on this machine");
+            return pg_backend_error(type, -2);
         }
         st->filter_type = "SSE";
         st->filter_shrink_X = filter_shrink_X_SSE;
@@ -1529,23 +2619,96 @@ surf_set_smoothscale_backend(PyObject *self, PyObject *args, PyObject *kwds)
         st->filter_expand_X = filter_expand_X_SSE;
         st->filter_expand_Y = filter_expand_Y_SSE;
     }
+    else if (strcmp(type, "AVX2") == 0) {
+#if defined(SCALE_AVX2_SUPPORT)
+        if (!pg_backend_runs(PG_BACKEND_AVX2)) {
+            return pg_backend_error(type, -2);
+        }
+        st->filter_type = "AVX2";
+        st->filter_shrink_X = filter_shrink_X_AVX2;
+        st->filter_shrink_Y = filter_shrink_Y_AVX2;
+        st->filter_expand_X = filter_expand_X_AVX2;
+        st->filter_expand_Y = filter_expand_Y_AVX2;
+#else  /* no AVX2 filters in this build */
+        return pg_backend_error(type, -2);
+#endif /* SCALE_AVX2_SUPPORT */
+    }
     else {
-        return PyErr_Format(PyExc_ValueError, "Unknown backend type %s", type);
+        return pg_backend_error(type, -1);
     }
     Py_RETURN_NONE;
 #else  /* Not an x86 processor */
     if (strcmp(type, "GENERIC") != 0) {
-        if (strcmp(st->filter_type, "MMX") == 0 ||
-            strcmp(st->filter_type, "SSE") == 0) {
-            return PyErr_Format(PyExc_ValueError,
-                                "%s not supported on this machine", type);
+        if (strcmp(type, "MMX") == 0 || strcmp(type, "SSE") == 0 ||
+            strcmp(type, "AVX2") == 0) {
+            return pg_backend_error(type, -2);
         }
-        return PyErr_Format(PyExc_ValueError, "Unknown backend type %s", type);
+        return pg_backend_error(type, -1);
     }
     Py_RETURN_NONE;
 #endif /* defined(SCALE_MMX_SUPPORT) */
 }
 
+static PyObject *
+surf_get_threads(PyObject *self, PyObject *args)
+{
+    return PyInt_FromLong(scale_pool.threads);
+}
+
+static PyObject *
+surf_set_threads(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"count", NULL};
+    static int quit_registered = 0;
+    int count;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:_set_threads",
+                                     keywords, &count)) {
+        return NULL;
+    }
+    if (count < 0) {
+        return RAISE(PyExc_ValueError, "count must not be negative");
+    }
+    if (pg_pool_set_threads(&scale_pool, count)) {
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    if (!quit_registered && scale_pool.threads > 1) {
+        pg_RegisterQuit(_scale_quit_threads);
+        quit_registered = 1;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+surf_set_cache_size(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    char *keywords[] = {"size", NULL};
+    Py_ssize_t size;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n:set_cache_size",
+                                     keywords, &size)) {
+        return NULL;
+    }
+    if (size < 0) {
+        return RAISE(PyExc_ValueError, "size must not be negative");
+    }
+    pg_surface_cache_resize(&rotate_cache, (size_t)size);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+surf_get_cache_size(PyObject *self, PyObject *args)
+{
+    return PyLong_FromSize_t(rotate_cache.budget);
+}
+
+static PyObject *
+surf_clear_cache(PyObject *self, PyObject *args)
+{
+    _rotate_cache_clear();
+    Py_RETURN_NONE;
+}
+
 /* _get_color_move_pixels is for iterating over pixels in a Surface.
 
     bpp - bytes per pixel
@@ -1874,9 +3037,9 @@ surf_threshold(PyObject *self, PyObject *args, PyObject *kwds)
 
     if (dest_surf)
         pgSurface_Lock(dest_surf_obj);
-    pgSurface_Lock(surf_obj);
+    pgSurface_LockForRead(surf_obj);
     if (search_surf)
-        pgSurface_Lock(search_surf_obj);
+        pgSurface_LockForRead(search_surf_obj);
 
     Py_BEGIN_ALLOW_THREADS;
     num_threshold_pixels =
@@ -1977,430 +3140,1060 @@ clamp_4
 #endif
 
 /*
-number to use for missing samples
-*/
-#define LAPLACIAN_NUM 0xFFFFFFFF
+ * Convolution.
+ *
+ * Each destination row is computed from kh padded source rows, with every
+ * channel filtered as an 8 bit value. Pixels whose channels are whole bytes
+ * (24 and 32 bit surfaces laid out like the destination) are filtered as
+ * bytes; anything else is unpacked to RGBA with SDL_GetRGBA and packed back
+ * into the destination format with SDL_MapRGBA.
+ *
+ * The kernel is divided by the divisor and turned into 16 bit fixed point
+ * weights, so the inner loop is the SSE2 multiply-add of two taps at a time
+ * over 8 channels. The C loop below it does the same integer arithmetic, so
+ * both give the same result. A kernel that is the outer product of a row and
+ * a column with no negative weights, like a box or gaussian blur, is applied
+ * as a horizontal pass into 16 bit rows and a vertical pass over those,
+ * which costs kw + kh taps per channel instead of kw * kh.
+ *
+ * Row bands are handed to the smoothscale thread pool through scale_rows.
+ */
+#define CONVOLVE_CLAMP 0
+#define CONVOLVE_WRAP 1
+#define CONVOLVE_CONSTANT 2
 
-void
-laplacian(SDL_Surface *surf, SDL_Surface *destsurf)
+/* Largest fixed point shift tried for the weights. */
+#define CONVOLVE_MAX_SHIFT 22
+
+typedef struct {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    int raw;       /* filter the pixel bytes, else RGBA from SDL_GetRGBA */
+    int nch;       /* bytes in a working pixel */
+    int border;    /* CONVOLVE_CLAMP, CONVOLVE_WRAP or CONVOLVE_CONSTANT */
+    Uint8 fill[4]; /* working pixel outside the source for CONVOLVE_CONSTANT */
+    int offset;    /* added to every channel after the division */
+    int kw, kh;
+    int separable;
+    /* direct: ntaps weights, tap k reading kernel row taprow[k] at byte
+     * offset tapoff[k] into the padded row. ntaps is even. */
+    int ntaps;
+    int *taprow;
+    int *tapoff;
+    Sint16 *q;
+    int shift;
+    /* separable: kw (rounded up to even) horizontal weights summing to
+     * 1 << 14 and kh (likewise) vertical ones with vshift */
+    Sint16 *hq;
+    Sint16 *vq;
+    int vshift;
+    int failed; /* set by a band that ran out of memory */
+} ConvolveJob;
+
+/* Arithmetic shift right, rounding down for negative values too. */
+static PG_INLINE Sint32
+_convolve_shift(Sint32 acc, int shift)
 {
-    int ii;
-    int x, y, height, width;
+    return acc >= 0 ? acc >> shift : -((-acc - 1) >> shift) - 1;
+}
 
-    Uint32 sample[9];
-    // Uint32 total[4];
-    int total[4];
+/* out[i] = ((sum of q[k] * src[k][i]) + rounding) >> shift, plus offset,
+ * for n channels. Saturated to 0..255 into out8 when it is given, else to
+ * 16 bits into out16. ntaps is even.
+ */
+static void
+_convolve_u8(Uint8 **src, const Sint16 *q, int ntaps, int n, int shift,
+             int offset, Uint8 *out8, Sint16 *out16)
+{
+    Sint32 bias = shift ? 1 << (shift - 1) : 0;
+    int i = 0, k;
+
+#ifdef PG_HAS_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i count = _mm_cvtsi32_si128(shift);
+    __m128i offs = _mm_set1_epi32(offset);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo = _mm_set1_epi32(bias), hi = lo, a, b, w;
+
+        for (k = 0; k < ntaps; k += 2) {
+            a = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(src[k] + i)),
+                                  zero);
+            b = _mm_unpacklo_epi8(
+                _mm_loadl_epi64((__m128i *)(src[k + 1] + i)), zero);
+            w = _mm_set1_epi32((int)(((Uint32)(Uint16)q[k + 1] << 16) |
+                                     (Uint16)q[k]));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b),
+                                                  w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b),
+                                                  w));
+        }
+        lo = _mm_add_epi32(_mm_sra_epi32(lo, count), offs);
+        hi = _mm_add_epi32(_mm_sra_epi32(hi, count), offs);
+        a = _mm_packs_epi32(lo, hi);
+        if (out8) {
+            _mm_storel_epi64((__m128i *)(out8 + i), _mm_packus_epi16(a, a));
+        }
+        else {
+            _mm_storeu_si128((__m128i *)(out16 + i), a);
+        }
+    }
+#endif /* PG_HAS_SSE2 */
+    for (; i < n; ++i) {
+        Sint32 acc = bias;
 
-    Uint8 c1r, c1g, c1b, c1a;
-    // Uint32 c1r, c1g, c1b, c1a;
-    Uint8 acolor[4];
+        for (k = 0; k < ntaps; ++k) {
+            acc += q[k] * src[k][i];
+        }
+        acc = _convolve_shift(acc, shift) + offset;
+        if (out8) {
+            out8[i] = (Uint8)(acc < 0 ? 0 : acc > 255 ? 255 : acc);
+        }
+        else {
+            out16[i] = (Sint16)(acc < -32768 ? -32768
+                                : acc > 32767 ? 32767
+                                              : acc);
+        }
+    }
+}
 
-    Uint32 the_color;
+/* _convolve_u8 over 16 bit source rows, saturating to 0..255. */
+static void
+_convolve_s16(Sint16 **src, const Sint16 *q, int ntaps, int n, int shift,
+              int offset, Uint8 *out8)
+{
+    Sint32 bias = shift ? 1 << (shift - 1) : 0;
+    int i = 0, k;
+
+#ifdef PG_HAS_SSE2
+    __m128i count = _mm_cvtsi32_si128(shift);
+    __m128i offs = _mm_set1_epi32(offset);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo = _mm_set1_epi32(bias), hi = lo, a, b, w;
+
+        for (k = 0; k < ntaps; k += 2) {
+            a = _mm_loadu_si128((__m128i *)(src[k] + i));
+            b = _mm_loadu_si128((__m128i *)(src[k + 1] + i));
+            w = _mm_set1_epi32((int)(((Uint32)(Uint16)q[k + 1] << 16) |
+                                     (Uint16)q[k]));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b),
+                                                  w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b),
+                                                  w));
+        }
+        lo = _mm_add_epi32(_mm_sra_epi32(lo, count), offs);
+        hi = _mm_add_epi32(_mm_sra_epi32(hi, count), offs);
+        a = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i *)(out8 + i), _mm_packus_epi16(a, a));
+    }
+#endif /* PG_HAS_SSE2 */
+    for (; i < n; ++i) {
+        Sint32 acc = bias;
 
-    int atmp0;
-    int atmp1;
-    int atmp2;
-    int atmp3;
+        for (k = 0; k < ntaps; ++k) {
+            acc += q[k] * src[k][i];
+        }
+        acc = _convolve_shift(acc, shift) + offset;
+        out8[i] = (Uint8)(acc < 0 ? 0 : acc > 255 ? 255 : acc);
+    }
+}
 
-    SDL_PixelFormat *format, *destformat;
-    Uint8 *pixels, *destpixels;
+/* Read source row y, or the border row standing in for it, into row as
+ * working pixels with kw / 2 border pixels on either side.
+ */
+static void
+_convolve_load(const ConvolveJob *job, int y, Uint8 *row)
+{
+    SDL_Surface *src = job->src;
+    SDL_PixelFormat *format = src->format;
+    Uint8 *pixels = (Uint8 *)src->pixels;
+    int w = src->w, h = src->h, nch = job->nch, rx = job->kw / 2;
+    Uint8 *mid = row + rx * nch;
     Uint8 *pix;
+    Uint32 pixel;
+    int x;
 
-    Uint8 *byte_buf;
-
-    height = surf->h;
-    width = surf->w;
+    if (y < 0 || y >= h) {
+        if (job->border == CONVOLVE_CONSTANT) {
+            for (x = 0; x < w + 2 * rx; ++x) {
+                memcpy(row + x * nch, job->fill, nch);
+            }
+            return;
+        }
+        if (job->border == CONVOLVE_WRAP) {
+            y = (y % h + h) % h;
+        }
+        else {
+            y = y < 0 ? 0 : h - 1;
+        }
+    }
 
-    pixels = (Uint8 *)surf->pixels;
-    format = surf->format;
+    if (job->raw) {
+        memcpy(mid, pixels + y * src->pitch, w * nch);
+    }
+    else {
+        for (x = 0; x < w; ++x) {
+            SURF_GET_AT(pixel, src, x, y, pixels, format, pix);
+            SDL_GetRGBA(pixel, format, mid + x * 4, mid + x * 4 + 1,
+                        mid + x * 4 + 2, mid + x * 4 + 3);
+        }
+    }
 
-    destpixels = (Uint8 *)destsurf->pixels;
-    destformat = destsurf->format;
+    for (x = 1; x <= rx; ++x) {
+        const Uint8 *left, *right;
 
-    /*
-        -1 -1 -1
-        -1  8 -1
-        -1 -1 -1
+        if (job->border == CONVOLVE_CONSTANT) {
+            left = right = job->fill;
+        }
+        else if (job->border == CONVOLVE_WRAP) {
+            left = mid + ((w - x % w) % w) * nch;
+            right = mid + ((w - 1 + x) % w) * nch;
+        }
+        else {
+            left = mid;
+            right = mid + (w - 1) * nch;
+        }
+        memcpy(mid - x * nch, left, nch);
+        memcpy(mid + (w - 1 + x) * nch, right, nch);
+    }
+}
 
-        col = (sample[4] * 8) - (sample[0] + sample[1] + sample[2] +
-                                 sample[3] +             sample[5] +
-                                 sample[6] + sample[7] + sample[8])
+/* Pack the RGBA working pixels of out into destination row y. */
+static void
+_convolve_store(const ConvolveJob *job, int y, const Uint8 *out)
+{
+    SDL_Surface *dst = job->dst;
+    SDL_PixelFormat *format = dst->format;
+    Uint8 *row = (Uint8 *)dst->pixels + y * dst->pitch;
+    Uint32 pixel;
+    int x;
+
+    for (x = 0; x < dst->w; ++x, out += 4) {
+        pixel = SDL_MapRGBA(format, out[0], out[1], out[2], out[3]);
+        switch (format->BytesPerPixel) {
+            case 1:
+                row[x] = (Uint8)pixel;
+                break;
+            case 2:
+                ((Uint16 *)row)[x] = (Uint16)pixel;
+                break;
+            case 3:
+#if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+                row[x * 3] = (Uint8)pixel;
+                row[x * 3 + 1] = (Uint8)(pixel >> 8);
+                row[x * 3 + 2] = (Uint8)(pixel >> 16);
+#else
+                row[x * 3] = (Uint8)(pixel >> 16);
+                row[x * 3 + 1] = (Uint8)(pixel >> 8);
+                row[x * 3 + 2] = (Uint8)pixel;
+#endif
+                break;
+            default:
+                ((Uint32 *)row)[x] = pixel;
+                break;
+        }
+    }
+}
 
-        [(-1,-1), (0,-1), (1,-1),     (-1,0), (0,0), (1,0),     (-1,1), (0,1),
-       (1,1)]
+/* Convolve destination rows start to end. */
+static void
+_convolve_rows(void *data, int start, int end)
+{
+    ConvolveJob *job = (ConvolveJob *)data;
+    int w = job->src->w, nch = job->nch, kh = job->kh, ry = kh / 2;
+    int n = w * nch, padded = (w + job->kw - 1) * nch;
+    int nrows = job->separable ? 1 : kh;
+    int ntaps = job->separable ? job->kw + (job->kw & 1) : job->ntaps;
+    Uint8 **rows = (Uint8 **)malloc(sizeof(Uint8 *) * kh);
+    Uint8 **taps = (Uint8 **)malloc(sizeof(Uint8 *) * ntaps);
+    Uint8 *buf = (Uint8 *)malloc((size_t)padded * nrows);
+    Uint8 *out = job->raw ? NULL : (Uint8 *)malloc(n);
+    Sint16 **vrows = NULL;
+    Sint16 *vbuf = NULL;
+    int y, r, k;
+
+    if (job->separable) {
+        vrows = (Sint16 **)malloc(sizeof(Sint16 *) * (kh + 1));
+        vbuf = (Sint16 *)malloc(sizeof(Sint16) * n * kh);
+    }
+    if (!rows || !taps || !buf || (!job->raw && !out) ||
+        (job->separable && (!vrows || !vbuf))) {
+        job->failed = 1;
+        goto done;
+    }
 
-    */
+    if (job->separable) {
+        /* a zero weight tap, if any, reads the first pixel again */
+        for (k = 0; k < ntaps; ++k) {
+            taps[k] = buf + (k < job->kw ? k : 0) * nch;
+        }
+        for (r = 0; r < kh; ++r) {
+            vrows[r] = vbuf + r * n;
+        }
+        vrows[kh] = vrows[0];
+    }
+    else {
+        for (r = 0; r < kh; ++r) {
+            rows[r] = buf + r * padded;
+        }
+    }
 
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
-            // Need to bounds check these accesses.
+    /* rows (or vrows) hold source rows y - ry to y + ry; the one falling
+     * out at the top is reused for the row coming in at the bottom.
+     */
+    for (y = start - ry; y < end + ry; ++y) {
+        Uint8 *dstrow;
 
-            if (y > 0) {
-                if (x > 0) {
-                    SURF_GET_AT(sample[0], surf, x + -1, y + -1, pixels,
-                                format, pix);
-                }
+        if (job->separable) {
+            Sint16 *next = vrows[0];
 
-                SURF_GET_AT(sample[1], surf, x + 0, y + -1, pixels, format,
-                            pix);
+            memmove(vrows, vrows + 1, sizeof(Sint16 *) * (kh - 1));
+            vrows[kh - 1] = next;
+            _convolve_load(job, y, buf);
+            _convolve_u8(taps, job->hq, ntaps, n, 7, 0, NULL, next);
+        }
+        else {
+            Uint8 *next = rows[0];
 
-                if (x + 1 < width) {
-                    SURF_GET_AT(sample[2], surf, x + 1, y + -1, pixels, format,
-                                pix);
-                }
-            }
-            else {
-                sample[0] = LAPLACIAN_NUM;
-                sample[1] = LAPLACIAN_NUM;
-                sample[2] = LAPLACIAN_NUM;
-            }
+            memmove(rows, rows + 1, sizeof(Uint8 *) * (kh - 1));
+            rows[kh - 1] = next;
+            _convolve_load(job, y, next);
+        }
+        if (y < start + ry) {
+            continue;
+        }
 
-            if (x > 0) {
-                SURF_GET_AT(sample[3], surf, x + -1, y + 0, pixels, format,
-                            pix);
-            }
-            else {
-                sample[3] = LAPLACIAN_NUM;
+        dstrow = job->raw ? (Uint8 *)job->dst->pixels +
+                                (y - ry) * job->dst->pitch
+                          : out;
+        if (job->separable) {
+            vrows[kh] = vrows[0];
+            _convolve_s16(vrows, job->vq, kh + (kh & 1), n, job->vshift,
+                          job->offset, dstrow);
+        }
+        else {
+            for (k = 0; k < ntaps; ++k) {
+                taps[k] = rows[job->taprow[k]] + job->tapoff[k];
             }
+            _convolve_u8(taps, job->q, ntaps, n, job->shift, job->offset,
+                         dstrow, NULL);
+        }
+        if (!job->raw) {
+            _convolve_store(job, y - ry, out);
+        }
+    }
 
-            // SURF_GET_AT(sample[4], surf, x+0 , y+0);
-            sample[4] = 0;
+done:
+    free(rows);
+    free(taps);
+    free(buf);
+    free(out);
+    free(vrows);
+    free(vbuf);
+}
 
-            if (x + 1 < width) {
-                SURF_GET_AT(sample[5], surf, x + 1, y + 0, pixels, format,
-                            pix);
-            }
-            else {
-                sample[5] = LAPLACIAN_NUM;
-            }
+/* Round weights[0..count) times 1 << shift to q, nudging the largest one so
+ * the rounded weights add up to the rounded sum. Returns the sum of their
+ * magnitudes, or -1 if a weight does not fit in 16 bits.
+ */
+static double
+_convolve_quantize(const double *weights, int count, int shift, Sint16 *q)
+{
+    double scale = ldexp(1.0, shift), sum = 0.0, total = 0.0, v;
+    int i, big = 0, rounded = 0;
 
-            if (y + 1 < height) {
-                if (x > 0) {
-                    SURF_GET_AT(sample[6], surf, x + -1, y + 1, pixels, format,
-                                pix);
-                }
+    for (i = 0; i < count; ++i) {
+        v = floor(weights[i] * scale + 0.5);
+        if (v > 32767.0 || v < -32767.0) {
+            return -1.0;
+        }
+        q[i] = (Sint16)v;
+        rounded += q[i];
+        sum += weights[i];
+        if (fabs(weights[i]) > fabs(weights[big])) {
+            big = i;
+        }
+    }
+    v = floor(sum * scale + 0.5) - rounded;
+    if (fabs(q[big] + v) <= 32767.0) {
+        q[big] = (Sint16)(q[big] + v);
+    }
+    for (i = 0; i < count; ++i) {
+        total += abs(q[i]);
+    }
+    return total;
+}
 
-                SURF_GET_AT(sample[7], surf, x + 0, y + 1, pixels, format,
-                            pix);
+/* Quantize count weights with the largest shift that keeps sum |q| * range
+ * plus the rounding for a shift of that plus extra inside an Sint32.
+ * Returns the shift, or -1 if even a shift of 0 does not fit.
+ */
+static int
+_convolve_weights(const double *weights, int count, double range,
+                  int extra, Sint16 *q)
+{
+    int shift;
+    double total;
+
+    for (shift = CONVOLVE_MAX_SHIFT; shift >= 0; --shift) {
+        total = _convolve_quantize(weights, count, shift, q);
+        if (total >= 0.0 &&
+            total * range + ldexp(1.0, shift + extra) < 2147483647.0) {
+            return shift;
+        }
+    }
+    return -1;
+}
 
-                if (x + 1 < width) {
-                    SURF_GET_AT(sample[8], surf, x + 1, y + 1, pixels, format,
-                                pix);
-                }
+/* Check whether kernel (kh rows of kw, already divided) is the outer product
+ * of a column and a row of non negative weights. If so store the row, scaled
+ * to add up to 1, in h and the column in v.
+ */
+static int
+_convolve_separate(const double *kernel, int kw, int kh, double *h,
+                   double *v)
+{
+    int r, c, pr = 0, pc = 0;
+    double peak = 0.0, hsum = 0.0;
+
+    for (r = 0; r < kh; ++r) {
+        for (c = 0; c < kw; ++c) {
+            if (fabs(kernel[r * kw + c]) > peak) {
+                peak = fabs(kernel[r * kw + c]);
+                pr = r;
+                pc = c;
             }
-            else {
-                sample[6] = LAPLACIAN_NUM;
-                sample[7] = LAPLACIAN_NUM;
-                sample[8] = LAPLACIAN_NUM;
+        }
+    }
+    if (peak == 0.0) {
+        return 0;
+    }
+    for (c = 0; c < kw; ++c) {
+        h[c] = kernel[pr * kw + c] / kernel[pr * kw + pc];
+        if (h[c] < 0.0) {
+            return 0;
+        }
+        hsum += h[c];
+    }
+    for (r = 0; r < kh; ++r) {
+        v[r] = kernel[r * kw + pc] * hsum;
+        if (v[r] < 0.0) {
+            return 0;
+        }
+        for (c = 0; c < kw; ++c) {
+            if (fabs(kernel[r * kw + c] - kernel[r * kw + pc] * h[c]) >
+                peak * 1e-9) {
+                return 0;
             }
+        }
+    }
+    for (c = 0; c < kw; ++c) {
+        h[c] /= hsum;
+    }
+    return 1;
+}
 
-            total[0] = 0;
-            total[1] = 0;
-            total[2] = 0;
-            total[3] = 0;
-
-            for (ii = 0; ii < 9; ii++) {
-                SDL_GetRGBA(sample[ii], format, &c1r, &c1g, &c1b, &c1a);
-                total[0] += c1r;
-                total[1] += c1g;
-                total[2] += c1b;
-                total[3] += c1a;
-            }
+/* Convolve src into dst, which has the same size and bytes per pixel and
+ * is not src. kernel holds kh rows of kw weights, both odd, already divided
+ * by the divisor; border is one of the CONVOLVE_ modes, with borderpixel the
+ * mapped color for CONVOLVE_CONSTANT. Call with both surfaces locked; the
+ * GIL may be released.
+ *
+ * Returns 0 on success, -1 if memory ran out and -2 if the weights are too
+ * large to be applied.
+ */
+static int
+convolve(SDL_Surface *src, SDL_Surface *dst, const double *kernel, int kw,
+         int kh, int offset, int border, Uint32 borderpixel)
+{
+    SDL_PixelFormat *format = src->format;
+    ConvolveJob job;
+    double *h = NULL, *v = NULL, *flat = NULL;
+    int size = kw * kh, result = 0, r, c, k;
+
+    if (src->w <= 0 || src->h <= 0) {
+        return 0;
+    }
+
+    memset(&job, 0, sizeof(job));
+    job.src = src;
+    job.dst = dst;
+    job.border = border;
+    job.offset = offset;
+    job.kw = kw;
+    job.kh = kh;
+    job.raw = format->BytesPerPixel >= 3 && format->Rloss == 0 &&
+              format->Gloss == 0 && format->Bloss == 0 &&
+              (!format->Amask || format->Aloss == 0) &&
+              format->Rmask == dst->format->Rmask &&
+              format->Gmask == dst->format->Gmask &&
+              format->Bmask == dst->format->Bmask &&
+              format->Amask == dst->format->Amask;
+    job.nch = job.raw ? format->BytesPerPixel : 4;
+    if (job.raw) {
+#if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+        memcpy(job.fill, &borderpixel, job.nch);
+#else
+        memcpy(job.fill, (Uint8 *)&borderpixel + 4 - job.nch, job.nch);
+#endif
+    }
+    else {
+        SDL_GetRGBA(borderpixel, format, job.fill, job.fill + 1,
+                    job.fill + 2, job.fill + 3);
+    }
 
-            SURF_GET_AT(sample[4], surf, x, y, pixels, format, pix);
+    h = (double *)malloc(sizeof(double) * (kw + 1));
+    v = (double *)malloc(sizeof(double) * (kh + 1));
+    flat = (double *)malloc(sizeof(double) * (size + 2));
+    job.hq = (Sint16 *)malloc(sizeof(Sint16) * (kw + 1));
+    job.vq = (Sint16 *)malloc(sizeof(Sint16) * (kh + 1));
+    job.q = (Sint16 *)malloc(sizeof(Sint16) * (size + 2));
+    job.taprow = (int *)malloc(sizeof(int) * (size + 2));
+    job.tapoff = (int *)malloc(sizeof(int) * (size + 2));
+    if (!h || !v || !flat || !job.hq || !job.vq || !job.q || !job.taprow ||
+        !job.tapoff) {
+        result = -1;
+        goto done;
+    }
 
-            SDL_GetRGBA(sample[4], format, &c1r, &c1g, &c1b, &c1a);
+    /* a 1 by n or n by 1 kernel is as cheap to apply directly */
+    job.separable = kw > 1 && kh > 1 &&
+                    _convolve_separate(kernel, kw, kh, h, v);
+    if (job.separable) {
+        h[kw] = v[kh] = 0.0;
+        /* the horizontal weights add up to exactly 1 << 14 and their
+         * pass keeps 7 bits of fraction, so its rows stay within 0 to
+         * 255 << 7 */
+        job.vshift = _convolve_weights(v, kh + (kh & 1), 255 << 7, 7,
+                                       job.vq);
+        if (_convolve_quantize(h, kw + (kw & 1), 14, job.hq) < 0.0 ||
+            job.vshift < 0) {
+            job.separable = 0;
+        }
+        job.vshift += 7;
+    }
+    if (!job.separable) {
+        /* leave out zero weights, like the corners of a laplacian */
+        for (r = 0, k = 0; r < kh; ++r) {
+            for (c = 0; c < kw; ++c) {
+                if (kernel[r * kw + c] != 0.0) {
+                    flat[k] = kernel[r * kw + c];
+                    job.taprow[k] = r;
+                    job.tapoff[k] = c * job.nch;
+                    ++k;
+                }
+            }
+        }
+        while (k == 0 || (k & 1)) {
+            flat[k] = 0.0;
+            job.taprow[k] = job.tapoff[k] = 0;
+            ++k;
+        }
+        job.ntaps = k;
+        job.shift = _convolve_weights(flat, k, 255, 0, job.q);
+        if (job.shift < 0) {
+            result = -2;
+            goto done;
+        }
+    }
 
-            // cast on the right to a signed int, and then clamp to 0-255.
+    scale_rows(_convolve_rows, &job, src->h, src->w);
+    if (job.failed) {
+        result = -1;
+    }
 
-            // atmp = c1r * 8
+done:
+    free(h);
+    free(v);
+    free(flat);
+    free(job.hq);
+    free(job.vq);
+    free(job.q);
+    free(job.taprow);
+    free(job.tapoff);
+    return result;
+}
 
-            atmp0 = c1r * 8;
-            acolor[0] = MIN(MAX(atmp0 - total[0], 0), 255);
-            atmp1 = c1g * 8;
-            acolor[1] = MIN(MAX(atmp1 - total[1], 0), 255);
-            atmp2 = c1b * 8;
-            acolor[2] = MIN(MAX(atmp2 - total[2], 0), 255);
-            atmp3 = c1a * 8;
-            acolor[3] = MIN(MAX(atmp3 - total[3], 0), 255);
+/* Check that destobj, when given, can take a filtered copy of surf, or
+ * make a new destination surface. Returns NULL with an exception set on
+ * failure.
+ */
+static SDL_Surface *
+_convolve_dest(SDL_Surface *surf, PyObject *destobj)
+{
+    SDL_Surface *newsurf;
 
-            // printf("%d;;%d;;%d;;  ", atmp0, acolor[0],total[0]);
+    if (!destobj) {
+        return newsurf_fromsurf(surf, surf->w, surf->h);
+    }
+    newsurf = pgSurface_AsSurface(destobj);
+    if (newsurf == surf)
+        return (SDL_Surface *)(RAISE(
+            PyExc_ValueError,
+            "Destination surface cannot be the source surface."));
+    if (newsurf->w != surf->w || newsurf->h != surf->h)
+        return (SDL_Surface *)(RAISE(
+            PyExc_ValueError, "Destination surface not the same size."));
+    if (surf->format->BytesPerPixel != newsurf->format->BytesPerPixel)
+        return (SDL_Surface *)(RAISE(
+            PyExc_ValueError,
+            "Source and destination surfaces need the same format."));
+    return newsurf;
+}
 
-            // printf("%d,%d,%d,%d;;  \n", acolor[0], acolor[1], acolor[2],
-            // acolor[3]);
+/* Run convolve from surfobj into destobj, or a new surface when destobj is
+ * NULL, and return the destination.
+ */
+static PyObject *
+_convolve_surface(PyObject *surfobj, PyObject *destobj, const double *kernel,
+                  int kw, int kh, int offset, int border, Uint32 borderpixel)
+{
+    SDL_Surface *surf = pgSurface_AsSurface(surfobj);
+    SDL_Surface *newsurf;
+    int result;
 
-            // the_color = (Uint32)acolor;
-            // the_color = 0x00000000;
+    newsurf = _convolve_dest(surf, destobj);
+    if (!newsurf) {
+        return NULL;
+    }
+    if (destobj) {
+        pgSurface_Lock(destobj);
+    }
+    else {
+        SDL_LockSurface(newsurf);
+    }
+    pgSurface_LockForRead(surfobj);
 
-            // cast on the right to Uint32, and then clamp to 255.
+    Py_BEGIN_ALLOW_THREADS;
+    result = convolve(surf, newsurf, kernel, kw, kh, offset, border,
+                      borderpixel);
+    Py_END_ALLOW_THREADS;
 
-            the_color = SDL_MapRGBA(surf->format, acolor[0], acolor[1],
-                                    acolor[2], acolor[3]);
+    pgSurface_Unlock(surfobj);
+    if (destobj) {
+        pgSurface_Unlock(destobj);
+    }
+    else {
+        SDL_UnlockSurface(newsurf);
+    }
 
-            // set_at(destsurf, color, x,y);
+    if (result < 0) {
+        if (!destobj) {
+            SDL_FreeSurface(newsurf);
+        }
+        if (result == -2) {
+            return RAISE(PyExc_ValueError, "kernel weights are too large");
+        }
+        return PyErr_NoMemory();
+    }
+    if (destobj) {
+        Py_INCREF(destobj);
+        return destobj;
+    }
+    return pgSurface_New(newsurf);
+}
 
-            switch (destformat->BytesPerPixel) {
-                case 1:
-                    *((Uint8 *)destpixels + y * destsurf->pitch + x) =
-                        (Uint8)the_color;
-                    break;
-                case 2:
-                    *((Uint16 *)(destpixels + y * destsurf->pitch) + x) =
-                        (Uint16)the_color;
-                    break;
-                case 3:
-                    byte_buf =
-                        (Uint8 *)(destpixels + y * destsurf->pitch) + x * 3;
-#if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
-                    *(byte_buf + (destformat->Rshift >> 3)) =
-                        (Uint8)(the_color >> 16);
-                    *(byte_buf + (destformat->Gshift >> 3)) =
-                        (Uint8)(the_color >> 8);
-                    *(byte_buf + (destformat->Bshift >> 3)) = (Uint8)the_color;
-#else
-                    *(byte_buf + 2 - (destformat->Rshift >> 3)) =
-                        (Uint8)(the_color >> 16);
-                    *(byte_buf + 2 - (destformat->Gshift >> 3)) =
-                        (Uint8)(the_color >> 8);
-                    *(byte_buf + 2 - (destformat->Bshift >> 3)) =
-                        (Uint8)the_color;
-#endif
-                    break;
-                default:
-                    *((Uint32 *)(destpixels + y * destsurf->pitch) + x) =
-                        the_color;
-                    break;
-            }
+/* Get the CONVOLVE_ mode named by obj, 'clamp' or 'wrap', or else the
+ * color obj maps to in format for CONVOLVE_CONSTANT. Returns -1 with an
+ * exception set if obj is neither.
+ */
+static int
+_convolve_border(PyObject *obj, SDL_PixelFormat *format, Uint32 *pixel)
+{
+    const char *names[] = {"clamp", "wrap"};
+    int i, same;
+
+    if (Text_Check(obj) || PyUnicode_Check(obj)) {
+        for (i = 0; i < 2; ++i) {
+            PyObject *name = Text_FromUTF8(names[i]);
+
+            if (!name)
+                return -1;
+            same = PyObject_RichCompareBool(obj, name, Py_EQ);
+            Py_DECREF(name);
+            if (same)
+                return same < 0 ? -1 : i;
         }
     }
+    else if (_color_from_obj(obj, format, NULL, pixel) == 0) {
+        return CONVOLVE_CONSTANT;
+    }
+    PyErr_SetString(PyExc_ValueError,
+                    "border must be 'clamp', 'wrap' or a color");
+    return -1;
 }
 
 static PyObject *
-surf_laplacian(PyObject *self, PyObject *arg)
+surf_convolve(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    PyObject *surfobj, *surfobj2;
+    PyObject *surfobj, *kernelobj, *divobj = NULL, *borderobj = NULL;
+    PyObject *destobj = NULL, *row, *item, *result;
     SDL_Surface *surf;
-    SDL_Surface *newsurf;
-    int width, height;
-    surfobj2 = NULL;
-
-    /*get all the arguments*/
-    if (!PyArg_ParseTuple(arg, "O!|O!", &pgSurface_Type, &surfobj,
-                          &pgSurface_Type, &surfobj2))
+    double *kernel, divisor, sum = 0.0;
+    int offset = 0, border = CONVOLVE_CLAMP, kw = 0, kh, r, c;
+    Uint32 borderpixel = 0;
+    char *keywords[] = {"surface", "kernel", "divisor", "offset",
+                        "border", "dest_surface", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O|OiOO!", keywords,
+                                     &pgSurface_Type, &surfobj, &kernelobj,
+                                     &divobj, &offset, &borderobj,
+                                     &pgSurface_Type, &destobj))
         return NULL;
-
     surf = pgSurface_AsSurface(surfobj);
 
-    /* if the second surface is not there, then make a new one. */
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4)
+        return RAISE(PyExc_ValueError,
+                     "unsupport Surface bit depth for transform");
+    if (offset < -255 || offset > 255)
+        return RAISE(PyExc_ValueError, "offset must be between -255 and 255");
 
-    if (!surfobj2) {
-        width = surf->w;
-        height = surf->h;
+    if (borderobj && borderobj != Py_None) {
+        border = _convolve_border(borderobj, surf->format, &borderpixel);
+        if (border < 0)
+            return NULL;
+    }
 
-        newsurf = newsurf_fromsurf(surf, width, height);
+    if (!PySequence_Check(kernelobj) ||
+        (kh = (int)PySequence_Length(kernelobj)) < 1)
+        return RAISE(PyExc_TypeError,
+                     "kernel must be a non empty sequence of rows");
+    for (r = 0; r < kh; ++r) {
+        int len;
 
-        if (!newsurf)
+        row = PySequence_GetItem(kernelobj, r);
+        if (!row)
             return NULL;
+        len = PySequence_Check(row) ? (int)PySequence_Length(row) : -1;
+        Py_DECREF(row);
+        if (len < 1 || (r && len != kw))
+            return RAISE(PyExc_TypeError,
+                         "kernel rows must be sequences of the same length");
+        kw = len;
     }
-    else
-        newsurf = pgSurface_AsSurface(surfobj2);
-
-    /* check to see if the size is the correct size. */
-    if (newsurf->w != (surf->w) || newsurf->h != (surf->h))
+    if (!(kw & 1) || !(kh & 1))
         return RAISE(PyExc_ValueError,
-                     "Destination surface not the same size.");
+                     "kernel width and height must be odd");
+
+    kernel = (double *)PyMem_Malloc(sizeof(double) * kw * kh);
+    if (!kernel)
+        return PyErr_NoMemory();
+    for (r = 0; r < kh; ++r) {
+        row = PySequence_GetItem(kernelobj, r);
+        for (c = 0; row && c < kw; ++c) {
+            item = PySequence_GetItem(row, c);
+            kernel[r * kw + c] = item ? PyFloat_AsDouble(item) : -1.0;
+            Py_XDECREF(item);
+            if (PyErr_Occurred())
+                break;
+            sum += kernel[r * kw + c];
+        }
+        Py_XDECREF(row);
+        if (PyErr_Occurred()) {
+            PyMem_Free(kernel);
+            return NULL;
+        }
+    }
 
-    /* check to see if the format of the surface is the same. */
-    if (surf->format->BytesPerPixel != newsurf->format->BytesPerPixel)
-        return RAISE(PyExc_ValueError,
-                     "Source and destination surfaces need the same format.");
+    if (divobj && divobj != Py_None) {
+        divisor = PyFloat_AsDouble(divobj);
+        if (divisor == -1.0 && PyErr_Occurred()) {
+            PyMem_Free(kernel);
+            return NULL;
+        }
+        if (divisor == 0.0) {
+            PyMem_Free(kernel);
+            return RAISE(PyExc_ValueError, "divisor cannot be zero");
+        }
+    }
+    else {
+        /* a kernel adding up to zero, like an edge detector, is used as is */
+        divisor = fabs(sum) > 1e-9 ? sum : 1.0;
+    }
+    for (r = 0; r < kw * kh; ++r) {
+        kernel[r] /= divisor;
+    }
 
-    SDL_LockSurface(newsurf);
-    SDL_LockSurface(surf);
+    result = _convolve_surface(surfobj, destobj, kernel, kw, kh, offset,
+                               border, borderpixel);
+    PyMem_Free(kernel);
+    return result;
+}
 
-    Py_BEGIN_ALLOW_THREADS;
-    laplacian(surf, newsurf);
-    Py_END_ALLOW_THREADS;
+/* number to use for missing samples */
+#define LAPLACIAN_NUM 0xFFFFFFFF
 
-    SDL_UnlockSurface(surf);
-    SDL_UnlockSurface(newsurf);
+/*
+    -1 -1 -1
+    -1  8 -1
+    -1 -1 -1
 
-    if (surfobj2) {
-        Py_INCREF(surfobj2);
-        return surfobj2;
-    }
-    else
-        return pgSurface_New(newsurf);
-}
+    with the pixels around the surface taken as LAPLACIAN_NUM.
+*/
+static const double laplacian_kernel[9] = {-1.0, -1.0, -1.0, -1.0, 8.0,
+                                           -1.0, -1.0, -1.0, -1.0};
 
-int
-average_surfaces(SDL_Surface **surfaces, int num_surfaces,
-                 SDL_Surface *destsurf, int palette_colors)
+static PyObject *
+surf_laplacian(PyObject *self, PyObject *arg)
 {
-    /*
-        returns the average surface from the ones given.
+    PyObject *surfobj, *surfobj2;
+    surfobj2 = NULL;
 
-        All surfaces need to be the same size.
+    /*get all the arguments*/
+    if (!PyArg_ParseTuple(arg, "O!|O!", &pgSurface_Type, &surfobj,
+                          &pgSurface_Type, &surfobj2))
+        return NULL;
 
-        palette_colors - if true we average the colors in palette, otherwise we
-            average the pixel values.  This is useful if the surface is
-            actually greyscale colors, and not palette colors.
+    return _convolve_surface(surfobj, surfobj2, laplacian_kernel, 3, 3, 0,
+                             CONVOLVE_CONSTANT, LAPLACIAN_NUM);
+}
 
-    */
+/*
+ * Averaging.
+ *
+ * average_surfaces goes through the image one row segment of at most
+ * AVERAGE_SEGMENT pixels at a time and adds that segment of every surface
+ * into accumulators small enough to stay in the L1 cache, instead of adding
+ * each whole surface into accumulators for the full image in turn. When the
+ * sources are laid out like the destination and their channels are whole
+ * bytes the pixel bytes are added as they are, 16 at a time with SSE2, into
+ * 16 bit sums that are flushed into 32 bit ones every AVERAGE_BATCH
+ * surfaces. average_color adds 32 bit pixels up the same way, a row at a
+ * time.
+ *
+ * Rows are handed to the smoothscale thread pool through scale_rows.
+ */
+#define AVERAGE_SEGMENT 1024
+#define AVERAGE_BATCH 257 /* 257 * 255 still fits in 16 bits */
 
-    Uint32 *accumulate;
-    Uint32 *the_idx;
-    Uint32 the_color;
-    SDL_Surface *surf;
-    int height, width, x, y, surf_idx;
+#define AVERAGE_BYTES 0 /* average each byte of the pixels */
+#define AVERAGE_RGB 1   /* average the RGB of the pixels */
+#define AVERAGE_INDEX 2 /* average the pixel values of 8 bit surfaces */
 
-    float div_inv;
+typedef struct {
+    SDL_Surface **surfaces;
+    int count;
+    SDL_Surface *dst;
+    int mode;
+    int failed; /* set by a band that ran out of memory */
+} AverageJob;
 
-    SDL_PixelFormat *format, *destformat;
-    Uint8 *pixels, *destpixels;
-    Uint8 *pix;
-    Uint8 *byte_buf;
+typedef struct {
+    SDL_Surface *surf;
+    int x, y, width;
+    Uint64 (*sums)[4]; /* r, g, b and a of each row */
+} AverageColorJob;
 
-    Uint32 rmask, gmask, bmask;
-    int rshift, gshift, bshift, rloss, gloss, bloss;
-    int num_elements;
+/* acc[i] += src[i] for n bytes. */
+static void
+_average_add_bytes(Uint16 *acc, const Uint8 *src, int n)
+{
+    int i = 0;
 
-    if (!num_surfaces) {
-        return 0;
-    }
+#ifdef PG_HAS_SSE2
+    __m128i zero = _mm_setzero_si128();
 
-    height = surfaces[0]->h;
-    width = surfaces[0]->w;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((__m128i *)(src + i));
+        __m128i *lo = (__m128i *)(acc + i), *hi = (__m128i *)(acc + i + 8);
 
-    destpixels = (Uint8 *)destsurf->pixels;
-    destformat = destsurf->format;
+        _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo),
+                                           _mm_unpacklo_epi8(v, zero)));
+        _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi),
+                                           _mm_unpackhi_epi8(v, zero)));
+    }
+#endif /* PG_HAS_SSE2 */
+    for (; i < n; ++i) {
+        acc[i] += src[i];
+    }
+}
 
-    /* allocate an array to accumulate them all.
+/* Move the 16 bit sums of n values into the 32 bit ones. */
+static void
+_average_flush(Uint32 *acc32, Uint16 *acc16, int n)
+{
+    int i;
 
-    If we're using 1 byte per pixel, then only need to average on that much.
-    */
+    for (i = 0; i < n; ++i) {
+        acc32[i] += acc16[i];
+    }
+    memset(acc16, 0, sizeof(Uint16) * n);
+}
 
-    if ((destformat->BytesPerPixel == 1) && (destformat->palette) &&
-        (!palette_colors)) {
-        num_elements = 1;
+/* Add pixel x of row y of surf to the sums in acc for job->mode. */
+static PG_INLINE void
+_average_add_pixel(const AverageJob *job, SDL_Surface *surf, int x, int y,
+                   Uint32 *acc)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint8 *pixels = (Uint8 *)surf->pixels;
+    Uint8 *pix, r, g, b;
+    Uint32 color;
+
+    SURF_GET_AT(color, surf, x, y, pixels, format, pix);
+    if (job->mode == AVERAGE_INDEX) {
+        acc[0] += color;
+    }
+    else if (format->palette) {
+        SDL_GetRGB(color, format, &r, &g, &b);
+        acc[0] += r;
+        acc[1] += g;
+        acc[2] += b;
     }
     else {
-        num_elements = 3;
+        acc[0] += ((color & format->Rmask) >> format->Rshift)
+                  << format->Rloss;
+        acc[1] += ((color & format->Gmask) >> format->Gshift)
+                  << format->Gloss;
+        acc[2] += ((color & format->Bmask) >> format->Bshift)
+                  << format->Bloss;
     }
+}
 
-    accumulate =
-        (Uint32 *)calloc(1, sizeof(Uint32) * height * width * num_elements);
+/* Average destination rows start to end. */
+static void
+_average_rows(void *data, int start, int end)
+{
+    AverageJob *job = (AverageJob *)data;
+    SDL_Surface *dst = job->dst;
+    SDL_PixelFormat *destformat = dst->format;
+    Uint8 *destpixels = (Uint8 *)dst->pixels;
+    int bpp = destformat->BytesPerPixel, count = job->count;
+    int nch = job->mode == AVERAGE_BYTES ? bpp : 3;
+    Uint32 *acc32 = (Uint32 *)malloc(sizeof(Uint32) * AVERAGE_SEGMENT * nch);
+    Uint16 *acc16 = (Uint16 *)calloc(AVERAGE_SEGMENT * nch, sizeof(Uint16));
+    Uint32 keep = destformat->Rmask | destformat->Gmask | destformat->Bmask;
+    Uint32 the_color;
+    Uint8 *byte_buf;
+    int x0, x, y, i, n, seg, batch;
 
-    if (!accumulate) {
-        return -1;
+    if (!acc32 || !acc16) {
+        job->failed = 1;
+        free(acc32);
+        free(acc16);
+        return;
     }
 
-    /* add up the r,g,b from all the surfaces. */
-
-    for (surf_idx = 0; surf_idx < num_surfaces; surf_idx++) {
-        surf = surfaces[surf_idx];
-
-        pixels = (Uint8 *)surf->pixels;
-        format = surf->format;
-        rmask = format->Rmask;
-        gmask = format->Gmask;
-        bmask = format->Bmask;
-        rshift = format->Rshift;
-        gshift = format->Gshift;
-        bshift = format->Bshift;
-        rloss = format->Rloss;
-        gloss = format->Gloss;
-        bloss = format->Bloss;
-
-        the_idx = accumulate;
-        /* If palette surface, we use a different code path... */
-
-        if ((format->BytesPerPixel == 1 && destformat->BytesPerPixel == 1) &&
-            (format->palette) && (destformat->palette) && (!palette_colors)) {
-            /*
-            This is useful if the surface is actually greyscale colors,
-            and not palette colors.
-            */
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++) {
-                    SURF_GET_AT(the_color, surf, x, y, pixels, format, pix);
-                    *(the_idx) += the_color;
-                    the_idx++;
+    for (y = start; y < end; ++y) {
+        for (x0 = 0; x0 < dst->w; x0 += seg) {
+            seg = dst->w - x0 < AVERAGE_SEGMENT ? dst->w - x0
+                                                : AVERAGE_SEGMENT;
+            n = seg * nch;
+            memset(acc32, 0, sizeof(Uint32) * n);
+
+            if (job->mode != AVERAGE_BYTES) {
+                for (i = 0; i < count; ++i) {
+                    for (x = 0; x < seg; ++x) {
+                        _average_add_pixel(job, job->surfaces[i], x0 + x, y,
+                                           acc32 + x * nch);
+                    }
+                }
+                for (x = 0; x < seg; ++x) {
+                    Uint32 *sum = acc32 + x * nch;
+
+                    if (job->mode == AVERAGE_INDEX) {
+                        the_color = (sum[0] + count / 2) / count;
+                    }
+                    else {
+                        the_color = SDL_MapRGB(
+                            destformat, (Uint8)((sum[0] + count / 2) / count),
+                            (Uint8)((sum[1] + count / 2) / count),
+                            (Uint8)((sum[2] + count / 2) / count));
+                    }
+                    SURF_SET_AT(the_color, dst, x0 + x, y, destpixels,
+                                destformat, byte_buf);
                 }
+                continue;
             }
-        }
-        else {
-            /* TODO: This doesn't work correctly for palette surfaces yet, when
-               the source is paletted.  Probably need to use something like
-               GET_PIXELVALS_1 from surface.h
-            */
 
-            /* for non palette surfaces, we do this... */
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++) {
-                    SURF_GET_AT(the_color, surf, x, y, pixels, format, pix);
+            for (i = 0, batch = 0; i < count; ++i) {
+                SDL_Surface *surf = job->surfaces[i];
+
+                _average_add_bytes(acc16,
+                                   (Uint8 *)surf->pixels + y * surf->pitch +
+                                       x0 * bpp,
+                                   n);
+                if (++batch == AVERAGE_BATCH) {
+                    _average_flush(acc32, acc16, n);
+                    batch = 0;
+                }
+            }
+            _average_flush(acc32, acc16, n);
 
-                    *(the_idx) += ((the_color & rmask) >> rshift) << rloss;
-                    *(the_idx + 1) += ((the_color & gmask) >> gshift) << gloss;
-                    *(the_idx + 2) += ((the_color & bmask) >> bshift) << bloss;
-                    the_idx += 3;
+            byte_buf = destpixels + y * dst->pitch + x0 * bpp;
+            for (i = 0; i < n; ++i) {
+                byte_buf[i] = (Uint8)((acc32[i] + count / 2) / count);
+            }
+            if (bpp == 4) {
+                /* set alpha opaque and clear unused bits, as SDL_MapRGB */
+                for (x = 0; x < seg; ++x) {
+                    memcpy(&the_color, byte_buf + x * 4, 4);
+                    the_color = (the_color & keep) | destformat->Amask;
+                    memcpy(byte_buf + x * 4, &the_color, 4);
                 }
             }
         }
     }
 
-    /* blit the accumulated array back to the destination surface. */
+    free(acc32);
+    free(acc16);
+}
 
-    div_inv = (float)(1.0L / (num_surfaces));
+/*
+    returns the average surface from the ones given.
 
-    the_idx = accumulate;
+    All surfaces need to be the same size.
 
-    if (num_elements == 1 && (!palette_colors)) {
-        /* this is where we are using the palette surface without using its
-        colors from the palette.
-        */
-        for (y = 0; y < height; y++) {
-            for (x = 0; x < width; x++) {
-                the_color = (*(the_idx)*div_inv + .5f);
-                SURF_SET_AT(the_color, destsurf, x, y, destpixels, destformat,
-                            byte_buf);
-                the_idx++;
-            }
-        }
-        /* TODO: will need to handle palette colors.
-         */
-    }
-    else if (num_elements == 3) {
-        for (y = 0; y < height; y++) {
-            for (x = 0; x < width; x++) {
-                the_color =
-                    SDL_MapRGB(destformat, (Uint8)(*(the_idx)*div_inv + .5f),
-                               (Uint8)(*(the_idx + 1) * div_inv + .5f),
-                               (Uint8)(*(the_idx + 2) * div_inv + .5f));
+    palette_colors - if true we average the colors in palette, otherwise we
+        average the pixel values.  This is useful if the surface is
+        actually greyscale colors, and not palette colors.
 
-                /* TODO: should it take into consideration the output
-                    shifts/masks/losses?  Or does SDL_MapRGB do that correctly?
+    Returns 1 on success and -1 if memory ran out.
+*/
+int
+average_surfaces(SDL_Surface **surfaces, int num_surfaces,
+                 SDL_Surface *destsurf, int palette_colors)
+{
+    SDL_PixelFormat *destformat = destsurf->format;
+    AverageJob job;
+    int i;
 
-                    *(the_idx) += ((the_color & rmask) >> rshift) << rloss;
-                    *(the_idx + 1) += ((the_color & gmask) >> gshift) << gloss;
-                    *(the_idx + 2) += ((the_color & bmask) >> bshift) << bloss;
-                */
+    if (!num_surfaces) {
+        return 0;
+    }
 
-                SURF_SET_AT(the_color, destsurf, x, y, destpixels, destformat,
-                            byte_buf);
+    job.surfaces = surfaces;
+    job.count = num_surfaces;
+    job.dst = destsurf;
+    job.failed = 0;
 
-                the_idx += 3;
+    if (destformat->BytesPerPixel == 1 && destformat->palette &&
+        !palette_colors) {
+        job.mode = AVERAGE_INDEX;
+    }
+    else if (destformat->BytesPerPixel >= 3 && destformat->Rloss == 0 &&
+             destformat->Gloss == 0 && destformat->Bloss == 0) {
+        job.mode = AVERAGE_BYTES;
+        for (i = 0; i < num_surfaces; ++i) {
+            SDL_PixelFormat *format = surfaces[i]->format;
+
+            if (format->BytesPerPixel != destformat->BytesPerPixel ||
+                format->Rmask != destformat->Rmask ||
+                format->Gmask != destformat->Gmask ||
+                format->Bmask != destformat->Bmask) {
+                job.mode = AVERAGE_RGB;
+                break;
             }
         }
     }
     else {
-        free(accumulate);
-        return -4;
+        job.mode = AVERAGE_RGB;
     }
 
-    free(accumulate);
-
-    return 1;
+    scale_rows(_average_rows, &job, destsurf->h,
+               destsurf->w * (num_surfaces < 64 ? num_surfaces : 64));
+    return job.failed ? -1 : 1;
 }
 
 /*
@@ -2421,7 +4214,7 @@ surf_average_surfaces(PyObject *self, PyObject *arg)
     SDL_Surface *newsurf;
     SDL_Surface **surfaces;
     int width, height;
-    int an_error;
+    int an_error, result;
     size_t size, loop, loop_up_to;
     int palette_colors = 1;
 
@@ -2504,8 +4297,10 @@ surf_average_surfaces(PyObject *self, PyObject *arg)
                     break;
                 }
             }
-            else
+            else {
                 newsurf = pgSurface_AsSurface(surfobj2);
+                pgSurface_Changed(surfobj2);
+            }
 
             /* check to see if the size is the correct size. */
             if (newsurf->w != (surf->w) || newsurf->h != (surf->h)) {
@@ -2543,12 +4338,18 @@ surf_average_surfaces(PyObject *self, PyObject *arg)
         SDL_LockSurface(newsurf);
 
         Py_BEGIN_ALLOW_THREADS;
-        average_surfaces(surfaces, size, newsurf, palette_colors);
+        result = average_surfaces(surfaces, size, newsurf, palette_colors);
         Py_END_ALLOW_THREADS;
 
         SDL_UnlockSurface(newsurf);
 
-        if (surfobj2) {
+        if (result < 0) {
+            if (!surfobj2) {
+                SDL_FreeSurface(newsurf);
+            }
+            ret = PyErr_NoMemory();
+        }
+        else if (surfobj2) {
             Py_INCREF(surfobj2);
             ret = surfobj2;
         }
@@ -2574,38 +4375,164 @@ surf_average_surfaces(PyObject *self, PyObject *arg)
     return ret;
 }
 
+/* Add up the bytes of npix 32 bit pixels at row by their place in the
+ * pixel, into sums.
+ */
+static void
+_average_sum_pixels(const Uint8 *row, int npix, Uint32 *sums)
+{
+    int i = 0, k;
+
+    sums[0] = sums[1] = sums[2] = sums[3] = 0;
+#ifdef PG_HAS_SSE2
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i total = zero;
+        Uint32 lanes[4];
+
+        while (i + 4 <= npix) {
+            __m128i acc = zero;
+            /* 128 blocks of 4 pixels add up to at most 255 * 256 per lane */
+            int stop = i + 4 * 128 < npix ? i + 4 * 128 : npix;
+
+            for (; i + 4 <= stop; i += 4) {
+                __m128i v = _mm_loadu_si128((__m128i *)(row + i * 4));
+
+                acc = _mm_add_epi16(acc, _mm_unpacklo_epi8(v, zero));
+                acc = _mm_add_epi16(acc, _mm_unpackhi_epi8(v, zero));
+            }
+            /* lanes k and k + 4 both hold byte k of a pixel */
+            total = _mm_add_epi32(total, _mm_unpacklo_epi16(acc, zero));
+            total = _mm_add_epi32(total, _mm_unpackhi_epi16(acc, zero));
+        }
+        _mm_storeu_si128((__m128i *)lanes, total);
+        for (k = 0; k < 4; ++k) {
+            sums[k] = lanes[k];
+        }
+    }
+#endif /* PG_HAS_SSE2 */
+    for (; i < npix; ++i) {
+        for (k = 0; k < 4; ++k) {
+            sums[k] += row[i * 4 + k];
+        }
+    }
+}
+
+/* Byte of a 32 bit pixel holding the 8 bit channel mask, or -1 if the
+ * channel is not a whole byte.
+ */
+static int
+_average_channel_byte(Uint32 mask)
+{
+    int k;
+
+    for (k = 0; k < 4; ++k) {
+        if (mask == (Uint32)0xFF << (k * 8)) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            return k;
+#else
+            return 3 - k;
+#endif
+        }
+    }
+    return -1;
+}
+
+/* Add up the channels of rows start to end of the rect. */
+static void
+_average_color_rows(void *data, int start, int end)
+{
+    AverageColorJob *job = (AverageColorJob *)data;
+    SDL_Surface *surf = job->surf;
+    SDL_PixelFormat *format = surf->format;
+    Uint32 masks[4], color;
+    int shifts[4], losses[4], bytes[4];
+    int row, col, k, whole = format->BytesPerPixel == 4;
+
+    masks[0] = format->Rmask;
+    masks[1] = format->Gmask;
+    masks[2] = format->Bmask;
+    masks[3] = format->Amask;
+    shifts[0] = format->Rshift;
+    shifts[1] = format->Gshift;
+    shifts[2] = format->Bshift;
+    shifts[3] = format->Ashift;
+    losses[0] = format->Rloss;
+    losses[1] = format->Gloss;
+    losses[2] = format->Bloss;
+    losses[3] = format->Aloss;
+    for (k = 0; k < 4; ++k) {
+        bytes[k] = masks[k] ? _average_channel_byte(masks[k]) : 4;
+        if (bytes[k] < 0) {
+            whole = 0;
+        }
+    }
+
+    for (row = start; row < end; ++row) {
+        Uint8 *pixels = (Uint8 *)surf->pixels + (job->y + row) * surf->pitch +
+                        job->x * format->BytesPerPixel;
+        Uint64 *sums = job->sums[row];
+
+        sums[0] = sums[1] = sums[2] = sums[3] = 0;
+        if (whole) {
+            /* a fifth, zero, sum stands in for a missing alpha */
+            Uint32 bytesums[5];
+
+            _average_sum_pixels(pixels, job->width, bytesums);
+            bytesums[4] = 0;
+            for (k = 0; k < 4; ++k) {
+                sums[k] = bytesums[bytes[k]];
+            }
+            continue;
+        }
+
+        for (col = 0; col < job->width; ++col) {
+            switch (format->BytesPerPixel) {
+                case 1:
+                    color = *pixels;
+                    break;
+                case 2:
+                    color = *(Uint16 *)pixels;
+                    break;
+                case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+                    color = (pixels[0]) + (pixels[1] << 8) +
+                            (pixels[2] << 16);
+#else
+                    color = (pixels[2]) + (pixels[1] << 8) +
+                            (pixels[0] << 16);
+#endif
+                    break;
+                default: /* case 4: */
+                    color = *(Uint32 *)pixels;
+                    break;
+            }
+            for (k = 0; k < 4; ++k) {
+                sums[k] += ((color & masks[k]) >> shifts[k]) << losses[k];
+            }
+            pixels += format->BytesPerPixel;
+        }
+    }
+}
+
 /* VS 2015 crashes when compiling this function, turning off optimisations to
  try to fix it */
 #if defined(_MSC_VER) && (_MSC_VER == 1900)
 #pragma optimize("", off)
 #endif
 
-void
+/* Find the average color of the part of the rect inside surf. Returns 0 on
+ * success and -1 if memory ran out.
+ */
+int
 average_color(SDL_Surface *surf, int x, int y, int width, int height, Uint8 *r,
               Uint8 *g, Uint8 *b, Uint8 *a)
 {
-    Uint32 color, rmask, gmask, bmask, amask;
-    Uint8 *pixels, *pix;
-    unsigned int rtot, gtot, btot, atot, size, rshift, gshift, bshift, ashift;
-    unsigned int rloss, gloss, bloss, aloss;
-    int row, col, width_and_x, height_and_y;
-
-    SDL_PixelFormat *format;
+    AverageColorJob job;
+    Uint64 totals[4] = {0, 0, 0, 0}, size;
+    int row, k;
 
-    format = surf->format;
-    rmask = format->Rmask;
-    gmask = format->Gmask;
-    bmask = format->Bmask;
-    amask = format->Amask;
-    rshift = format->Rshift;
-    gshift = format->Gshift;
-    bshift = format->Bshift;
-    ashift = format->Ashift;
-    rloss = format->Rloss;
-    gloss = format->Gloss;
-    bloss = format->Bloss;
-    aloss = format->Aloss;
-    rtot = gtot = btot = atot = 0;
+    *r = *g = *b = *a = 0;
 
     /* make sure the area specified is within the Surface */
     if ((x + width) > surf->w)
@@ -2620,77 +4547,33 @@ average_color(SDL_Surface *surf, int x, int y, int width, int height, Uint8 *r,
         height -= (-y);
         y = 0;
     }
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
 
-    size = width * height;
-    width_and_x = width + x;
-    height_and_y = height + y;
+    job.surf = surf;
+    job.x = x;
+    job.y = y;
+    job.width = width;
+    job.sums = (Uint64(*)[4])malloc(sizeof(Uint64) * 4 * height);
+    if (!job.sums) {
+        return -1;
+    }
+    scale_rows(_average_color_rows, &job, height, width);
 
-    switch (format->BytesPerPixel) {
-        case 1:
-            {
-                Uint8 color8;
-                for (row = y; row < height_and_y; row++) {
-                    pixels = (Uint8 *)surf->pixels + row * surf->pitch + x;
-                    for (col = x; col < width_and_x; col++) {
-                        color8 = *(Uint8 *)pixels;
-                        rtot += ((color8 & rmask) >> rshift) << rloss;
-                        gtot += ((color8 & gmask) >> gshift) << gloss;
-                        btot += ((color8 & bmask) >> bshift) << bloss;
-                        atot += ((color8 & amask) >> ashift) << aloss;
-                        pixels++;
-                    }
-                }
-            }
-            break;
-        case 2:
-            for (row = y; row < height_and_y; row++) {
-                pixels = (Uint8 *)surf->pixels + row * surf->pitch + x * 2;
-                for (col = x; col < width_and_x; col++) {
-                    color = (Uint32) * ((Uint16 *)pixels);
-                    rtot += ((color & rmask) >> rshift) << rloss;
-                    gtot += ((color & gmask) >> gshift) << gloss;
-                    btot += ((color & bmask) >> bshift) << bloss;
-                    atot += ((color & amask) >> ashift) << aloss;
-                    pixels += 2;
-                }
-            }
-            break;
-        case 3:
-            for (row = y; row < height_and_y; row++) {
-                pixels = (Uint8 *)surf->pixels + row * surf->pitch + x * 3;
-                for (col = x; col < width_and_x; col++) {
-                    pix = pixels;
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-                    color = (pix[0]) + (pix[1] << 8) + (pix[2] << 16);
-#else
-                    color = (pix[2]) + (pix[1] << 8) + (pix[0] << 16);
-#endif
-                    rtot += ((color & rmask) >> rshift) << rloss;
-                    gtot += ((color & gmask) >> gshift) << gloss;
-                    btot += ((color & bmask) >> bshift) << bloss;
-                    atot += ((color & amask) >> ashift) << aloss;
-                    pixels += 3;
-                }
-            }
-            break;
-        default: /* case 4: */
-            for (row = y; row < height_and_y; row++) {
-                pixels = (Uint8 *)surf->pixels + row * surf->pitch + x * 4;
-                for (col = x; col < width_and_x; col++) {
-                    color = *(Uint32 *)pixels;
-                    rtot += ((color & rmask) >> rshift) << rloss;
-                    gtot += ((color & gmask) >> gshift) << gloss;
-                    btot += ((color & bmask) >> bshift) << bloss;
-                    atot += ((color & amask) >> ashift) << aloss;
-                    pixels += 4;
-                }
-            }
-            break;
+    for (row = 0; row < height; ++row) {
+        for (k = 0; k < 4; ++k) {
+            totals[k] += job.sums[row][k];
+        }
     }
-    *r = rtot / size;
-    *g = gtot / size;
-    *b = btot / size;
-    *a = atot / size;
+    free(job.sums);
+
+    size = (Uint64)width * height;
+    *r = (Uint8)(totals[0] / size);
+    *g = (Uint8)(totals[1] / size);
+    *b = (Uint8)(totals[2] / size);
+    *a = (Uint8)(totals[3] / size);
+    return 0;
 }
 
 /* Optimisation was only disabled for one function - see above */
@@ -2705,13 +4588,12 @@ surf_average_color(PyObject *self, PyObject *arg)
     SDL_Surface *surf;
     GAME_Rect *rect, temp;
     Uint8 r, g, b, a;
-    int x, y, w, h;
+    int x, y, w, h, result;
 
     if (!PyArg_ParseTuple(arg, "O!|O", &pgSurface_Type, &surfobj, &rectobj))
         return NULL;
 
     surf = pgSurface_AsSurface(surfobj);
-    pgSurface_Lock(surfobj);
 
     if (!rectobj) {
         x = 0;
@@ -2728,19 +4610,24 @@ surf_average_color(PyObject *self, PyObject *arg)
         h = rect->h;
     }
 
+    pgSurface_LockForRead(surfobj);
     Py_BEGIN_ALLOW_THREADS;
-    average_color(surf, x, y, w, h, &r, &g, &b, &a);
+    result = average_color(surf, x, y, w, h, &r, &g, &b, &a);
     Py_END_ALLOW_THREADS;
-
     pgSurface_Unlock(surfobj);
+
+    if (result < 0)
+        return PyErr_NoMemory();
     return Py_BuildValue("(bbbb)", r, g, b, a);
 }
 
 static PyMethodDef _transform_methods[] = {
     {"scale", surf_scale, METH_VARARGS, DOC_PYGAMETRANSFORMSCALE},
-    {"rotate", surf_rotate, METH_VARARGS, DOC_PYGAMETRANSFORMROTATE},
+    {"rotate", (PyCFunction)surf_rotate, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETRANSFORMROTATE},
     {"flip", surf_flip, METH_VARARGS, DOC_PYGAMETRANSFORMFLIP},
-    {"rotozoom", surf_rotozoom, METH_VARARGS, DOC_PYGAMETRANSFORMROTOZOOM},
+    {"rotozoom", (PyCFunction)surf_rotozoom, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETRANSFORMROTOZOOM},
     {"chop", surf_chop, METH_VARARGS, DOC_PYGAMETRANSFORMCHOP},
     {"scale2x", surf_scale2x, METH_VARARGS, DOC_PYGAMETRANSFORMSCALE2X},
     {"smoothscale", surf_scalesmooth, METH_VARARGS,
@@ -2749,9 +4636,26 @@ static PyMethodDef _transform_methods[] = {
      METH_NOARGS, DOC_PYGAMETRANSFORMGETSMOOTHSCALEBACKEND},
     {"set_smoothscale_backend", (PyCFunction)surf_set_smoothscale_backend,
      METH_VARARGS | METH_KEYWORDS, DOC_PYGAMETRANSFORMSETSMOOTHSCALEBACKEND},
+    {"_get_threads", surf_get_threads, METH_NOARGS,
+     "_get_threads() -> int\n"
+     "return how many threads smoothscale, rotate, rotozoom, convolve "
+     "and the average functions may use"},
+    {"_set_threads", (PyCFunction)surf_set_threads,
+     METH_VARARGS | METH_KEYWORDS,
+     "_set_threads(count) -> None\n"
+     "let smoothscale, rotate, rotozoom, convolve and the average "
+     "functions use count threads, 0 for one per CPU"},
+    {"set_cache_size", (PyCFunction)surf_set_cache_size,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMETRANSFORMSETCACHESIZE},
+    {"get_cache_size", surf_get_cache_size, METH_NOARGS,
+     DOC_PYGAMETRANSFORMGETCACHESIZE},
+    {"clear_cache", surf_clear_cache, METH_NOARGS,
+     DOC_PYGAMETRANSFORMCLEARCACHE},
     {"threshold", (PyCFunction)surf_threshold, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMETRANSFORMTHRESHOLD},
-    {"laplacian", surf_laplacian, METH_VARARGS, DOC_PYGAMETRANSFORMTHRESHOLD},
+    {"laplacian", surf_laplacian, METH_VARARGS, DOC_PYGAMETRANSFORMLAPLACIAN},
+    {"convolve", (PyCFunction)surf_convolve, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETRANSFORMCONVOLVE},
     {"average_surfaces", surf_average_surfaces, METH_VARARGS,
      DOC_PYGAMETRANSFORMAVERAGESURFACES},
     {"average_color", surf_average_color, METH_VARARGS,
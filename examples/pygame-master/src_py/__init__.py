@@ -120,7 +120,7 @@ class MissingModule:
 from pygame.base import *
 from pygame.constants import *
 from pygame.version import *
-from pygame.rect import Rect
+from pygame.rect import Rect, RectArray
 from pygame.compat import PY_MAJOR_VERSION
 from pygame.rwobject import encode_string, encode_file_path
 import pygame.surflock
@@ -86,6 +86,7 @@ Sprites are not thread safe, so lock them yourself if using threads.
 ## specific ones that aren't quite so general but fit into common
 ## specialized cases.
 
+import sys
 import pygame
 from pygame import Rect
 from pygame.time import get_ticks
@@ -102,6 +103,16 @@ try:
 except:
     pass
 
+# The collide functions fall back to testing every pair without the
+# native broad phase, and LayeredDirty.draw to its Python loops.
+try:
+    from pygame._spritecore import (SpriteIndex, BOUNDS_RECT, BOUNDS_MASK,
+                                    BOUNDS_CIRCLE, BOUNDS_RECT_RATIO,
+                                    draw_dirty)
+except ImportError:
+    SpriteIndex = None
+    draw_dirty = None
+
 
 class Sprite(object):
     """simple base class for visible game objects
@@ -297,6 +308,10 @@ class AbstractGroup(object):
     # dummy val to identify sprite groups, and avoid infinite recursion
     _spritegroup = True
 
+    # broad phase for the collide functions, made on first use and then
+    # kept up to date by add_internal() and remove_internal()
+    _sprite_index = None
+
     def __init__(self):
         self.spritedict = {}
         self.lostsprites = []
@@ -316,12 +331,20 @@ class AbstractGroup(object):
 
     def add_internal(self, sprite):
         self.spritedict[sprite] = 0
+        if self._sprite_index is not None:
+            self._sprite_index.add(sprite)
 
     def remove_internal(self, sprite):
         r = self.spritedict[sprite]
         if r:
             self.lostsprites.append(r)
         del self.spritedict[sprite]
+        if self._sprite_index is not None:
+            self._sprite_index.remove(sprite)
+
+    def _sprite_layers(self, sprites):
+        """the layers of sprites for the broad phase, or None for one"""
+        return None
 
     def has_internal(self, sprite):
         return sprite in self.spritedict
@@ -678,6 +701,8 @@ class LayeredUpdates(AbstractGroup):
         while mid < leng and sprites_layers[sprites[mid]] <= layer:
             mid += 1
         sprites.insert(mid, sprite)
+        if self._sprite_index is not None:
+            self._sprite_index.add(sprite, layer)
 
     def add(self, *sprites, **kwargs):
         """add a sprite or sequence of sprites to a group
@@ -741,6 +766,12 @@ class LayeredUpdates(AbstractGroup):
 
         del self.spritedict[sprite]
         del self._spritelayers[sprite]
+        if self._sprite_index is not None:
+            self._sprite_index.remove(sprite)
+
+    def _sprite_layers(self, sprites):
+        """the layers of sprites for the broad phase"""
+        return [self._spritelayers[s] for s in sprites]
 
     def sprites(self):
         """return a ordered list of sprites (first back, last top).
@@ -854,6 +885,8 @@ class LayeredUpdates(AbstractGroup):
 
         # add layer info
         sprites_layers[sprite] = new_layer
+        if self._sprite_index is not None:
+            self._sprite_index.add(sprite, new_layer)
 
     def get_layer_of_sprite(self, sprite):
         """return the layer that sprite is currently in
@@ -1054,7 +1087,11 @@ class LayeredDirty(LayeredUpdates):
         # -------
         # 0. decide whether to render with update or flip
         start_time = get_ticks()
-        if self._use_update: # dirty rects mode
+        if draw_dirty is not None:
+            # the exact union of the dirty areas, drawn with one blits()
+            _ret = draw_dirty(_surf, _sprites, _old_rect, _update, _clip,
+                              _bgd, self._use_update, init_rect)
+        elif self._use_update: # dirty rects mode
             # 1. find dirty area on screen and put the rects into _update
             # still not happy with that part
             for spr in _sprites:
@@ -1145,6 +1182,10 @@ class LayeredDirty(LayeredUpdates):
 
         # timing for switching modes
         # How may a good threshold be found? It depends on the hardware.
+        # This stays here rather than in draw_dirty: it is two get_ticks()
+        # calls per frame, and _use_update and _time_threshold can be set
+        # as keyword arguments of __init__ and by set_timing_treshold() and
+        # set_clip(), so they have to stay plain attributes anyway.
         end_time = get_ticks()
         if end_time-start_time > self._time_threshold:
             self._use_update = False
@@ -1262,6 +1303,8 @@ class GroupSingle(AbstractGroup):
             self.__sprite.remove_internal(self)
             self.remove_internal(self.__sprite)
         self.__sprite = sprite
+        if self._sprite_index is not None:
+            self._sprite_index.add(sprite)
 
     def __nonzero__(self):
         return self.__sprite is not None
@@ -1282,6 +1325,8 @@ class GroupSingle(AbstractGroup):
     def remove_internal(self, sprite):
         if sprite is self.__sprite:
             self.__sprite = None
+            if self._sprite_index is not None:
+                self._sprite_index.remove(sprite)
         if sprite in self.spritedict:
             AbstractGroup.remove_internal(self, sprite)
 
@@ -1470,9 +1515,10 @@ def collide_mask(left, right):
 
     Tests for collision between two sprites by testing if their bitmasks
     overlap. If the sprites have a "mask" attribute, that is used as the mask;
-    otherwise, a mask is created from the sprite image. Intended to be passed
-    as a collided callback function to the *collide functions. Sprites must
-    have a "rect" and an optional "mask" attribute.
+    otherwise, a mask is created from the sprite image, which
+    pygame.mask.from_surface() caches while the image is unchanged. Intended
+    to be passed as a collided callback function to the *collide functions.
+    Sprites must have a "rect" and an optional "mask" attribute.
 
     New in pygame 1.8.0
 
@@ -1489,6 +1535,54 @@ def collide_mask(left, right):
         rightmask = from_surface(right.image)
     return leftmask.overlap(rightmask, (xoffset, yoffset))
 
+def _collide_bounds(collided):
+    """broad phase bounds to use for a collided callback
+
+    Returns a (mode, ratio) tuple for the callbacks in this module, whose
+    hits always lie inside those bounds, or None for any other callback.
+
+    """
+    if SpriteIndex is None:
+        return None
+    if collided is None or collided is collide_rect:
+        return BOUNDS_RECT, 1.0
+    if collided is collide_mask:
+        return BOUNDS_MASK, 1.0
+    if collided is collide_circle:
+        return BOUNDS_CIRCLE, 1.0
+    # collide_circle_ratio stores a scaled radius on the sprites it is
+    # called for, and later calls scale it again, so skipping pairs would
+    # change the results unless the ratio is 1.
+    if collided.__class__ is collide_circle_ratio and collided.ratio == 1:
+        return BOUNDS_CIRCLE, 1.0
+    if collided.__class__ is collide_rect_ratio:
+        return BOUNDS_RECT_RATIO, collided.ratio
+    return None
+
+# Hits are listed in the order the sprites were added, within their layer,
+# which is the order of sprites() as long as dicts keep insertion order.
+# Before that the index is filled again from sprites() for every query.
+_ordered_dicts = sys.version_info >= (3, 6)
+
+def _sprite_index(group, bounds):
+    """the broad phase index of a group, refreshed for a query
+
+    The index is filled from the group's sprites on first use, after which
+    the group adds and removes sprites in it as they come and go.
+
+    """
+    index = group._sprite_index
+    if index is None or not _ordered_dicts:
+        if index is None:
+            index = SpriteIndex()
+        else:
+            index.clear()
+        sprites = group.sprites()
+        index.extend(sprites, group._sprite_layers(sprites))
+        group._sprite_index = index
+    index.refresh(*bounds)
+    return index
+
 def spritecollide(sprite, group, dokill, collided=None):
     """find Sprites in a Group that intersect another Sprite
 
@@ -1509,6 +1603,16 @@ def spritecollide(sprite, group, dokill, collided=None):
     which will be used to calculate the collision.
 
     """
+    bounds = _collide_bounds(collided)
+    if bounds is not None and isinstance(group, AbstractGroup):
+        crashed = _sprite_index(group, bounds).query(sprite)
+        if bounds[0] != BOUNDS_RECT:
+            crashed = [s for s in crashed if collided(sprite, s)]
+        if dokill:
+            for s in crashed:
+                s.kill()
+        return crashed
+
     if dokill:
 
         crashed = []
@@ -1554,6 +1658,27 @@ def groupcollide(groupa, groupb, dokilla, dokillb, collided=None):
 
     """
     crashed = {}
+    bounds = _collide_bounds(collided)
+    if (bounds is not None and isinstance(groupa, AbstractGroup) and
+            isinstance(groupb, AbstractGroup)):
+        if not groupa or not groupb:
+            return crashed
+        indexb = _sprite_index(groupb, bounds)
+        for s, c in _sprite_index(groupa, bounds).collide(indexb):
+            if dokilla or dokillb:
+                # skip the sprites killed for an earlier sprite of groupa
+                c = [b for b in c if groupb.has_internal(b)]
+            if bounds[0] != BOUNDS_RECT:
+                c = [b for b in c if collided(s, b)]
+            if c:
+                crashed[s] = c
+                if dokillb:
+                    for b in c:
+                        b.kill()
+                if dokilla:
+                    s.kill()
+        return crashed
+
     SC = spritecollide
     if dokilla:
         for s in groupa.sprites():
@@ -1588,6 +1713,16 @@ def spritecollideany(sprite, group, collided=None):
 
 
     """
+    bounds = _collide_bounds(collided)
+    # collide_circle stores a radius on every sprite it tests, and this
+    # stops at the first hit, so leave that one to the loop below.
+    if (bounds is not None and bounds[0] != BOUNDS_CIRCLE and
+            isinstance(group, AbstractGroup)):
+        for s in _sprite_index(group, bounds).query(sprite):
+            if bounds[0] == BOUNDS_RECT or collided(sprite, s):
+                return s
+        return None
+
     if collided:
         for s in group:
             if collided(sprite, s):
@@ -1,3 +1,4 @@
+import random
 import unittest
 
 import pygame
@@ -76,6 +77,121 @@ class BlitTest( unittest.TestCase ):
         self.assertEqual(s.get_at((0,0))[0], 0 )
 
 
+    def blit_backends(self):
+        """The blitter versions this machine can run, GENERIC first."""
+        backends = ['GENERIC']
+        original = pygame.surface._get_blit_backend()
+        try:
+            for backend in ('SSE2', 'AVX2'):
+                try:
+                    pygame.surface._set_blit_backend(backend)
+                except ValueError:
+                    continue
+                backends.append(backend)
+        finally:
+            pygame.surface._set_blit_backend(original)
+        return backends
+
+    def random_surface(self, flags, depth, seed):
+        rng = random.Random(seed)
+        surf = pygame.Surface((37, 9), flags, depth)
+        for y in range(surf.get_height()):
+            for x in range(surf.get_width()):
+                alpha = rng.choice((0, 255, rng.randint(0, 255)))
+                surf.set_at((x, y), (rng.randint(0, 255), rng.randint(0, 255),
+                                     rng.randint(0, 255), alpha))
+        return surf
+
+    def self_blit_results(self, make_surface, special_flags=0):
+        """Blit a surface onto itself, shifted up and left, once per
+        blitter version. Overlapping self blits always go through pygame's
+        own blitters, so this reaches the vectorized kernels.
+        """
+        results = {}
+        original = pygame.surface._get_blit_backend()
+        try:
+            for backend in self.blit_backends():
+                pygame.surface._set_blit_backend(backend)
+                surf = make_surface()
+                w, h = surf.get_size()
+                surf.blit(surf, (0, 0), (1, 1, w - 1, h - 1), special_flags)
+                results[backend] = surf.get_buffer().raw
+        finally:
+            pygame.surface._set_blit_backend(original)
+        return results
+
+    def assert_backends_agree(self, results):
+        generic = results['GENERIC']
+        for backend, result in results.items():
+            self.assertEqual(result, generic,
+                             "%s blit differs from GENERIC" % backend)
+
+    def test_blit_backend(self):
+        self.assertIn(pygame.surface._get_blit_backend(),
+                      ('GENERIC', 'SSE2', 'AVX2'))
+        self.assertRaises(ValueError, pygame.surface._set_blit_backend,
+                          'NOT_A_BACKEND')
+
+    def test_SRCALPHA_backends(self):
+        """ Pixel alpha blits give identical results on every backend.
+        """
+        results = self.self_blit_results(
+            lambda: self.random_surface(SRCALPHA, 32, 1))
+        self.assert_backends_agree(results)
+
+    def test_colorkey_backends(self):
+        """ Colorkey blits give identical results on every backend.
+        """
+        def make_surface():
+            surf = self.random_surface(0, 32, 2)
+            surf.set_colorkey(surf.get_at((3, 3)))
+            surf.set_alpha(150)
+            return surf
+
+        self.assert_backends_agree(self.self_blit_results(make_surface))
+
+    def test_blanket_alpha_backends(self):
+        """ Surface alpha blits give identical results on every backend.
+        """
+        def make_surface():
+            surf = self.random_surface(0, 32, 3)
+            surf.set_alpha(77)
+            return surf
+
+        self.assert_backends_agree(self.self_blit_results(make_surface))
+
+    def blend_blit_results(self, special_flags, seed):
+        """Blend one random SRCALPHA surface onto another, once per
+        blitter version.
+        """
+        results = {}
+        original = pygame.surface._get_blit_backend()
+        try:
+            for backend in self.blit_backends():
+                pygame.surface._set_blit_backend(backend)
+                src = self.random_surface(SRCALPHA, 32, seed)
+                dst = self.random_surface(SRCALPHA, 32, seed + 1)
+                dst.blit(src, (2, 1), None, special_flags)
+                results[backend] = dst.get_buffer().raw
+        finally:
+            pygame.surface._set_blit_backend(original)
+        return results
+
+    def test_BLEND_RGBA_backends(self):
+        """ BLEND_RGBA_* blits give identical results on every backend.
+        """
+        for seed, flags in enumerate((BLEND_RGBA_ADD, BLEND_RGBA_SUB,
+                                      BLEND_RGBA_MULT, BLEND_RGBA_MIN,
+                                      BLEND_RGBA_MAX)):
+            self.assert_backends_agree(
+                self.blend_blit_results(flags, 10 * seed))
+
+    def test_BLEND_PREMULTIPLIED_backends(self):
+        """ Premultiplied blits give identical results on every backend.
+        """
+        self.assert_backends_agree(
+            self.blend_blit_results(BLEND_PREMULTIPLIED, 4))
+
     def make_blit_list(self, num_surfs):
 
         blit_list = []
@@ -137,6 +253,36 @@ class BlitTest( unittest.TestCase ):
             print("Surface.blits generator: %s" % (t1-t0))
 
 
+    def test_blits_matches_blit(self):
+        """ A batch gives the same pixels and rects as one blit at a time,
+        including repeated sources, areas, flags and a subsurface target.
+        """
+        tiles = [self.random_surface(SRCALPHA, 32, seed) for seed in (5, 6)]
+        blit_list = []
+        for i in range(40):
+            tile = tiles[(i // 3) % 2]
+            dest = ((i * 7) % 50 - 4, (i * 5) % 20 - 3)
+            if i % 4 == 0:
+                blit_list.append((tile, dest))
+            elif i % 4 == 1:
+                blit_list.append((tile, dest, (i % 9, 1, 20, 6)))
+            else:
+                blit_list.append((tile, dest, None, (0, BLEND_RGBA_ADD,
+                                                     BLEND_MAX)[i % 3]))
+
+        def target():
+            base = self.random_surface(SRCALPHA, 32, 7)
+            base = pygame.transform.scale(base, (90, 40))
+            return base, base.subsurface((10, 5, 60, 30))
+
+        base, sub = target()
+        expected = [sub.blit(*args) for args in blit_list]
+        expected_pixels = base.get_buffer().raw
+
+        base, sub = target()
+        self.assertEqual(sub.blits(blit_list), expected)
+        self.assertEqual(base.get_buffer().raw, expected_pixels)
+
     def test_blits_not_sequence(self):
         dst = pygame.Surface((100, 10), SRCALPHA, 32)
         self.assertRaises(ValueError, dst.blits, None)
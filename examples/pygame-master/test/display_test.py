@@ -35,6 +35,35 @@ class DisplayModuleTest(unittest.TestCase):
         r3 = pygame.Rect(-10, 0, -100, -100)
         pygame.display.update(r3)
 
+    def test_update__rect_list(self):
+        """Overlapping rects are presented once, and count as saved."""
+        screen = pygame.display.set_mode((100, 100))
+        screen.fill((55, 55, 55))
+        threshold = pygame.display.get_update_threshold()
+        self.assertEqual(threshold, 0.75)
+        try:
+            pygame.display.set_update_threshold(1.0)
+            saved = pygame.display.get_saved_pixels()
+            pygame.display.update([pygame.Rect(0, 0, 20, 20),
+                                   pygame.Rect(10, 10, 20, 20), None,
+                                   pygame.Rect(-10, 95, 30, 30),
+                                   pygame.Rect(200, 200, 10, 10)])
+            self.assertEqual(pygame.display.get_saved_pixels() - saved, 100)
+
+            # covering 0.5 of the screen updates all of it
+            pygame.display.set_update_threshold(0.5)
+            saved = pygame.display.get_saved_pixels()
+            pygame.display.update([(0, 0, 100, 50), (0, 0, 100, 50)])
+            self.assertEqual(pygame.display.get_saved_pixels() - saved, 0)
+
+            self.assertRaises(ValueError,
+                              pygame.display.set_update_threshold, 1.5)
+            self.assertRaises(ValueError,
+                              pygame.display.set_update_threshold, -0.1)
+            self.assertEqual(pygame.display.get_update_threshold(), 0.5)
+        finally:
+            pygame.display.set_update_threshold(threshold)
+
     def test_Info(self):
         inf = pygame.display.Info()
         self.assertNotEqual(inf.current_h, -1)
@@ -3459,6 +3459,96 @@ class DrawPolygonTest(DrawPolygonMixin, DrawTestCase):
     the class to add any draw.polygon specific tests to.
     """
 
+    def test_polygon__many_vertices(self):
+        """Ensures extra vertices along the edges do not change the fill."""
+        surfw, surfh = 60, 50
+        expected = pygame.Surface((surfw, surfh))
+        surface = pygame.Surface((surfw, surfh))
+        left, top, right, bottom = 5, 4, 52, 45
+        square = [(left, top), (right, top), (right, bottom), (left, bottom)]
+        points = ([(x, top) for x in range(left, right)] +
+                  [(right, y) for y in range(top, bottom)] +
+                  [(x, bottom) for x in range(right, left, -1)] +
+                  [(left, y) for y in range(bottom, top, -1)])
+
+        self.draw_polygon(expected, RED, square)
+        bounds_rect = self.draw_polygon(surface, RED, points)
+
+        self.assertEqual(bounds_rect, (left, top, right - left + 1,
+                                       bottom - top + 1))
+        for pt in ((x, y) for x in range(surfw) for y in range(surfh)):
+            self.assertEqual(surface.get_at(pt), expected.get_at(pt), pt)
+
+
+class DrawAAPolygonTest(DrawTestCase):
+    """Test draw module function aapolygon."""
+
+    def test_aapolygon__args(self):
+        """Ensures draw aapolygon accepts the correct args."""
+        bounds_rect = draw.aapolygon(pygame.Surface((3, 3)), (0, 10, 0, 50),
+                                     ((0, 0), (1, 1.5), (2, 0)))
+
+        self.assertIsInstance(bounds_rect, pygame.Rect)
+
+    def test_aapolygon__invalid_points(self):
+        """Ensures draw aapolygon detects invalid points."""
+        surface = pygame.Surface((3, 3))
+
+        with self.assertRaises(ValueError):
+            draw.aapolygon(surface, RED, ((0, 0), (1, 1)))
+
+        with self.assertRaises(TypeError):
+            draw.aapolygon(surface, RED, ((0, 0), (1, 1), 2))
+
+    def test_aapolygon__pixel_aligned(self):
+        """Ensures a pixel aligned polygon covers whole pixels only."""
+        surface = pygame.Surface((20, 20))
+        surface.fill(GREEN)
+
+        bounds_rect = draw.aapolygon(surface, RED,
+                                     ((2, 3), (12, 3), (12, 13), (2, 13)))
+
+        self.assertEqual(bounds_rect, (2, 3, 10, 10))
+        for pt in ((x, y) for x in range(20) for y in range(20)):
+            if 2 <= pt[0] < 12 and 3 <= pt[1] < 13:
+                self.assertEqual(surface.get_at(pt), RED, pt)
+            else:
+                self.assertEqual(surface.get_at(pt), GREEN, pt)
+
+    def test_aapolygon__partial_coverage(self):
+        """Ensures partly covered pixels are blended."""
+        black = pygame.Color('black')
+        white = pygame.Color('white')
+        surface = pygame.Surface((20, 20))
+        surface.fill(black)
+
+        draw.aapolygon(surface, white,
+                       ((2.5, 3), (12.5, 3), (12.5, 13), (2.5, 13)))
+
+        self.assertEqual(surface.get_at((3, 5)), white)
+        self.assertEqual(surface.get_at((1, 5)), black)
+        for x in (2, 12):
+            color = surface.get_at((x, 5))
+            self.assertTrue(100 <= color.r <= 155, color)
+            self.assertEqual(color.r, color.g)
+
+    def test_aapolygon__surface_clip(self):
+        """Ensures draw aapolygon respects a surface's clip area."""
+        surface = pygame.Surface((30, 30))
+        surface.fill(GREEN)
+        clip_rect = pygame.Rect(10, 10, 8, 6)
+        surface.set_clip(clip_rect)
+
+        bounds_rect = draw.aapolygon(surface, RED,
+                                     ((-5, -5), (40, -2), (35, 40), (0, 33)))
+
+        self.assertEqual(bounds_rect, clip_rect)
+        for pt in ((x, y) for x in range(30) for y in range(30)):
+            if clip_rect.collidepoint(pt):
+                self.assertEqual(surface.get_at(pt), RED, pt)
+            else:
+                self.assertEqual(surface.get_at(pt), GREEN, pt)
+
 
 # Commented out to avoid cluttering the test output. Add back in if draw_py
 # ever fully supports drawing polygons.
@@ -4766,6 +4856,112 @@ class DrawArcTest(DrawArcMixin, DrawTestCase):
 #    """
 
 
+### Batch Testing #############################################################
+
+class DrawBatchTest(DrawTestCase):
+    """Test draw module function batch."""
+
+    def _records(self, *records):
+        import array
+        return array.array('i', [v for record in records for v in record])
+
+    def test_batch__matches_primitives(self):
+        """Ensures a batch draws and bounds what the single calls do."""
+        surfw, surfh = 60, 50
+        expected = pygame.Surface((surfw, surfh))
+        surface = pygame.Surface((surfw, surfh))
+        color = surface.map_rgb(RED)
+        other = surface.map_rgb(GREEN)
+
+        records = [(draw.BATCH_LINE, 2, 3, 40, 30, color, 3, 0),
+                   (draw.BATCH_AALINE, 50, 2, 8, 45, other, 1, 0),
+                   (draw.BATCH_CIRCLE, 30, 25, 12, 0, color, 0, 0),
+                   (draw.BATCH_CIRCLE, 55, 45, 9, 0, other, 2, 0),
+                   (draw.BATCH_RECT, 5, 30, 20, 15, other, 0, 0),
+                   (draw.BATCH_ELLIPSE, -4, 10, 30, 14, color, 3, 0)]
+        calls = [lambda: draw.line(expected, RED, (2, 3), (40, 30), 3),
+                 lambda: draw.aaline(expected, GREEN, (50, 2), (8, 45), 1),
+                 lambda: draw.circle(expected, RED, (30, 25), 12),
+                 lambda: draw.circle(expected, GREEN, (55, 45), 9, 2),
+                 lambda: draw.rect(expected, GREEN, (5, 30, 20, 15)),
+                 lambda: draw.ellipse(expected, RED, (-4, 10, 30, 14), 3)]
+
+        expected_rects = [call() for call in calls]
+        rects = draw.batch(surface, self._records(*records), rects=True)
+
+        self.assertEqual(rects, expected_rects)
+        for pt in ((x, y) for x in range(surfw) for y in range(surfh)):
+            self.assertEqual(surface.get_at(pt), expected.get_at(pt), pt)
+
+    def test_batch__rect_outline(self):
+        """Ensures a batch rect outline matches draw.rect."""
+        expected = pygame.Surface((20, 20))
+        surface = pygame.Surface((20, 20))
+        record = (draw.BATCH_RECT, 3, 4, 12, 9, surface.map_rgb(RED), 2, 0)
+
+        draw.rect(expected, RED, (3, 4, 12, 9), 2)
+        draw.batch(surface, self._records(record))
+
+        for pt in ((x, y) for x in range(20) for y in range(20)):
+            self.assertEqual(surface.get_at(pt), expected.get_at(pt), pt)
+
+    def test_batch__union_rect(self):
+        """Ensures a batch returns the union of the changed areas."""
+        surface = pygame.Surface((100, 100))
+        color = surface.map_rgb(RED)
+        records = self._records((draw.BATCH_RECT, 10, 20, 5, 5, color, 0, 0),
+                                (draw.BATCH_LINE, 0, 0, 0, 0, color, 0, 0),
+                                (draw.BATCH_RECT, 50, 8, 4, 30, color, 0, 0))
+
+        bounds_rect = draw.batch(surface, records)
+
+        self.assertEqual(bounds_rect, (10, 8, 44, 30))
+        self.assertEqual(draw.batch(surface, self._records()), (0, 0, 0, 0))
+        self.assertEqual(draw.batch(surface, bytearray(), rects=True), [])
+
+    def test_batch__surface_clip(self):
+        """Ensures a batch respects a surface's clip area."""
+        surface = pygame.Surface((30, 30))
+        surface.fill(GREEN)
+        clip_rect = pygame.Rect(10, 10, 8, 6)
+        surface.set_clip(clip_rect)
+        record = (draw.BATCH_RECT, 0, 0, 30, 30, surface.map_rgb(RED), 0, 0)
+
+        bounds_rect = draw.batch(surface, self._records(record))
+
+        self.assertEqual(bounds_rect, clip_rect)
+        for pt in ((x, y) for x in range(30) for y in range(30)):
+            if clip_rect.collidepoint(pt):
+                self.assertEqual(surface.get_at(pt), RED, pt)
+            else:
+                self.assertEqual(surface.get_at(pt), GREEN, pt)
+
+    def test_batch__invalid_records(self):
+        """Ensures a batch checks its records before drawing any."""
+        surface = pygame.Surface((10, 10))
+        color = surface.map_rgb(RED)
+        good = (draw.BATCH_RECT, 0, 0, 10, 10, color, 0, 0)
+
+        with self.assertRaises(ValueError):
+            draw.batch(surface, bytearray(31))
+
+        with self.assertRaises(ValueError):
+            draw.batch(surface, self._records(good, (99, 0, 0, 1, 1, 0, 0, 0)))
+
+        with self.assertRaises(ValueError):
+            draw.batch(surface, self._records(
+                good, (draw.BATCH_CIRCLE, 5, 5, -1, 0, color, 0, 0)))
+
+        with self.assertRaises(ValueError):
+            draw.batch(surface, self._records(
+                good, (draw.BATCH_ELLIPSE, 0, 0, 4, 4, color, 3, 0)))
+
+        with self.assertRaises(TypeError):
+            draw.batch(surface, [good])
+
+        self.assertEqual(surface.get_at((5, 5)), (0, 0, 0, 255))
+
+
 ### Draw Module Testing #######################################################
 
 class DrawModuleTest(unittest.TestCase):
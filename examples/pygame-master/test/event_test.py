@@ -1,3 +1,4 @@
+import array
 import os
 import unittest
 
@@ -189,6 +190,57 @@ class EventModuleTest(unittest.TestCase):
         self.assertEqual(len(queue), event_cnt)
         self.assertTrue(all(e.type == pygame.USEREVENT for e in queue))
 
+    def test_get_into(self):
+        """Ensure get_into() writes records and stops before events with
+        attributes."""
+        pygame.event.clear()
+        buf = array.array('i', [-1] * 10 * 4)
+        self.assertEqual(pygame.event.get_into(buf), 0)
+
+        for _ in range(3):
+            pygame.event.post(pygame.event.Event(pygame.USEREVENT))
+        pygame.event.post(pygame.event.Event(pygame.USEREVENT, attr1=1))
+        pygame.event.post(pygame.event.Event(pygame.KEYDOWN))
+
+        self.assertEqual(pygame.event.get_into(buf, pump=False), 3)
+        for i in range(3):
+            record = buf[i * 10:i * 10 + 10]
+            self.assertEqual(record[0], pygame.USEREVENT)
+            self.assertEqual(record[2:], array.array('i', [0] * 8))
+        self.assertEqual(buf[30:], array.array('i', [-1] * 10))
+
+        # the event with attributes is left for get(), in order
+        self.assertEqual(pygame.event.get_into(buf), 0)
+        queue = pygame.event.get()
+        self.assertEqual([e.type for e in queue],
+                         [pygame.USEREVENT, pygame.KEYDOWN])
+        self.assertEqual(queue[0].attr1, 1)
+
+        # a buffer too small for one record takes nothing
+        pygame.event.post(pygame.event.Event(pygame.QUIT))
+        self.assertEqual(pygame.event.get_into(bytearray(39)), 0)
+        small = bytearray(40)
+        self.assertEqual(pygame.event.get_into(small), 1)
+        self.assertEqual(array.array('i', bytes(small))[0], pygame.QUIT)
+
+        self.assertRaises((TypeError, BufferError), pygame.event.get_into,
+                          b"\0" * 40)
+
+    def test_get_into__window_events(self):
+        """Ensure get_into() takes the events a new window sends, leaving
+        only text and dropped files for get()."""
+        pygame.display.set_mode((10, 10))
+        pygame.event.pump()
+        buf = array.array('i', [-1] * 10 * 64)
+        count = pygame.event.get_into(buf)
+
+        self.assertLess(count, 64)
+        self.assertNotIn(-1, buf[0:count * 10:10])
+        texts = (pygame.TEXTINPUT, pygame.TEXTEDITING, pygame.DROPFILE,
+                 pygame.DROPTEXT)
+        self.assertEqual([e.type for e in pygame.event.get()
+                          if e.type not in texts], [])
+
     def test_get_type(self):
         ev = pygame.event.Event(pygame.USEREVENT)
         pygame.event.post(ev)
@@ -1263,8 +1263,12 @@ class FreeTypeFontTest(unittest.TestCase):
         count += 2 * mglen
         access += 2 * mglen
         miss += 2 * mglen
-        f.get_metrics(many_glyphs, size=8)
-        f.get_metrics(many_glyphs, size=10)
+        ft.set_cache_limit(1)
+        try:
+            f.get_metrics(many_glyphs, size=8)
+            f.get_metrics(many_glyphs, size=10)
+        finally:
+            ft.set_cache_limit(0)
         ccount, cdelete_count, caccess, chit, cmiss = f._debug_cache_stats
         self.assertTrue(ccount < count)
         self.assertEqual((ccount + cdelete_count, caccess, chit, cmiss),
@@ -1549,6 +1553,110 @@ class FreeTypeTest(unittest.TestCase):
         ft.init(cache_size=new_cache_size)
         self.assertEqual(ft.get_cache_size(), new_cache_size)
 
+    def test_cache_stats(self):
+        path = os.path.join(FONTDIR, 'test_sans.ttf')
+        text = 'abcdefg'
+        stats = ft.get_cache_stats()
+        self.assertEqual(stats['limit'], 8 * 1024 * 1024)
+        self.assertEqual((stats['hits'], stats['misses'], stats['bytes'],
+                          stats['glyphs'], stats['faces']), (0, 0, 0, 0, 0))
+
+        # Fonts on the same file share their glyphs.
+        font1 = ft.Font(path, 24)
+        font2 = ft.Font(path, 24)
+        font1.render_raw(text)
+        stats = ft.get_cache_stats()
+        self.assertEqual(stats['misses'], len(text))
+        self.assertEqual(stats['glyphs'], len(text))
+        self.assertEqual(stats['faces'], 1)
+        self.assertGreater(stats['bytes'], 0)
+        font2.render_raw(text)
+        stats = ft.get_cache_stats()
+        self.assertEqual(stats['hits'], len(text))
+        self.assertEqual(stats['misses'], len(text))
+
+        # A smaller budget evicts the least recently used glyphs first.
+        font1.render_raw('xyz', size=48)
+        full = ft.get_cache_stats()['bytes']
+        try:
+            ft.set_cache_limit(full - 1)
+            stats = ft.get_cache_stats()
+            self.assertEqual(stats['limit'], full - 1)
+            self.assertEqual(stats['evictions'], 1)
+            self.assertEqual(stats['glyphs'], len(text) + 2)
+            hits = stats['hits']
+            font2.render_raw('xyz', size=48)
+            self.assertEqual(ft.get_cache_stats()['hits'], hits + 3)
+            ft.set_cache_limit(1)
+            stats = ft.get_cache_stats()
+            self.assertEqual((stats['bytes'], stats['glyphs']), (0, 0))
+        finally:
+            ft.set_cache_limit(0)
+        self.assertEqual(ft.get_cache_stats()['limit'], 8 * 1024 * 1024)
+        self.assertRaises(ValueError, ft.set_cache_limit, -1)
+
+        del font1, font2
+        self.assertEqual(ft.get_cache_stats()['faces'], 0)
+
+    def test_cache_eviction__other_font(self):
+        # Evicting glyphs another font's last layout uses reloads them.
+        path = os.path.join(FONTDIR, 'test_sans.ttf')
+        font1 = ft.Font(path, 24)
+        font2 = ft.Font(path, 24)
+        surf, rect = font1.render('abc', (0, 0, 0), (255, 255, 255))
+        expected = pygame.image.tostring(surf, 'RGB'), rect
+        try:
+            ft.set_cache_limit(1)
+            font2.render_raw('abcxyz', size=36)
+            surf, rect = font1.render(None, (0, 0, 0), (255, 255, 255))
+            self.assertEqual((pygame.image.tostring(surf, 'RGB'), rect),
+                             expected)
+            self.assertEqual(font1.get_rect(None).size, expected[1].size)
+        finally:
+            ft.set_cache_limit(0)
+
+    def test_layout_cache(self):
+        font = ft.Font(os.path.join(FONTDIR, 'test_sans.ttf'), 24)
+        self.assertEqual(font.layout_cache_size, 8)
+
+        def render(text, **kwds):
+            before = ft.get_cache_stats()
+            surf, rect = font.render(text, (0, 0, 0), (255, 255, 255), **kwds)
+            after = ft.get_cache_stats()
+            hit = after['layout_hits'] - before['layout_hits']
+            miss = after['layout_misses'] - before['layout_misses']
+            self.assertEqual(hit + miss, int(text is not None))
+            return pygame.image.tostring(surf, 'RGB'), rect, hit
+
+        first = render('Score: 100')
+        self.assertFalse(first[2])
+        again = render('Score: 100')
+        self.assertTrue(again[2])
+        self.assertEqual(again[:2], first[:2])
+
+        # Other text, sizes and layout affecting styles miss.
+        self.assertFalse(render('Score: 101')[2])
+        self.assertFalse(render('Score: 100', size=30)[2])
+        self.assertFalse(render('Score: 100', style=ft.STYLE_STRONG)[2])
+        self.assertFalse(render('Score: 100', rotation=90)[2])
+        # The underline is drawn apart from the layout.
+        underlined = render('Score: 100', style=ft.STYLE_UNDERLINE)
+        self.assertTrue(underlined[2])
+        self.assertNotEqual(underlined[0], first[0])
+
+        # text=None lays out the last text again, hit or miss.
+        self.assertEqual(render(None)[:2], first[:2])
+        other = render('Lives: 3')
+        self.assertEqual(render(None)[:2], other[:2])
+        self.assertTrue(render('Score: 100')[2])
+        self.assertEqual(render(None)[:2], first[:2])
+
+        font.layout_cache_size = 0
+        self.assertEqual(font.layout_cache_size, 0)
+        self.assertFalse(render('Score: 100')[2])
+        self.assertEqual(render('Score: 100')[:2], first[:2])
+        self.assertRaises(ValueError, setattr, font, 'layout_cache_size', -1)
+
 
 if __name__ == '__main__':
     unittest.main()
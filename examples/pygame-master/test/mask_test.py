@@ -905,6 +905,56 @@ class MaskTypeTest(unittest.TestCase):
         with self.assertRaises(TypeError):
             overlap_mask = mask1.overlap_mask(mask2, offset)
 
+    def test_overlap_backends(self):
+        """Ensure every overlap backend gives the same results."""
+        original = pygame.mask._get_overlap_backend()
+        backends = []
+        for backend in ('GENERIC', 'SSE2', 'AVX2'):
+            try:
+                pygame.mask._set_overlap_backend(backend)
+            except ValueError:
+                continue
+            backends.append(backend)
+        self.assertRaises(ValueError, pygame.mask._set_overlap_backend,
+                          'NOT_A_BACKEND')
+
+        rng = random.Random(5)
+        cases = []
+        for size1, size2 in (((33, 20), (70, 41)), ((150, 9), (65, 64)),
+                             ((130, 70), (130, 70))):
+            mask1 = pygame.mask.Mask(size1)
+            mask2 = pygame.mask.Mask(size2)
+            for mask in (mask1, mask2):
+                w, h = mask.get_size()
+                for _ in range(w * h // 5):
+                    mask.set_at((rng.randrange(w), rng.randrange(h)))
+            for _ in range(30):
+                offset = (rng.randint(-size2[0], size1[0]),
+                          rng.randint(-size2[1], size1[1]))
+                cases.append((mask1, mask2, offset))
+            cases.append((mask1, mask2, (64, 3)))
+            cases.append((mask1, mask2, (-64, -3)))
+
+        def results():
+            found = []
+            for mask1, mask2, offset in cases:
+                overlap_mask = mask1.overlap_mask(mask2, offset)
+                found.append((mask1.overlap(mask2, offset),
+                              mask1.overlap_area(mask2, offset),
+                              overlap_mask.count(),
+                              overlap_mask.outline()))
+            return found
+
+        try:
+            pygame.mask._set_overlap_backend('GENERIC')
+            expected = results()
+            for backend in backends:
+                pygame.mask._set_overlap_backend(backend)
+                self.assertEqual(results(), expected,
+                                 "%s differs from GENERIC" % backend)
+        finally:
+            pygame.mask._set_overlap_backend(original)
+
     def test_mask_access( self ):
         """ do the set_at, and get_at parts work correctly?
         """
@@ -1509,6 +1559,38 @@ class MaskTypeTest(unittest.TestCase):
         self.assertIsInstance(o, pygame.mask.Mask)
         assertMaskEqual(self, o, test)
 
+    def test_convolve__kernel_shapes(self):
+        """Ensures convolving with solid, round and sparse kernels matches
+        drawing the mask once for every set bit of the kernel.
+        """
+        random.seed(5)
+        mask = random_mask((128, 20))
+        mask.draw(pygame.Mask((70, 3), fill=True), (40, 8))
+
+        disc = pygame.Mask((13, 13))
+        for x in range(13):
+            for y in range(13):
+                if (x - 6) ** 2 + (y - 6) ** 2 <= 36:
+                    disc.set_at((x, y))
+        kernels = (pygame.Mask((9, 7), fill=True), disc,
+                   random_mask((70, 5)), pygame.Mask((1, 1), fill=True))
+
+        for kernel in kernels:
+            kw, kh = kernel.get_size()
+            for offset in ((0, 0), (-9, 4), (30, -2)):
+                output = pygame.Mask((128 + kw - 1, 20 + kh - 1))
+                output.set_at((0, 0))
+                expected = output.copy()
+                for x in range(kw):
+                    for y in range(kh):
+                        if kernel.get_at((x, y)):
+                            expected.draw(mask, (offset[0] + kw - 1 - x,
+                                                 offset[1] + kh - 1 - y))
+
+                mask.convolve(kernel, output, offset)
+
+                assertMaskEqual(self, output, expected)
+
     def test_convolve__out_of_range(self):
         full = pygame.Mask((2, 2), fill=True)
         # Tuple of points (out of range) and the expected count for each.
@@ -1915,6 +1997,56 @@ class MaskTypeTest(unittest.TestCase):
             self.assertListEqual(sorted(mask.get_bounding_rects(), key=tuple),
                                  expected_rects, 'size={}'.format(size))
 
+    def test_connected_component__largest_after_merges(self):
+        """Ensures the largest component is found when several provisional
+        labels of it are merged late in the scan.
+        """
+        rows = ('1001001001101011000',
+                '1111001101111001010',
+                '1111010001000101111',
+                '1111100101111101100',
+                '1100100010100110000',
+                '1100001000011110100',
+                '1110010000000000011',
+                '1011010011000100000')
+        mask = pygame.mask.Mask((len(rows[0]), len(rows)))
+        for y, row in enumerate(rows):
+            for x, bit in enumerate(row):
+                if bit == '1':
+                    mask.set_at((x, y))
+
+        largest = max(m.count() for m in mask.connected_components())
+
+        self.assertEqual(largest, 33)
+        self.assertEqual(mask.connected_component().count(), largest)
+
+    def test_get_component_stats(self):
+        """Ensures get_component_stats matches the component masks."""
+        random.seed(11)
+        for size in ((0, 0), (1, 40), (70, 1), (65, 33), (200, 30)):
+            mask = random_mask(size)
+            # Long runs that cross word boundaries.
+            if size[0] > 64:
+                mask.draw(pygame.mask.Mask((size[0] - 3, 1), fill=True),
+                          (2, size[1] // 2))
+
+            for minimum in (0, 3):
+                components = mask.connected_components(minimum)
+                stats = mask.get_component_stats(minimum)
+
+                self.assertEqual(len(stats), len(components))
+                for (area, rect, centroid), component in zip(stats,
+                                                             components):
+                    self.assertEqual(area, component.count())
+                    self.assertEqual(rect, component.get_bounding_rects()[0])
+                    self.assertEqual(centroid, component.centroid())
+
+            rects = mask.get_bounding_rects()
+            self.assertListEqual([rect for _, rect, _ in
+                                  mask.get_component_stats()], rects)
+
+        self.assertRaises(TypeError, mask.get_component_stats, 'x')
+
     def test_to_surface(self):
         """Ensures empty and full masks can be drawn onto surfaces."""
         expected_ref_count = 3
@@ -3161,6 +3293,152 @@ class MaskModuleTest(unittest.TestCase):
             self.assertEqual(mask.count(), 100)
             self.assertEqual(mask.get_bounding_rects(), [pygame.Rect((40,40,10,10))])
 
+    def test_from_surface__32bit_backends_and_threads(self):
+        """Ensures the word at a time 32 bit paths of from_surface and
+        from_threshold match a pixel by pixel check, for every overlap
+        backend and with several threads.
+        """
+        size = (300, 240)  # big enough to be cut into bands
+        levels = (0, 60, 100, 127, 128, 200, 255)
+        rng = random.Random(13)
+        alpha_surf = pygame.Surface(size, SRCALPHA, 32)
+        key_surf = pygame.Surface(size, 0, 32)
+        other_surf = pygame.Surface(size, 0, 32)
+        colors = {}
+        for y in range(size[1]):
+            for x in range(size[0]):
+                color = tuple(rng.choice(levels) for _ in range(4))
+                colors[x, y] = color
+                alpha_surf.set_at((x, y), color)
+                key_surf.set_at((x, y), color[:3])
+                other_surf.set_at((x, y), color[1:])
+        key = colors[0, 0][:3]
+        key_surf.set_colorkey(key)
+
+        def expected_mask(test):
+            mask = pygame.mask.Mask(size)
+            for pos, color in colors.items():
+                if test(color):
+                    mask.set_at(pos)
+            return mask
+
+        def near(color1, color2, threshold):
+            return all(abs(c1 - c2) < t
+                       for c1, c2, t in zip(color1, color2, threshold))
+
+        cases = (
+            (lambda: pygame.mask.from_surface(alpha_surf, 127),
+             expected_mask(lambda c: c[3] > 127)),
+            (lambda: pygame.mask.from_surface(alpha_surf, 0),
+             expected_mask(lambda c: c[3] > 0)),
+            (lambda: pygame.mask.from_surface(key_surf),
+             expected_mask(lambda c: c[:3] != key)),
+            (lambda: pygame.mask.from_threshold(
+                key_surf, (100, 60, 200), (30, 50, 1, 255)),
+             expected_mask(lambda c: near(c, (100, 60, 200), (30, 50, 1)))),
+            (lambda: pygame.mask.from_threshold(
+                key_surf, (0, 0, 0), (41, 41, 41, 255), other_surf),
+             expected_mask(lambda c: near(c[:3], c[1:], (41, 41, 41)))),
+        )
+
+        original_backend = pygame.mask._get_overlap_backend()
+        original_threads = pygame.mask._get_threads()
+        original_cache_size = pygame.mask.get_cache_size()
+        try:
+            # The surfaces do not change, so cached masks would stand in
+            # for every pass after the first.
+            pygame.mask.set_cache_size(0)
+            for backend in ('GENERIC', 'SSE2', 'AVX2'):
+                try:
+                    pygame.mask._set_overlap_backend(backend)
+                except ValueError:
+                    continue
+                for threads in (1, 3):
+                    pygame.mask._set_threads(threads)
+                    self.assertEqual(pygame.mask._get_threads(), threads)
+                    for i, (make_mask, expected) in enumerate(cases):
+                        mask = make_mask()
+                        msg = "case %d, %s, %d threads" % (i, backend,
+                                                            threads)
+                        self.assertEqual(mask.count(), expected.count(), msg)
+                        self.assertEqual(mask.overlap_area(expected, (0, 0)),
+                                         expected.count(), msg)
+        finally:
+            pygame.mask._set_overlap_backend(original_backend)
+            pygame.mask._set_threads(original_threads)
+            pygame.mask.set_cache_size(original_cache_size)
+
+        self.assertRaises(ValueError, pygame.mask._set_threads, -1)
+
+    def test_from_surface__cache(self):
+        """Ensures from_surface hands out cached masks only while the
+        surface is unchanged.
+        """
+        original_size = pygame.mask.get_cache_size()
+        size = (40, 30)
+        surface = pygame.Surface(size, SRCALPHA, 32)
+        surface.fill((255, 0, 0, 255), (5, 5, 10, 10))
+        subsurface = surface.subsurface((0, 0, 20, 20))
+
+        def check(surf, expected_count):
+            mask = pygame.mask.from_surface(surf)
+            self.assertEqual(mask.count(), expected_count)
+            return mask
+
+        try:
+            pygame.mask.set_cache_size(8)
+            self.assertEqual(pygame.mask.get_cache_size(), 8)
+
+            # Masks handed out are copies.
+            check(surface, 100).clear()
+            check(surface, 100)
+            check(subsurface, 100)
+
+            surface.fill((0, 0, 0, 255), (0, 0, 1, 1))
+            check(surface, 101)
+            check(subsurface, 101)
+
+            surface.set_at((39, 29), (0, 0, 0, 255))
+            check(surface, 102)
+
+            subsurface.fill((0, 0, 0, 0))
+            check(surface, 1)
+            check(subsurface, 0)
+
+            pygame.draw.rect(surface, (1, 2, 3, 255), (30, 20, 2, 2))
+            check(surface, 5)
+
+            pixels = pygame.PixelArray(surface)
+            check(surface, 5)
+            pixels[20, 0] = (1, 2, 3, 255)
+            check(surface, 6)
+            del pixels
+            check(surface, 6)
+
+            surface.blit(pygame.Surface((3, 3)), (35, 0))
+            check(surface, 15)
+
+            keyed = pygame.Surface(size)
+            keyed.set_colorkey((0, 0, 0))
+            check(keyed, 0)
+            keyed.set_colorkey((1, 1, 1))
+            check(keyed, size[0] * size[1])
+
+            # The pixels of a frombuffer() image change behind its back.
+            data = bytearray(4 * 4 * 4)
+            shared = pygame.image.frombuffer(data, (4, 4), 'RGBA')
+            check(shared, 0)
+            data[3] = 255
+            check(shared, 1)
+
+            pygame.mask.clear_cache()
+            check(surface, 15)
+            pygame.mask.set_cache_size(0)
+            check(surface, 15)
+            self.assertRaises(ValueError, pygame.mask.set_cache_size, -1)
+        finally:
+            pygame.mask.set_cache_size(original_size)
+
     def test_zero_size_from_surface(self):
         """Ensures from_surface can create masks from zero sized surfaces."""
         for size in ((100, 0), (0, 100), (0, 0)):
@@ -1,5 +1,9 @@
+import random
+import sys
 import unittest
-from pygame import Rect
+
+import pygame
+from pygame import Rect, RectArray
 
 class RectTypeTest(unittest.TestCase):
     def testConstructionXYWidthHeight(self):
@@ -718,6 +722,70 @@ class RectTypeTest(unittest.TestCase):
         self.assertEqual(r, [14, 13, 12, 11])
 
 
+class RectArrayTypeTest(unittest.TestCase):
+    BACKENDS = ('GENERIC', 'SSE2', 'AVX2')
+
+    def test_sequence(self):
+        a = RectArray([(1, 2, 3, 4), Rect(5, 6, 7, 8)])
+        a.append(((9, 10), (11, 12)))
+        self.assertEqual(len(a), 3)
+        self.assertEqual(list(a), [Rect(1, 2, 3, 4), Rect(5, 6, 7, 8),
+                                   Rect(9, 10, 11, 12)])
+        a[1] = (0, 0, 1, 1)
+        self.assertEqual(a[1], Rect(0, 0, 1, 1))
+        self.assertEqual(a[-1], Rect(9, 10, 11, 12))
+        self.assertEqual(len(RectArray()), 0)
+        self.assertRaises(IndexError, lambda: a[3])
+        self.assertRaises(TypeError, RectArray, [(1, 2)])
+        self.assertRaises(TypeError, a.append, "rect")
+
+    @unittest.skipIf(sys.version_info < (3,), "buffer protocol needs py3")
+    def test_buffer(self):
+        a = RectArray([(1, 2, 3, 4), (5, 6, 7, 8)])
+        view = memoryview(a)
+        self.assertEqual(view.shape, (4, 2))
+        self.assertEqual(view.format, 'i')
+        self.assertEqual(view.tolist(), [[1, 5], [2, 6], [3, 7], [4, 8]])
+        view[0, 1] = 50
+        self.assertEqual(a[1], Rect(50, 6, 7, 8))
+        self.assertRaises(BufferError, a.append, (0, 0, 1, 1))
+        view.release()
+        a.append((0, 0, 1, 1))
+        self.assertEqual(len(a), 3)
+
+    def test_collide_backends(self):
+        """Every backend must find the same hits as Rect."""
+        original = pygame.rect._get_rectarray_backend()
+        rand = random.Random(73)
+        try:
+            for n in (0, 1, 7, 8, 9, 33):
+                rects = [Rect(rand.randint(-20, 20), rand.randint(-20, 20),
+                              rand.randint(-3, 15), rand.randint(-3, 15))
+                         for _ in range(n)]
+                a = RectArray(rects)
+                for _ in range(20):
+                    r = Rect(rand.randint(-20, 20), rand.randint(-20, 20),
+                             rand.randint(-3, 25), rand.randint(-3, 25))
+                    point = rand.randint(-20, 20), rand.randint(-20, 20)
+                    by_rect = [i for i, s in enumerate(rects)
+                               if r.colliderect(s)]
+                    by_point = [i for i, s in enumerate(rects)
+                                if s.collidepoint(point)]
+                    for backend in self.BACKENDS:
+                        try:
+                            pygame.rect._set_rectarray_backend(backend)
+                        except ValueError:
+                            continue
+                        self.assertEqual(list(a.colliderect(r)), by_rect)
+                        self.assertEqual(list(a.collidepoint(point)),
+                                         by_point)
+                        self.assertEqual(r.collidelistall(a), by_rect)
+                        self.assertEqual(r.collidelist(a),
+                                         by_rect[0] if by_rect else -1)
+        finally:
+            pygame.rect._set_rectarray_backend(original)
+
+
 class SubclassTest(unittest.TestCase):
     class MyRect(Rect):
         def __init__(self, *args, **kwds):
@@ -2,6 +2,7 @@
 # -*- encoding: utf-8 -*-
 
 
+import random
 import unittest
 
 import pygame
@@ -427,6 +428,116 @@ class SpriteCollideTest( unittest.TestCase ):
         self.assertFalse(pygame.sprite.collide_rect(self.s1, self.s3))
         self.assertFalse(pygame.sprite.collide_rect(self.s3, self.s1))
 
+    def _random_collide_groups(self, seed):
+        rand = random.Random(seed)
+        groups = (sprite.Group(), sprite.LayeredUpdates())
+        for i in range(40):
+            spr = sprite.Sprite()
+            spr.number = i
+            size = rand.randint(1, 30), rand.randint(1, 30)
+            spr.image = pygame.Surface(size, pygame.SRCALPHA, 32)
+            pygame.draw.circle(spr.image, (255, 255, 255, 255),
+                               (size[0] // 2, size[1] // 2),
+                               min(size) // 2)
+            spr.rect = spr.image.get_rect(topleft=(rand.randint(0, 150),
+                                                   rand.randint(0, 150)))
+            if i % 3 == 0:
+                spr.mask = pygame.mask.from_surface(spr.image)
+            if i % 4 == 0:
+                spr.radius = rand.randint(0, 20)
+            groups[i % 2].add(spr)
+            if i % 5 == 0:
+                groups[1 - i % 2].add(spr)
+        return groups
+
+    def _collide_results(self, collided, seed):
+        """Sprite numbers found by the collide functions, in order."""
+        def numbers(sprites):
+            return [spr.number for spr in sprites]
+
+        def dict_numbers(crashed):
+            return [(spr.number, numbers(crashed[spr])) for spr in crashed]
+
+        groupa, groupb = self._random_collide_groups(seed)
+        results = []
+        for spr in groupa:
+            results.append(numbers(
+                sprite.spritecollide(spr, groupb, False, collided)))
+            hit = sprite.spritecollideany(spr, groupb, collided)
+            results.append(hit and hit.number)
+
+        # the index must follow sprites that move, come, go and change layer
+        rand = random.Random(seed)
+        for spr in groupb.sprites()[::3]:
+            spr.rect.move_ip(rand.randint(-20, 20), rand.randint(-20, 20))
+        groupb.remove(groupb.sprites()[1::4])
+        groupb.add(groupa.sprites()[::4], layer=1)
+        for spr in groupb.sprites()[::5]:
+            groupb.change_layer(spr, rand.randint(-1, 1))
+        for spr in groupa:
+            results.append(numbers(
+                sprite.spritecollide(spr, groupb, False, collided)))
+        results.append(dict_numbers(
+            sprite.groupcollide(groupa, groupb, False, False, collided)))
+        results.append(dict_numbers(
+            sprite.groupcollide(groupa, groupb, False, True, collided)))
+        results.append(dict_numbers(
+            sprite.groupcollide(groupb, groupa, True, False, collided)))
+        results.append((numbers(groupa), numbers(groupb)))
+        return results
+
+    def test_collide_functions_match_without_index(self):
+        """The broad phase must find the same collisions as the loops."""
+        if sprite.SpriteIndex is None:
+            self.skipTest("no pygame._spritecore")
+        callbacks = (None, sprite.collide_rect, sprite.collide_mask,
+                     sprite.collide_circle, sprite.collide_circle_ratio(1.0),
+                     sprite.collide_rect_ratio(2), sprite.collide_rect_ratio(3))
+        index_type = sprite.SpriteIndex
+        try:
+            for seed in range(3):
+                for collided in callbacks:
+                    sprite.SpriteIndex = None
+                    expected = self._collide_results(collided, seed)
+                    sprite.SpriteIndex = index_type
+                    self.assertEqual(self._collide_results(collided, seed),
+                                     expected)
+        finally:
+            sprite.SpriteIndex = index_type
+
+    def test_collide_after_rect_changes(self):
+        """Queries see rects moved in place, replaced or behind a property."""
+        class PropertySprite(sprite.Sprite):
+            position = (0, 0)
+
+            @property
+            def rect(self):
+                return pygame.Rect(self.position, (10, 10))
+
+        mover = sprite.Sprite()
+        mover.rect = pygame.Rect(0, 0, 10, 10)
+        other = PropertySprite()
+        group = sprite.Group(mover, other)
+        probe = sprite.Sprite()
+        probe.rect = pygame.Rect(100, 100, 10, 10)
+
+        def hits():
+            return set(sprite.spritecollide(probe, group, False))
+
+        self.assertEqual(hits(), set())
+        mover.rect.topleft = (95, 95)
+        self.assertEqual(hits(), set([mover]))
+        mover.rect = pygame.Rect(0, 0, 10, 10)
+        self.assertEqual(hits(), set())
+        other.position = (105, 105)
+        self.assertEqual(hits(), set([other]))
+        mover.rect.inflate_ip(200, 200)
+        self.assertEqual(hits(), set([mover, other]))
+        mover.rect.size = (10, 10)
+        self.assertEqual(set(sprite.spritecollide(
+            probe, group, False, sprite.collide_rect_ratio(30))),
+            set([mover, other]))
+
 
 ################################################################################
 
@@ -1096,6 +1207,84 @@ class LayeredDirtyTypeTest__DirtySprite(LayeredGroupBase, unittest.TestCase):
         """
         self._nondirty_intersections_redrawn(True)
 
+    def _draw_frames(self, seed):
+        """Surface contents and update rects of a few frames of moves."""
+        rand = random.Random(seed)
+        surface = pygame.Surface((120, 90))
+        bgd = pygame.Surface((120, 90))
+        for x in range(0, 120, 8):
+            pygame.draw.line(bgd, (x * 2, 60, 255 - x * 2), (x, 0), (x, 89))
+        group = self.LG
+        group.set_timing_treshold(1000000.0)
+        sprites = []
+        for i in range(30):
+            spr = sprite.DirtySprite()
+            spr.image = pygame.Surface((rand.randint(2, 30),
+                                        rand.randint(2, 30)))
+            spr.image.fill((i * 8, 255 - i * 8, i * 3))
+            spr.rect = spr.image.get_rect(topleft=(rand.randint(-10, 110),
+                                                   rand.randint(-10, 80)))
+            if i % 5 == 0:
+                spr.source_rect = pygame.Rect(1, 1, spr.rect.w - 1,
+                                              spr.rect.h - 1)
+            group.add(spr, layer=rand.randint(0, 3))
+            sprites.append(spr)
+        sprites[7].dirty = 2
+
+        frames = []
+        for frame in range(8):
+            for spr in rand.sample(sprites, 6):
+                spr.rect.move_ip(rand.randint(-15, 15), rand.randint(-15, 15))
+                if spr.dirty < 2:
+                    spr.dirty = 1
+            if frame == 4:
+                sprites[3].visible = 0
+            rects = group.draw(surface, bgd)
+            frames.append((pygame.image.tostring(surface, 'RGB'), rects))
+        return frames
+
+    def test_draw__native_matches_python(self):
+        """The native draw must give the pixels of the Python loops, and
+        update rects that do not overlap."""
+        if sprite.draw_dirty is None:
+            self.skipTest("no pygame._spritecore")
+
+        frames = self._draw_frames(3)
+        draw_dirty = sprite.draw_dirty
+        sprite.draw_dirty = None
+        try:
+            self.LG = sprite.LayeredDirty()
+            expected = self._draw_frames(3)
+        finally:
+            sprite.draw_dirty = draw_dirty
+
+        for (pixels, rects), (expected_pixels, _) in zip(frames, expected):
+            self.assertEqual(pixels, expected_pixels)
+            for i, rect in enumerate(rects):
+                self.assertEqual(rect.collidelist(rects[i + 1:]), -1)
+
+    def test_union_rects(self):
+        if sprite.draw_dirty is None:
+            self.skipTest("no pygame._spritecore")
+        from pygame._spritecore import union_rects
+
+        rand = random.Random(5)
+        clip = pygame.Rect(5, 5, 40, 30)
+        for _ in range(20):
+            rects = [pygame.Rect(rand.randint(0, 45), rand.randint(0, 35),
+                                 rand.randint(0, 15), rand.randint(0, 15))
+                     for i in range(rand.randint(0, 8))]
+            union = union_rects(rects, clip)
+
+            for i, rect in enumerate(union):
+                self.assertEqual(rect.collidelist(union[i + 1:]), -1)
+            for y in range(40):
+                for x in range(50):
+                    inside = (clip.collidepoint(x, y) and
+                              any(r.collidepoint(x, y) for r in rects))
+                    self.assertEqual(
+                        any(r.collidepoint(x, y) for r in union), inside)
+
 
 ############################### SPRITE BASE CLASS ##############################
 #
@@ -2533,6 +2533,32 @@ class SurfaceFillTest(unittest.TestCase):
         for y in range(5, 480,  10):
             self.assertEqual(screen.get_at((10, y)), screen.get_at((330, 480 - y)))
 
+    def test_fill_threads(self):
+        """Threaded special_flags fills match single threaded ones."""
+        original = pygame.surface._get_threads()
+        self.assertRaises(ValueError, pygame.surface._set_threads, -1)
+        self.assertEqual(original, 1)
+
+        def filled(threads, flags):
+            pygame.surface._set_threads(threads)
+            surf = pygame.Surface((520, 300), SRCALPHA, 32)
+            for x in range(0, 520, 13):
+                color = (x % 256, 255 - x % 256, 77, x % 200)
+                surf.fill(color, (x, 0, 7, 300))
+            surf.set_clip((3, 5, 510, 290))
+            surf.fill((90, 20, 200, 100), (1, 2, 515, 297), flags)
+            return surf.get_buffer().raw
+
+        try:
+            for flags in (BLEND_ADD, BLEND_SUB, BLEND_MULT, BLEND_MIN,
+                          BLEND_MAX, BLEND_RGBA_ADD, BLEND_RGBA_SUB,
+                          BLEND_RGBA_MULT, BLEND_RGBA_MIN, BLEND_RGBA_MAX):
+                expected = filled(1, flags)
+                self.assertEqual(filled(4, flags), expected)
+                self.assertEqual(filled(0, flags), expected)
+        finally:
+            pygame.surface._set_threads(original)
+
 
 if __name__ == '__main__':
     unittest.main()
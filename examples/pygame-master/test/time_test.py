@@ -1,7 +1,9 @@
+import time
 import unittest
 import pygame
 
 Clock = pygame.time.Clock
+FixedStepClock = pygame.time.FixedStepClock
 
 
 class ClockTypeTest(unittest.TestCase):
@@ -11,6 +13,40 @@ class ClockTypeTest(unittest.TestCase):
 
         self.assertTrue(c, "Clock cannot be constructed")
 
+    def test_low_power(self):
+        """Ensure a low power Clock still limits the framerate of both
+        tick methods."""
+        c = Clock(low_power=True)
+
+        self.assertTrue(c, "low power Clock cannot be constructed")
+
+        for tick in (c.tick, c.tick_busy_loop):
+            tick()
+            for _ in range(3):
+                tick(100)
+                self.assertGreaterEqual(c.get_frametime(), 10.0)
+
+    def test_get_frametime__and_get_jitter(self):
+        """Ensure ticks with a framerate report fractional times and
+        frame time errors."""
+        for c in (Clock(), Clock(low_power=True)):
+            self.assertEqual(c.get_jitter(), 0.0)
+
+            c.tick()
+            for _ in range(5):
+                c.tick(200)
+                frametime = c.get_frametime()
+
+                self.assertIsInstance(frametime, float)
+                self.assertGreaterEqual(frametime, 5.0)
+                self.assertEqual(c.get_time(), int(frametime + 0.5))
+
+            self.assertGreaterEqual(c.get_jitter(0), 0.0)
+            self.assertLessEqual(c.get_jitter(0), c.get_jitter(50))
+            self.assertLessEqual(c.get_jitter(50), c.get_jitter(100))
+            self.assertRaises(ValueError, c.get_jitter, 101)
+            self.assertRaises(ValueError, c.get_jitter, -1)
+
     def todo_test_get_fps(self):
 
         # __doc__ (as of 2008-08-02) for pygame.time.Clock.get_fps:
@@ -134,6 +170,64 @@ class ClockTypeTest(unittest.TestCase):
 
         self.fail()
 
+
+class FixedStepClockTypeTest(unittest.TestCase):
+    def test_construction(self):
+        """Ensure a FixedStepClock checks its arguments"""
+        self.assertTrue(FixedStepClock(60))
+        self.assertTrue(FixedStepClock(60, max_steps=1, low_power=True))
+
+        self.assertRaises(ValueError, FixedStepClock, 0)
+        self.assertRaises(ValueError, FixedStepClock, -60)
+        self.assertRaises(ValueError, FixedStepClock, 1e-10)
+        self.assertRaises(ValueError, FixedStepClock, float('nan'))
+        self.assertRaises(ValueError, FixedStepClock, 60, max_steps=0)
+        self.assertRaises(TypeError, FixedStepClock)
+
+    def test_tick(self):
+        """Ensure ticks report the steps due and the interpolation alpha."""
+        c = FixedStepClock(100)
+
+        for _ in range(3):
+            steps, alpha = c.tick(50)
+
+            self.assertIn(steps, (1, 2, 3))
+            self.assertGreaterEqual(alpha, 0.0)
+            self.assertLess(alpha, 1.0)
+
+        counters = c.get_counters()
+
+        self.assertEqual(counters['frames'], 3)
+        self.assertGreaterEqual(counters['steps'], 4)
+        self.assertEqual(counters['dropped_steps'], 0)
+        self.assertGreater(counters['wait_time'], 0.0)
+
+    def test_tick__max_steps(self):
+        """Ensure a long frame runs at most max_steps steps."""
+        c = FixedStepClock(1000, max_steps=3)
+        c.tick()
+        time.sleep(0.05)
+        steps, alpha = c.tick()
+
+        self.assertEqual(steps, 3)
+        self.assertLess(alpha, 1.0)
+        self.assertGreater(c.get_counters()['dropped_steps'], 30)
+
+    def test_mark_render(self):
+        """Ensure marked frames split their work into update and render."""
+        c = FixedStepClock(60)
+        c.tick()
+        time.sleep(0.01)
+        c.mark_render()
+        time.sleep(0.01)
+        c.tick()
+        counters = c.get_counters()
+
+        self.assertGreaterEqual(counters['update_time'], 9.0)
+        self.assertGreaterEqual(counters['render_time'], 9.0)
+        self.assertEqual(counters['wait_time'], 0.0)
+
+
 class TimeModuleTest(unittest.TestCase):
     def todo_test_delay(self):
 
@@ -1,5 +1,6 @@
 import unittest
 import platform
+import math
 
 from pygame.tests import test_utils
 import pygame
@@ -75,6 +76,36 @@ def threshold(return_surf, surf, color, threshold = (0,0,0), diff_color = (0,0,0
     return similar
 
 
+def banded_surface(depth=32):
+    """A 301x283 patchwork of 7x5 blocks, big enough to be cut into bands.
+    """
+    surf = pygame.Surface((301, 283), 0, 32)
+    for x in range(0, 301, 7):
+        for y in range(0, 283, 5):
+            surf.fill(((x * 3) % 256, (y * 5) % 256, (x * y) % 256),
+                      (x, y, 7, 5))
+    if depth != 32:
+        converted = pygame.Surface(surf.get_size(), 0, depth)
+        converted.blit(surf, (0, 0))
+        surf = converted
+    return surf
+
+def with_threads(func, thread_counts):
+    """Call func() with each of the transform thread counts, in order.
+
+    Returns the results in a list. The thread count is put back afterwards.
+    """
+    original_threads = pygame.transform._get_threads()
+    try:
+        results = []
+        for threads in thread_counts:
+            pygame.transform._set_threads(threads)
+            results.append(func())
+        return results
+    finally:
+        pygame.transform._set_threads(original_threads)
+
+
 class TransformModuleTest( unittest.TestCase ):
 
     def test_scale__alpha( self ):
@@ -746,6 +777,103 @@ class TransformModuleTest( unittest.TestCase ):
         self.assertEqual(s2.get_at((0,31)), (255,0,0,255))
         self.assertEqual(s2.get_at((31,31)), (255,0,0,255))
 
+    def test_convolve(self):
+        """convolve matches a plain weighted sum of the pixels around."""
+        w, h = 13, 11
+        src = pygame.Surface((w, h), pygame.SRCALPHA, 32)
+        for x in range(w):
+            for y in range(h):
+                src.set_at((x, y), ((x * 37 + y * 11) % 256,
+                                    (x * y * 7) % 256,
+                                    (255 - x * 19) % 256,
+                                    (y * 23 + 40) % 256))
+
+        def expected(kernel, divisor, offset, border):
+            kh, kw = len(kernel), len(kernel[0])
+            result = {}
+            for x in range(w):
+                for y in range(h):
+                    sums = [0.0] * 4
+                    for r in range(kh):
+                        for c in range(kw):
+                            sx, sy = x + c - kw // 2, y + r - kh // 2
+                            if border == 'wrap':
+                                color = src.get_at((sx % w, sy % h))
+                            elif border == 'clamp':
+                                color = src.get_at((min(max(sx, 0), w - 1),
+                                                    min(max(sy, 0), h - 1)))
+                            elif 0 <= sx < w and 0 <= sy < h:
+                                color = src.get_at((sx, sy))
+                            else:
+                                color = border
+                            for i in range(4):
+                                sums[i] += kernel[r][c] * color[i]
+                    result[x, y] = [
+                        min(max(int(math.floor(v / divisor + 0.5)) + offset,
+                                0), 255) for v in sums]
+            return result
+
+        cases = [
+            # a gaussian, applied as two passes
+            ([[1, 4, 6, 4, 1], [2, 8, 12, 8, 2], [1, 4, 6, 4, 1]],
+             None, 0, 'clamp'),
+            ([[1, 1, 1]] * 5, None, 0, 'wrap'),
+            ([[0, -1, 0], [-1, 5, -1], [0, -1, 0]], None, 0, 'clamp'),
+            ([[-2, -1, 0], [-1, 1, 1], [0, 1, 2]], 2, 10,
+             pygame.Color(30, 60, 90, 120)),
+            ([[1, 2, 3, 2, 1]], 3, -20, 'wrap'),
+        ]
+        for kernel, divisor, offset, border in cases:
+            result = pygame.transform.convolve(src, kernel, divisor, offset,
+                                               border)
+            total = divisor or sum(sum(row) for row in kernel) or 1
+            for (x, y), color in expected(kernel, total, offset,
+                                          border).items():
+                got = result.get_at((x, y))
+                for i in range(4):
+                    self.assertAlmostEqual(got[i], color[i], delta=1,
+                                           msg=(kernel, (x, y), got, color))
+
+        dest = pygame.Surface((w, h), pygame.SRCALPHA, 32)
+        result = pygame.transform.convolve(src, [[1]], dest_surface=dest)
+        self.assertIs(result, dest)
+        self.assertEqual(dest.get_buffer().raw, src.get_buffer().raw)
+
+        for args, kwargs in [(([[1, 1]],), {}),
+                             (([[1]],), {'divisor': 0}),
+                             (([[1]],), {'offset': 300}),
+                             (([[1]],), {'border': 'mirror'}),
+                             (([[1]],), {'dest_surface': src}),
+                             (([[1]],), {'dest_surface':
+                                         pygame.Surface((3, 3), 0, 32)})]:
+            self.assertRaises(ValueError, pygame.transform.convolve, src,
+                              *args, **kwargs)
+        self.assertRaises(TypeError, pygame.transform.convolve, src,
+                          [[1, 2, 3], [1]])
+        self.assertRaises(TypeError, pygame.transform.convolve, src, [])
+
+    def test_convolve__threads(self):
+        """Convolving in bands gives the same pixels as in one piece."""
+        src = banded_surface()
+        kernels = [[[1, 2, 1], [2, 4, 2], [1, 2, 1]],
+                   [[-1, -1, -1], [-1, 9, -1], [-1, -1, -1]]]
+
+        def convolved():
+            return ([pygame.transform.convolve(src, k) for k in kernels] +
+                    [pygame.transform.laplacian(src)])
+
+        banded, whole = with_threads(convolved, (3, 1))
+        self.assertEqual([s.get_buffer().raw for s in banded],
+                         [s.get_buffer().raw for s in whole])
+
+        # Both kernels sum to their divisor, so the inside of a block keeps
+        # its color, and has no edges for laplacian to find.
+        inside = (10, 7)
+        blur, sharpen, edges = banded
+        self.assertEqual(blur.get_at(inside), src.get_at(inside))
+        self.assertEqual(sharpen.get_at(inside), src.get_at(inside))
+        self.assertEqual(edges.get_at(inside)[:3], (0, 0, 0))
+
     def test_average_surfaces(self):
         """
         """
@@ -852,6 +980,47 @@ class TransformModuleTest( unittest.TestCase ):
         self.assertEqual(dest_surface.get_size(), expected_size)
         self.assertEqual(dest_surface.get_flags(), expected_flags)
 
+    def test_average_surfaces__many(self):
+        """Averages of many surfaces are rounded per channel."""
+        # Tall and big enough to be cut into row bands with 2 threads, with
+        # an odd width for the row tails.
+        size = (257, 256)
+        distinct = []
+        for i in range(37):
+            color = ((i * 41) % 256, (i * 7) % 256, 255 - (i * 41) % 256)
+            s = pygame.Surface(size, pygame.SRCALPHA, 32)
+            s.fill(color + (0,))
+            distinct.append((s, color))
+        surfaces = [distinct[i % 37][0] for i in range(300)]
+        colors = [distinct[i % 37][1] for i in range(300)]
+
+        expected = tuple(
+            int(sum(c[i] for c in colors) / float(len(colors)) + 0.5)
+            for i in range(3)) + (255,)
+
+        def averaged():
+            sr = pygame.transform.average_surfaces(surfaces)
+            return [sr.get_at(pos)
+                    for pos in ((0, 0), (256, 255), (128, 127), (3, 200))]
+
+        for results in with_threads(averaged, (1, 2)):
+            self.assertEqual(results, [expected] * 4)
+
+    def test_average_color__rects(self):
+        """average_color only counts the part of the rect on the surface."""
+        s = pygame.Surface((37, 20), pygame.SRCALPHA, 32)
+        s.fill((10, 20, 30, 40))
+        s.fill((50, 60, 70, 80), (0, 0, 37, 10))
+
+        self.assertEqual(pygame.transform.average_color(s),
+                         (30, 40, 50, 60))
+        self.assertEqual(pygame.transform.average_color(s, (-5, 5, 20, 10)),
+                         (30, 40, 50, 60))
+        self.assertEqual(pygame.transform.average_color(s, (30, 15, 20, 20)),
+                         (10, 20, 30, 40))
+        self.assertEqual(pygame.transform.average_color(s, (40, 0, 5, 5)),
+                         (0, 0, 0, 0))
+
     def test_average_color(self):
         """
         """
@@ -897,6 +1066,122 @@ class TransformModuleTest( unittest.TestCase ):
         for pt, color in gradient:
             self.assertTrue(s.get_at(pt) == color)
 
+    def test_rotate__filter(self):
+        """Each filter keeps flat areas flat and fills the corners."""
+        s = pygame.Surface((40, 30), pygame.SRCALPHA, 32)
+        s.fill((10, 200, 30, 255))
+        expected = pygame.transform.rotate(s, 30)
+
+        self.assertEqual(
+            pygame.transform.rotate(s, 30, 'nearest').get_buffer().raw,
+            expected.get_buffer().raw)
+        for filter in ('bilinear', 'bicubic'):
+            r = pygame.transform.rotate(s, 30, filter=filter)
+            self.assertEqual(r.get_size(), expected.get_size())
+            center = (r.get_width() // 2, r.get_height() // 2)
+            self.assertEqual(r.get_at(center), (10, 200, 30, 255))
+            self.assertEqual(r.get_at((0, 0)).a, 0)
+            for pos in ((x, y) for x in range(r.get_width())
+                        for y in range(r.get_height())):
+                self.assertEqual(r.get_at(pos).a, expected.get_at(pos).a)
+
+        self.assertRaises(ValueError, pygame.transform.rotate, s, 30, 'cubic')
+        self.assertRaises(ValueError, pygame.transform.rotate,
+                          pygame.Surface((4, 4), 0, 8), 30, 'bilinear')
+
+    def test_rotate__threads(self):
+        """Rotating in bands gives the same pixels as in one piece."""
+        src = banded_surface()
+
+        def rotated():
+            return ([pygame.transform.rotate(src, 37, filter)
+                     for filter in ('nearest', 'bilinear', 'bicubic')] +
+                    [pygame.transform.rotozoom(src, 37, 1.7)])
+
+        banded, whole = with_threads(rotated, (3, 1))
+        self.assertEqual([s.get_buffer().raw for s in banded],
+                         [s.get_buffer().raw for s in whole])
+
+        # The rotation turns about the middle of the surface, which lands in
+        # the middle of the result.
+        nearest = banded[0]
+        middle = nearest.get_width() // 2, nearest.get_height() // 2
+        self.assertEqual(nearest.get_at(middle), src.get_at((150, 141)))
+
+    def test_rotate__cache(self):
+        """rotate and rotozoom results are the same with the cache on."""
+        original_size = pygame.transform.get_cache_size()
+        self.assertEqual(original_size, 0)
+        s = pygame.Surface((40, 30), pygame.SRCALPHA, 32)
+        s.fill((10, 200, 30, 255))
+        fresh = pygame.transform.rotate(s, 30).get_buffer().raw
+        fresh_zoom = pygame.transform.rotozoom(s, 30, 1.5).get_buffer().raw
+
+        try:
+            pygame.transform.set_cache_size(1 << 20)
+            self.assertEqual(pygame.transform.get_cache_size(), 1 << 20)
+            r = pygame.transform.rotate(s, 30)
+            r2 = pygame.transform.rotate(s, 30)
+            self.assertIsNot(r2, r)
+            self.assertEqual(r2.get_buffer().raw, fresh)
+            pygame.transform.rotate(s, 31)
+            pygame.transform.rotate(s, 30, 'bilinear')
+            z = pygame.transform.rotozoom(s, 30, 1.5)
+            self.assertEqual(z.get_buffer().raw, fresh_zoom)
+            self.assertEqual(pygame.transform.rotozoom(s, 30, 1.5)
+                             .get_buffer().raw, fresh_zoom)
+
+            # Each call gets its own Surface, so changing one does not
+            # reach later calls.
+            r.fill((0, 0, 0, 0))
+            r.set_alpha(10)
+            r3 = pygame.transform.rotate(s, 30)
+            self.assertEqual(r3.get_buffer().raw, fresh)
+            self.assertEqual(r3.get_alpha(), r2.get_alpha())
+
+            # Changing the source does.
+            s.fill((90, 20, 30, 255))
+            r4 = pygame.transform.rotate(s, 30)
+            center = r4.get_width() // 2, r4.get_height() // 2
+            self.assertEqual(r4.get_at(center), (90, 20, 30, 255))
+
+            # The pixels of a frombuffer() image change behind its back.
+            data = bytearray(8 * 8 * 4)
+            shared = pygame.image.frombuffer(data, (8, 8), 'RGBA')
+            r5 = pygame.transform.rotate(shared, 30)
+            center = r5.get_width() // 2, r5.get_height() // 2
+            self.assertEqual(r5.get_at(center), (0, 0, 0, 0))
+            data[:] = b'\xff' * len(data)
+            r5 = pygame.transform.rotate(shared, 30)
+            self.assertEqual(r5.get_at(center), (255, 255, 255, 255))
+
+            # A destination surface gets a copy.
+            dest = pygame.Surface(r4.get_size(), pygame.SRCALPHA, 32)
+            self.assertIs(pygame.transform.rotate(s, 30, dest_surface=dest),
+                          dest)
+            self.assertEqual(dest.get_buffer().raw, r4.get_buffer().raw)
+            self.assertRaises(ValueError, pygame.transform.rotate, s, 30,
+                              dest_surface=pygame.Surface((3, 3), 0, 32))
+
+            # Over the budget, the least recently used result goes.
+            pygame.transform.clear_cache()
+            pygame.transform.set_cache_size(r4.get_pitch() * r4.get_height())
+            a = pygame.transform.rotate(s, 30).get_buffer().raw
+            b = pygame.transform.rotate(s, -30).get_buffer().raw
+            self.assertEqual(pygame.transform.rotate(s, -30).get_buffer().raw,
+                             b)
+            self.assertEqual(pygame.transform.rotate(s, 30).get_buffer().raw,
+                             a)
+
+            pygame.transform.clear_cache()
+            self.assertEqual(pygame.transform.rotate(s, 30).get_buffer().raw,
+                             a)
+            self.assertRaises(ValueError,
+                              pygame.transform.set_cache_size, -1)
+        finally:
+            pygame.transform.set_cache_size(original_size)
+            pygame.transform.clear_cache()
+
     def test_scale2x(self):
 
         # __doc__ (as of 2008-06-25) for pygame.transform.scale2x:
@@ -914,7 +1199,7 @@ class TransformModuleTest( unittest.TestCase ):
 
     def test_get_smoothscale_backend(self):
         filter_type = pygame.transform.get_smoothscale_backend()
-        self.assertTrue(filter_type in ['GENERIC', 'MMX', 'SSE'])
+        self.assertTrue(filter_type in ['GENERIC', 'MMX', 'SSE', 'AVX2'])
         # It would be nice to test if a non-generic type corresponds to an x86
         # processor. But there is no simple test for this. platform.machine()
         # returns process version specific information, like 'i686'.
@@ -941,7 +1226,7 @@ class TransformModuleTest( unittest.TestCase ):
             pygame.transform.set_smoothscale_backend(1)
         self.assertRaises(TypeError, change)
         # Unsupported type, if possible.
-        if original_type != 'SSE':
+        if original_type not in ('SSE', 'AVX2'):
             def change():
                 pygame.transform.set_smoothscale_backend('SSE')
             self.assertRaises(ValueError, change)
@@ -949,6 +1234,56 @@ class TransformModuleTest( unittest.TestCase ):
         filter_type = pygame.transform.get_smoothscale_backend()
         self.assertEqual(filter_type, original_type)
 
+    def test_smoothscale_backends_and_threads(self):
+        """AVX2 matches GENERIC and threaded passes match unthreaded ones."""
+        original_type = pygame.transform.get_smoothscale_backend()
+        self.assertEqual(pygame.transform._get_threads(), 1)
+        self.assertRaises(ValueError,
+                          pygame.transform._set_threads, -1)
+
+        src = banded_surface()
+        src24 = banded_surface(24)
+        sizes = ((97, 61), (301, 140), (640, 283), (700, 590), (45, 600))
+
+        def scaled(surf):
+            results = [pygame.transform.smoothscale(surf, size)
+                       for size in sizes]
+            self.assertEqual([s.get_size() for s in results], list(sizes))
+            return [s.get_buffer().raw for s in results]
+
+        backends = []
+        for backend in ('GENERIC', 'MMX', 'SSE', 'AVX2'):
+            try:
+                pygame.transform.set_smoothscale_backend(backend)
+            except ValueError:
+                continue
+            backends.append(backend)
+        try:
+            results = {}
+            for backend in backends:
+                pygame.transform.set_smoothscale_backend(backend)
+                for surf in (src, src24):
+                    expected, banded, auto = with_threads(
+                        lambda: scaled(surf), (1, 3, 0))
+                    self.assertEqual(banded, expected)
+                    self.assertEqual(auto, expected)
+                results[backend] = expected
+            if 'AVX2' in results:
+                self.assertEqual(results['AVX2'], results['GENERIC'])
+
+            # Both passes average colors, so a flat surface stays flat.
+            flat = pygame.Surface(src.get_size(), 0, 32)
+            flat.fill((40, 90, 160))
+            big, small = with_threads(
+                lambda: [pygame.transform.smoothscale(flat, size)
+                         for size in ((700, 590), (97, 61))], (3,))[0]
+            for surf in (big, small):
+                w, h = surf.get_size()
+                for pos in ((0, 0), (w - 1, h - 1), (w // 2, h // 2)):
+                    self.assertEqual(surf.get_at(pos), (40, 90, 160, 255))
+        finally:
+            pygame.transform.set_smoothscale_backend(original_type)
+
     def todo_test_chop(self):
 
         # __doc__ (as of 2008-08-02) for pygame.transform.chop: